@@ -0,0 +1,277 @@
+#ifndef HTTP_SIM_ARRIVALS_H
+#define HTTP_SIM_ARRIVALS_H
+
+// Open-loop request arrivals (--arrivalRate, --arrivalTrace, --maxBacklog).
+//
+// By default the clients are closed loop: the next request goes out only once
+// a response (plus --interval / --thinkDist) is done, so the offered load
+// follows the service rate and no queue ever builds up. In open-loop mode
+// requests arrive on their own clock instead:
+//
+//   --arrivalRate=R                 Poisson arrivals at R req/s
+//   --arrivalTrace=<file>           arrival times from a trace, one per line
+//                                   (seconds from client start, first column,
+//                                   non-decreasing, # comments)
+//   --arrivalTrace=<file> --arrivalRate=R
+//                                   the trace's pattern, time-scaled to a mean
+//                                   of R req/s
+//
+// Arrivals are dealt round robin over the client connections and wait in the
+// client's backlog until the connection can take them (HTTP/1.1: no response
+// outstanding; HTTP/2 and HTTP/3: a free stream slot). With --maxBacklog=B an
+// arrival that finds B requests waiting is dropped; 0 keeps the backlog
+// unbounded. Think times do not apply.
+//
+// GlobalHistograms().sojourn holds arrival -> last response byte, i.e. backlog
+// wait plus the request latency; `queued` in the request timeline is the
+// arrival time. The Poisson draws use stream kStreamBase + 4 next to the
+// --*Dist streams (see distributions.h), so a run number gives every protocol
+// the same arrivals.
+
+#include "distributions.h"
+#include "json-object.h"
+#include "latency-histogram.h"
+
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Arrival times of one run (seconds from client start), shared out per client.
+class ArrivalSchedule {
+public:
+  static constexpr int64_t kStream = SampledDistribution::kStreamBase + 4;
+
+  // Loads --arrivalTrace (empty = none). Call before sizing the run: a trace
+  // fixes the number of requests.
+  bool LoadTrace(const std::string& file, std::string& error) {
+    m_traceFile = file;
+    m_times.clear();
+    if (file.empty()) return true;
+    std::ifstream in(file);
+    if (!in) return Fail("cannot open " + file, error);
+    std::string line;
+    double last = 0.0;
+    while (std::getline(in, line)) {
+      size_t hash = line.find('#');
+      if (hash != std::string::npos) line.erase(hash);
+      std::istringstream ls(line);
+      double t;
+      if (!(ls >> t)) continue;
+      if (t < last) return Fail(file + ": arrival times must be non-negative and non-decreasing", error);
+      m_times.push_back(t);
+      last = t;
+    }
+    if (m_times.empty()) return Fail(file + ": no arrival times", error);
+    return true;
+  }
+
+  bool HasTrace() const { return !m_traceFile.empty(); }
+  uint32_t Size() const { return static_cast<uint32_t>(m_times.size()); }
+
+  // Turns open-loop mode on when a rate or trace is given: n Poisson arrivals
+  // at `rate`, or the loaded trace rescaled to `rate` (if > 0).
+  bool Setup(double rate, uint32_t n, std::string& error) {
+    if (rate < 0) return Fail("arrival rate must not be negative", error);
+    m_rate = rate;
+    m_active = rate > 0 || HasTrace();
+    if (HasTrace()) {
+      double span = m_times.back();
+      if (rate > 0) {
+        if (span <= 0) return Fail(m_traceFile + ": trace spans no time, cannot rescale", error);
+        double scale = (m_times.size() / span) / rate;
+        for (double& t : m_times) t *= scale;
+      } else {
+        m_rate = span > 0 ? m_times.size() / span : 0.0;
+      }
+      return true;
+    }
+    m_times.clear();
+    if (!m_active) return true;
+    Ptr<ExponentialRandomVariable> gap = CreateObject<ExponentialRandomVariable>();
+    gap->SetAttribute("Mean", DoubleValue(1.0 / rate));
+    gap->SetStream(kStream);
+    double t = 0.0;
+    m_times.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      t += gap->GetValue();
+      m_times.push_back(t);
+    }
+    return true;
+  }
+
+  bool Active() const { return m_active; }
+  // Offered load in req/s (the Poisson rate, or the trace's mean rate).
+  double OfferedRate() const { return m_rate; }
+
+  // Arrivals i, i + n, i + 2n, ... for client i of n.
+  std::vector<double> Share(uint32_t i, uint32_t n) const {
+    std::vector<double> out;
+    for (size_t k = i; k < m_times.size(); k += n) out.push_back(m_times[k]);
+    return out;
+  }
+
+  // "Open loop: Poisson 40.00 req/s, 200 arrivals over 4.93 s, backlog unbounded"
+  void Print(std::ostream& os, uint32_t maxBacklog) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "Open loop: " << (HasTrace() ? "trace " + m_traceFile : std::string("Poisson")) << " "
+       << std::fixed << std::setprecision(2) << m_rate << " req/s, " << m_times.size()
+       << " arrivals over " << (m_times.empty() ? 0.0 : m_times.back()) << " s, backlog ";
+    if (maxBacklog > 0) os << "<= " << maxBacklog;
+    else os << "unbounded";
+    os << "\n";
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+private:
+  bool Fail(const std::string& what, std::string& error) const {
+    error = what;
+    return false;
+  }
+
+  std::string m_traceFile;
+  std::vector<double> m_times;
+  double m_rate = 0.0;
+  bool m_active = false;
+};
+
+// Open-loop counters of one or more clients.
+struct ArrivalStats {
+  uint32_t arrived = 0;
+  uint32_t dropped = 0;     // found the backlog full
+  uint32_t completed = 0;   // response fully received
+  uint32_t peakBacklog = 0; // most requests waiting at once (largest client)
+  double firstArrival = std::numeric_limits<double>::infinity();
+  double lastDone = 0.0;
+
+  void Add(const ArrivalStats& o) {
+    arrived += o.arrived;
+    dropped += o.dropped;
+    completed += o.completed;
+    peakBacklog = std::max(peakBacklog, o.peakBacklog);
+    firstArrival = std::min(firstArrival, o.firstArrival);
+    lastDone = std::max(lastDone, o.lastDone);
+  }
+
+  // Completed requests per second from the first arrival to the last response.
+  double AchievedRate() const {
+    return completed > 0 && lastDone > firstArrival ? completed / (lastDone - firstArrival) : 0.0;
+  }
+
+  void Print(std::ostream& os, double offeredRate) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "Open loop: offered " << std::fixed << std::setprecision(2) << offeredRate
+       << " req/s, achieved " << AchievedRate() << " req/s, arrived " << arrived
+       << ", dropped " << dropped << ", completed " << completed
+       << ", peak backlog " << peakBacklog << "\n";
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+  void AddMetrics(JsonObject& metrics, double offeredRate) const {
+    metrics.Field("offered_rps", offeredRate).Field("achieved_rps", AchievedRate())
+           .Field("arrived_requests", arrived).Field("dropped_requests", dropped)
+           .Field("peak_backlog", peakBacklog);
+  }
+};
+
+// One client's backlog: arrivals are scheduled from Start() and wait here
+// until the client takes them, in arrival order.
+class ArrivalQueue {
+public:
+  // offsets: arrival times relative to Start(); maxBacklog 0 = unbounded.
+  void Assign(std::vector<double> offsets, uint32_t maxBacklog) {
+    m_offsets = offsets;
+    m_limit = maxBacklog;
+    m_active = true;
+  }
+  bool Active() const { return m_active; }
+
+  // Client start; `onArrival` runs after every arrival (dropped ones too).
+  void Start(std::function<void()> onArrival) {
+    if (!m_active) return;
+    Simulator::Cancel(m_event);
+    m_onArrival = onArrival;
+    m_origin = Simulator::Now().GetSeconds();
+    m_next = 0;
+    m_waiting.clear();
+    m_arrivalOf.clear();
+    m_stats = ArrivalStats();
+    ScheduleNext();
+  }
+  void Stop() { Simulator::Cancel(m_event); }
+
+  bool Empty() const { return m_waiting.empty(); }
+  uint32_t Dropped() const { return m_stats.dropped; }
+  const ArrivalStats& GetStats() const { return m_stats; }
+
+  // The oldest waiting request goes out as request i; returns its arrival time.
+  double Take(uint32_t i) {
+    double t = m_waiting.front();
+    m_waiting.pop_front();
+    if (i >= m_arrivalOf.size()) m_arrivalOf.resize(i + 1, -1.0);
+    m_arrivalOf[i] = t;
+    return t;
+  }
+
+  // Request i's response has fully arrived.
+  void Complete(uint32_t i, double now) {
+    if (i >= m_arrivalOf.size() || m_arrivalOf[i] < 0) return;
+    GlobalHistograms().sojourn.RecordSeconds(now - m_arrivalOf[i]);
+    ++m_stats.completed;
+    m_stats.lastDone = std::max(m_stats.lastDone, now);
+  }
+
+private:
+  void ScheduleNext() {
+    if (m_next >= m_offsets.size()) return;
+    double delay = std::max(0.0, m_origin + m_offsets[m_next] - Simulator::Now().GetSeconds());
+    m_event = Simulator::Schedule(Seconds(delay), &ArrivalQueue::Arrive, this);
+  }
+
+  void Arrive() {
+    double now = Simulator::Now().GetSeconds();
+    ++m_next;
+    ++m_stats.arrived;
+    m_stats.firstArrival = std::min(m_stats.firstArrival, now);
+    if (m_limit > 0 && m_waiting.size() >= m_limit) {
+      ++m_stats.dropped;
+    } else {
+      m_waiting.push_back(now);
+      m_stats.peakBacklog = std::max<uint32_t>(m_stats.peakBacklog, m_waiting.size());
+    }
+    ScheduleNext();
+    if (m_onArrival) m_onArrival();
+  }
+
+  std::vector<double> m_offsets;
+  uint32_t m_limit = 0;
+  bool m_active = false;
+  std::function<void()> m_onArrival;
+  double m_origin = 0.0;
+  size_t m_next = 0;
+  EventId m_event;
+  std::deque<double> m_waiting;    // arrival times, oldest first
+  std::vector<double> m_arrivalOf; // request index -> arrival time
+  ArrivalStats m_stats;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_ARRIVALS_H
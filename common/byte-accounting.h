@@ -0,0 +1,227 @@
+#ifndef HTTP_SIM_BYTE_ACCOUNTING_H
+#define HTTP_SIM_BYTE_ACCOUNTING_H
+
+// Per-layer byte accounting shared by the HTTP/1.1, HTTP/2 and HTTP/3 sims.
+//
+// Every byte is charged to (direction, layer, purpose):
+//   direction  up = client -> server, down = server -> client (by sending node)
+//   layer      link (PPP), ip, transport (TCP/UDP header), quic (packet and
+//              frame headers), framing (HTTP/2 / HTTP/3 frame headers),
+//              headers (HTTP header block), body
+//   purpose    data, retx, ack, control
+//
+// Sources:
+//   - TapDevices(): the wire as transmitted (PhyTxBegin on every link
+//     device). Charges link/ip/transport headers of each packet, and the
+//     payload of TCP retransmissions (to transport/retx; which HTTP bytes
+//     were resent is not known there). TCP purpose comes from the segment
+//     itself; UDP packets carry a BytePurposeTag set by the QUIC session.
+//   - The QUIC session charges its packet/frame overhead, ACK/PING-only
+//     packets and whole retransmitted packets.
+//   - The HTTP apps charge framing/headers/body when they hand bytes to the
+//     transport (first transmission only).
+// The sum over layers therefore matches the tapped wire bytes up to bytes
+// written by the apps but still unsent when the run ends.
+
+#include "json-object.h"
+
+#include "ns3/ipv4-header.h"
+#include "ns3/net-device-container.h"
+#include "ns3/packet.h"
+#include "ns3/ppp-header.h"
+#include "ns3/tag.h"
+#include "ns3/tcp-header.h"
+#include "ns3/udp-header.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace ns3 {
+
+enum ByteDir : uint8_t { BYTES_UP, BYTES_DOWN, BYTES_DIR_COUNT };
+enum ByteLayer : uint8_t {
+  BYTES_LINK, BYTES_IP, BYTES_TRANSPORT, BYTES_QUIC, BYTES_FRAMING, BYTES_HEADERS, BYTES_BODY,
+  BYTES_LAYER_COUNT
+};
+enum BytePurpose : uint8_t { BYTES_DATA, BYTES_RETX, BYTES_ACK, BYTES_CONTROL, BYTES_PURPOSE_COUNT };
+
+inline const char* ByteDirName(uint8_t d) { return d == BYTES_UP ? "up" : "down"; }
+inline const char* ByteLayerName(uint8_t l) {
+  static const char* const names[BYTES_LAYER_COUNT] = {"link", "ip", "transport", "quic", "framing", "headers", "body"};
+  return l < BYTES_LAYER_COUNT ? names[l] : "?";
+}
+inline const char* BytePurposeName(uint8_t p) {
+  static const char* const names[BYTES_PURPOSE_COUNT] = {"data", "retx", "ack", "control"};
+  return p < BYTES_PURPOSE_COUNT ? names[p] : "?";
+}
+
+// Purpose of a UDP datagram, attached by the QUIC session for the wire tap.
+class BytePurposeTag : public Tag {
+public:
+  BytePurposeTag() {}
+  explicit BytePurposeTag(BytePurpose p) : m_purpose(p) {}
+  BytePurpose Get() const { return m_purpose; }
+
+  static TypeId GetTypeId() {
+    static TypeId tid = TypeId("ns3::BytePurposeTag")
+                          .SetParent<Tag>()
+                          .SetGroupName("HttpSim")
+                          .AddConstructor<BytePurposeTag>();
+    return tid;
+  }
+  TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+  uint32_t GetSerializedSize() const override { return 1; }
+  void Serialize(TagBuffer i) const override { i.WriteU8(m_purpose); }
+  void Deserialize(TagBuffer i) override { m_purpose = static_cast<BytePurpose>(i.ReadU8()); }
+  void Print(std::ostream& os) const override { os << "purpose=" << BytePurposeName(m_purpose); }
+
+private:
+  BytePurpose m_purpose{BYTES_DATA};
+};
+
+class ByteAccounting {
+public:
+  // Packets sent by this node count as downlink; all others as uplink.
+  void SetServerNode(uint32_t node) { m_serverNode = node; }
+  ByteDir DirOf(uint32_t node) const { return node == m_serverNode ? BYTES_DOWN : BYTES_UP; }
+
+  void Add(uint32_t node, ByteLayer layer, BytePurpose purpose, uint64_t bytes) {
+    m_bytes[DirOf(node)][layer][purpose] += bytes;
+  }
+  uint64_t Get(ByteDir d, ByteLayer l, BytePurpose p) const { return m_bytes[d][l][p]; }
+  uint64_t LayerTotal(ByteDir d, ByteLayer l) const {
+    uint64_t sum = 0;
+    for (int p = 0; p < BYTES_PURPOSE_COUNT; ++p) sum += m_bytes[d][l][p];
+    return sum;
+  }
+  uint64_t Total(ByteDir d) const {
+    uint64_t sum = 0;
+    for (int l = 0; l < BYTES_LAYER_COUNT; ++l) sum += LayerTotal(d, static_cast<ByteLayer>(l));
+    return sum;
+  }
+  // Bytes seen by the tap (link headers included).
+  uint64_t WireBytes(ByteDir d) const { return m_wire[d]; }
+
+  void TapDevices(const NetDeviceContainer& devices) {
+    for (uint32_t i = 0; i < devices.GetN(); ++i) {
+      Ptr<NetDevice> dev = devices.Get(i);
+      dev->TraceConnectWithoutContext("PhyTxBegin",
+                                      MakeBoundCallback(&ByteAccounting::OnPhyTx, this, dev->GetNode()->GetId()));
+    }
+  }
+
+  // One table per direction; rows are layers with any bytes.
+  void Print(std::ostream& os) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    for (int d = 0; d < BYTES_DIR_COUNT; ++d) {
+      ByteDir dir = static_cast<ByteDir>(d);
+      if (Total(dir) == 0 && m_wire[d] == 0) continue;
+      os << std::left << std::setw(30) << (d == BYTES_UP ? "Bytes up (client->server)" : "Bytes down (server->client)")
+         << std::right;
+      for (int p = 0; p < BYTES_PURPOSE_COUNT; ++p) os << std::setw(12) << BytePurposeName(p);
+      os << std::setw(12) << "total" << "\n";
+      for (int l = 0; l < BYTES_LAYER_COUNT; ++l) {
+        ByteLayer layer = static_cast<ByteLayer>(l);
+        if (LayerTotal(dir, layer) == 0) continue;
+        os << "  " << std::left << std::setw(28) << ByteLayerName(l) << std::right;
+        for (int p = 0; p < BYTES_PURPOSE_COUNT; ++p) os << std::setw(12) << m_bytes[d][l][p];
+        os << std::setw(12) << LayerTotal(dir, layer) << "\n";
+      }
+      uint64_t body = LayerTotal(dir, BYTES_BODY);
+      os << "  accounted " << Total(dir) << " B, wire " << m_wire[d] << " B, body/wire " << std::fixed
+         << std::setprecision(1) << (m_wire[d] ? 100.0 * body / m_wire[d] : 0.0) << "%\n";
+      os.flags(flags);
+      os.precision(prec);
+    }
+  }
+
+  // bytes_<dir>_<layer>_<purpose> for every non-zero cell, and wire_bytes_<dir>.
+  void AddMetrics(JsonObject& metrics) const {
+    for (int d = 0; d < BYTES_DIR_COUNT; ++d) {
+      for (int l = 0; l < BYTES_LAYER_COUNT; ++l) {
+        for (int p = 0; p < BYTES_PURPOSE_COUNT; ++p) {
+          if (m_bytes[d][l][p] == 0) continue;
+          std::string key = std::string("bytes_") + ByteDirName(d) + "_" + ByteLayerName(l) + "_" + BytePurposeName(p);
+          metrics.Field(key.c_str(), m_bytes[d][l][p]);
+        }
+      }
+      metrics.Field((std::string("wire_bytes_") + ByteDirName(d)).c_str(), m_wire[d]);
+    }
+  }
+
+private:
+  static void OnPhyTx(ByteAccounting* self, uint32_t node, Ptr<const Packet> packet) { self->Tap(node, packet); }
+
+  void Tap(uint32_t node, Ptr<const Packet> packet) {
+    m_wire[DirOf(node)] += packet->GetSize();
+    Ptr<Packet> p = packet->Copy();
+    PppHeader ppp;
+    uint32_t link = p->RemoveHeader(ppp);
+    if (ppp.GetProtocol() != 0x0021) { // not IPv4
+      Add(node, BYTES_LINK, BYTES_CONTROL, packet->GetSize());
+      return;
+    }
+    Ipv4Header ip;
+    uint32_t ipBytes = p->RemoveHeader(ip);
+    BytePurpose purpose = BYTES_DATA;
+    uint32_t l4 = 0;
+    if (ip.GetProtocol() == 6) {
+      TcpHeader tcp;
+      l4 = p->RemoveHeader(tcp);
+      purpose = ClassifyTcp(node, tcp, p->GetSize());
+    } else if (ip.GetProtocol() == 17) {
+      UdpHeader udp;
+      l4 = p->RemoveHeader(udp);
+      BytePurposeTag tag;
+      if (packet->PeekPacketTag(tag)) purpose = tag.Get();
+    }
+    Add(node, BYTES_LINK, purpose, link);
+    Add(node, BYTES_IP, purpose, ipBytes);
+    Add(node, BYTES_TRANSPORT, purpose, l4);
+  }
+
+  // Payload-less segments are ACKs (or SYN/FIN/RST control); payload below
+  // the highest sequence already sent on this flow is a retransmission and
+  // is charged here, since the apps only account first transmissions.
+  BytePurpose ClassifyTcp(uint32_t node, const TcpHeader& tcp, uint32_t payload) {
+    uint8_t flags = tcp.GetFlags();
+    if (payload == 0) {
+      return (flags & (TcpHeader::SYN | TcpHeader::FIN | TcpHeader::RST)) ? BYTES_CONTROL : BYTES_ACK;
+    }
+    uint64_t flow = (uint64_t(node) << 32) | (uint32_t(tcp.GetSourcePort()) << 16) | tcp.GetDestinationPort();
+    uint32_t seq = tcp.GetSequenceNumber().GetValue();
+    auto it = m_tcpHighest.find(flow);
+    if (it == m_tcpHighest.end()) {
+      m_tcpHighest[flow] = seq + payload;
+      return BYTES_DATA;
+    }
+    int32_t resent = static_cast<int32_t>(it->second - seq); // bytes of this segment already sent
+    if (resent <= 0) {
+      it->second = seq + payload;
+      return BYTES_DATA;
+    }
+    uint32_t retx = std::min<uint32_t>(resent, payload);
+    Add(node, BYTES_TRANSPORT, BYTES_RETX, retx);
+    if (retx < payload) it->second = seq + payload;
+    return BYTES_RETX;
+  }
+
+  uint32_t m_serverNode = 1;
+  uint64_t m_bytes[BYTES_DIR_COUNT][BYTES_LAYER_COUNT][BYTES_PURPOSE_COUNT] = {};
+  uint64_t m_wire[BYTES_DIR_COUNT] = {};
+  std::map<uint64_t, uint32_t> m_tcpHighest; // (node, ports) -> next new sequence number
+};
+
+inline ByteAccounting& GlobalBytes() {
+  static ByteAccounting bytes;
+  return bytes;
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_BYTE_ACCOUNTING_H
@@ -0,0 +1,114 @@
+#ifndef HTTP_SIM_COLUMN_FILE_H
+#define HTTP_SIM_COLUMN_FILE_H
+
+// Column-major table of doubles written by the periodic samplers.
+//
+// Binary layout (host byte order), read back by trace2csv:
+//   char magic[4] = "HSCL"; uint16 version; uint16 ncols; uint64 nrows;
+//   ncols x { uint16 len; char name[len]; }
+//   ncols x { double value[nrows]; }
+// A path ending in ".csv" is written as CSV (header + one line per row).
+//
+// No ns-3 dependency so the reader can include it.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+constexpr uint16_t kColumnFileVersion = 1;
+
+struct ColumnTable {
+  std::vector<std::string> names;
+  std::vector<std::vector<double>> columns;
+
+  size_t AddColumn(const std::string& name) {
+    names.push_back(name);
+    columns.emplace_back();
+    return columns.size() - 1;
+  }
+  size_t Rows() const { return columns.empty() ? 0 : columns[0].size(); }
+
+  bool WriteCsv(FILE* f) const {
+    for (size_t c = 0; c < names.size(); ++c) std::fprintf(f, "%s%s", c ? "," : "", names[c].c_str());
+    std::fprintf(f, "\n");
+    for (size_t r = 0; r < Rows(); ++r) {
+      for (size_t c = 0; c < columns.size(); ++c) std::fprintf(f, "%s%.9g", c ? "," : "", columns[c][r]);
+      std::fprintf(f, "\n");
+    }
+    return !std::ferror(f);
+  }
+
+  // Returns false if the file cannot be written.
+  bool Write(const std::string& path) const {
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    FILE* f = std::fopen(path.c_str(), csv ? "w" : "wb");
+    if (!f) return false;
+    bool ok = csv ? WriteCsv(f) : WriteBinary(f);
+    return std::fclose(f) == 0 && ok;
+  }
+
+  bool Read(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    bool ok = ReadBinary(f);
+    std::fclose(f);
+    return ok;
+  }
+
+private:
+  bool WriteBinary(FILE* f) const {
+    uint16_t version = kColumnFileVersion;
+    uint16_t ncols = static_cast<uint16_t>(columns.size());
+    uint64_t nrows = Rows();
+    bool ok = std::fwrite("HSCL", 1, 4, f) == 4
+              && std::fwrite(&version, sizeof(version), 1, f) == 1
+              && std::fwrite(&ncols, sizeof(ncols), 1, f) == 1
+              && std::fwrite(&nrows, sizeof(nrows), 1, f) == 1;
+    for (size_t c = 0; ok && c < names.size(); ++c) {
+      uint16_t len = static_cast<uint16_t>(names[c].size());
+      ok = std::fwrite(&len, sizeof(len), 1, f) == 1 && std::fwrite(names[c].data(), 1, len, f) == len;
+    }
+    for (size_t c = 0; ok && c < columns.size(); ++c) {
+      ok = nrows == 0 || std::fwrite(columns[c].data(), sizeof(double), nrows, f) == nrows;
+    }
+    return ok;
+  }
+
+  bool ReadBinary(FILE* f) {
+    char magic[4];
+    uint16_t version = 0, ncols = 0;
+    uint64_t nrows = 0;
+    if (std::fread(magic, 1, 4, f) != 4 || std::memcmp(magic, "HSCL", 4) != 0) return false;
+    if (std::fread(&version, sizeof(version), 1, f) != 1 || version != kColumnFileVersion) return false;
+    if (std::fread(&ncols, sizeof(ncols), 1, f) != 1 || std::fread(&nrows, sizeof(nrows), 1, f) != 1) return false;
+    names.assign(ncols, std::string());
+    columns.assign(ncols, std::vector<double>());
+    for (auto& name : names) {
+      uint16_t len = 0;
+      if (std::fread(&len, sizeof(len), 1, f) != 1) return false;
+      name.resize(len);
+      if (len && std::fread(&name[0], 1, len, f) != len) return false;
+    }
+    // A corrupt or truncated header must not size the columns: the data
+    // that follows has to hold nrows * ncols doubles
+    long pos = std::ftell(f);
+    if (pos < 0 || std::fseek(f, 0, SEEK_END) != 0) return false;
+    long end = std::ftell(f);
+    if (end < pos || std::fseek(f, pos, SEEK_SET) != 0) return false;
+    uint64_t remaining = static_cast<uint64_t>(end - pos);
+    if (ncols > 0 && nrows > remaining / (sizeof(double) * ncols)) return false;
+    for (auto& col : columns) {
+      col.resize(nrows);
+      if (nrows && std::fread(col.data(), sizeof(double), nrows, f) != nrows) return false;
+    }
+    return true;
+  }
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_COLUMN_FILE_H
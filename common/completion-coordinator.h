@@ -0,0 +1,59 @@
+#ifndef HTTP_SIM_COMPLETION_COORDINATOR_H
+#define HTTP_SIM_COMPLETION_COORDINATOR_H
+
+// Ends a run early once every client has all of its responses.
+//
+// Each client app gets a done-callback from Register() and invokes it once,
+// when its last response completes. When the final registered client reports
+// in, the coordinator schedules Simulator::Stop() after a drain period (so
+// trailing ACKs, FINs and samplers settle). simTime stays in force as the
+// upper bound for runs that never finish.
+
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <iostream>
+
+namespace ns3 {
+
+class CompletionCoordinator {
+public:
+  CompletionCoordinator() = default;
+  CompletionCoordinator(bool autoStop, Time drainTime) : m_autoStop(autoStop), m_drainTime(drainTime) {}
+
+  // Registers one client; the returned callback must be invoked exactly once.
+  Callback<void> Register() {
+    ++m_expected;
+    return MakeCallback(&CompletionCoordinator::NotifyDone, this);
+  }
+
+  void NotifyDone() {
+    ++m_done;
+    if (m_done < m_expected || m_allDone) return;
+    m_allDone = true;
+    m_allDoneTime = Simulator::Now();
+    if (!m_autoStop) return;
+    std::cout << "All " << m_expected << " clients finished at " << m_allDoneTime.GetSeconds()
+              << "s, stopping after " << m_drainTime.GetSeconds() << "s drain" << std::endl;
+    Simulator::Schedule(m_drainTime, &CompletionCoordinator::StopSimulation);
+  }
+
+  bool AllDone() const { return m_allDone; }
+  Time GetAllDoneTime() const { return m_allDoneTime; }
+
+private:
+  static void StopSimulation() { Simulator::Stop(); }
+
+  bool m_autoStop = true;
+  Time m_drainTime = Seconds(0.5);
+  uint32_t m_expected = 0;
+  uint32_t m_done = 0;
+  bool m_allDone = false;
+  Time m_allDoneTime;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_COMPLETION_COORDINATOR_H
@@ -0,0 +1,261 @@
+#ifndef HTTP_SIM_DISTRIBUTIONS_H
+#define HTTP_SIM_DISTRIBUTIONS_H
+
+// Seeded per-request distributions: response sizes, request/response header
+// sizes and client think times (--respSizeDist, --reqHdrDist, --respHdrDist,
+// --thinkDist).
+//
+// A spec is "<name>:<args>":
+//
+//   fixed:<v>
+//   uniform:<min>,<max>
+//   exponential:<mean>[,<bound>]
+//   lognormal:<mu>,<sigma>           ln X ~ N(mu, sigma)
+//   pareto:<scale>,<shape>[,<bound>]  scale = minimum value
+//   zipf:<n>,<alpha>,<unit>          unit x rank, rank 1..n ~ Zipf(alpha):
+//                                    small objects popular, long tail
+//   empirical:<file>                 "<value> <cdf>" lines (# comments),
+//                                    both non-decreasing, cdf ending at 1;
+//                                    interpolated between points
+//
+// Sizes are in bytes and think times in seconds. Every generator is an ns-3
+// RandomVariableStream on a fixed stream number (kStreamBase + 0..3), so the
+// draws depend only on --RngSeed/--RngRun and not on how many other random
+// variables a sim creates: the same run number gives the three protocols the
+// same request mix. RequestDistributions draws all values up front, indexed
+// like g_respSizes by global request id: connection i of n sends requests i,
+// i + n, i + 2n, ... (the round robin of Workload::Share and
+// ArrivalSchedule::Share). Synthetic requests carry the id in their path,
+// "/file<id>", so client and server index the same draw whatever the
+// protocol's connection count or the order requests reach the server.
+
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class SampledDistribution {
+public:
+  static constexpr int64_t kStreamBase = 100;
+
+  bool IsSet() const { return bool(m_rv); }
+  const std::string& GetSpec() const { return m_spec; }
+
+  // Empty spec leaves the distribution unset; false (with error) if malformed.
+  bool Parse(const std::string& spec, std::string& error) {
+    m_spec = spec;
+    m_rv = Ptr<RandomVariableStream>();
+    m_unit = 1.0;
+    if (spec.empty()) return true;
+    size_t colon = spec.find(':');
+    std::string name = spec.substr(0, colon);
+    std::string args = colon == std::string::npos ? "" : spec.substr(colon + 1);
+    if (name == "empirical") return LoadEmpirical(args, error);
+
+    std::vector<double> a;
+    std::stringstream ss(args);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+      char* end = nullptr;
+      double v = std::strtod(item.c_str(), &end);
+      if (item.empty() || *end != '\0') return Fail("bad number '" + item + "'", error);
+      a.push_back(v);
+    }
+    auto want = [&](size_t lo, size_t hi) { return a.size() >= lo && a.size() <= hi; };
+    if (name == "fixed" && want(1, 1)) {
+      Ptr<ConstantRandomVariable> rv = CreateObject<ConstantRandomVariable>();
+      rv->SetAttribute("Constant", DoubleValue(a[0]));
+      m_rv = rv;
+    } else if (name == "uniform" && want(2, 2) && a[0] <= a[1]) {
+      Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+      rv->SetAttribute("Min", DoubleValue(a[0]));
+      rv->SetAttribute("Max", DoubleValue(a[1]));
+      m_rv = rv;
+    } else if (name == "exponential" && want(1, 2) && a[0] > 0) {
+      Ptr<ExponentialRandomVariable> rv = CreateObject<ExponentialRandomVariable>();
+      rv->SetAttribute("Mean", DoubleValue(a[0]));
+      rv->SetAttribute("Bound", DoubleValue(a.size() > 1 ? a[1] : 0.0));
+      m_rv = rv;
+    } else if (name == "lognormal" && want(2, 2) && a[1] > 0) {
+      Ptr<LogNormalRandomVariable> rv = CreateObject<LogNormalRandomVariable>();
+      rv->SetAttribute("Mu", DoubleValue(a[0]));
+      rv->SetAttribute("Sigma", DoubleValue(a[1]));
+      m_rv = rv;
+    } else if (name == "pareto" && want(2, 3) && a[0] > 0 && a[1] > 0) {
+      Ptr<ParetoRandomVariable> rv = CreateObject<ParetoRandomVariable>();
+      rv->SetAttribute("Scale", DoubleValue(a[0]));
+      rv->SetAttribute("Shape", DoubleValue(a[1]));
+      rv->SetAttribute("Bound", DoubleValue(a.size() > 2 ? a[2] : 0.0));
+      m_rv = rv;
+    } else if (name == "zipf" && want(3, 3) && a[0] >= 1 && a[1] > 0) {
+      Ptr<ZipfRandomVariable> rv = CreateObject<ZipfRandomVariable>();
+      rv->SetAttribute("N", UintegerValue(static_cast<uint32_t>(a[0])));
+      rv->SetAttribute("Alpha", DoubleValue(a[1]));
+      m_rv = rv;
+      m_unit = a[2];
+    } else {
+      return Fail("unknown distribution or bad arguments", error);
+    }
+    return true;
+  }
+
+  void AssignStream(int64_t stream) {
+    if (m_rv) m_rv->SetStream(stream);
+  }
+
+  double Sample() { return m_rv ? m_unit * m_rv->GetValue() : 0.0; }
+
+  std::vector<uint32_t> SampleBytes(uint32_t n) {
+    std::vector<uint32_t> v;
+    v.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      double x = std::min(Sample(), double(std::numeric_limits<uint32_t>::max()));
+      v.push_back(static_cast<uint32_t>(std::max(0.0, x) + 0.5));
+    }
+    return v;
+  }
+
+  std::vector<double> SampleSeconds(uint32_t n) {
+    std::vector<double> v;
+    v.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) v.push_back(std::max(0.0, Sample()));
+    return v;
+  }
+
+private:
+  bool Fail(const std::string& what, std::string& error) const {
+    error = "'" + m_spec + "': " + what;
+    return false;
+  }
+
+  bool LoadEmpirical(const std::string& file, std::string& error) {
+    std::ifstream in(file);
+    if (!in) return Fail("cannot open " + file, error);
+    Ptr<EmpiricalRandomVariable> rv = CreateObject<EmpiricalRandomVariable>();
+    rv->SetInterpolate(true);
+    double lastValue = -std::numeric_limits<double>::infinity();
+    double lastCdf = 0.0;
+    std::string line;
+    uint32_t points = 0;
+    while (std::getline(in, line)) {
+      size_t hash = line.find('#');
+      if (hash != std::string::npos) line.erase(hash);
+      std::istringstream ls(line);
+      double value, cdf;
+      if (!(ls >> value)) continue;
+      if (!(ls >> cdf) || cdf < lastCdf || cdf > 1.0 || value < lastValue) {
+        return Fail(file + ": bad point '" + line + "'", error);
+      }
+      rv->CDF(value, cdf);
+      lastValue = value;
+      lastCdf = cdf;
+      ++points;
+    }
+    if (points == 0 || lastCdf != 1.0) return Fail(file + ": CDF must end at 1", error);
+    m_rv = rv;
+    return true;
+  }
+
+  std::string m_spec;
+  Ptr<RandomVariableStream> m_rv;
+  double m_unit = 1.0; // zipf: bytes per rank
+};
+
+// The four per-request tables of one run.
+class RequestDistributions {
+public:
+  // Parses the specs (empty = keep the sim's fixed values) and draws n values
+  // for each one that is set.
+  bool Setup(const std::string& respSize, const std::string& reqHdr, const std::string& respHdr,
+             const std::string& think, uint32_t n, std::string& error) {
+    const std::string* specs[] = {&respSize, &reqHdr, &respHdr, &think};
+    for (int k = 0; k < 4; ++k) {
+      if (!m_dist[k].Parse(*specs[k], error)) return false;
+      m_dist[k].AssignStream(SampledDistribution::kStreamBase + k);
+    }
+    m_respSizes = m_dist[0].IsSet() ? m_dist[0].SampleBytes(n) : std::vector<uint32_t>();
+    m_reqHeaderSizes = m_dist[1].IsSet() ? m_dist[1].SampleBytes(n) : std::vector<uint32_t>();
+    m_respHeaderSizes = m_dist[2].IsSet() ? m_dist[2].SampleBytes(n) : std::vector<uint32_t>();
+    m_thinkTimes = m_dist[3].IsSet() ? m_dist[3].SampleSeconds(n) : std::vector<double>();
+    return true;
+  }
+
+  bool Any() const { return m_dist[0].IsSet() || m_dist[1].IsSet() || m_dist[2].IsSet() || m_dist[3].IsSet(); }
+  const std::vector<uint32_t>& RespSizes() const { return m_respSizes; }
+
+  // Value for request i, or `fallback` when that distribution is unset.
+  uint32_t ReqHeaderBytes(uint32_t i, uint32_t fallback) const { return At(m_reqHeaderSizes, i, fallback); }
+  uint32_t RespHeaderBytes(uint32_t i, uint32_t fallback) const { return At(m_respHeaderSizes, i, fallback); }
+  double ThinkSeconds(uint32_t i, double fallback) const { return At(m_thinkTimes, i, fallback); }
+  bool HasThinkTimes() const { return !m_thinkTimes.empty(); }
+
+  // "Distributions: respSize=... (mean ...)" for the ones that are set.
+  void Print(std::ostream& os) const {
+    static const char* const names[] = {"respSize", "reqHdr", "respHdr", "think"};
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "Distributions:";
+    for (int k = 0; k < 4; ++k) {
+      if (!m_dist[k].IsSet()) continue;
+      double mean = k == 3 ? Mean(m_thinkTimes)
+                           : Mean(k == 0 ? m_respSizes : k == 1 ? m_reqHeaderSizes : m_respHeaderSizes);
+      os << " " << names[k] << "=" << m_dist[k].GetSpec() << " (mean " << std::fixed
+         << std::setprecision(k == 3 ? 6 : 0) << mean << (k == 3 ? " s)" : " B)");
+    }
+    os << "\n";
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+private:
+  template <typename T>
+  static T At(const std::vector<T>& v, uint32_t i, T fallback) {
+    return v.empty() ? fallback : v[std::min<size_t>(i, v.size() - 1)];
+  }
+
+  template <typename T>
+  static double Mean(const std::vector<T>& v) {
+    double sum = 0.0;
+    for (T x : v) sum += x;
+    return v.empty() ? 0.0 : sum / v.size();
+  }
+
+  SampledDistribution m_dist[4];
+  std::vector<uint32_t> m_respSizes;
+  std::vector<uint32_t> m_reqHeaderSizes;
+  std::vector<uint32_t> m_respHeaderSizes;
+  std::vector<double> m_thinkTimes;
+};
+
+// Global id of connection `conn`'s k-th request (of nConns connections).
+inline uint32_t GlobalRequestId(uint32_t conn, uint32_t nConns, uint32_t k) { return k * nConns + conn; }
+
+inline std::string RequestIdPath(uint32_t id) { return "/file" + std::to_string(id); }
+
+// Request id of a "/file<id>" path, `fallback` for any other path.
+inline uint32_t RequestIdOfPath(const std::string& path, uint32_t fallback) {
+  if (path.compare(0, 5, "/file") != 0 || path.size() == 5 || path.size() > 15) return fallback;
+  uint64_t id = 0;
+  for (size_t k = 5; k < path.size(); ++k) {
+    if (path[k] < '0' || path[k] > '9') return fallback;
+    id = id * 10 + (path[k] - '0');
+  }
+  return id <= std::numeric_limits<uint32_t>::max() ? static_cast<uint32_t>(id) : fallback;
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_DISTRIBUTIONS_H
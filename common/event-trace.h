@@ -0,0 +1,178 @@
+#ifndef HTTP_SIM_EVENT_TRACE_H
+#define HTTP_SIM_EVENT_TRACE_H
+
+// In-memory binary event tracer shared by the HTTP/1.1, HTTP/2 and HTTP/3 sims.
+//
+// Hot-path hooks append a fixed 32-byte TraceRecord to a power-of-two ring
+// (one store and a mask, no formatting, no I/O). When the ring is full the
+// oldest records are overwritten and counted as dropped. The sims call Dump()
+// once at the end of the run; trace2csv/trace2csv.cc turns the file into CSV.
+//
+// File layout: TraceFileHeader followed by `count` TraceRecords, oldest first,
+// in host byte order.
+//
+// The header deliberately has no ns-3 dependency so the reader can include it.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+enum TraceEventType : uint16_t {
+  TRACE_MAC_TX = 1,      // bytes = packet size
+  TRACE_MAC_RX = 2,      // bytes = packet size
+  TRACE_TCP_RETX = 3,    // bytes = retransmitted segment size
+  TRACE_CWND = 4,        // value = cwnd (bytes), bytes = bytes in flight
+  TRACE_STREAM_DONE = 5, // stream = stream/request id, bytes = response size
+  TRACE_QUIC_RETX = 6,   // value = old packet number
+  TRACE_RTT = 7,         // value = RTT sample (ns)
+  TRACE_CONG_STATE = 8,  // value = TcpSocketState::TcpCongState_t
+  TRACE_RTO = 9,         // value = retransmission timeout (ns)
+};
+// For TCP socket events (CWND/RTT/CONG_STATE/RTO) `stream` is the connection
+// number assigned by TcpProbeSet; QUIC session events use stream 0.
+
+inline const char* TraceEventName(uint16_t type) {
+  switch (type) {
+    case TRACE_MAC_TX: return "mac_tx";
+    case TRACE_MAC_RX: return "mac_rx";
+    case TRACE_TCP_RETX: return "tcp_retx";
+    case TRACE_CWND: return "cwnd";
+    case TRACE_STREAM_DONE: return "stream_done";
+    case TRACE_QUIC_RETX: return "quic_retx";
+    case TRACE_RTT: return "rtt";
+    case TRACE_CONG_STATE: return "cong_state";
+    case TRACE_RTO: return "rto";
+    default: return "unknown";
+  }
+}
+
+struct TraceRecord {
+  int64_t timeNs;
+  uint32_t node;
+  uint16_t type;
+  uint16_t flags;
+  uint32_t stream;
+  uint32_t bytes;
+  uint64_t value;
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay 32 bytes");
+
+struct TraceFileHeader {
+  char magic[4];     // "HSTR"
+  uint16_t version;
+  uint16_t recordSize;
+  uint64_t count;    // records that follow
+  uint64_t dropped;  // records overwritten before the dump
+  char source[16];   // writer, e.g. "http2"
+};
+
+constexpr uint16_t kTraceFileVersion = 1;
+
+class EventTracer {
+public:
+  // Allocates the ring, rounding capacity up to a power of two.
+  void Enable(size_t capacity) {
+    size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+    m_ring.assign(cap, TraceRecord());
+    m_mask = cap - 1;
+    m_next = 0;
+  }
+
+  bool IsEnabled() const { return !m_ring.empty(); }
+
+  void Record(int64_t timeNs, uint32_t node, uint16_t type,
+              uint32_t stream, uint32_t bytes, uint64_t value = 0, uint16_t flags = 0) {
+    if (m_ring.empty()) return;
+    TraceRecord& r = m_ring[m_next & m_mask];
+    r.timeNs = timeNs; r.node = node; r.type = type; r.flags = flags;
+    r.stream = stream; r.bytes = bytes; r.value = value;
+    ++m_next;
+  }
+
+  uint64_t GetRecorded() const { return m_next; }
+  uint64_t GetDropped() const { return m_next > m_ring.size() ? m_next - m_ring.size() : 0; }
+
+  // Writes the retained records oldest first. Returns false if the file
+  // cannot be written.
+  bool Dump(const std::string& path, const std::string& source) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    TraceFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "HSTR", 4);
+    h.version = kTraceFileVersion;
+    h.recordSize = sizeof(TraceRecord);
+    h.dropped = GetDropped();
+    h.count = m_next - h.dropped;
+    std::strncpy(h.source, source.c_str(), sizeof(h.source) - 1);
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    uint64_t first = h.dropped;
+    // The retained window may wrap around the end of the ring: two writes.
+    size_t start = first & m_mask;
+    size_t n1 = std::min<uint64_t>(h.count, m_ring.size() - start);
+    if (ok && n1) ok = std::fwrite(&m_ring[start], sizeof(TraceRecord), n1, f) == n1;
+    if (ok && h.count > n1) ok = std::fwrite(&m_ring[0], sizeof(TraceRecord), h.count - n1, f) == h.count - n1;
+    return std::fclose(f) == 0 && ok;
+  }
+
+private:
+  std::vector<TraceRecord> m_ring;
+  size_t m_mask{0};
+  uint64_t m_next{0};
+};
+
+// One tracer per process; the sims are single-threaded.
+inline EventTracer& GlobalTracer() {
+  static EventTracer tracer;
+  return tracer;
+}
+
+// End-of-run dump of GlobalTracer() with a one-line report; no-op when the
+// tracer was never enabled.
+inline void DumpGlobalTrace(const std::string& path, const std::string& source, std::ostream& os) {
+  const EventTracer& t = GlobalTracer();
+  if (!t.IsEnabled()) return;
+  if (t.Dump(path, source)) {
+    os << "Event trace: " << t.GetRecorded() - t.GetDropped() << " records ("
+       << t.GetDropped() << " dropped) -> " << path << std::endl;
+  } else {
+    std::cerr << "Event trace: cannot write " << path << std::endl;
+  }
+}
+
+// Reads a file written by EventTracer::Dump. Returns false on a bad header
+// or a short read.
+inline bool ReadTraceFile(const std::string& path, TraceFileHeader& h, std::vector<TraceRecord>& out) {
+  FILE* f = std::fopen(path.c_str(), "rb");
+  if (!f) return false;
+  bool ok = std::fread(&h, sizeof(h), 1, f) == 1
+            && std::memcmp(h.magic, "HSTR", 4) == 0
+            && h.version == kTraceFileVersion
+            && h.recordSize == sizeof(TraceRecord);
+  if (ok) {
+    // A corrupt or truncated header must not size the vector: the rest of
+    // the file has to hold count records
+    long pos = std::ftell(f);
+    ok = pos >= 0 && std::fseek(f, 0, SEEK_END) == 0;
+    long end = ok ? std::ftell(f) : -1;
+    ok = ok && end >= pos && std::fseek(f, pos, SEEK_SET) == 0
+         && h.count <= static_cast<uint64_t>(end - pos) / sizeof(TraceRecord);
+  }
+  if (ok) {
+    out.resize(h.count);
+    ok = h.count == 0 || std::fread(out.data(), sizeof(TraceRecord), h.count, f) == h.count;
+  }
+  std::fclose(f);
+  return ok;
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_EVENT_TRACE_H
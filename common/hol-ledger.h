@@ -0,0 +1,147 @@
+#ifndef HTTP_SIM_HOL_LEDGER_H
+#define HTTP_SIM_HOL_LEDGER_H
+
+// Head-of-line bookkeeping for one in-order byte stream (a TCP receive
+// stream or a single QUIC stream).
+//
+// Data that arrives beyond the in-order point `next` is held behind a gap;
+// Hold() records it with its arrival time (duplicates ignored) and
+// Advance() releases it once `next` moves past it. A gap episode lasts while
+// any bytes are held. Offsets are stream bytes from 0.
+//
+// No ns-3 dependency; callers pass the simulation time in seconds.
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace ns3 {
+
+// HoL share of a byte range of the stream.
+struct HolShare {
+  uint64_t bytes = 0;   // bytes of the range that waited behind a gap
+  double seconds = 0.0; // longest wait of any of them
+
+  void Add(const HolShare& o) {
+    bytes += o.bytes;
+    seconds = std::max(seconds, o.seconds);
+  }
+};
+
+struct RxHolStats {
+  uint64_t episodes = 0;     // times a gap opened with data waiting behind it
+  double seconds = 0.0;      // time data was waiting behind a gap
+  uint64_t heldBytes = 0;    // distinct bytes that arrived behind a gap
+  uint64_t maxHeldBytes = 0; // peak bytes waiting at once
+  double byteSeconds = 0.0;  // sum over held bytes of their wait
+  double maxWait = 0.0;      // longest wait of any byte
+
+  void Add(const RxHolStats& o) {
+    episodes += o.episodes;
+    seconds += o.seconds;
+    heldBytes += o.heldBytes;
+    maxHeldBytes = std::max(maxHeldBytes, o.maxHeldBytes);
+    byteSeconds += o.byteSeconds;
+    maxWait = std::max(maxWait, o.maxWait);
+  }
+};
+
+class HolLedger {
+public:
+  // [lo, hi) arrived at `now`; the part at or beyond `next` is held.
+  void Hold(uint64_t lo, uint64_t hi, uint64_t next, double now) {
+    lo = std::max(lo, next);
+    uint64_t cur = lo;
+    auto it = m_chunks.upper_bound(lo);
+    if (it != m_chunks.begin()) cur = std::max(cur, std::prev(it)->second.hi);
+    while (cur < hi) {
+      uint64_t end = (it != m_chunks.end() && it->first < hi) ? it->first : hi;
+      if (end > cur) {
+        m_chunks[cur] = Chunk{end, now, -1.0};
+        m_stats.heldBytes += end - cur;
+        m_heldNow += end - cur;
+      }
+      if (it == m_chunks.end() || it->first >= hi) break;
+      cur = std::max(cur, it->second.hi);
+      ++it;
+    }
+    m_stats.maxHeldBytes = std::max(m_stats.maxHeldBytes, m_heldNow);
+  }
+
+  // The in-order point is now `next`: releases what it passed and opens or
+  // closes the gap episode.
+  void Advance(uint64_t next, double now) {
+    for (auto it = m_chunks.lower_bound(m_released); it != m_chunks.end() && it->first < next; ++it) {
+      Chunk& c = it->second;
+      if (c.hi > next) { // gap filled part-way through the chunk
+        m_chunks[next] = Chunk{c.hi, c.arrival, -1.0};
+        c.hi = next;
+      }
+      uint64_t n = c.hi - it->first;
+      c.release = now;
+      m_heldNow -= n;
+      m_stats.byteSeconds += n * (now - c.arrival);
+      m_stats.maxWait = std::max(m_stats.maxWait, now - c.arrival);
+    }
+    m_released = std::max(m_released, next);
+
+    if (m_heldNow > 0 && m_openSince < 0) {
+      m_openSince = now;
+      ++m_stats.episodes;
+    } else if (m_heldNow == 0 && m_openSince >= 0) {
+      m_stats.seconds += now - m_openSince;
+      m_openSince = -1.0;
+    }
+  }
+
+  // Bytes currently waiting behind a gap.
+  uint64_t HeldBytes() const { return m_heldNow; }
+
+  // HoL share of [lo, hi) and forgets it; ranges must be consumed in order.
+  HolShare Consume(uint64_t lo, uint64_t hi, double now) {
+    HolShare share;
+    while (!m_chunks.empty() && m_chunks.begin()->first < hi) {
+      auto it = m_chunks.begin();
+      uint64_t from = std::max(lo, it->first);
+      uint64_t to = std::min(hi, it->second.hi);
+      if (to > from) {
+        share.bytes += to - from;
+        double release = it->second.release >= 0 ? it->second.release : now;
+        share.seconds = std::max(share.seconds, release - it->second.arrival);
+      }
+      if (it->second.hi > hi) { // keep the part past this range
+        Chunk rest = it->second;
+        m_chunks.erase(it);
+        m_chunks[hi] = rest;
+        break;
+      }
+      m_chunks.erase(it);
+    }
+    return share;
+  }
+
+  // An episode still open counts up to `now`.
+  RxHolStats GetStats(double now) const {
+    RxHolStats s = m_stats;
+    if (m_openSince >= 0) s.seconds += now - m_openSince;
+    return s;
+  }
+
+private:
+  struct Chunk {
+    uint64_t hi;
+    double arrival;
+    double release; // -1 while still behind a gap
+  };
+
+  std::map<uint64_t, Chunk> m_chunks; // keyed by start offset, non-overlapping
+  uint64_t m_released = 0;            // chunks below this are released
+  uint64_t m_heldNow = 0;
+  double m_openSince = -1.0;
+  RxHolStats m_stats;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_HOL_LEDGER_H
@@ -0,0 +1,477 @@
+#ifndef HTTP_SIM_HPACK_H
+#define HTTP_SIM_HPACK_H
+
+// HPACK header compression (RFC 7541) for the HTTP/2 sim.
+//
+// HpackEncoder/HpackDecoder hold one direction of a connection each: the
+// static table, a size-limited dynamic table (entry size = name + value + 32,
+// oldest entries evicted first) and the canonical Huffman code of Appendix B.
+// The encoder emits, per field:
+//   - indexed field when name and value are in a table,
+//   - literal with incremental indexing otherwise (name by index when known),
+//   - literal without indexing when the entry would take more than 3/4 of the
+//     table (it would only flush useful entries),
+//   - literal never indexed for credentials (authorization).
+// String literals are Huffman coded when that is shorter.
+//
+// The integer, string and Huffman primitives are shared with QPACK (RFC 9204),
+// which uses the same static Huffman code and integer encoding with different
+// prefixes.
+
+#include "http-headers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// ---------------------------------------------------------------------------
+// Primitives
+// ---------------------------------------------------------------------------
+
+// Integer with an N-bit prefix (§5.1); `flags` fills the bits above the prefix.
+inline void HpackEncodeInt(std::string& out, uint8_t flags, uint8_t prefixBits, uint64_t value) {
+  uint8_t max = static_cast<uint8_t>((1u << prefixBits) - 1);
+  if (value < max) {
+    out.push_back(static_cast<char>(flags | value));
+    return;
+  }
+  out.push_back(static_cast<char>(flags | max));
+  value -= max;
+  while (value >= 128) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// Reads an integer whose prefix starts at in[pos]; false if truncated or
+// larger than 2^62.
+inline bool HpackDecodeInt(const std::string& in, size_t& pos, uint8_t prefixBits, uint64_t& value) {
+  if (pos >= in.size()) return false;
+  uint8_t max = static_cast<uint8_t>((1u << prefixBits) - 1);
+  value = static_cast<uint8_t>(in[pos++]) & max;
+  if (value < max) return true;
+  for (unsigned shift = 0; shift <= 56; shift += 7) {
+    if (pos >= in.size()) return false;
+    uint8_t b = static_cast<uint8_t>(in[pos++]);
+    value += uint64_t(b & 0x7f) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+struct HuffmanSym {
+  uint32_t code;
+  uint8_t bits;
+};
+
+// RFC 7541 Appendix B; index 256 is EOS.
+inline const HuffmanSym* HuffmanTable() {
+  static const HuffmanSym table[257] = {
+    {0x1ff8, 13},     {0x7fffd8, 23},   {0xfffffe2, 28},  {0xfffffe3, 28},  {0xfffffe4, 28},  {0xfffffe5, 28},
+    {0xfffffe6, 28},  {0xfffffe7, 28},  {0xfffffe8, 28},  {0xffffea, 24},   {0x3ffffffc, 30}, {0xfffffe9, 28},
+    {0xfffffea, 28},  {0x3ffffffd, 30}, {0xfffffeb, 28},  {0xfffffec, 28},  {0xfffffed, 28},  {0xfffffee, 28},
+    {0xfffffef, 28},  {0xffffff0, 28},  {0xffffff1, 28},  {0xffffff2, 28},  {0x3ffffffe, 30}, {0xffffff3, 28},
+    {0xffffff4, 28},  {0xffffff5, 28},  {0xffffff6, 28},  {0xffffff7, 28},  {0xffffff8, 28},  {0xffffff9, 28},
+    {0xffffffa, 28},  {0xffffffb, 28},  {0x14, 6},        {0x3f8, 10},      {0x3f9, 10},      {0xffa, 12},
+    {0x1ff9, 13},     {0x15, 6},        {0xf8, 8},        {0x7fa, 11},      {0x3fa, 10},      {0x3fb, 10},
+    {0xf9, 8},        {0x7fb, 11},      {0xfa, 8},        {0x16, 6},        {0x17, 6},        {0x18, 6},
+    {0x0, 5},         {0x1, 5},         {0x2, 5},         {0x19, 6},        {0x1a, 6},        {0x1b, 6},
+    {0x1c, 6},        {0x1d, 6},        {0x1e, 6},        {0x1f, 6},        {0x5c, 7},        {0xfb, 8},
+    {0x7ffc, 15},     {0x20, 6},        {0xffb, 12},      {0x3fc, 10},      {0x1ffa, 13},     {0x21, 6},
+    {0x5d, 7},        {0x5e, 7},        {0x5f, 7},        {0x60, 7},        {0x61, 7},        {0x62, 7},
+    {0x63, 7},        {0x64, 7},        {0x65, 7},        {0x66, 7},        {0x67, 7},        {0x68, 7},
+    {0x69, 7},        {0x6a, 7},        {0x6b, 7},        {0x6c, 7},        {0x6d, 7},        {0x6e, 7},
+    {0x6f, 7},        {0x70, 7},        {0x71, 7},        {0x72, 7},        {0xfc, 8},        {0x73, 7},
+    {0xfd, 8},        {0x1ffb, 13},     {0x7fff0, 19},    {0x1ffc, 13},     {0x3ffc, 14},     {0x22, 6},
+    {0x7ffd, 15},     {0x3, 5},         {0x23, 6},        {0x4, 5},         {0x24, 6},        {0x5, 5},
+    {0x25, 6},        {0x26, 6},        {0x27, 6},        {0x6, 5},         {0x74, 7},        {0x75, 7},
+    {0x28, 6},        {0x29, 6},        {0x2a, 6},        {0x7, 5},         {0x2b, 6},        {0x76, 7},
+    {0x2c, 6},        {0x8, 5},         {0x9, 5},         {0x2d, 6},        {0x77, 7},        {0x78, 7},
+    {0x79, 7},        {0x7a, 7},        {0x7b, 7},        {0x7ffe, 15},     {0x7fc, 11},      {0x3ffd, 14},
+    {0x1ffd, 13},     {0xffffffc, 28},  {0xfffe6, 20},    {0x3fffd2, 22},   {0xfffe7, 20},    {0xfffe8, 20},
+    {0x3fffd3, 22},   {0x3fffd4, 22},   {0x3fffd5, 22},   {0x7fffd9, 23},   {0x3fffd6, 22},   {0x7fffda, 23},
+    {0x7fffdb, 23},   {0x7fffdc, 23},   {0x7fffdd, 23},   {0x7fffde, 23},   {0xffffeb, 24},   {0x7fffdf, 23},
+    {0xffffec, 24},   {0xffffed, 24},   {0x3fffd7, 22},   {0x7fffe0, 23},   {0xffffee, 24},   {0x7fffe1, 23},
+    {0x7fffe2, 23},   {0x7fffe3, 23},   {0x7fffe4, 23},   {0x1fffdc, 21},   {0x3fffd8, 22},   {0x7fffe5, 23},
+    {0x3fffd9, 22},   {0x7fffe6, 23},   {0x7fffe7, 23},   {0xffffef, 24},   {0x3fffda, 22},   {0x1fffdd, 21},
+    {0xfffe9, 20},    {0x3fffdb, 22},   {0x3fffdc, 22},   {0x7fffe8, 23},   {0x7fffe9, 23},   {0x1fffde, 21},
+    {0x7fffea, 23},   {0x3fffdd, 22},   {0x3fffde, 22},   {0xfffff0, 24},   {0x1fffdf, 21},   {0x3fffdf, 22},
+    {0x7fffeb, 23},   {0x7fffec, 23},   {0x1fffe0, 21},   {0x1fffe1, 21},   {0x3fffe0, 22},   {0x1fffe2, 21},
+    {0x7fffed, 23},   {0x3fffe1, 22},   {0x7fffee, 23},   {0x7fffef, 23},   {0xfffea, 20},    {0x3fffe2, 22},
+    {0x3fffe3, 22},   {0x3fffe4, 22},   {0x7ffff0, 23},   {0x3fffe5, 22},   {0x3fffe6, 22},   {0x7ffff1, 23},
+    {0x3ffffe0, 26},  {0x3ffffe1, 26},  {0xfffeb, 20},    {0x7fff1, 19},    {0x3fffe7, 22},   {0x7ffff2, 23},
+    {0x3fffe8, 22},   {0x1ffffec, 25},  {0x3ffffe2, 26},  {0x3ffffe3, 26},  {0x3ffffe4, 26},  {0x7ffffde, 27},
+    {0x7ffffdf, 27},  {0x3ffffe5, 26},  {0xfffff1, 24},   {0x1ffffed, 25},  {0x7fff2, 19},    {0x1fffe3, 21},
+    {0x3ffffe6, 26},  {0x7ffffe0, 27},  {0x7ffffe1, 27},  {0x3ffffe7, 26},  {0x7ffffe2, 27},  {0xfffff2, 24},
+    {0x1fffe4, 21},   {0x1fffe5, 21},   {0x3ffffe8, 26},  {0x3ffffe9, 26},  {0xffffffd, 28},  {0x7ffffe3, 27},
+    {0x7ffffe4, 27},  {0x7ffffe5, 27},  {0xfffec, 20},    {0xfffff3, 24},   {0xfffed, 20},    {0x1fffe6, 21},
+    {0x3fffe9, 22},   {0x1fffe7, 21},   {0x1fffe8, 21},   {0x7ffff3, 23},   {0x3fffea, 22},   {0x3fffeb, 22},
+    {0x1ffffee, 25},  {0x1ffffef, 25},  {0xfffff4, 24},   {0xfffff5, 24},   {0x3ffffea, 26},  {0x7ffff4, 23},
+    {0x3ffffeb, 26},  {0x7ffffe6, 27},  {0x3ffffec, 26},  {0x3ffffed, 26},  {0x7ffffe7, 27},  {0x7ffffe8, 27},
+    {0x7ffffe9, 27},  {0x7ffffea, 27},  {0x7ffffeb, 27},  {0xffffffe, 28},  {0x7ffffec, 27},  {0x7ffffed, 27},
+    {0x7ffffee, 27},  {0x7ffffef, 27},  {0x7fffff0, 27},  {0x3ffffee, 26},  {0x3fffffff, 30},
+  };
+  return table;
+}
+
+inline uint64_t HuffmanEncodedLength(const std::string& s) {
+  uint64_t bits = 0;
+  for (unsigned char c : s) bits += HuffmanTable()[c].bits;
+  return (bits + 7) / 8;
+}
+
+// Pads the last byte with the most significant bits of EOS (all ones).
+inline void HuffmanEncode(std::string& out, const std::string& s) {
+  uint64_t acc = 0;
+  unsigned n = 0;
+  for (unsigned char c : s) {
+    const HuffmanSym& sym = HuffmanTable()[c];
+    acc = (acc << sym.bits) | sym.code;
+    n += sym.bits;
+    while (n >= 8) {
+      n -= 8;
+      out.push_back(static_cast<char>(acc >> n));
+    }
+    acc &= (uint64_t(1) << n) - 1;
+  }
+  if (n > 0) out.push_back(static_cast<char>((acc << (8 - n)) | (0xff >> n)));
+}
+
+// Binary decoding tree over the code, built once. Leaves hold the symbol.
+class HuffmanTree {
+public:
+  static const HuffmanTree& Get() {
+    static HuffmanTree tree;
+    return tree;
+  }
+
+  // Decodes in[pos, pos + len); false on EOS, padding longer than 7 bits or
+  // padding that is not a prefix of EOS (§5.2).
+  bool Decode(const std::string& in, size_t pos, size_t len, std::string& out) const {
+    int node = 0;
+    unsigned depth = 0; // bits since the last symbol
+    bool allOnes = true;
+    for (size_t i = pos; i < pos + len; ++i) {
+      uint8_t b = static_cast<uint8_t>(in[i]);
+      for (int bit = 7; bit >= 0; --bit) {
+        int v = (b >> bit) & 1;
+        node = m_nodes[node].child[v];
+        if (node < 0) return false;
+        ++depth;
+        allOnes = allOnes && v;
+        if (m_nodes[node].sym >= 0) {
+          if (m_nodes[node].sym == 256) return false;
+          out.push_back(static_cast<char>(m_nodes[node].sym));
+          node = 0;
+          depth = 0;
+          allOnes = true;
+        }
+      }
+    }
+    return depth <= 7 && allOnes;
+  }
+
+private:
+  struct Node {
+    int child[2] = {-1, -1};
+    int sym = -1;
+  };
+
+  HuffmanTree() {
+    m_nodes.emplace_back();
+    for (int s = 0; s < 257; ++s) {
+      const HuffmanSym& sym = HuffmanTable()[s];
+      int node = 0;
+      for (int bit = sym.bits - 1; bit >= 0; --bit) {
+        int v = (sym.code >> bit) & 1;
+        if (m_nodes[node].child[v] < 0) {
+          m_nodes[node].child[v] = static_cast<int>(m_nodes.size());
+          m_nodes.emplace_back();
+        }
+        node = m_nodes[node].child[v];
+      }
+      m_nodes[node].sym = s;
+    }
+  }
+
+  std::vector<Node> m_nodes;
+};
+
+// String literal (§5.2): H flag just above an N-bit length prefix, then the
+// raw or Huffman-coded octets. Huffman is used only when it is shorter.
+inline void HpackEncodeString(std::string& out, const std::string& s, bool huffman, uint8_t flags = 0,
+                              uint8_t prefixBits = 7) {
+  uint64_t hlen = huffman ? HuffmanEncodedLength(s) : s.size();
+  if (huffman && hlen < s.size()) {
+    HpackEncodeInt(out, static_cast<uint8_t>(flags | (1u << prefixBits)), prefixBits, hlen);
+    HuffmanEncode(out, s);
+  } else {
+    HpackEncodeInt(out, flags, prefixBits, s.size());
+    out += s;
+  }
+}
+
+inline bool HpackDecodeString(const std::string& in, size_t& pos, std::string& out, uint8_t prefixBits = 7) {
+  if (pos >= in.size()) return false;
+  bool huffman = (static_cast<uint8_t>(in[pos]) >> prefixBits) & 1;
+  uint64_t len = 0;
+  if (!HpackDecodeInt(in, pos, prefixBits, len) || len > in.size() - pos) return false;
+  out.clear();
+  if (huffman) {
+    if (!HuffmanTree::Get().Decode(in, pos, len, out)) return false;
+  } else {
+    out.assign(in, pos, len);
+  }
+  pos += len;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Tables
+// ---------------------------------------------------------------------------
+
+// Appendix A; index 1 is element 0.
+inline const HttpHeaderList& HpackStaticTable() {
+  static const HttpHeaderList table = {
+    {":authority", ""}, {":method", "GET"}, {":method", "POST"}, {":path", "/"}, {":path", "/index.html"},
+    {":scheme", "http"}, {":scheme", "https"}, {":status", "200"}, {":status", "204"}, {":status", "206"},
+    {":status", "304"}, {":status", "400"}, {":status", "404"}, {":status", "500"}, {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"}, {"accept-language", ""}, {"accept-ranges", ""}, {"accept", ""},
+    {"access-control-allow-origin", ""}, {"age", ""}, {"allow", ""}, {"authorization", ""},
+    {"cache-control", ""}, {"content-disposition", ""}, {"content-encoding", ""}, {"content-language", ""},
+    {"content-length", ""}, {"content-location", ""}, {"content-range", ""}, {"content-type", ""},
+    {"cookie", ""}, {"date", ""}, {"etag", ""}, {"expect", ""}, {"expires", ""}, {"from", ""}, {"host", ""},
+    {"if-match", ""}, {"if-modified-since", ""}, {"if-none-match", ""}, {"if-range", ""},
+    {"if-unmodified-since", ""}, {"last-modified", ""}, {"link", ""}, {"location", ""}, {"max-forwards", ""},
+    {"proxy-authenticate", ""}, {"proxy-authorization", ""}, {"range", ""}, {"referer", ""}, {"refresh", ""},
+    {"retry-after", ""}, {"server", ""}, {"set-cookie", ""}, {"strict-transport-security", ""},
+    {"transfer-encoding", ""}, {"user-agent", ""}, {"vary", ""}, {"via", ""}, {"www-authenticate", ""},
+  };
+  return table;
+}
+
+inline uint64_t HpackEntrySize(const HttpHeader& h) { return h.name.size() + h.value.size() + 32; }
+
+// Dynamic table (§2.3.2, §4); Get(0) is the newest entry.
+class HpackDynamicTable {
+public:
+  explicit HpackDynamicTable(uint64_t maxSize = 4096) : m_maxSize(maxSize) {}
+
+  uint64_t Size() const { return m_size; }
+  uint64_t MaxSize() const { return m_maxSize; }
+  size_t Count() const { return m_entries.size(); }
+  uint64_t Evictions() const { return m_evictions; }
+  const HttpHeader& Get(size_t i) const { return m_entries[i]; }
+
+  void SetMaxSize(uint64_t maxSize) {
+    m_maxSize = maxSize;
+    EvictTo(m_maxSize);
+  }
+
+  // An entry larger than the table empties it and is not added (§4.4).
+  void Add(const HttpHeader& h) {
+    uint64_t size = HpackEntrySize(h);
+    if (size > m_maxSize) {
+      EvictTo(0);
+      return;
+    }
+    EvictTo(m_maxSize - size);
+    m_entries.push_front(h);
+    m_size += size;
+  }
+
+private:
+  void EvictTo(uint64_t limit) {
+    while (m_size > limit && !m_entries.empty()) {
+      m_size -= HpackEntrySize(m_entries.back());
+      m_entries.pop_back();
+      ++m_evictions;
+    }
+  }
+
+  std::deque<HttpHeader> m_entries;
+  uint64_t m_size = 0;
+  uint64_t m_maxSize;
+  uint64_t m_evictions = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Encoder / decoder
+// ---------------------------------------------------------------------------
+
+struct HpackStats {
+  uint64_t blocks = 0;
+  uint64_t fields = 0;
+  uint64_t indexed = 0;      // fields sent as a table index only
+  uint64_t plainBytes = 0;   // HTTP/1.1 text size of the header lists
+  uint64_t encodedBytes = 0; // header block bytes
+
+  void Add(const HpackStats& o) {
+    blocks += o.blocks;
+    fields += o.fields;
+    indexed += o.indexed;
+    plainBytes += o.plainBytes;
+    encodedBytes += o.encodedBytes;
+  }
+  // Encoded / plain; 0 before the first block.
+  double Ratio() const { return plainBytes ? double(encodedBytes) / plainBytes : 0.0; }
+};
+
+class HpackEncoder {
+public:
+  // The table starts at the protocol default of 4096 bytes.
+  explicit HpackEncoder(bool huffman = true) : m_huffman(huffman) {}
+
+  // The peer's SETTINGS_HEADER_TABLE_SIZE changed; the update is signalled at
+  // the start of the next block (§4.2), including an intermediate minimum.
+  void SetMaxTableSize(uint64_t size) {
+    m_pendingMin = m_sizeUpdatePending ? std::min(m_pendingMin, size) : size;
+    m_sizeUpdatePending = true;
+    m_pendingFinal = size;
+  }
+
+  std::string Encode(const HttpHeaderList& headers) {
+    std::string out;
+    if (m_sizeUpdatePending) {
+      if (m_pendingMin < m_pendingFinal) {
+        HpackEncodeInt(out, 0x20, 5, m_pendingMin);
+        m_table.SetMaxSize(m_pendingMin);
+      }
+      HpackEncodeInt(out, 0x20, 5, m_pendingFinal);
+      m_table.SetMaxSize(m_pendingFinal);
+      m_sizeUpdatePending = false;
+    }
+    for (const HttpHeader& h : headers) EncodeField(out, h);
+    ++m_stats.blocks;
+    m_stats.fields += headers.size();
+    m_stats.plainBytes += HeaderListPlainBytes(headers);
+    m_stats.encodedBytes += out.size();
+    return out;
+  }
+
+  const HpackStats& GetStats() const { return m_stats; }
+  const HpackDynamicTable& GetTable() const { return m_table; }
+
+private:
+  // Returns the index of a full match, and the first name match in `nameIndex`.
+  size_t Find(const HttpHeader& h, size_t& nameIndex) const {
+    nameIndex = 0;
+    const HttpHeaderList& st = HpackStaticTable();
+    for (size_t i = 0; i < st.size(); ++i) {
+      if (st[i].name != h.name) continue;
+      if (st[i].value == h.value) return i + 1;
+      if (!nameIndex) nameIndex = i + 1;
+    }
+    for (size_t i = 0; i < m_table.Count(); ++i) {
+      const HttpHeader& e = m_table.Get(i);
+      if (e.name != h.name) continue;
+      if (e.value == h.value) return st.size() + 1 + i;
+      if (!nameIndex) nameIndex = st.size() + 1 + i;
+    }
+    return 0;
+  }
+
+  void EncodeField(std::string& out, const HttpHeader& h) {
+    size_t nameIndex = 0;
+    size_t index = Find(h, nameIndex);
+    if (index) {
+      HpackEncodeInt(out, 0x80, 7, index);
+      ++m_stats.indexed;
+      return;
+    }
+    uint8_t flags, prefix;
+    bool addToTable = false;
+    if (h.name == "authorization") {
+      flags = 0x10; prefix = 4; // never indexed
+    } else if (4 * HpackEntrySize(h) > 3 * m_table.MaxSize()) {
+      flags = 0x00; prefix = 4; // without indexing
+    } else {
+      flags = 0x40; prefix = 6; // incremental indexing
+      addToTable = true;
+    }
+    HpackEncodeInt(out, flags, prefix, nameIndex);
+    if (!nameIndex) HpackEncodeString(out, h.name, m_huffman);
+    HpackEncodeString(out, h.value, m_huffman);
+    if (addToTable) m_table.Add(h);
+  }
+
+  HpackDynamicTable m_table;
+  bool m_huffman;
+  bool m_sizeUpdatePending = false;
+  uint64_t m_pendingMin = 0;
+  uint64_t m_pendingFinal = 0;
+  HpackStats m_stats;
+};
+
+class HpackDecoder {
+public:
+  // `maxTableSize` is the SETTINGS_HEADER_TABLE_SIZE this endpoint advertises;
+  // the table itself stays at 4096 until the encoder signals a new size.
+  explicit HpackDecoder(uint64_t maxTableSize = 4096) : m_limit(maxTableSize) {}
+
+  // Decodes one complete header block; false on any compression error, which
+  // is a connection error (COMPRESSION_ERROR) in HTTP/2.
+  bool Decode(const std::string& block, HttpHeaderList& headers) {
+    headers.clear();
+    size_t pos = 0;
+    bool fieldSeen = false;
+    while (pos < block.size()) {
+      uint8_t b = static_cast<uint8_t>(block[pos]);
+      if (b & 0x80) { // indexed field
+        uint64_t index = 0;
+        HttpHeader h;
+        if (!HpackDecodeInt(block, pos, 7, index) || !Lookup(index, h)) return false;
+        headers.push_back(h);
+        fieldSeen = true;
+      } else if ((b & 0xe0) == 0x20) { // dynamic table size update, only before the first field
+        uint64_t size = 0;
+        if (fieldSeen || !HpackDecodeInt(block, pos, 5, size) || size > m_limit) return false;
+        m_table.SetMaxSize(size);
+      } else {
+        bool incremental = (b & 0xc0) == 0x40;
+        uint64_t nameIndex = 0;
+        HttpHeader h;
+        if (!HpackDecodeInt(block, pos, incremental ? 6 : 4, nameIndex)) return false;
+        if (nameIndex) {
+          HttpHeader named;
+          if (!Lookup(nameIndex, named)) return false;
+          h.name = named.name;
+        } else if (!HpackDecodeString(block, pos, h.name)) {
+          return false;
+        }
+        if (!HpackDecodeString(block, pos, h.value)) return false;
+        if (incremental) m_table.Add(h);
+        headers.push_back(h);
+        fieldSeen = true;
+      }
+    }
+    return true;
+  }
+
+  const HpackDynamicTable& GetTable() const { return m_table; }
+
+private:
+  bool Lookup(uint64_t index, HttpHeader& h) const {
+    const HttpHeaderList& st = HpackStaticTable();
+    if (index == 0) return false;
+    if (index <= st.size()) {
+      h = st[index - 1];
+      return true;
+    }
+    if (index - st.size() - 1 >= m_table.Count()) return false;
+    h = m_table.Get(index - st.size() - 1);
+    return true;
+  }
+
+  HpackDynamicTable m_table;
+  uint64_t m_limit;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_HPACK_H
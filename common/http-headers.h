@@ -0,0 +1,109 @@
+#ifndef HTTP_SIM_HTTP_HEADERS_H
+#define HTTP_SIM_HTTP_HEADERS_H
+
+// Header lists exchanged by the HTTP/2 and HTTP/3 sims, and the realistic
+// request/response header sets they send.
+//
+// Names are lower case (RFC 9113 §8.2.1); pseudo-headers come first. The sets
+// mirror what a browser and a CDN-fronted origin typically send, so header
+// compression sees the same mix of static-table hits, fields repeated across
+// requests and per-request values as on a real connection:
+//
+//   request   :method :scheme :authority :path user-agent accept
+//             accept-encoding accept-language [priority] [cookie]
+//   response  :status content-type content-length cache-control etag server
+//             [content-security-policy]
+//
+// The workload sizes a header list by its HTTP/1.1 text form ("name: value"
+// plus CRLF per field); when the base set is smaller, the bracketed field is
+// added with a value that stays the same across requests on a connection, as
+// a session cookie or a site-wide policy header would.
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct HttpHeader {
+  std::string name;
+  std::string value;
+};
+
+typedef std::vector<HttpHeader> HttpHeaderList;
+
+// Uncompressed reference size: the fields as HTTP/1.1 text.
+inline uint64_t HeaderListPlainBytes(const HttpHeaderList& headers) {
+  uint64_t sum = 0;
+  for (const HttpHeader& h : headers) sum += h.name.size() + 2 + h.value.size() + 2;
+  return sum;
+}
+
+// Value of the first field called `name`, or empty.
+inline std::string FindHeader(const HttpHeaderList& headers, const std::string& name) {
+  for (const HttpHeader& h : headers) {
+    if (h.name == name) return h.value;
+  }
+  return std::string();
+}
+
+// Appends `name` with a filler value so the list reaches `targetBytes`, if it
+// is short of it and the field itself fits.
+inline void PadHeaderList(HttpHeaderList& headers, const std::string& name, const std::string& prefix,
+                          uint64_t targetBytes) {
+  uint64_t have = HeaderListPlainBytes(headers);
+  uint64_t fixed = name.size() + 4 + prefix.size();
+  if (targetBytes <= have + fixed) return;
+  headers.push_back(HttpHeader{name, prefix + std::string(targetBytes - have - fixed, 'x')});
+}
+
+// Urgency (0..7) from an RFC 9218 "priority" field value such as "u=1, i";
+// 3 when absent or out of range.
+inline uint8_t ParseUrgency(const std::string& value) {
+  size_t at = value.find("u=");
+  while (at != std::string::npos && at > 0 && value[at - 1] != ' ' && value[at - 1] != ',') at = value.find("u=", at + 1);
+  if (at == std::string::npos || at + 2 >= value.size()) return 3;
+  char d = value[at + 2];
+  return d >= '0' && d <= '7' ? static_cast<uint8_t>(d - '0') : 3;
+}
+
+// `urgency` other than the default 3 is sent as a "priority" field.
+inline HttpHeaderList BrowserRequestHeaders(const std::string& authority, const std::string& path,
+                                            uint64_t targetBytes, uint8_t urgency = 3) {
+  HttpHeaderList h = {
+    {":method", "GET"},
+    {":scheme", "https"},
+    {":authority", authority},
+    {":path", path},
+    {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36"},
+    {"accept", "*/*"},
+    {"accept-encoding", "gzip, deflate, br"},
+    {"accept-language", "en-US,en;q=0.9"},
+  };
+  if (urgency != 3) h.push_back(HttpHeader{"priority", "u=" + std::to_string(urgency)});
+  PadHeaderList(h, "cookie", "sid=", targetBytes);
+  return h;
+}
+
+// `objectId` distinguishes responses (etag); `server` names the origin software.
+inline HttpHeaderList OriginResponseHeaders(uint64_t contentLength, uint32_t objectId, const std::string& server,
+                                            uint64_t targetBytes) {
+  std::ostringstream etag;
+  etag << "\"" << std::hex << std::setw(8) << std::setfill('0') << objectId << "\"";
+  HttpHeaderList h = {
+    {":status", "200"},
+    {"content-type", "application/octet-stream"},
+    {"content-length", std::to_string(contentLength)},
+    {"cache-control", "public, max-age=3600"},
+    {"etag", etag.str()},
+    {"server", server},
+  };
+  PadHeaderList(h, "content-security-policy", "default-src 'self'; report-uri /csp?", targetBytes);
+  return h;
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_HTTP_HEADERS_H
@@ -0,0 +1,93 @@
+#ifndef HTTP_SIM_JSON_OBJECT_H
+#define HTTP_SIM_JSON_OBJECT_H
+
+// Minimal ordered JSON object builder used by the qlog writer and the
+// --resultsFile output:
+//
+//   JsonObject().Field("a", 1).Field("b", "x").Str()   ->  {"a":1,"b":"x"}
+//
+// Fields keep insertion order and are stored as (key, serialized value), so
+// callers can also walk them to produce flat formats such as CSV.
+// Non-finite doubles are written as null.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class JsonObject {
+public:
+  using FieldList = std::vector<std::pair<std::string, std::string>>;
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JsonObject&>::type
+  Field(const char* key, T v) { return Raw(key, std::to_string(v)); }
+
+  JsonObject& Field(const char* key, double v) { return Raw(key, Number(v)); }
+  JsonObject& Field(const char* key, bool v) { return Raw(key, v ? "true" : "false"); }
+  JsonObject& Field(const char* key, const char* v) { return Raw(key, Quote(v)); }
+  JsonObject& Field(const char* key, const std::string& v) { return Raw(key, Quote(v)); }
+  JsonObject& Field(const char* key, const JsonObject& v) { return Raw(key, v.Str()); }
+  JsonObject& Field(const char* key, const std::vector<JsonObject>& v) {
+    std::string a = "[";
+    for (size_t i = 0; i < v.size(); ++i) { if (i) a += ','; a += v[i].Str(); }
+    return Raw(key, a + "]");
+  }
+  JsonObject& Field(const char* key, const std::vector<uint64_t>& v) {
+    std::string a = "[";
+    for (size_t i = 0; i < v.size(); ++i) { if (i) a += ','; a += std::to_string(v[i]); }
+    return Raw(key, a + "]");
+  }
+
+  // Adds an already-serialized JSON value.
+  JsonObject& Raw(const std::string& key, const std::string& json) {
+    m_fields.emplace_back(key, json);
+    return *this;
+  }
+
+  const FieldList& Fields() const { return m_fields; }
+  bool Empty() const { return m_fields.empty(); }
+
+  std::string Str() const {
+    std::string out = "{";
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+      if (i) out += ',';
+      out += Quote(m_fields[i].first);
+      out += ':';
+      out += m_fields[i].second;
+    }
+    return out + "}";
+  }
+
+  static std::string Number(double v) {
+    if (!std::isfinite(v)) return "null";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+  }
+
+  static std::string Quote(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+      if (c == '"' || c == '\\') { out += '\\'; out += c; }
+      else if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+        out += buf;
+      } else out += c;
+    }
+    return out + "\"";
+  }
+
+private:
+  FieldList m_fields;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_JSON_OBJECT_H
@@ -0,0 +1,224 @@
+#ifndef HTTP_SIM_JSON_VALUE_H
+#define HTTP_SIM_JSON_VALUE_H
+
+// Minimal JSON reader (RFC 8259) used to load workload files such as HAR
+// captures; the writing side is JsonObject.
+//
+//   JsonValue doc;
+//   std::string err;
+//   if (!JsonValue::Parse(text, doc, err)) ...
+//   const JsonValue& entries = doc["log"]["entries"];
+//   for (size_t i = 0; i < entries.Size(); ++i) entries[i]["request"]["url"].Str();
+//
+// Lookups never throw: a missing member or index yields a shared null value,
+// and the typed accessors return the given fallback for any other type.
+// Objects keep member order; duplicate keys resolve to the first.
+//
+// No ns-3 dependency.
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class JsonValue {
+public:
+  enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+  Type GetType() const { return m_type; }
+  bool IsNull() const { return m_type == JSON_NULL; }
+  bool IsNumber() const { return m_type == JSON_NUMBER; }
+  bool IsString() const { return m_type == JSON_STRING; }
+  bool IsArray() const { return m_type == JSON_ARRAY; }
+  bool IsObject() const { return m_type == JSON_OBJECT; }
+
+  bool Bool(bool fallback = false) const { return m_type == JSON_BOOL ? m_bool : fallback; }
+  double Num(double fallback = 0.0) const { return m_type == JSON_NUMBER ? m_number : fallback; }
+  const std::string& Str() const { return m_type == JSON_STRING ? m_string : Empty().m_string; }
+
+  // Array elements / object members.
+  size_t Size() const { return m_type == JSON_ARRAY ? m_items.size() : m_type == JSON_OBJECT ? m_members.size() : 0; }
+  const JsonValue& operator[](size_t i) const { return m_type == JSON_ARRAY && i < m_items.size() ? m_items[i] : Empty(); }
+  const JsonValue& operator[](const std::string& key) const {
+    if (m_type == JSON_OBJECT) {
+      for (const auto& kv : m_members) {
+        if (kv.first == key) return kv.second;
+      }
+    }
+    return Empty();
+  }
+  const std::vector<std::pair<std::string, JsonValue>>& Members() const { return m_members; }
+
+  // Parses a complete document; on failure `error` names the byte offset.
+  static bool Parse(const std::string& text, JsonValue& out, std::string& error) {
+    size_t pos = 0;
+    out = JsonValue();
+    if (!ParseValue(text, pos, out, 0, error)) return false;
+    SkipSpace(text, pos);
+    if (pos != text.size()) return Fail(pos, "trailing characters", error);
+    return true;
+  }
+
+private:
+  static const JsonValue& Empty() {
+    static const JsonValue null;
+    return null;
+  }
+
+  static bool Fail(size_t pos, const char* what, std::string& error) {
+    error = std::string(what) + " at byte " + std::to_string(pos);
+    return false;
+  }
+
+  static void SkipSpace(const std::string& s, size_t& pos) {
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) ++pos;
+  }
+
+  static bool Literal(const std::string& s, size_t& pos, const char* word) {
+    size_t n = std::char_traits<char>::length(word);
+    if (s.compare(pos, n, word) != 0) return false;
+    pos += n;
+    return true;
+  }
+
+  static bool ParseValue(const std::string& s, size_t& pos, JsonValue& v, int depth, std::string& error) {
+    if (depth > 256) return Fail(pos, "nesting too deep", error);
+    SkipSpace(s, pos);
+    if (pos >= s.size()) return Fail(pos, "unexpected end", error);
+    char c = s[pos];
+    if (c == '{') {
+      v.m_type = JSON_OBJECT;
+      ++pos;
+      SkipSpace(s, pos);
+      if (pos < s.size() && s[pos] == '}') { ++pos; return true; }
+      while (true) {
+        SkipSpace(s, pos);
+        std::string key;
+        if (pos >= s.size() || s[pos] != '"' || !ParseString(s, pos, key)) return Fail(pos, "expected member name", error);
+        SkipSpace(s, pos);
+        if (pos >= s.size() || s[pos] != ':') return Fail(pos, "expected ':'", error);
+        ++pos;
+        v.m_members.emplace_back(std::move(key), JsonValue());
+        if (!ParseValue(s, pos, v.m_members.back().second, depth + 1, error)) return false;
+        SkipSpace(s, pos);
+        if (pos < s.size() && s[pos] == ',') { ++pos; continue; }
+        if (pos < s.size() && s[pos] == '}') { ++pos; return true; }
+        return Fail(pos, "expected ',' or '}'", error);
+      }
+    }
+    if (c == '[') {
+      v.m_type = JSON_ARRAY;
+      ++pos;
+      SkipSpace(s, pos);
+      if (pos < s.size() && s[pos] == ']') { ++pos; return true; }
+      while (true) {
+        v.m_items.emplace_back();
+        if (!ParseValue(s, pos, v.m_items.back(), depth + 1, error)) return false;
+        SkipSpace(s, pos);
+        if (pos < s.size() && s[pos] == ',') { ++pos; continue; }
+        if (pos < s.size() && s[pos] == ']') { ++pos; return true; }
+        return Fail(pos, "expected ',' or ']'", error);
+      }
+    }
+    if (c == '"') {
+      v.m_type = JSON_STRING;
+      return ParseString(s, pos, v.m_string) || Fail(pos, "bad string", error);
+    }
+    if (Literal(s, pos, "true")) { v.m_type = JSON_BOOL; v.m_bool = true; return true; }
+    if (Literal(s, pos, "false")) { v.m_type = JSON_BOOL; v.m_bool = false; return true; }
+    if (Literal(s, pos, "null")) { v.m_type = JSON_NULL; return true; }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      const char* begin = s.c_str() + pos;
+      char* end = nullptr;
+      v.m_number = std::strtod(begin, &end);
+      if (end == begin) return Fail(pos, "bad number", error);
+      v.m_type = JSON_NUMBER;
+      pos += end - begin;
+      return true;
+    }
+    return Fail(pos, "unexpected character", error);
+  }
+
+  // s[pos] is the opening quote; \u escapes (with surrogate pairs) become UTF-8.
+  static bool ParseString(const std::string& s, size_t& pos, std::string& out) {
+    out.clear();
+    ++pos;
+    while (pos < s.size()) {
+      char c = s[pos++];
+      if (c == '"') return true;
+      if (c != '\\') { out.push_back(c); continue; }
+      if (pos >= s.size()) return false;
+      char e = s[pos++];
+      switch (e) {
+      case '"': case '\\': case '/': out.push_back(e); break;
+      case 'b': out.push_back('\b'); break;
+      case 'f': out.push_back('\f'); break;
+      case 'n': out.push_back('\n'); break;
+      case 'r': out.push_back('\r'); break;
+      case 't': out.push_back('\t'); break;
+      case 'u': {
+        uint32_t cp = 0;
+        if (!Hex4(s, pos, cp)) return false;
+        if (cp >= 0xd800 && cp < 0xdc00 && s.compare(pos, 2, "\\u") == 0) {
+          size_t p = pos + 2;
+          uint32_t lo = 0;
+          if (Hex4(s, p, lo) && lo >= 0xdc00 && lo < 0xe000) {
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+            pos = p;
+          }
+        }
+        AppendUtf8(out, cp);
+        break;
+      }
+      default: return false;
+      }
+    }
+    return false;
+  }
+
+  static bool Hex4(const std::string& s, size_t& pos, uint32_t& cp) {
+    if (pos + 4 > s.size()) return false;
+    cp = 0;
+    for (int i = 0; i < 4; ++i) {
+      char h = s[pos++];
+      cp <<= 4;
+      if (h >= '0' && h <= '9') cp |= h - '0';
+      else if (h >= 'a' && h <= 'f') cp |= h - 'a' + 10;
+      else if (h >= 'A' && h <= 'F') cp |= h - 'A' + 10;
+      else return false;
+    }
+    return true;
+  }
+
+  static void AppendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+      out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+      out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else {
+      out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+  }
+
+  Type m_type = JSON_NULL;
+  bool m_bool = false;
+  double m_number = 0.0;
+  std::string m_string;
+  std::vector<JsonValue> m_items;
+  std::vector<std::pair<std::string, JsonValue>> m_members;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_JSON_VALUE_H
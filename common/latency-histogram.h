@@ -0,0 +1,261 @@
+#ifndef HTTP_SIM_LATENCY_HISTOGRAM_H
+#define HTTP_SIM_LATENCY_HISTOGRAM_H
+
+// Fixed-memory log-linear latency histograms (HdrHistogram layout).
+//
+// Values are nanoseconds. Each power-of-two range is split into
+// kSubBucketHalf linear sub-buckets, so every recorded value is kept with a
+// relative error below 1/kSubBucketHalf (~0.8%) from 1 ns up to kMaxValue
+// (~18 min); larger values are clamped. One histogram is ~35 KB and
+// Record() is a few shifts and an increment.
+//
+// The sims record into GlobalHistograms():
+//   request - request sent -> last response byte
+//   ttfb    - request sent -> first response byte (response HEADERS)
+//   stream  - first response byte -> last response byte
+//   rtt     - transport RTT samples (TCP "RTT" trace, QUIC ACK of largest)
+//   sojourn - open-loop arrival -> last response byte (backlog wait included;
+//             empty in closed-loop runs)
+//
+// Save()/Load() use a small text format so histograms from replicated runs
+// can be merged (histmerge/histmerge.cc) before taking percentiles:
+//
+//   # http-sim-histograms 1 <source>
+//   <name> <count> <min> <max> <index>:<count> <index>:<count> ...
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Version on the "# http-sim-histograms" line; MergeFile() rejects others.
+constexpr int kHistogramFileVersion = 1;
+
+class LatencyHistogram {
+public:
+  static constexpr int kSubBucketBits = 8;
+  static constexpr int64_t kSubBucketCount = int64_t(1) << kSubBucketBits;
+  static constexpr int64_t kSubBucketHalf = kSubBucketCount / 2;
+  static constexpr int kMaxValueBits = 40;
+  static constexpr int64_t kMaxValue = (int64_t(1) << kMaxValueBits) - 1;
+  static constexpr size_t kBucketCount = kMaxValueBits - kSubBucketBits + 1;
+  static constexpr size_t kCountsLen = (kBucketCount + 1) * kSubBucketHalf;
+
+  LatencyHistogram() : m_counts(kCountsLen, 0) {}
+
+  void Record(int64_t valueNs) {
+    valueNs = std::max<int64_t>(0, std::min(valueNs, kMaxValue));
+    ++m_counts[IndexOf(valueNs)];
+    if (m_total == 0 || valueNs < m_min) m_min = valueNs;
+    if (valueNs > m_max) m_max = valueNs;
+    ++m_total;
+  }
+
+  void RecordSeconds(double s) {
+    if (std::isfinite(s)) Record(static_cast<int64_t>(std::llround(s * 1e9)));
+  }
+
+  void Merge(const LatencyHistogram& o) {
+    if (o.m_total == 0) return;
+    for (size_t i = 0; i < kCountsLen; ++i) m_counts[i] += o.m_counts[i];
+    m_min = m_total ? std::min(m_min, o.m_min) : o.m_min;
+    m_max = std::max(m_max, o.m_max);
+    m_total += o.m_total;
+  }
+
+  void Reset() {
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_total = 0; m_min = 0; m_max = 0;
+  }
+
+  uint64_t GetCount() const { return m_total; }
+  int64_t GetMin() const { return m_min; }
+  int64_t GetMax() const { return m_max; }
+
+  // Smallest recorded value v such that at least p% of the samples are <= v,
+  // reported as the upper edge of its bucket (never above the exact max).
+  int64_t ValueAtPercentile(double p) const {
+    if (m_total == 0) return 0;
+    p = std::min(std::max(p, 0.0), 100.0);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * m_total));
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kCountsLen; ++i) {
+      seen += m_counts[i];
+      if (seen >= rank) return std::min(HighestEquivalent(i), m_max);
+    }
+    return m_max;
+  }
+
+  double PercentileSeconds(double p) const { return ValueAtPercentile(p) / 1e9; }
+
+  // One line: "<name> <count> <min> <max> i:c ..." (non-zero buckets only).
+  void Save(std::ostream& os, const std::string& name) const {
+    os << name << ' ' << m_total << ' ' << m_min << ' ' << m_max;
+    for (size_t i = 0; i < kCountsLen; ++i) {
+      if (m_counts[i]) os << ' ' << i << ':' << m_counts[i];
+    }
+    os << '\n';
+  }
+
+  // Parses the body of a Save() line (everything after the name); false on
+  // a malformed line or when the buckets do not add up to <count>.
+  bool Load(std::istream& is) {
+    Reset();
+    uint64_t total = 0;
+    if (!(is >> total >> m_min >> m_max)) return false;
+    std::string tok;
+    while (is >> tok) {
+      size_t colon = tok.find(':');
+      uint64_t idx = 0, count = 0;
+      if (colon == std::string::npos || !ParseU64(tok.substr(0, colon), idx) ||
+          !ParseU64(tok.substr(colon + 1), count)) {
+        return false;
+      }
+      if (idx >= kCountsLen || count > UINT64_MAX - m_total) return false;
+      m_counts[idx] += count;
+      m_total += count;
+    }
+    return m_total == total;
+  }
+
+private:
+  // Whole-string unsigned decimal (strtoull alone accepts signs and stops at junk).
+  static bool ParseU64(const std::string& s, uint64_t& out) {
+    if (s.empty() || !std::isdigit(static_cast<unsigned char>(s[0]))) return false;
+    errno = 0;
+    char* end = nullptr;
+    out = std::strtoull(s.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+  }
+
+  static size_t IndexOf(int64_t v) {
+    // Position of the highest set bit, with everything below kSubBucketCount
+    // folded into bucket 0.
+    int msb = 63 - __builtin_clzll(static_cast<uint64_t>(v) | (kSubBucketCount - 1));
+    int bucket = msb - (kSubBucketBits - 1);
+    int64_t sub = v >> bucket;
+    return static_cast<size_t>(((bucket + 1) << (kSubBucketBits - 1)) + (sub - kSubBucketHalf));
+  }
+
+  static int64_t LowestEquivalent(size_t index, int* bucketOut) {
+    int bucket = static_cast<int>(index >> (kSubBucketBits - 1)) - 1;
+    int64_t sub = static_cast<int64_t>(index & (kSubBucketHalf - 1)) + kSubBucketHalf;
+    if (bucket < 0) { sub -= kSubBucketHalf; bucket = 0; }
+    *bucketOut = bucket;
+    return sub << bucket;
+  }
+
+  static int64_t HighestEquivalent(size_t index) {
+    int bucket;
+    int64_t lo = LowestEquivalent(index, &bucket);
+    return lo + (int64_t(1) << bucket) - 1;
+  }
+
+  std::vector<uint64_t> m_counts;
+  uint64_t m_total{0};
+  int64_t m_min{0};
+  int64_t m_max{0};
+};
+
+struct LatencyHistograms {
+  LatencyHistogram request;
+  LatencyHistogram ttfb;
+  LatencyHistogram stream;
+  LatencyHistogram rtt;
+  LatencyHistogram sojourn;
+
+  template <typename F>
+  void ForEach(F f) {
+    f("request", request); f("ttfb", ttfb); f("stream", stream); f("rtt", rtt);
+    f("sojourn", sojourn);
+  }
+  template <typename F>
+  void ForEach(F f) const {
+    f("request", request); f("ttfb", ttfb); f("stream", stream); f("rtt", rtt);
+    f("sojourn", sojourn);
+  }
+
+  LatencyHistogram* Find(const std::string& name) {
+    LatencyHistogram* found = nullptr;
+    ForEach([&](const char* n, LatencyHistogram& h) { if (name == n) found = &h; });
+    return found;
+  }
+
+  bool Save(const std::string& path, const std::string& source) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "# http-sim-histograms " << kHistogramFileVersion << ' ' << source << "\n";
+    ForEach([&](const char* n, const LatencyHistogram& h) { h.Save(out, n); });
+    return static_cast<bool>(out);
+  }
+
+  // Adds the histograms stored in `path` to this set. Unknown names and
+  // later comment lines are skipped; returns false when the first line is not
+  // a header of this version or on a malformed line.
+  bool MergeFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    bool header = false;
+    while (std::getline(in, line)) {
+      if (line.empty()) continue;
+      if (!header) {
+        std::istringstream hs(line);
+        std::string hash, magic;
+        int version = 0;
+        if (!(hs >> hash >> magic >> version) || hash != "#" || magic != "http-sim-histograms" ||
+            version != kHistogramFileVersion) {
+          return false;
+        }
+        header = true;
+        continue;
+      }
+      if (line[0] == '#') continue;
+      std::istringstream is(line);
+      std::string name;
+      is >> name;
+      LatencyHistogram h;
+      if (!h.Load(is)) return false;
+      if (LatencyHistogram* dst = Find(name)) dst->Merge(h);
+    }
+    return header;
+  }
+};
+
+// One set per process; the sims are single-threaded.
+inline LatencyHistograms& GlobalHistograms() {
+  static LatencyHistograms hists;
+  return hists;
+}
+
+// "Latency <name> (ms): n=.. p50=.. p90=.. p99=.. p99.9=.. max=.."
+inline void PrintLatencyPercentiles(const LatencyHistograms& hs, std::ostream& os) {
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize prec = os.precision();
+  hs.ForEach([&](const char* n, const LatencyHistogram& h) {
+    if (h.GetCount() == 0) return;
+    os << "Latency " << n << " (ms): n=" << h.GetCount() << std::fixed << std::setprecision(3)
+       << " p50=" << h.ValueAtPercentile(50.0) / 1e6
+       << " p90=" << h.ValueAtPercentile(90.0) / 1e6
+       << " p99=" << h.ValueAtPercentile(99.0) / 1e6
+       << " p99.9=" << h.ValueAtPercentile(99.9) / 1e6
+       << " max=" << h.GetMax() / 1e6 << std::endl;
+  });
+  os.flags(flags);
+  os.precision(prec);
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_LATENCY_HISTOGRAM_H
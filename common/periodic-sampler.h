@@ -0,0 +1,80 @@
+#ifndef HTTP_SIM_PERIODIC_SAMPLER_H
+#define HTTP_SIM_PERIODIC_SAMPLER_H
+
+// Periodic state sampler shared by the HTTP/1.1, HTTP/2 and HTTP/3 servers.
+//
+// Probes are named getters registered once; every `interval` the sampler
+// appends one row (time_s + one value per probe) to a ColumnTable. When the
+// busy check reports no work (nothing queued, nothing in flight) the sampler
+// stops rescheduling itself, so an idle connection costs no events; the app
+// calls Wake() when new work arrives. The table is written once with
+// Write() at the end of the run (binary columnar, or CSV for *.csv).
+
+#include "column-file.h"
+
+#include "ns3/simulator.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class PeriodicSampler {
+public:
+  using Probe = std::function<double()>;
+  using RowHook = std::function<void(const std::vector<double>& row)>;
+
+  PeriodicSampler() { m_table.AddColumn("time_s"); }
+
+  void AddProbe(const std::string& name, Probe probe) {
+    m_table.AddColumn(name);
+    m_probes.push_back(probe);
+  }
+
+  // Returns true while there is work worth sampling; default: always busy.
+  void SetBusyCheck(std::function<bool()> busy) { m_busy = busy; }
+
+  // Called with each new row (time first, then probes in AddProbe order).
+  void SetRowHook(RowHook hook) { m_hook = hook; }
+
+  // Arms the sampler; the first sample is taken on the next Wake().
+  void Enable(Time interval) { m_interval = interval; m_enabled = interval > Time(0); }
+  bool IsEnabled() const { return m_enabled; }
+
+  // Resumes sampling now if it was paused for idleness.
+  void Wake() {
+    if (!m_enabled || m_running) return;
+    m_running = true;
+    Simulator::ScheduleNow(&PeriodicSampler::Sample, this);
+  }
+
+  const ColumnTable& GetTable() const { return m_table; }
+  bool Write(const std::string& path) const { return m_table.Write(path); }
+
+private:
+  void Sample() {
+    m_row.assign(1, Simulator::Now().GetSeconds());
+    for (const Probe& p : m_probes) m_row.push_back(p());
+    for (size_t c = 0; c < m_row.size(); ++c) m_table.columns[c].push_back(m_row[c]);
+    if (m_hook) m_hook(m_row);
+    if (m_busy && !m_busy()) {
+      m_running = false;
+      return;
+    }
+    Simulator::Schedule(m_interval, &PeriodicSampler::Sample, this);
+  }
+
+  ColumnTable m_table;
+  std::vector<Probe> m_probes;
+  std::vector<double> m_row;
+  std::function<bool()> m_busy;
+  RowHook m_hook;
+  Time m_interval;
+  bool m_enabled{false};
+  bool m_running{false};
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_PERIODIC_SAMPLER_H
@@ -0,0 +1,91 @@
+#ifndef HTTP_SIM_QLOG_WRITER_H
+#define HTTP_SIM_QLOG_WRITER_H
+
+// Minimal qlog (draft 0.3, JSON-SEQ) writer for the simulated QUIC endpoints.
+//
+// Each record is RS (0x1E) + one JSON object + '\n' (RFC 7464), which is what
+// qvis and the qlog tooling read for *.sqlog files. The first record is the
+// trace header; every following record is one event:
+//
+//   {"time":12.5,"name":"transport:packet_sent","data":{...}}
+//
+// Times are simulator milliseconds ("time_format":"relative", reference 0).
+// Events are appended to an in-memory buffer that is written out every
+// kFlushBytes and on Close(), so emitting an event never touches the file.
+
+#include "json-object.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace ns3 {
+
+class QlogWriter {
+public:
+  static constexpr size_t kFlushBytes = 64 * 1024;
+
+  QlogWriter() = default;
+  QlogWriter(const QlogWriter&) = delete;
+  QlogWriter& operator=(const QlogWriter&) = delete;
+  ~QlogWriter() { Close(); }
+
+  // vantagePoint is "client" or "server". Returns false if the file cannot
+  // be created.
+  bool Open(const std::string& path, const std::string& title, const std::string& vantagePoint) {
+    Close();
+    m_file = std::fopen(path.c_str(), "w");
+    if (!m_file) return false;
+    JsonObject common;
+    common.Field("time_format", "relative").Field("reference_time", 0);
+    JsonObject vp;
+    vp.Field("name", title).Field("type", vantagePoint);
+    JsonObject trace;
+    trace.Field("common_fields", common).Field("vantage_point", vp);
+    JsonObject header;
+    header.Field("qlog_version", "0.3").Field("qlog_format", "JSON-SEQ")
+          .Field("title", title).Field("trace", trace);
+    Append(header.Str());
+    return true;
+  }
+
+  bool IsOpen() const { return m_file != nullptr; }
+
+  void Event(double timeMs, const char* name, const JsonObject& data) {
+    if (!m_file) return;
+    JsonObject ev;
+    ev.Field("time", timeMs).Field("name", name).Field("data", data);
+    Append(ev.Str());
+    ++m_events;
+  }
+
+  uint64_t GetEventCount() const { return m_events; }
+
+  void Close() {
+    if (!m_file) return;
+    Flush();
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+
+private:
+  void Append(const std::string& json) {
+    m_buf += '\x1e';
+    m_buf += json;
+    m_buf += '\n';
+    if (m_buf.size() >= kFlushBytes) Flush();
+  }
+
+  void Flush() {
+    if (m_file && !m_buf.empty()) std::fwrite(m_buf.data(), 1, m_buf.size(), m_file);
+    m_buf.clear();
+  }
+
+  FILE* m_file{nullptr};
+  std::string m_buf;
+  uint64_t m_events{0};
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_QLOG_WRITER_H
@@ -0,0 +1,623 @@
+#ifndef HTTP_SIM_QPACK_H
+#define HTTP_SIM_QPACK_H
+
+// QPACK field compression (RFC 9204) for the HTTP/3 sim.
+//
+// Unlike HPACK, dynamic table updates do not ride inside the header blocks:
+// the encoder inserts entries with instructions on its unidirectional encoder
+// stream, and a field section only references them by absolute index. The
+// decoder acknowledges sections and inserts on its decoder stream. A section
+// that references an entry whose insert has not reached the decoder yet is
+// blocked until the encoder stream catches up; this is the head-of-line
+// blocking QPACK trades for compression, and the decoder records how long
+// each section waited.
+//
+// Encoder policy (per field, same shape as the HPACK encoder):
+//   - static table match: indexed;
+//   - dynamic table match: indexed, if the entry is acknowledged or the
+//     section may block (at most SETTINGS_QPACK_BLOCKED_STREAMS streams have
+//     unacknowledged references at once);
+//   - otherwise the field is inserted (name by static index when known)
+//     unless it would take more than 3/4 of the table, and referenced if
+//     allowed; if not, sent as a literal with name reference;
+//   - credentials (authorization) are never inserted and sent never-indexed.
+// Entries are only evicted once acknowledged and not referenced by a section
+// the decoder has not acknowledged. Post-base indexing is not emitted (Base is
+// always the insert count), but the decoder accepts it.
+
+#include "hpack.h"
+#include "http-headers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Appendix A; index 0 is element 0.
+inline const HttpHeaderList& QpackStaticTable() {
+  static const HttpHeaderList table = {
+    {":authority", ""}, {":path", "/"}, {"age", "0"}, {"content-disposition", ""}, {"content-length", "0"},
+    {"cookie", ""}, {"date", ""}, {"etag", ""}, {"if-modified-since", ""}, {"if-none-match", ""},
+    {"last-modified", ""}, {"link", ""}, {"location", ""}, {"referer", ""}, {"set-cookie", ""},
+    {":method", "CONNECT"}, {":method", "DELETE"}, {":method", "GET"}, {":method", "HEAD"},
+    {":method", "OPTIONS"}, {":method", "POST"}, {":method", "PUT"}, {":scheme", "http"},
+    {":scheme", "https"}, {":status", "103"}, {":status", "200"}, {":status", "304"}, {":status", "404"},
+    {":status", "503"}, {"accept", "*/*"}, {"accept", "application/dns-message"},
+    {"accept-encoding", "gzip, deflate, br"}, {"accept-ranges", "bytes"},
+    {"access-control-allow-headers", "cache-control"}, {"access-control-allow-headers", "content-type"},
+    {"access-control-allow-origin", "*"}, {"cache-control", "max-age=0"}, {"cache-control", "max-age=2592000"},
+    {"cache-control", "max-age=604800"}, {"cache-control", "no-cache"}, {"cache-control", "no-store"},
+    {"cache-control", "public, max-age=31536000"}, {"content-encoding", "br"}, {"content-encoding", "gzip"},
+    {"content-type", "application/dns-message"}, {"content-type", "application/javascript"},
+    {"content-type", "application/json"}, {"content-type", "application/x-www-form-urlencoded"},
+    {"content-type", "image/gif"}, {"content-type", "image/jpeg"}, {"content-type", "image/png"},
+    {"content-type", "text/css"}, {"content-type", "text/html; charset=utf-8"}, {"content-type", "text/plain"},
+    {"content-type", "text/plain;charset=utf-8"}, {"range", "bytes=0-"},
+    {"strict-transport-security", "max-age=31536000"},
+    {"strict-transport-security", "max-age=31536000; includesubdomains"},
+    {"strict-transport-security", "max-age=31536000; includesubdomains; preload"},
+    {"vary", "accept-encoding"}, {"vary", "origin"}, {"x-content-type-options", "nosniff"},
+    {"x-xss-protection", "1; mode=block"}, {":status", "100"}, {":status", "204"}, {":status", "206"},
+    {":status", "302"}, {":status", "400"}, {":status", "403"}, {":status", "421"}, {":status", "425"},
+    {":status", "500"}, {"accept-language", ""}, {"access-control-allow-credentials", "FALSE"},
+    {"access-control-allow-credentials", "TRUE"}, {"access-control-allow-headers", "*"},
+    {"access-control-allow-methods", "get"}, {"access-control-allow-methods", "get, post, options"},
+    {"access-control-allow-methods", "options"}, {"access-control-expose-headers", "content-length"},
+    {"access-control-request-headers", "content-type"}, {"access-control-request-method", "get"},
+    {"access-control-request-method", "post"}, {"alt-svc", "clear"}, {"authorization", ""},
+    {"content-security-policy", "script-src 'none'; object-src 'none'; base-uri 'none'"}, {"early-data", "1"},
+    {"expect-ct", ""}, {"forwarded", ""}, {"if-range", ""}, {"origin", ""}, {"purpose", "prefetch"},
+    {"server", ""}, {"timing-allow-origin", "*"}, {"upgrade-insecure-requests", "1"}, {"user-agent", ""},
+    {"x-forwarded-for", ""}, {"x-frame-options", "deny"}, {"x-frame-options", "sameorigin"},
+  };
+  return table;
+}
+
+// Dynamic table addressed by absolute index (§3.2.4): the first entry ever
+// inserted is 0, so indexes stay valid across evictions.
+class QpackDynamicTable {
+public:
+  uint64_t Capacity() const { return m_capacity; }
+  uint64_t Size() const { return m_size; }
+  uint64_t InsertCount() const { return m_dropped + m_entries.size(); }
+  uint64_t Evictions() const { return m_dropped; }
+  bool Has(uint64_t abs) const { return abs >= m_dropped && abs < InsertCount(); }
+  const HttpHeader& Get(uint64_t abs) const { return m_entries[abs - m_dropped]; }
+
+  // Whether `room` bytes can be freed by evicting only entries below `evictableBelow`.
+  bool CanMakeRoom(uint64_t room, uint64_t evictableBelow) const {
+    if (room > m_capacity) return false;
+    uint64_t size = m_size;
+    for (uint64_t abs = m_dropped; size + room > m_capacity; ++abs) {
+      if (abs >= evictableBelow || abs >= InsertCount()) return false;
+      size -= HpackEntrySize(Get(abs));
+    }
+    return true;
+  }
+
+  // Evicts oldest entries until `room` bytes are free; false if the entry cannot fit at all.
+  bool MakeRoom(uint64_t room) {
+    if (room > m_capacity) return false;
+    while (m_size + room > m_capacity && !m_entries.empty()) {
+      m_size -= HpackEntrySize(m_entries.front());
+      m_entries.pop_front();
+      ++m_dropped;
+    }
+    return true;
+  }
+
+  bool SetCapacity(uint64_t capacity) {
+    m_capacity = capacity;
+    return MakeRoom(0);
+  }
+
+  bool Insert(const HttpHeader& h) {
+    if (!MakeRoom(HpackEntrySize(h))) return false;
+    m_entries.push_back(h);
+    m_size += HpackEntrySize(h);
+    return true;
+  }
+
+  // Newest entry matching name and value (`exact`) or name only, or npos.
+  uint64_t Find(const HttpHeader& h, bool exact) const {
+    for (uint64_t abs = InsertCount(); abs-- > m_dropped;) {
+      const HttpHeader& e = Get(abs);
+      if (e.name == h.name && (!exact || e.value == h.value)) return abs;
+    }
+    return npos;
+  }
+
+  static constexpr uint64_t npos = std::numeric_limits<uint64_t>::max();
+
+private:
+  std::deque<HttpHeader> m_entries; // oldest first
+  uint64_t m_dropped = 0;           // absolute index of m_entries.front()
+  uint64_t m_size = 0;
+  uint64_t m_capacity = 0;
+};
+
+struct QpackStats {
+  uint64_t sections = 0;
+  uint64_t fields = 0;
+  uint64_t dynamicRefs = 0;        // fields referencing the dynamic table
+  uint64_t blockingSections = 0;   // sent with references the peer had not acknowledged
+  uint64_t plainBytes = 0;         // HTTP/1.1 text size of the header lists
+  uint64_t encodedBytes = 0;       // field section bytes
+  uint64_t encoderStreamBytes = 0; // instructions sent on the encoder stream
+
+  void Add(const QpackStats& o) {
+    sections += o.sections;
+    fields += o.fields;
+    dynamicRefs += o.dynamicRefs;
+    blockingSections += o.blockingSections;
+    plainBytes += o.plainBytes;
+    encodedBytes += o.encodedBytes;
+    encoderStreamBytes += o.encoderStreamBytes;
+  }
+  // (sections + encoder stream) / plain; 0 before the first section.
+  double Ratio() const { return plainBytes ? double(encodedBytes + encoderStreamBytes) / plainBytes : 0.0; }
+};
+
+class QpackEncoder {
+public:
+  // The dynamic table is not used until the peer's SETTINGS arrive.
+  explicit QpackEncoder(bool huffman = true) : m_huffman(huffman) {}
+
+  // Peer decoder's SETTINGS_QPACK_MAX_TABLE_CAPACITY / SETTINGS_QPACK_BLOCKED_STREAMS.
+  // The whole capacity is used, announced with Set Dynamic Table Capacity.
+  void SetPeerSettings(uint64_t maxTableCapacity, uint64_t blockedStreams) {
+    m_maxCapacity = maxTableCapacity;
+    m_maxBlocked = blockedStreams;
+    if (maxTableCapacity == 0) return;
+    m_table.SetCapacity(maxTableCapacity);
+    Emit([&](std::string& out) { HpackEncodeInt(out, 0x20, 5, maxTableCapacity); });
+  }
+
+  // Field section for `headers` on `streamId`. With `allowDynamic` false the
+  // section is self-contained (Required Insert Count 0), e.g. for a
+  // PUSH_PROMISE that is decoded on a stream the peer has not opened yet.
+  std::string Encode(uint64_t streamId, const HttpHeaderList& headers, bool allowDynamic = true) {
+    enum Kind { STATIC_INDEX, DYNAMIC_INDEX, STATIC_NAME, LITERAL };
+    struct Line { Kind kind; uint64_t index; bool never; const HttpHeader* h; };
+    std::vector<Line> lines;
+    bool mayBlock = IsBlocking(streamId) || BlockingStreams() < m_maxBlocked;
+    uint64_t ric = 0;
+    uint64_t minRef = QpackDynamicTable::npos;
+    auto usable = [&](uint64_t abs) { return abs < m_knownReceived || mayBlock; };
+    for (const HttpHeader& h : headers) {
+      Line line{LITERAL, 0, h.name == "authorization", &h};
+      uint64_t nameIndex = QpackDynamicTable::npos;
+      uint64_t exact = FindStatic(h, nameIndex);
+      if (exact != QpackDynamicTable::npos) {
+        line.kind = STATIC_INDEX;
+        line.index = exact;
+      } else if (allowDynamic && !line.never && m_table.Capacity() > 0) {
+        uint64_t abs = m_table.Find(h, true);
+        if (abs == QpackDynamicTable::npos) abs = Insert(h, nameIndex, std::min(minRef, PinnedFrom()));
+        if (abs != QpackDynamicTable::npos && usable(abs)) {
+          line.kind = DYNAMIC_INDEX;
+          line.index = abs;
+          ric = std::max(ric, abs + 1);
+          minRef = std::min(minRef, abs);
+          ++m_stats.dynamicRefs;
+        }
+      }
+      if (line.kind == LITERAL && nameIndex != QpackDynamicTable::npos) {
+        line.kind = STATIC_NAME;
+        line.index = nameIndex;
+      }
+      lines.push_back(line);
+    }
+
+    std::string out;
+    uint64_t base = m_table.InsertCount();
+    uint64_t maxEntries = m_maxCapacity / 32;
+    HpackEncodeInt(out, 0x00, 8, ric ? ric % (2 * maxEntries) + 1 : 0);
+    HpackEncodeInt(out, 0x00, 7, ric ? base - ric : 0); // sign 0: Base = RIC + delta
+    if (!ric) base = 0;
+    for (const Line& l : lines) {
+      switch (l.kind) {
+      case STATIC_INDEX:
+        HpackEncodeInt(out, 0xc0, 6, l.index);
+        break;
+      case DYNAMIC_INDEX:
+        HpackEncodeInt(out, 0x80, 6, base - 1 - l.index);
+        break;
+      case STATIC_NAME:
+        HpackEncodeInt(out, 0x50 | (l.never ? 0x20 : 0), 4, l.index);
+        HpackEncodeString(out, l.h->value, m_huffman);
+        break;
+      case LITERAL:
+        HpackEncodeString(out, l.h->name, m_huffman, 0x20 | (l.never ? 0x10 : 0), 3);
+        HpackEncodeString(out, l.h->value, m_huffman);
+        break;
+      }
+    }
+    if (ric) {
+      if (ric > m_knownReceived) ++m_stats.blockingSections;
+      m_sections[streamId].push_back(Section{ric, minRef});
+    }
+    ++m_stats.sections;
+    m_stats.fields += headers.size();
+    m_stats.plainBytes += HeaderListPlainBytes(headers);
+    m_stats.encodedBytes += out.size();
+    return out;
+  }
+
+  // Encoder stream bytes produced since the last call; they must be sent
+  // before the sections that reference them.
+  std::string TakeEncoderStream() {
+    std::string out;
+    out.swap(m_encoderStream);
+    return out;
+  }
+
+  // Decoder stream instructions (§4.4), possibly split across calls; false on
+  // a malformed acknowledgement (QPACK_DECODER_STREAM_ERROR).
+  bool OnDecoderStream(const std::string& bytes) {
+    m_in += bytes;
+    size_t pos = 0;
+    while (pos < m_in.size()) {
+      size_t start = pos;
+      uint8_t b = static_cast<uint8_t>(m_in[pos]);
+      uint64_t v = 0;
+      if (!HpackDecodeInt(m_in, pos, (b & 0x80) ? 7 : 6, v)) {
+        pos = start; // incomplete
+        break;
+      }
+      if (b & 0x80) { // Section Acknowledgment
+        auto it = m_sections.find(v);
+        if (it == m_sections.end()) return false;
+        m_knownReceived = std::max(m_knownReceived, it->second.front().ric);
+        it->second.pop_front();
+        if (it->second.empty()) m_sections.erase(it);
+      } else if (b & 0x40) { // Stream Cancellation
+        m_sections.erase(v);
+      } else { // Insert Count Increment
+        if (v == 0 || m_knownReceived + v > m_table.InsertCount()) return false;
+        m_knownReceived += v;
+      }
+    }
+    m_in.erase(0, pos);
+    return true;
+  }
+
+  uint64_t KnownReceivedCount() const { return m_knownReceived; }
+  const QpackDynamicTable& GetTable() const { return m_table; }
+  const QpackStats& GetStats() const { return m_stats; }
+
+private:
+  struct Section {
+    uint64_t ric;    // Required Insert Count
+    uint64_t minRef; // oldest entry referenced
+  };
+
+  // Static full match (index returned) and first name match (`nameIndex`).
+  static uint64_t FindStatic(const HttpHeader& h, uint64_t& nameIndex) {
+    const HttpHeaderList& st = QpackStaticTable();
+    uint64_t found = QpackDynamicTable::npos;
+    for (uint64_t i = 0; i < st.size(); ++i) {
+      if (st[i].name != h.name) continue;
+      if (nameIndex == QpackDynamicTable::npos) nameIndex = i;
+      if (st[i].value == h.value) {
+        found = i;
+        break;
+      }
+    }
+    return found;
+  }
+
+  // Streams with unacknowledged references (each counts against the peer's
+  // blocked-streams limit until acknowledged).
+  bool IsBlocking(uint64_t streamId) const {
+    auto it = m_sections.find(streamId);
+    if (it == m_sections.end()) return false;
+    for (const Section& s : it->second) {
+      if (s.ric > m_knownReceived) return true;
+    }
+    return false;
+  }
+  uint64_t BlockingStreams() const {
+    uint64_t n = 0;
+    for (const auto& kv : m_sections) n += IsBlocking(kv.first);
+    return n;
+  }
+
+  // Entries below this index are evictable: acknowledged and not referenced
+  // by an outstanding section.
+  uint64_t PinnedFrom() const {
+    uint64_t pin = m_knownReceived;
+    for (const auto& kv : m_sections) {
+      for (const Section& s : kv.second) pin = std::min(pin, s.minRef);
+    }
+    return pin;
+  }
+
+  // Inserts `h` (Insert with Name Reference to the static table, or with
+  // Literal Name); returns its absolute index, or npos when it does not fit.
+  uint64_t Insert(const HttpHeader& h, uint64_t staticName, uint64_t evictableBelow) {
+    uint64_t size = HpackEntrySize(h);
+    if (4 * size > 3 * m_table.Capacity() || !m_table.CanMakeRoom(size, evictableBelow)) {
+      return QpackDynamicTable::npos;
+    }
+    Emit([&](std::string& out) {
+      if (staticName != QpackDynamicTable::npos) {
+        HpackEncodeInt(out, 0xc0, 6, staticName);
+      } else {
+        HpackEncodeString(out, h.name, m_huffman, 0x40, 5);
+      }
+      HpackEncodeString(out, h.value, m_huffman);
+    });
+    m_table.Insert(h);
+    return m_table.InsertCount() - 1;
+  }
+
+  template <typename F>
+  void Emit(F write) {
+    size_t before = m_encoderStream.size();
+    write(m_encoderStream);
+    m_stats.encoderStreamBytes += m_encoderStream.size() - before;
+  }
+
+  QpackDynamicTable m_table;
+  bool m_huffman;
+  uint64_t m_maxCapacity = 0;
+  uint64_t m_maxBlocked = 0;
+  uint64_t m_knownReceived = 0;
+  std::map<uint64_t, std::deque<Section>> m_sections; // unacknowledged, per stream in send order
+  std::string m_encoderStream;
+  std::string m_in;
+  QpackStats m_stats;
+};
+
+struct QpackDecoderStats {
+  uint64_t sections = 0;
+  uint64_t blockedSections = 0;
+  double blockedSeconds = 0.0; // summed over blocked sections
+  double maxBlockedSeconds = 0.0;
+  uint64_t decoderStreamBytes = 0;
+
+  void Add(const QpackDecoderStats& o) {
+    sections += o.sections;
+    blockedSections += o.blockedSections;
+    blockedSeconds += o.blockedSeconds;
+    maxBlockedSeconds = std::max(maxBlockedSeconds, o.maxBlockedSeconds);
+    decoderStreamBytes += o.decoderStreamBytes;
+  }
+};
+
+class QpackDecoder {
+public:
+  enum Result { QPACK_DECODED, QPACK_BLOCKED, QPACK_FAILED };
+
+  // A section that waited for the encoder stream, decoded once it caught up.
+  struct Unblocked {
+    uint64_t streamId;
+    HttpHeaderList headers;
+    double blockedSeconds;
+  };
+
+  // The SETTINGS_QPACK_MAX_TABLE_CAPACITY / SETTINGS_QPACK_BLOCKED_STREAMS
+  // this endpoint advertises.
+  QpackDecoder(uint64_t maxTableCapacity = 0, uint64_t maxBlockedStreams = 0)
+    : m_maxCapacity(maxTableCapacity), m_maxBlocked(maxBlockedStreams) {}
+
+  // Decodes the field section of `streamId` received at `now` (seconds). A
+  // blocked section is kept and returned by OnEncoderStream once decodable;
+  // QPACK_FAILED is a connection error (QPACK_DECOMPRESSION_FAILED).
+  Result Decode(uint64_t streamId, const std::string& section, HttpHeaderList& headers, double now) {
+    size_t pos = 0;
+    uint64_t ric = 0, base = 0;
+    if (!ParsePrefix(section, pos, ric, base)) return QPACK_FAILED;
+    ++m_stats.sections;
+    if (ric > m_table.InsertCount()) {
+      std::set<uint64_t> streams;
+      for (const Blocked& b : m_blocked) streams.insert(b.streamId);
+      if (!streams.count(streamId) && streams.size() >= m_maxBlocked) return QPACK_FAILED;
+      m_blocked.push_back(Blocked{streamId, section, ric, now});
+      ++m_stats.blockedSections;
+      return QPACK_BLOCKED;
+    }
+    if (!DecodeLines(section, pos, ric, base, headers)) return QPACK_FAILED;
+    if (ric) Acknowledge(streamId, ric);
+    return QPACK_DECODED;
+  }
+
+  // Encoder stream instructions (§4.3), possibly split across calls. Sections
+  // unblocked by them are appended to `unblocked` in arrival order; false on
+  // an encoder stream or decompression error.
+  bool OnEncoderStream(const std::string& bytes, double now, std::vector<Unblocked>& unblocked) {
+    m_in += bytes;
+    size_t pos = 0;
+    while (pos < m_in.size()) {
+      size_t start = pos;
+      uint8_t b = static_cast<uint8_t>(m_in[pos]);
+      HttpHeader h;
+      uint64_t v = 0;
+      bool complete, ok = true;
+      if (b & 0x80) { // Insert with Name Reference
+        complete = HpackDecodeInt(m_in, pos, 6, v) && HpackDecodeString(m_in, pos, h.value);
+        if (complete) {
+          if (b & 0x40) {
+            ok = v < QpackStaticTable().size();
+            if (ok) h.name = QpackStaticTable()[v].name;
+          } else {
+            ok = v < m_table.InsertCount() && m_table.Has(m_table.InsertCount() - 1 - v);
+            if (ok) h.name = m_table.Get(m_table.InsertCount() - 1 - v).name;
+          }
+          ok = ok && m_table.Insert(h);
+        }
+      } else if (b & 0x40) { // Insert with Literal Name
+        complete = HpackDecodeString(m_in, pos, h.name, 5) && HpackDecodeString(m_in, pos, h.value);
+        if (complete) ok = m_table.Insert(h);
+      } else if (b & 0x20) { // Set Dynamic Table Capacity
+        complete = HpackDecodeInt(m_in, pos, 5, v);
+        if (complete) ok = v <= m_maxCapacity && m_table.SetCapacity(v);
+      } else { // Duplicate
+        complete = HpackDecodeInt(m_in, pos, 5, v);
+        if (complete) {
+          ok = v < m_table.InsertCount() && m_table.Has(m_table.InsertCount() - 1 - v);
+          if (ok) {
+            HttpHeader dup = m_table.Get(m_table.InsertCount() - 1 - v);
+            ok = m_table.Insert(dup);
+          }
+        }
+      }
+      if (!complete) {
+        pos = start;
+        break;
+      }
+      if (!ok) return false;
+    }
+    m_in.erase(0, pos);
+
+    for (auto it = m_blocked.begin(); it != m_blocked.end();) {
+      if (it->ric > m_table.InsertCount()) {
+        ++it;
+        continue;
+      }
+      Unblocked u{it->streamId, HttpHeaderList(), now - it->since};
+      size_t p = 0;
+      uint64_t ric = 0, base = 0;
+      if (!ParsePrefix(it->section, p, ric, base) || !DecodeLines(it->section, p, ric, base, u.headers)) return false;
+      Acknowledge(it->streamId, ric);
+      m_stats.blockedSeconds += u.blockedSeconds;
+      m_stats.maxBlockedSeconds = std::max(m_stats.maxBlockedSeconds, u.blockedSeconds);
+      unblocked.push_back(u);
+      it = m_blocked.erase(it);
+    }
+    if (m_table.InsertCount() > m_acked) { // Insert Count Increment
+      Emit([&](std::string& out) { HpackEncodeInt(out, 0x00, 6, m_table.InsertCount() - m_acked); });
+      m_acked = m_table.InsertCount();
+    }
+    return true;
+  }
+
+  // Decoder stream bytes produced since the last call.
+  std::string TakeDecoderStream() {
+    std::string out;
+    out.swap(m_decoderStream);
+    return out;
+  }
+
+  size_t BlockedSections() const { return m_blocked.size(); }
+  const QpackDynamicTable& GetTable() const { return m_table; }
+  const QpackDecoderStats& GetStats() const { return m_stats; }
+
+private:
+  struct Blocked {
+    uint64_t streamId;
+    std::string section;
+    uint64_t ric;
+    double since;
+  };
+
+  // Encoded Field Section Prefix (§4.5.1): Required Insert Count and Base.
+  bool ParsePrefix(const std::string& in, size_t& pos, uint64_t& ric, uint64_t& base) const {
+    uint64_t encoded = 0, delta = 0;
+    if (!HpackDecodeInt(in, pos, 8, encoded) || pos >= in.size()) return false;
+    bool negative = static_cast<uint8_t>(in[pos]) & 0x80;
+    if (!HpackDecodeInt(in, pos, 7, delta)) return false;
+    ric = 0;
+    if (encoded) {
+      uint64_t maxEntries = m_maxCapacity / 32;
+      uint64_t fullRange = 2 * maxEntries;
+      if (encoded > fullRange) return false;
+      uint64_t maxValue = m_table.InsertCount() + maxEntries;
+      ric = (maxValue / fullRange) * fullRange + encoded - 1;
+      if (ric > maxValue) {
+        if (ric <= fullRange) return false;
+        ric -= fullRange;
+      }
+      if (ric == 0) return false;
+    }
+    if (negative) {
+      if (delta >= ric) return false;
+      base = ric - delta - 1;
+    } else {
+      base = ric + delta;
+    }
+    return true;
+  }
+
+  // Field line representations (§4.5.2-4.5.6); every dynamic reference must
+  // be below the Required Insert Count.
+  bool DecodeLines(const std::string& in, size_t& pos, uint64_t ric, uint64_t base, HttpHeaderList& headers) const {
+    headers.clear();
+    while (pos < in.size()) {
+      uint8_t b = static_cast<uint8_t>(in[pos]);
+      HttpHeader h;
+      uint64_t index = 0;
+      if (b & 0x80) { // Indexed Field Line
+        if (!HpackDecodeInt(in, pos, 6, index)) return false;
+        if (b & 0x40) {
+          if (!Static(index, h, true)) return false;
+        } else if (index >= base || !Dynamic(base - 1 - index, ric, h, true)) {
+          return false;
+        }
+      } else if (b & 0x40) { // Literal Field Line with Name Reference
+        if (!HpackDecodeInt(in, pos, 4, index)) return false;
+        if (b & 0x10) {
+          if (!Static(index, h, false)) return false;
+        } else if (index >= base || !Dynamic(base - 1 - index, ric, h, false)) {
+          return false;
+        }
+        if (!HpackDecodeString(in, pos, h.value)) return false;
+      } else if (b & 0x20) { // Literal Field Line with Literal Name
+        if (!HpackDecodeString(in, pos, h.name, 3) || !HpackDecodeString(in, pos, h.value)) return false;
+      } else if (b & 0x10) { // Indexed Field Line with Post-Base Index
+        if (!HpackDecodeInt(in, pos, 4, index) || !Dynamic(base + index, ric, h, true)) return false;
+      } else { // Literal Field Line with Post-Base Name Reference
+        if (!HpackDecodeInt(in, pos, 3, index) || !Dynamic(base + index, ric, h, false)) return false;
+        if (!HpackDecodeString(in, pos, h.value)) return false;
+      }
+      headers.push_back(h);
+    }
+    return true;
+  }
+
+  static bool Static(uint64_t index, HttpHeader& h, bool withValue) {
+    const HttpHeaderList& st = QpackStaticTable();
+    if (index >= st.size()) return false;
+    h.name = st[index].name;
+    if (withValue) h.value = st[index].value;
+    return true;
+  }
+  bool Dynamic(uint64_t abs, uint64_t ric, HttpHeader& h, bool withValue) const {
+    if (abs >= ric || !m_table.Has(abs)) return false;
+    h.name = m_table.Get(abs).name;
+    if (withValue) h.value = m_table.Get(abs).value;
+    return true;
+  }
+
+  void Acknowledge(uint64_t streamId, uint64_t ric) {
+    Emit([&](std::string& out) { HpackEncodeInt(out, 0x80, 7, streamId); });
+    m_acked = std::max(m_acked, ric);
+  }
+
+  template <typename F>
+  void Emit(F write) {
+    size_t before = m_decoderStream.size();
+    write(m_decoderStream);
+    m_stats.decoderStreamBytes += m_decoderStream.size() - before;
+  }
+
+  QpackDynamicTable m_table;
+  uint64_t m_maxCapacity;
+  uint64_t m_maxBlocked;
+  uint64_t m_acked = 0; // insert count the encoder knows of (acks + increments sent)
+  std::vector<Blocked> m_blocked;
+  std::string m_in;
+  std::string m_decoderStream;
+  QpackDecoderStats m_stats;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_QPACK_H
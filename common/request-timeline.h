@@ -0,0 +1,129 @@
+#ifndef HTTP_SIM_REQUEST_TIMELINE_H
+#define HTTP_SIM_REQUEST_TIMELINE_H
+
+// Per-request timeline kept by every HTTP client app, exported with
+// --waterfallFile so PLT regressions can be traced to individual objects.
+//
+// Milestones (simulator seconds, -1 = not reached):
+//   queued     request was next in line but no connection/stream slot was free
+//              (equal to `sent` when it went out immediately)
+//   sent       request HEADERS / request line written to the transport
+//   headers    response HEADERS (status line + Content-Length) parsed
+//   firstData  first response body byte
+//   lastByte   response complete
+//
+// `stream` is the HTTP/2 or QUIC stream id (0 for HTTP/1.1); `conn` is the
+// client/connection index assigned when the sims collect the timelines.
+// holBytes/holSeconds are the response bytes that waited behind a transport
+// gap (TCP out-of-order buffer) and the longest such wait. hdrBlockedSeconds
+// is the time the response header block waited for the QPACK encoder stream,
+// reqHdrBlockedSeconds the same wait for the request header block at the
+// server (HTTP/3 only).
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct RequestTiming {
+  uint32_t conn = 0;
+  uint32_t stream = 0;
+  uint32_t index = 0;   // request number on its connection
+  uint64_t bytes = 0;   // response body size
+  double queued = -1.0;
+  double sent = -1.0;
+  double headers = -1.0;
+  double firstData = -1.0;
+  double lastByte = -1.0;
+  uint64_t holBytes = 0;
+  double holSeconds = 0.0;
+  double hdrBlockedSeconds = 0.0;
+  double reqHdrBlockedSeconds = 0.0;
+
+  bool Done() const { return lastByte >= 0; }
+};
+
+class RequestTimeline {
+public:
+  void Clear() { m_reqs.clear(); }
+
+  // Each milestone is kept at its first occurrence.
+  void MarkQueued(uint32_t index, double t) { SetOnce(At(index).queued, t); }
+  void MarkSent(uint32_t index, uint32_t stream, double t) {
+    RequestTiming& r = At(index);
+    r.stream = stream;
+    SetOnce(r.queued, t);
+    SetOnce(r.sent, t);
+  }
+  void MarkHeaders(uint32_t index, uint64_t bytes, double t) {
+    RequestTiming& r = At(index);
+    r.bytes = bytes;
+    SetOnce(r.headers, t);
+  }
+  void MarkFirstData(uint32_t index, double t) { SetOnce(At(index).firstData, t); }
+  void MarkDone(uint32_t index, double t) {
+    RequestTiming& r = At(index);
+    SetOnce(r.firstData, t); // zero-length bodies
+    SetOnce(r.lastByte, t);
+  }
+
+  void AddHol(uint32_t index, uint64_t bytes, double seconds) {
+    if (bytes == 0) return;
+    RequestTiming& r = At(index);
+    r.holBytes += bytes;
+    r.holSeconds = std::max(r.holSeconds, seconds);
+  }
+
+  void AddHeaderBlocked(uint32_t index, double seconds) { At(index).hdrBlockedSeconds += seconds; }
+
+  const std::vector<RequestTiming>& Get() const { return m_reqs; }
+
+private:
+  RequestTiming& At(uint32_t index) {
+    if (index >= m_reqs.size()) {
+      size_t old = m_reqs.size();
+      m_reqs.resize(index + 1);
+      for (size_t i = old; i < m_reqs.size(); ++i) m_reqs[i].index = static_cast<uint32_t>(i);
+    }
+    return m_reqs[index];
+  }
+  static void SetOnce(double& field, double t) { if (field < 0) field = t; }
+
+  std::vector<RequestTiming> m_reqs;
+};
+
+// CSV waterfall, one row per request ordered by send time. Derived columns:
+// blocked = sent - queued, ttfb = headers - sent, download = lastByte -
+// firstData, total = lastByte - queued (empty when a milestone is missing),
+// then hol_bytes / hol_s / hdr_blocked_s / req_hdr_blocked_s.
+inline bool WriteWaterfall(const std::string& path, std::vector<RequestTiming> reqs) {
+  std::ofstream out(path);
+  if (!out) return false;
+  std::stable_sort(reqs.begin(), reqs.end(), [](const RequestTiming& a, const RequestTiming& b) {
+    if ((a.sent < 0) != (b.sent < 0)) return b.sent < 0;
+    return a.sent < b.sent;
+  });
+  auto cell = [&out](double v) { if (v >= 0) out << v; out << ','; };
+  auto span = [](double from, double to) { return (from >= 0 && to >= 0) ? to - from : -1.0; };
+  out << "conn,stream,request,bytes,queued_s,sent_s,headers_s,first_data_s,last_byte_s,"
+         "blocked_s,ttfb_s,download_s,total_s,hol_bytes,hol_s,hdr_blocked_s,req_hdr_blocked_s\n";
+  out << std::fixed << std::setprecision(9);
+  for (const RequestTiming& r : reqs) {
+    out << r.conn << ',' << r.stream << ',' << r.index << ',' << r.bytes << ',';
+    cell(r.queued); cell(r.sent); cell(r.headers); cell(r.firstData); cell(r.lastByte);
+    cell(span(r.queued, r.sent)); cell(span(r.sent, r.headers));
+    cell(span(r.firstData, r.lastByte));
+    cell(span(r.queued, r.lastByte));
+    out << r.holBytes << ',' << r.holSeconds << ',' << r.hdrBlockedSeconds << ','
+        << r.reqHdrBlockedSeconds << '\n';
+  }
+  return static_cast<bool>(out);
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_REQUEST_TIMELINE_H
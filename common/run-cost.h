@@ -0,0 +1,173 @@
+#ifndef HTTP_SIM_RUN_COST_H
+#define HTTP_SIM_RUN_COST_H
+
+// Cost of one simulation run: events executed by the simulator and the
+// wall-clock time spent in Simulator::Run(), normalised per simulated second.
+// Used to compare how much scheduler work a design costs, independent of how
+// long the scenario runs.
+//
+// With --profile the sims also time their hot application callbacks
+// (SIM_PROFILE_SCOPE) and print PrintProfile(): event rate, wall-clock per
+// simulated second, inclusive time and call count per callback, and the
+// process peak RSS. Timers cost two clock reads per call and are skipped
+// entirely when profiling is off.
+
+#include "ns3/simulator.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Peak resident set size of this process in KiB (0 if unavailable).
+inline uint64_t PeakRssKb() {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+  return static_cast<uint64_t>(ru.ru_maxrss); // Linux reports KiB
+}
+
+// Per-callback wall-clock accounting for --profile. Times are inclusive: a
+// callback that calls another timed callback counts the nested time too.
+class CallbackProfiler {
+public:
+  struct Slot {
+    std::string name;
+    uint64_t calls = 0;
+    double seconds = 0.0;
+  };
+
+  static CallbackProfiler& Get() {
+    static CallbackProfiler profiler;
+    return profiler;
+  }
+
+  void Enable(bool on) { m_enabled = on; }
+  bool IsEnabled() const { return m_enabled; }
+
+  // Registers a named slot once per call site; the index stays valid.
+  size_t Register(const char* name) {
+    m_slots.push_back(Slot{name, 0, 0.0});
+    return m_slots.size() - 1;
+  }
+
+  void Add(size_t slot, double seconds) {
+    ++m_slots[slot].calls;
+    m_slots[slot].seconds += seconds;
+  }
+
+  // Callbacks that ran, slowest first, with their share of `wallSeconds`.
+  void Print(std::ostream& os, double wallSeconds) const {
+    std::vector<Slot> used;
+    for (const Slot& s : m_slots) if (s.calls) used.push_back(s);
+    std::sort(used.begin(), used.end(), [](const Slot& a, const Slot& b) { return a.seconds > b.seconds; });
+    for (const Slot& s : used) {
+      os << "  " << std::left << std::setw(28) << s.name << std::right
+         << " calls=" << std::setw(10) << s.calls
+         << " total=" << std::fixed << std::setprecision(3) << std::setw(9) << s.seconds * 1e3 << " ms"
+         << " avg=" << std::setprecision(3) << std::setw(8) << s.seconds * 1e6 / s.calls << " us"
+         << " (" << std::setprecision(1) << (wallSeconds > 0 ? 100.0 * s.seconds / wallSeconds : 0.0) << "%)\n";
+    }
+  }
+
+private:
+  bool m_enabled = false;
+  std::vector<Slot> m_slots;
+};
+
+class ScopedCallbackTimer {
+public:
+  explicit ScopedCallbackTimer(size_t slot)
+    : m_slot(slot), m_on(CallbackProfiler::Get().IsEnabled()) {
+    if (m_on) m_start = std::chrono::steady_clock::now();
+  }
+  ~ScopedCallbackTimer() {
+    if (m_on) {
+      CallbackProfiler::Get().Add(m_slot, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+    }
+  }
+  ScopedCallbackTimer(const ScopedCallbackTimer&) = delete;
+  ScopedCallbackTimer& operator=(const ScopedCallbackTimer&) = delete;
+
+private:
+  size_t m_slot;
+  bool m_on;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#define SIM_PROFILE_CONCAT2(a, b) a##b
+#define SIM_PROFILE_CONCAT(a, b) SIM_PROFILE_CONCAT2(a, b)
+// Times the rest of the enclosing scope under `name` when --profile is on.
+#define SIM_PROFILE_SCOPE(name)                                                              \
+  static const size_t SIM_PROFILE_CONCAT(simProfSlot_, __LINE__) =                           \
+      ::ns3::CallbackProfiler::Get().Register(name);                                         \
+  ::ns3::ScopedCallbackTimer SIM_PROFILE_CONCAT(simProfTimer_, __LINE__)(SIM_PROFILE_CONCAT(simProfSlot_, __LINE__))
+
+class RunCost {
+public:
+  // Call right before Simulator::Run().
+  void Start() {
+    m_startEvents = Simulator::GetEventCount();
+    m_startSim = Simulator::Now().GetSeconds();
+    m_wallStart = std::chrono::steady_clock::now();
+  }
+
+  // Call right after Simulator::Run() returns (before Simulator::Destroy()).
+  void Stop() {
+    m_wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_wallStart).count();
+    m_events = Simulator::GetEventCount() - m_startEvents;
+    m_simSeconds = Simulator::Now().GetSeconds() - m_startSim;
+  }
+
+  uint64_t GetEvents() const { return m_events; }
+  double GetWallSeconds() const { return m_wallSeconds; }
+  double GetSimSeconds() const { return m_simSeconds; }
+  double GetEventsPerSimSecond() const { return m_simSeconds > 0 ? m_events / m_simSeconds : 0.0; }
+  double GetWallPerSimSecond() const { return m_simSeconds > 0 ? m_wallSeconds / m_simSeconds : 0.0; }
+  double GetEventsPerWallSecond() const { return m_wallSeconds > 0 ? m_events / m_wallSeconds : 0.0; }
+
+  void Print(std::ostream& os) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "Simulator events: " << m_events
+       << " (" << std::fixed << std::setprecision(1) << GetEventsPerSimSecond() << " per simulated second)\n";
+    os << "Wall-clock: " << std::setprecision(3) << m_wallSeconds << " s for "
+       << m_simSeconds << " s simulated (" << std::setprecision(3) << GetWallPerSimSecond() * 1e3
+       << " ms per simulated second)" << std::endl;
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+  // Print() plus event rate, per-callback timers and peak RSS (--profile).
+  void PrintProfile(std::ostream& os) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "------ Profile ------\n";
+    Print(os);
+    os << "Event rate: " << std::fixed << std::setprecision(0) << GetEventsPerWallSecond()
+       << " events per wall-clock second\n";
+    os << "App callbacks (inclusive wall time):\n";
+    CallbackProfiler::Get().Print(os, m_wallSeconds);
+    os << "Peak RSS: " << std::setprecision(1) << PeakRssKb() / 1024.0 << " MiB" << std::endl;
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+private:
+  uint64_t m_startEvents = 0;
+  uint64_t m_events = 0;
+  double m_startSim = 0.0;
+  double m_simSeconds = 0.0;
+  double m_wallSeconds = 0.0;
+  std::chrono::steady_clock::time_point m_wallStart;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_RUN_COST_H
@@ -0,0 +1,204 @@
+#ifndef HTTP_SIM_RESULTS_H
+#define HTTP_SIM_RESULTS_H
+
+// Machine-readable run results (--resultsFile), one schema for H1/H2/H3:
+//
+//   {
+//     "schema": "http-sim-results/1",
+//     "protocol": "http/1.1" | "http/2" | "http/3",
+//     "command_line": "...",
+//     "config":   { "<option>": value, ... },
+//     "metrics":  { ... },
+//     "requests": [ {"conn":0,"stream":1,"request":0,"bytes":..,"queued_s":..,
+//                    "sent_s":..,"headers_s":..,"first_data_s":..,"done_s":..,
+//                    "hol_bytes":..,"hol_s":..}, ... ],
+//     "flows":    [ {"flow_id":1,"src":"10.1.1.1:49153","dst":"10.1.1.2:8080",
+//                    "protocol":6,"rx_packets":..,"lost_packets":..,
+//                    "delay_sum_s":..,"jitter_sum_s":..,"avg_delay_s":..,
+//                    "avg_jitter_s":..}, ... ]            // only with FlowMonitor on
+//   }
+//
+// Metric keys every sim writes: completed_responses, requested_responses,
+// page_load_time_s, avg_delay_s, mean_response_time_s, p95_response_time_s,
+// downlink_bytes, throughput_mbps, retransmissions, jitter_s, sim_events,
+// wall_s, peak_rss_kb, and
+// latency_<hist>_{count,p50_s,p90_s,p99_s,p999_s,max_s} for every non-empty
+// GlobalHistograms() entry (request, ttfb, stream, rtt, sojourn).
+// Protocol-specific metrics sit next to them under their own keys. Open-loop
+// runs (common/arrivals.h) add offered_rps, achieved_rps, arrived_requests,
+// dropped_requests and peak_backlog.
+//
+// A path ending in ".csv" gets a flat header row plus one value row with the
+// config and metrics columns instead (requests and flows are omitted), which
+// sweep drivers can concatenate directly.
+//
+// WriteFlows() writes just the per-flow counters (--flowStatsFile) as
+// {"schema":"http-sim-flows/1","protocol":..,"command_line":..,"flows":[..]},
+// or as CSV with one row per flow.
+
+#include "json-object.h"
+#include "latency-histogram.h"
+#include "request-timeline.h"
+
+#include "ns3/double.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class SimResults {
+public:
+  explicit SimResults(const std::string& protocol) : m_protocol(protocol) {}
+
+  void SetCommandLine(int argc, char* argv[]) {
+    m_commandLine.clear();
+    for (int i = 0; i < argc; ++i) {
+      if (i) m_commandLine += ' ';
+      m_commandLine += argv[i];
+    }
+  }
+
+  JsonObject& Config() { return m_config; }
+  JsonObject& Metrics() { return m_metrics; }
+
+  // Milestones that were never reached are written as null.
+  void AddRequest(const RequestTiming& t) {
+    auto at = [](double v) { return v >= 0 ? v : std::numeric_limits<double>::quiet_NaN(); };
+    m_requests.push_back(JsonObject().Field("conn", t.conn).Field("stream", t.stream)
+                                     .Field("request", t.index).Field("bytes", t.bytes)
+                                     .Field("queued_s", at(t.queued)).Field("sent_s", at(t.sent))
+                                     .Field("headers_s", at(t.headers)).Field("first_data_s", at(t.firstData))
+                                     .Field("done_s", at(t.lastByte))
+                                     .Field("hol_bytes", t.holBytes).Field("hol_s", t.holSeconds)
+                                     .Field("hdr_blocked_s", t.hdrBlockedSeconds)
+                                     .Field("req_hdr_blocked_s", t.reqHdrBlockedSeconds));
+  }
+
+  void AddLatencyPercentiles(const LatencyHistograms& hs) {
+    hs.ForEach([this](const char* n, const LatencyHistogram& h) {
+      if (h.GetCount() == 0) return;
+      std::string k = std::string("latency_") + n + "_";
+      m_metrics.Field((k + "count").c_str(), h.GetCount())
+               .Field((k + "p50_s").c_str(), h.PercentileSeconds(50.0))
+               .Field((k + "p90_s").c_str(), h.PercentileSeconds(90.0))
+               .Field((k + "p99_s").c_str(), h.PercentileSeconds(99.0))
+               .Field((k + "p999_s").c_str(), h.PercentileSeconds(99.9))
+               .Field((k + "max_s").c_str(), h.GetMax() / 1e9);
+    });
+  }
+
+  // Only the counters the analysis uses are kept: the raw sums so runs can be
+  // pooled, plus the per-flow means.
+  void AddFlows(Ptr<FlowMonitor> flowmon, Ptr<Ipv4FlowClassifier> classifier) {
+    if (!flowmon || !classifier) return;
+    for (const auto& kv : flowmon->GetFlowStats()) {
+      const FlowMonitor::FlowStats& st = kv.second;
+      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(kv.first);
+      std::ostringstream src, dst;
+      src << t.sourceAddress << ":" << t.sourcePort;
+      dst << t.destinationAddress << ":" << t.destinationPort;
+      double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
+      double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
+      m_flows.push_back(JsonObject().Field("flow_id", kv.first)
+                                    .Field("src", src.str()).Field("dst", dst.str())
+                                    .Field("protocol", static_cast<uint32_t>(t.protocol))
+                                    .Field("rx_packets", st.rxPackets).Field("lost_packets", st.lostPackets)
+                                    .Field("delay_sum_s", st.delaySum.GetSeconds())
+                                    .Field("jitter_sum_s", st.jitterSum.GetSeconds())
+                                    .Field("avg_delay_s", avgDelay).Field("avg_jitter_s", avgJitter));
+    }
+  }
+
+  // Returns false if the file cannot be written.
+  bool Write(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0) {
+      WriteCsv(out);
+    } else {
+      JsonObject root;
+      root.Field("schema", "http-sim-results/1").Field("protocol", m_protocol)
+          .Field("command_line", m_commandLine)
+          .Field("config", m_config).Field("metrics", m_metrics)
+          .Field("requests", m_requests).Field("flows", m_flows);
+      out << root.Str() << "\n";
+    }
+    return static_cast<bool>(out);
+  }
+
+  bool WriteFlows(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0) {
+      for (size_t r = 0; r < m_flows.size(); ++r) {
+        const JsonObject::FieldList& f = m_flows[r].Fields();
+        if (r == 0) {
+          for (size_t i = 0; i < f.size(); ++i) out << (i ? "," : "") << f[i].first;
+          out << "\n";
+        }
+        for (size_t i = 0; i < f.size(); ++i) out << (i ? "," : "") << CsvValue(f[i].second);
+        out << "\n";
+      }
+    } else {
+      JsonObject root;
+      root.Field("schema", "http-sim-flows/1").Field("protocol", m_protocol)
+          .Field("command_line", m_commandLine).Field("flows", m_flows);
+      out << root.Str() << "\n";
+    }
+    return static_cast<bool>(out);
+  }
+
+private:
+  void WriteCsv(std::ostream& out) const {
+    std::vector<std::pair<std::string, std::string>> cols{{"protocol", JsonObject::Quote(m_protocol)}};
+    cols.insert(cols.end(), m_config.Fields().begin(), m_config.Fields().end());
+    cols.insert(cols.end(), m_metrics.Fields().begin(), m_metrics.Fields().end());
+    for (size_t i = 0; i < cols.size(); ++i) out << (i ? "," : "") << cols[i].first;
+    out << "\n";
+    for (size_t i = 0; i < cols.size(); ++i) out << (i ? "," : "") << CsvValue(cols[i].second);
+    out << "\n";
+  }
+
+  // JSON literal -> CSV cell: numbers pass through, strings lose their JSON
+  // escaping and are quoted CSV-style, null becomes an empty cell.
+  static std::string CsvValue(const std::string& json) {
+    if (json == "null") return "";
+    if (json.empty() || json[0] != '"') return json;
+    std::string cell = "\"";
+    for (size_t i = 1; i + 1 < json.size(); ++i) {
+      char c = json[i];
+      if (c == '\\' && i + 2 < json.size()) c = json[++i];
+      if (c == '"') cell += '"';
+      cell += c;
+    }
+    return cell + "\"";
+  }
+
+  std::string m_protocol;
+  std::string m_commandLine;
+  JsonObject m_config;
+  JsonObject m_metrics;
+  std::vector<JsonObject> m_requests;
+  std::vector<JsonObject> m_flows;
+};
+
+// Lightweight FlowMonitor: unless the full XML (histograms + probes) was asked
+// for, every histogram collapses into a single bin so the per-packet cost is
+// only the counters AddFlows() reads.
+inline void ConfigureFlowMonitor(FlowMonitorHelper& helper, bool fullXml) {
+  if (fullXml) return;
+  helper.SetMonitorAttribute("DelayBinWidth", DoubleValue(1e9));
+  helper.SetMonitorAttribute("JitterBinWidth", DoubleValue(1e9));
+  helper.SetMonitorAttribute("PacketSizeBinWidth", DoubleValue(1e9));
+  helper.SetMonitorAttribute("FlowInterruptionsBinWidth", DoubleValue(1e9));
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_RESULTS_H
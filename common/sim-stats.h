@@ -0,0 +1,29 @@
+#ifndef HTTP_SIM_STATS_H
+#define HTTP_SIM_STATS_H
+
+// Small summary-statistics helpers used by the end-of-run reports.
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace ns3 {
+
+// Nearest-rank percentile (p in [0,100]) of an unsorted sample; 0 when empty.
+inline double SamplePercentile(std::vector<double> v, double p) {
+  if (v.empty()) return 0.0;
+  std::sort(v.begin(), v.end());
+  double rank = std::ceil(p / 100.0 * v.size());
+  size_t idx = rank < 1.0 ? 0 : static_cast<size_t>(rank) - 1;
+  return v[std::min(idx, v.size() - 1)];
+}
+
+inline double SampleMean(const std::vector<double>& v) {
+  if (v.empty()) return 0.0;
+  return std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+}
+
+} // namespace ns3
+
+#endif // HTTP_SIM_STATS_H
@@ -0,0 +1,98 @@
+#ifndef HTTP_SIM_STREAM_SCHEDULER_H
+#define HTTP_SIM_STREAM_SCHEDULER_H
+
+// Response scheduling shared by the HTTP/2 and HTTP/3 servers.
+//
+// Both servers keep a std::deque<PendingItem> of responses that still have
+// body bytes to send. Each SendTick takes one item, sends one chunk for it
+// and puts it back. The scheduler only decides which item is taken and where
+// it goes back; the framing and transport checks stay in the servers.
+//
+//   rr   - plain round robin (front of the queue, re-queued at the back)
+//   srpt - shortest remaining size first; with agingBytesPerSec > 0 an item's
+//          effective size shrinks by that many bytes per second it has been
+//          waiting, so large objects are not starved indefinitely.
+//
+// Either policy only picks among the items with the lowest RFC 9218 urgency
+// (Item.urgency, 0 = most urgent) in the queue; with every item at the
+// default urgency 3 this is the plain policy.
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace ns3 {
+
+enum class SchedulerPolicy { ROUND_ROBIN, SRPT };
+
+class StreamScheduler {
+public:
+  StreamScheduler() : m_policy(SchedulerPolicy::ROUND_ROBIN), m_agingBytesPerSec(0.0) {}
+  StreamScheduler(SchedulerPolicy policy, double agingBytesPerSec)
+    : m_policy(policy), m_agingBytesPerSec(agingBytesPerSec) {}
+
+  // Accepts "rr"/"roundrobin" and "srpt"; returns false (policy = rr) for
+  // anything else so main can warn about the typo.
+  static bool ParsePolicy(const std::string& name, SchedulerPolicy& policy) {
+    policy = SchedulerPolicy::ROUND_ROBIN;
+    if (name == "srpt" || name == "SRPT") policy = SchedulerPolicy::SRPT;
+    else if (name != "rr" && name != "RR" && name != "roundrobin") return false;
+    return true;
+  }
+
+  SchedulerPolicy GetPolicy() const { return m_policy; }
+  double GetAgingBytesPerSec() const { return m_agingBytesPerSec; }
+  std::string GetName() const { return m_policy == SchedulerPolicy::SRPT ? "srpt" : "rr"; }
+
+  // Removes and returns the item to serve next. The queue must not be empty.
+  template <typename Item>
+  Item Take(std::deque<Item>& q, double now) const {
+    size_t idx = PickIndex(q, now);
+    Item item = q[idx];
+    q.erase(q.begin() + idx);
+    return item;
+  }
+
+  // Puts back an item that still has bytes left after being served.
+  // Round robin rotates it to the tail; SRPT keeps it at the head so that an
+  // equal-size tie keeps serving the same stream instead of interleaving.
+  template <typename Item>
+  void Requeue(std::deque<Item>& q, const Item& item) const {
+    if (m_policy == SchedulerPolicy::SRPT) q.push_front(item);
+    else q.push_back(item);
+  }
+
+private:
+  template <typename Item>
+  size_t PickIndex(const std::deque<Item>& q, double now) const {
+    if (q.size() == 1) return 0;
+    uint8_t urgency = q[0].urgency;
+    for (size_t i = 1; i < q.size(); ++i) urgency = std::min(urgency, q[i].urgency);
+    size_t best = q.size();
+    double bestScore = 0.0;
+    for (size_t i = 0; i < q.size(); ++i) {
+      if (q[i].urgency != urgency) continue;
+      if (m_policy == SchedulerPolicy::ROUND_ROBIN) return i;
+      double s = Score(q[i], now);
+      if (best == q.size() || s < bestScore) { best = i; bestScore = s; } // ties keep the earlier item
+    }
+    return best;
+  }
+
+  template <typename Item>
+  double Score(const Item& item, double now) const {
+    double score = static_cast<double>(item.remainingBytes);
+    if (m_agingBytesPerSec > 0.0 && now > item.enqueueTime) {
+      score -= m_agingBytesPerSec * (now - item.enqueueTime);
+    }
+    return score;
+  }
+
+  SchedulerPolicy m_policy;
+  double m_agingBytesPerSec;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_STREAM_SCHEDULER_H
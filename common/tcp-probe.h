@@ -0,0 +1,124 @@
+#ifndef HTTP_SIM_TCP_PROBE_H
+#define HTTP_SIM_TCP_PROBE_H
+
+// Congestion/RTT instrumentation of TCP sockets from the TcpSocketBase trace
+// sources (CongestionWindow, BytesInFlight, RTT, CongState, RTO).
+//
+// Every watched socket keeps its latest state here so samplers can read it,
+// and each change is recorded into GlobalTracer() in the same TraceRecord
+// format the QUIC session uses (TRACE_CWND: value = cwnd, bytes = bytes in
+// flight; TRACE_RTT / TRACE_RTO in ns; TRACE_CONG_STATE), with `stream` set
+// to the connection number, so TCP and QUIC can be overlaid from one trace.
+// RTT samples also feed GlobalHistograms().rtt; srtt is smoothed here from
+// them (RFC 6298, alpha = 1/8).
+
+#include "event-trace.h"
+#include "latency-histogram.h"
+
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-socket-state.h"
+#include "ns3/tcp-tx-buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ns3 {
+
+struct TcpProbe {
+  Ptr<TcpSocketBase> socket;
+  uint32_t node = 0;
+  uint32_t conn = 0;          // process-wide connection number
+  uint32_t cwnd = 0;
+  uint32_t bytesInFlight = 0;
+  uint32_t congState = TcpSocketState::CA_OPEN;
+  Time lastRtt;
+  Time srtt;
+  Time rto;
+};
+
+class TcpProbeSet {
+public:
+  // Starts tracking `sock`; the returned probe lives as long as the set.
+  TcpProbe* Watch(Ptr<TcpSocketBase> sock) {
+    m_probes.push_back(std::unique_ptr<TcpProbe>(new TcpProbe()));
+    TcpProbe* p = m_probes.back().get();
+    p->socket = sock;
+    p->node = sock->GetNode()->GetId();
+    p->conn = NextConnNumber();
+    sock->TraceConnectWithoutContext("CongestionWindow", MakeBoundCallback(&TcpProbeSet::OnCwnd, p));
+    sock->TraceConnectWithoutContext("BytesInFlight", MakeBoundCallback(&TcpProbeSet::OnBytesInFlight, p));
+    sock->TraceConnectWithoutContext("RTT", MakeBoundCallback(&TcpProbeSet::OnRtt, p));
+    sock->TraceConnectWithoutContext("CongState", MakeBoundCallback(&TcpProbeSet::OnCongState, p));
+    sock->TraceConnectWithoutContext("RTO", MakeBoundCallback(&TcpProbeSet::OnRto, p));
+    return p;
+  }
+
+  uint64_t TotalCwnd() const {
+    uint64_t sum = 0;
+    for (const auto& p : m_probes) sum += p->cwnd;
+    return sum;
+  }
+  uint64_t TotalBytesInFlight() const {
+    uint64_t sum = 0;
+    for (const auto& p : m_probes) sum += p->bytesInFlight;
+    return sum;
+  }
+  // Mean srtt over sockets that have an RTT sample.
+  double MeanSrttSeconds() const {
+    double sum = 0.0;
+    uint32_t n = 0;
+    for (const auto& p : m_probes) {
+      if (p->srtt > Time(0)) { sum += p->srtt.GetSeconds(); ++n; }
+    }
+    return n ? sum / n : 0.0;
+  }
+  uint64_t TotalTxAvailable() const {
+    uint64_t sum = 0;
+    for (const auto& p : m_probes) sum += p->socket->GetTxAvailable();
+    return sum;
+  }
+  // Bytes written by the app but not yet acknowledged (unsent + in flight).
+  uint64_t TotalTxBuffered() const {
+    uint64_t sum = 0;
+    for (const auto& p : m_probes) sum += p->socket->GetTxBuffer()->Size();
+    return sum;
+  }
+
+private:
+  static uint32_t NextConnNumber() {
+    static uint32_t next = 0;
+    return next++;
+  }
+
+  static void Record(const TcpProbe* p, uint16_t type, uint32_t bytes, uint64_t value) {
+    GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), p->node, type, p->conn, bytes, value);
+  }
+
+  static void OnCwnd(TcpProbe* p, uint32_t, uint32_t cwnd) {
+    p->cwnd = cwnd;
+    Record(p, TRACE_CWND, p->bytesInFlight, cwnd);
+  }
+  static void OnBytesInFlight(TcpProbe* p, uint32_t, uint32_t inFlight) { p->bytesInFlight = inFlight; }
+  static void OnRtt(TcpProbe* p, Time, Time rtt) {
+    p->lastRtt = rtt;
+    p->srtt = (p->srtt == Time(0)) ? rtt : (7 * p->srtt + rtt) / 8;
+    GlobalHistograms().rtt.Record(rtt.GetNanoSeconds());
+    Record(p, TRACE_RTT, 0, rtt.GetNanoSeconds());
+  }
+  static void OnCongState(TcpProbe* p, TcpSocketState::TcpCongState_t, TcpSocketState::TcpCongState_t state) {
+    p->congState = state;
+    Record(p, TRACE_CONG_STATE, 0, state);
+  }
+  static void OnRto(TcpProbe* p, Time, Time rto) {
+    p->rto = rto;
+    Record(p, TRACE_RTO, 0, rto.GetNanoSeconds());
+  }
+
+  std::vector<std::unique_ptr<TcpProbe>> m_probes;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_TCP_PROBE_H
@@ -0,0 +1,97 @@
+#ifndef HTTP_SIM_TCP_RX_HOL_H
+#define HTTP_SIM_TCP_RX_HOL_H
+
+// Receive-side TCP head-of-line blocking, measured from the socket's
+// TcpRxBuffer rather than inferred from response timing.
+//
+// Every received data segment (the "Rx" trace) is checked once the socket
+// has processed it: bytes stored beyond NextRxSequence sit in the
+// out-of-order buffer behind a missing segment and go into a HolLedger until
+// the gap fills.
+//
+// Offsets are bytes from the start of the connection's receive stream (the
+// first payload byte is 0), which is what the app sees through Recv(), so
+// the app can attribute held bytes to the requests/streams it parses with
+// Consume(), in stream order.
+
+#include "hol-ledger.h"
+
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/tcp-socket-base.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+class TcpRxHolTracker {
+public:
+  void Watch(Ptr<TcpSocketBase> sock) {
+    m_socket = sock;
+    sock->TraceConnectWithoutContext("Rx", MakeCallback(&TcpRxHolTracker::OnRx, this));
+  }
+
+  // HoL share of [lo, hi); ranges must be consumed in stream order.
+  HolShare Consume(uint64_t lo, uint64_t hi) { return m_ledger.Consume(lo, hi, Simulator::Now().GetSeconds()); }
+
+  // An episode still open at the end of the run counts up to now.
+  RxHolStats GetStats() const { return m_ledger.GetStats(Simulator::Now().GetSeconds()); }
+
+private:
+  struct Segment {
+    uint64_t lo, hi;
+  };
+
+  // Sequence numbers wrap every 4 GiB. A received segment lies within 2^31
+  // bytes of the in-order point, so its signed 32-bit distance from that point
+  // gives the 64-bit stream offset across wraps.
+  uint64_t Offset(SequenceNumber32 seq) const {
+    uint32_t nextSeq = m_base + static_cast<uint32_t>(m_nextOffset);
+    int32_t d = static_cast<int32_t>(seq.GetValue() - nextSeq);
+    if (d < 0 && static_cast<uint64_t>(-static_cast<int64_t>(d)) > m_nextOffset) return 0;
+    return m_nextOffset + d;
+  }
+
+  void OnRx(Ptr<const Packet> p, const TcpHeader& h, Ptr<const TcpSocketBase>) {
+    if (p->GetSize() == 0) return;
+    if (!m_haveBase) { // before the first data segment is processed: ISN + 1
+      m_base = m_socket->GetRxBuffer()->NextRxSequence().GetValue();
+      m_haveBase = true;
+    }
+    uint64_t lo = Offset(h.GetSequenceNumber());
+    m_pending.push_back(Segment{lo, lo + p->GetSize()});
+    if (!m_checkPending) {
+      m_checkPending = true;
+      Simulator::ScheduleNow(&TcpRxHolTracker::Check, this);
+    }
+  }
+
+  // Runs after the socket has processed this instant's segments. Segments
+  // the buffer did not keep (nothing out of order) are not counted as held.
+  void Check() {
+    m_checkPending = false;
+    Ptr<TcpRxBuffer> rx = m_socket->GetRxBuffer();
+    uint64_t next = Offset(rx->NextRxSequence());
+    m_nextOffset = next;
+    double now = Simulator::Now().GetSeconds();
+    if (rx->Size() > rx->Available()) {
+      for (const Segment& seg : m_pending) m_ledger.Hold(seg.lo, seg.hi, next, now);
+    }
+    m_pending.clear();
+    m_ledger.Advance(next, now);
+  }
+
+  Ptr<TcpSocketBase> m_socket;
+  uint32_t m_base = 0;
+  uint64_t m_nextOffset = 0; // stream offset of NextRxSequence at the last Check()
+  bool m_haveBase = false;
+  bool m_checkPending = false;
+  std::vector<Segment> m_pending;
+  HolLedger m_ledger;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_TCP_RX_HOL_H
@@ -0,0 +1,548 @@
+#ifndef HTTP_SIM_WORKLOAD_H
+#define HTTP_SIM_WORKLOAD_H
+
+// Object workloads replayed by the HTTP/1.1, HTTP/2 and HTTP/3 sims
+// (--harFile, --pageFile, --pageGraph).
+//
+// A Workload is the list of objects one page load fetches, in the order the
+// browser issues them. Per object:
+//   host, path        request target; paths are unique within a workload
+//                     (repeats get a "_rep=<n>" query parameter) so the
+//                     servers can look every request up by path
+//   reqHeaderBytes    request header size as HTTP/1.1 text (0 = sim default)
+//   respHeaderBytes   response header size as HTTP/1.1 text (0 = sim default)
+//   bodyBytes         response body bytes on the wire
+//   urgency           RFC 9218 urgency, 0 = most urgent, 3 = default
+//   startOffset       not requested earlier than this after the page started
+//   deps              objects that must have arrived before this one is
+//                     discovered (indices of earlier objects)
+//   processDelay      parse/execute time after this object arrives before
+//                     the objects depending on it are discovered
+//
+// LoadHar() reads an HTTP Archive 1.2 file (log.entries[]). Header sizes
+// come from headersSize, or from the header list when it is -1 (HTTP/2 and
+// HTTP/3 captures); the body from response.bodySize, or content.size when
+// unknown; the urgency from Chrome's _priority or a request "priority"
+// header. Entries that never hit the network (served from cache, failed,
+// non-http URLs) are skipped. HAR objects have no dependencies: the recorded
+// start offsets already carry the page's discovery order.
+//
+// LoadPage() reads a dependency graph:
+//
+//   {"objects": [
+//     {"id": "html", "host": "www.example.com", "path": "/", "bodyBytes": 12000,
+//      "urgency": 0, "processDelay": 0.02},
+//     {"id": "app.js", "bodyBytes": 50000, "after": ["html"], "processDelay": 0.03},
+//     {"id": "hero.jpg", "bodyBytes": 200000, "after": ["app.js"], "urgency": 4}]}
+//
+// with the per-object fields above ("after" lists ids); missing fields take
+// the defaults (path "/<id>", host "server", bodyBytes 0 = an empty response
+// such as a 204 beacon; workloads/zero-body.json is a page with several).
+// BuildPage() generates a page with the --mixedSizes object mix: an HTML
+// root, CSS and JS discovered by parsing it, images discovered by the HTML or
+// by one of the scripts.
+//
+// Clients take a WorkloadQueue: their share of the objects, fetched in order.
+// An object is due once it is startOffset into the page (the first client's
+// start) and processDelay after each of its deps arrived, on any connection;
+// clients register a waker that runs whenever an object completes. Shares
+// are dealt round robin in issue order over the client connections.
+//
+// CriticalPath() is the page's lower bound: the longest dependency chain
+// when every fetch costs one round trip plus its bytes at the link rate.
+// LoadTime() is what the run achieved (last arrival minus page start).
+
+#include "http-headers.h"
+#include "json-value.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct WorkloadObject {
+  std::string host;
+  std::string path;
+  uint32_t reqHeaderBytes = 0;
+  uint32_t respHeaderBytes = 0;
+  uint32_t bodyBytes = 0;
+  uint8_t urgency = 3;
+  double startOffset = 0.0;
+  std::vector<uint32_t> deps;
+  double processDelay = 0.0;
+};
+
+// Longest chain found by Workload::CriticalPath().
+struct CriticalPathInfo {
+  double seconds = 0.0;         // total length
+  double fetchSeconds = 0.0;    // round trips and transfer on the chain
+  double processSeconds = 0.0;  // parse/execute delays on the chain
+  std::vector<uint32_t> objects; // root first
+};
+
+// ISO 8601 date-time ("2024-05-01T10:00:00.123Z", "...+02:00") as seconds
+// since the Unix epoch; false if malformed.
+inline bool ParseIsoTime(const std::string& s, double& seconds) {
+  int y, mo, d, h, mi;
+  double sec;
+  char tail[16] = {0};
+  if (std::sscanf(s.c_str(), "%d-%d-%dT%d:%d:%lf%15s", &y, &mo, &d, &h, &mi, &sec, tail) < 6) return false;
+  // days_from_civil (proleptic Gregorian)
+  y -= mo <= 2;
+  int era = (y >= 0 ? y : y - 399) / 400;
+  unsigned yoe = static_cast<unsigned>(y - era * 400);
+  unsigned doy = (153 * (mo + (mo > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  double days = double(era) * 146097 + double(doe) - 719468;
+  seconds = days * 86400.0 + h * 3600.0 + mi * 60.0 + sec;
+  int th = 0, tm = 0;
+  if ((tail[0] == '+' || tail[0] == '-') && std::sscanf(tail + 1, "%d:%d", &th, &tm) >= 1) {
+    double offset = th * 3600.0 + tm * 60.0;
+    seconds += tail[0] == '+' ? -offset : offset;
+  }
+  return true;
+}
+
+class Workload {
+public:
+  bool Empty() const { return m_objects.empty(); }
+  size_t Size() const { return m_objects.size(); }
+  const WorkloadObject& Get(size_t i) const { return m_objects[i]; }
+  uint32_t Skipped() const { return m_skipped; }
+
+  uint32_t DependencyCount() const {
+    uint32_t n = 0;
+    for (const WorkloadObject& o : m_objects) n += o.deps.size();
+    return n;
+  }
+
+  uint64_t TotalBodyBytes() const {
+    uint64_t sum = 0;
+    for (const WorkloadObject& o : m_objects) sum += o.bodyBytes;
+    return sum;
+  }
+
+  // Index of the object requested with `path`, or -1.
+  int64_t Find(const std::string& path) const {
+    auto it = m_byPath.find(path);
+    return it == m_byPath.end() ? -1 : static_cast<int64_t>(it->second);
+  }
+
+  // Object indices for connection `conn` of `nConns`, in start order.
+  std::vector<uint32_t> Share(uint32_t conn, uint32_t nConns) const {
+    std::vector<uint32_t> ids;
+    for (uint32_t i = conn; i < m_objects.size(); i += std::max(1u, nConns)) ids.push_back(i);
+    return ids;
+  }
+
+  // Appends an object in issue order; deps must name earlier objects. The
+  // path is made unique.
+  void Add(WorkloadObject o) {
+    if (m_byPath.count(o.path)) {
+      std::string base = o.path;
+      for (uint32_t rep = 1; m_byPath.count(o.path); ++rep) {
+        o.path = base + (base.find('?') == std::string::npos ? "?" : "&") + "_rep=" + std::to_string(rep);
+      }
+    }
+    m_byPath[o.path] = static_cast<uint32_t>(m_objects.size());
+    m_objects.push_back(o);
+    m_doneAt.push_back(-1.0);
+  }
+
+  void Clear() {
+    m_objects.clear();
+    m_byPath.clear();
+    m_doneAt.clear();
+    m_skipped = 0;
+    m_origin = -1.0;
+    m_lastDone = -1.0;
+  }
+
+  bool LoadHar(const std::string& file, std::string& error) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+      error = "cannot open " + file;
+      return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    JsonValue doc;
+    if (!JsonValue::Parse(text.str(), doc, error)) {
+      error = file + ": " + error;
+      return false;
+    }
+    const JsonValue& entries = doc["log"]["entries"];
+    if (!entries.IsArray()) {
+      error = file + ": no log.entries array";
+      return false;
+    }
+    Clear();
+
+    std::vector<std::pair<double, WorkloadObject>> loaded;
+    double origin = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < entries.Size(); ++i) {
+      const JsonValue& e = entries[i];
+      WorkloadObject o;
+      double started = 0.0;
+      if (!FromHarEntry(e, o) || !ParseIsoTime(e["startedDateTime"].Str(), started)) {
+        ++m_skipped;
+        continue;
+      }
+      origin = std::min(origin, started);
+      loaded.emplace_back(started, o);
+    }
+    std::stable_sort(loaded.begin(), loaded.end(),
+                     [](const std::pair<double, WorkloadObject>& a, const std::pair<double, WorkloadObject>& b) {
+                       return a.first < b.first;
+                     });
+    for (auto& l : loaded) {
+      l.second.startOffset = l.first - origin;
+      Add(l.second);
+    }
+    if (m_objects.empty()) {
+      error = file + ": no replayable entries";
+      return false;
+    }
+    return true;
+  }
+
+  bool LoadPage(const std::string& file, std::string& error) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+      error = "cannot open " + file;
+      return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    JsonValue doc;
+    if (!JsonValue::Parse(text.str(), doc, error)) {
+      error = file + ": " + error;
+      return false;
+    }
+    const JsonValue& list = doc["objects"];
+    if (!list.IsArray() || list.Size() == 0) {
+      error = file + ": no objects array";
+      return false;
+    }
+    Clear();
+
+    // Resolve ids, then emit in topological order (file order among ready objects)
+    std::map<std::string, uint32_t> byId;
+    for (size_t i = 0; i < list.Size(); ++i) {
+      std::string id = list[i]["id"].Str();
+      if (id.empty()) id = list[i]["path"].Str();
+      if (id.empty() || !byId.emplace(id, static_cast<uint32_t>(i)).second) {
+        error = file + ": object " + std::to_string(i) + " has a missing or duplicate id";
+        return false;
+      }
+    }
+    std::vector<std::vector<uint32_t>> parents(list.Size());
+    for (size_t i = 0; i < list.Size(); ++i) {
+      const JsonValue& after = list[i]["after"];
+      for (size_t k = 0; k < after.Size(); ++k) {
+        auto it = byId.find(after[k].Str());
+        if (it == byId.end()) {
+          error = file + ": unknown dependency '" + after[k].Str() + "'";
+          return false;
+        }
+        parents[i].push_back(it->second);
+      }
+    }
+    std::vector<int64_t> placed(list.Size(), -1);
+    for (uint32_t emitted = 0; emitted < list.Size();) {
+      uint32_t before = emitted;
+      for (size_t i = 0; i < list.Size(); ++i) {
+        if (placed[i] >= 0) continue;
+        bool ready = true;
+        for (uint32_t p : parents[i]) ready = ready && placed[p] >= 0;
+        if (!ready) continue;
+        const JsonValue& j = list[i];
+        WorkloadObject o;
+        std::string id = j["id"].Str().empty() ? j["path"].Str() : j["id"].Str();
+        o.host = j["host"].Str().empty() ? "server" : j["host"].Str();
+        o.path = j["path"].Str().empty() ? (id[0] == '/' ? id : "/" + id) : j["path"].Str();
+        o.reqHeaderBytes = static_cast<uint32_t>(std::max(0.0, j["reqHeaderBytes"].Num()));
+        o.respHeaderBytes = static_cast<uint32_t>(std::max(0.0, j["respHeaderBytes"].Num()));
+        o.bodyBytes = static_cast<uint32_t>(std::max(0.0, j["bodyBytes"].Num()));
+        o.urgency = static_cast<uint8_t>(std::min(7.0, std::max(0.0, j["urgency"].Num(3))));
+        o.startOffset = std::max(0.0, j["startOffset"].Num());
+        o.processDelay = std::max(0.0, j["processDelay"].Num());
+        for (uint32_t p : parents[i]) o.deps.push_back(static_cast<uint32_t>(placed[p]));
+        placed[i] = emitted++;
+        Add(o);
+      }
+      if (emitted == before) {
+        error = file + ": dependency cycle";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Synthetic page of n objects with the --mixedSizes mix (5% HTML 10 KB,
+  // 35% CSS/JS 50 KB, 60% images 200 KB). Object 0 is the page; other HTML
+  // (iframes), CSS and JS are discovered by parsing it; the first half of the
+  // images too, the rest by the scripts in turn. HTML takes 20 ms to parse,
+  // CSS 5 ms, JS 30 ms to execute.
+  void BuildPage(uint32_t n) {
+    Clear();
+    std::vector<uint32_t> scripts;
+    uint32_t firstImage = n;
+    for (uint32_t i = 1; i < n && firstImage == n; ++i) {
+      if (double(i) / std::max(1u, n - 1) >= 0.40) firstImage = i;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      double r = double(i) / std::max(1u, n - 1);
+      WorkloadObject o;
+      o.host = "server";
+      o.path = "/file" + std::to_string(i);
+      if (i == 0 || r < 0.05) {
+        o.bodyBytes = 10 * 1024;
+        o.urgency = 0;
+        o.processDelay = 0.020;
+      } else if (r < 0.40) {
+        bool script = i % 2 == 0;
+        o.bodyBytes = 50 * 1024;
+        o.urgency = script ? 2 : 1;
+        o.processDelay = script ? 0.030 : 0.005;
+        if (script) scripts.push_back(i);
+      } else {
+        o.bodyBytes = 200 * 1024;
+        o.urgency = 4;
+      }
+      if (i > 0) {
+        uint32_t image = i - firstImage;
+        bool byScript = i >= firstImage && image >= (n - firstImage) / 2 && !scripts.empty();
+        o.deps.push_back(byScript ? scripts[image % scripts.size()] : 0);
+      }
+      Add(o);
+    }
+  }
+
+  // --- run state, shared by all clients of one run ---
+
+  // Page start: the first call wins.
+  void Begin(double now) {
+    if (m_origin < 0) m_origin = now;
+  }
+  // Earliest time object `obj` may be requested; +inf while a dependency is
+  // still outstanding.
+  double DueTime(uint32_t obj) const {
+    const WorkloadObject& o = m_objects[obj];
+    double due = std::max(m_origin, 0.0) + o.startOffset;
+    for (uint32_t d : o.deps) {
+      if (m_doneAt[d] < 0) return std::numeric_limits<double>::infinity();
+      due = std::max(due, m_doneAt[d] + m_objects[d].processDelay);
+    }
+    return due;
+  }
+  void MarkDone(uint32_t obj, double now) {
+    if (m_doneAt[obj] >= 0) return;
+    m_doneAt[obj] = now;
+    m_lastDone = std::max(m_lastDone, now);
+    for (const auto& w : m_wakers) w.second();
+  }
+  // Runs after every MarkDone (clients re-check what became due) until
+  // removed with the returned id.
+  uint32_t AddWaker(std::function<void()> waker) {
+    m_wakers[m_nextWaker] = waker;
+    return m_nextWaker++;
+  }
+  void RemoveWaker(uint32_t id) { m_wakers.erase(id); }
+  uint32_t DoneCount() const {
+    uint32_t n = 0;
+    for (double t : m_doneAt) n += t >= 0;
+    return n;
+  }
+  // Page start to last arrival; 0 before anything arrived.
+  double LoadTime() const { return m_lastDone >= 0 && m_origin >= 0 ? m_lastDone - m_origin : 0.0; }
+
+  // Longest chain when each fetch takes rtt + (headers + body) / bytesPerSec.
+  CriticalPathInfo CriticalPath(double rtt, double bytesPerSec) const {
+    CriticalPathInfo info;
+    size_t n = m_objects.size();
+    std::vector<double> finish(n, 0.0), fetch(n, 0.0);
+    std::vector<int64_t> via(n, -1);
+    int64_t last = -1;
+    for (size_t i = 0; i < n; ++i) {
+      const WorkloadObject& o = m_objects[i];
+      double start = o.startOffset;
+      for (uint32_t d : o.deps) {
+        double ready = finish[d] + m_objects[d].processDelay;
+        if (ready > start) { start = ready; via[i] = d; }
+      }
+      uint64_t bytes = uint64_t(o.reqHeaderBytes) + o.respHeaderBytes + o.bodyBytes;
+      fetch[i] = rtt + (bytesPerSec > 0 ? bytes / bytesPerSec : 0.0);
+      finish[i] = start + fetch[i];
+      if (last < 0 || finish[i] > finish[last]) last = static_cast<int64_t>(i);
+    }
+    if (last < 0) return info;
+    info.seconds = finish[last];
+    for (int64_t i = last; i >= 0; i = via[i]) {
+      info.objects.insert(info.objects.begin(), static_cast<uint32_t>(i));
+      info.fetchSeconds += fetch[i];
+      if (via[i] >= 0) info.processSeconds += m_objects[via[i]].processDelay;
+    }
+    return info;
+  }
+
+  // One line: objects, hosts, dependencies, bytes, span of start offsets.
+  void Print(std::ostream& os) const {
+    std::set<std::string> hosts;
+    double span = 0.0;
+    for (const WorkloadObject& o : m_objects) {
+      hosts.insert(o.host);
+      span = std::max(span, o.startOffset);
+    }
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "Workload: " << m_objects.size() << " objects (" << m_skipped << " skipped) from " << hosts.size()
+       << " hosts, " << DependencyCount() << " dependencies, body " << TotalBodyBytes()
+       << " B, requests issued over " << std::fixed << std::setprecision(3) << span << " s\n";
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+  // "Critical path: ..." line comparing the lower bound with the achieved load time.
+  void PrintCriticalPath(std::ostream& os, const CriticalPathInfo& cp) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    os << "Critical path: " << std::fixed << std::setprecision(6) << cp.seconds << " s over " << cp.objects.size()
+       << " objects (fetch " << cp.fetchSeconds << " s, processing " << cp.processSeconds << " s)  PLT: "
+       << LoadTime() << " s (" << std::setprecision(3) << (cp.seconds > 0 ? LoadTime() / cp.seconds : 0.0)
+       << "x)  done: " << DoneCount() << "/" << m_objects.size() << "\n";
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+private:
+  static uint32_t HarHeaderBytes(const JsonValue& msg) {
+    double size = msg["headersSize"].Num(-1.0);
+    if (size > 0) return static_cast<uint32_t>(size);
+    HttpHeaderList headers;
+    const JsonValue& list = msg["headers"];
+    for (size_t i = 0; i < list.Size(); ++i) headers.push_back(HttpHeader{list[i]["name"].Str(), list[i]["value"].Str()});
+    return static_cast<uint32_t>(HeaderListPlainBytes(headers));
+  }
+
+  static uint8_t HarUrgency(const JsonValue& e) {
+    static const char* const names[] = {"VeryHigh", "High", "Medium", "Low", "VeryLow"};
+    const std::string& p = e["_priority"].Str();
+    for (uint8_t u = 0; u < 5; ++u) {
+      if (p == names[u]) return u;
+    }
+    const JsonValue& headers = e["request"]["headers"];
+    for (size_t i = 0; i < headers.Size(); ++i) {
+      std::string name = headers[i]["name"].Str();
+      std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+      if (name == "priority") return ParseUrgency(headers[i]["value"].Str());
+    }
+    return 3;
+  }
+
+  static bool FromHarEntry(const JsonValue& e, WorkloadObject& o) {
+    const JsonValue& req = e["request"];
+    const JsonValue& resp = e["response"];
+    const std::string& url = req["url"].Str();
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos) return false;
+    std::string proto = url.substr(0, scheme);
+    if (proto != "http" && proto != "https") return false;
+    if (resp["status"].Num(0) <= 0) return false;              // blocked / failed / aborted
+    if (!e["_fromCache"].Str().empty()) return false;          // memory or disk cache hit
+    size_t hostStart = scheme + 3;
+    size_t pathStart = url.find_first_of("/?#", hostStart);
+    o.host = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    size_t at = o.host.rfind('@');
+    if (at != std::string::npos) o.host = o.host.substr(at + 1);
+    o.path = pathStart == std::string::npos ? "/" : url.substr(pathStart, url.find('#', pathStart) - pathStart);
+    if (o.path.empty() || o.path[0] != '/') o.path = "/" + o.path;
+    o.reqHeaderBytes = HarHeaderBytes(req);
+    o.respHeaderBytes = HarHeaderBytes(resp);
+    double body = resp["bodySize"].Num(-1.0);
+    if (body < 0) body = resp["content"]["size"].Num(0.0);
+    o.bodyBytes = static_cast<uint32_t>(std::max(0.0, body));
+    o.urgency = HarUrgency(e);
+    return true;
+  }
+
+  std::vector<WorkloadObject> m_objects;
+  std::map<std::string, uint32_t> m_byPath;
+  uint32_t m_skipped = 0;
+  std::vector<double> m_doneAt;               // arrival per object, -1 = outstanding
+  std::map<uint32_t, std::function<void()>> m_wakers;
+  uint32_t m_nextWaker = 0;
+  double m_origin = -1.0;
+  double m_lastDone = -1.0;
+};
+
+// One client's share of a workload: its i-th request fetches object ids[i].
+class WorkloadQueue {
+public:
+  void Assign(Workload* workload, std::vector<uint32_t> ids) {
+    m_workload = workload;
+    m_ids = ids;
+  }
+  bool Active() const { return m_workload != nullptr; }
+  uint32_t Size() const { return static_cast<uint32_t>(m_ids.size()); }
+  const WorkloadObject& At(uint32_t i) const { return m_workload->Get(m_ids[i]); }
+
+  // Client start; also starts the page on the first call of the run.
+  void Start(double now) {
+    if (Active()) m_workload->Begin(now);
+  }
+  // When request i becomes due (-inf without a workload, +inf while blocked
+  // on a dependency).
+  double DueTime(uint32_t i) const {
+    if (!Active() || i >= m_ids.size()) return -std::numeric_limits<double>::infinity();
+    return m_workload->DueTime(m_ids[i]);
+  }
+  // Seconds until request i is due: 0 when due already, +inf while blocked
+  // (the waker runs once something it may depend on arrives).
+  double Wait(uint32_t i, double now) const { return std::max(0.0, DueTime(i) - now); }
+  // When request i joins the client's queue: `now`, or its due time if later;
+  // -1 while it is blocked on a dependency.
+  double QueueTime(uint32_t i, double now) const {
+    double due = DueTime(i);
+    return std::isinf(due) && due > 0 ? -1.0 : std::max(now, due);
+  }
+  // Request i's response has fully arrived.
+  void Complete(uint32_t i, double now) {
+    if (Active() && i < m_ids.size()) m_workload->MarkDone(m_ids[i], now);
+  }
+  // The client's waker, replacing any earlier one; ClearWaker() when the
+  // client stops so a finished app is never called back.
+  void SetWaker(std::function<void()> waker) {
+    ClearWaker();
+    if (Active()) {
+      m_wakerId = m_workload->AddWaker(waker);
+      m_hasWaker = true;
+    }
+  }
+  void ClearWaker() {
+    if (m_hasWaker) m_workload->RemoveWaker(m_wakerId);
+    m_hasWaker = false;
+  }
+
+private:
+  Workload* m_workload = nullptr;
+  std::vector<uint32_t> m_ids;
+  uint32_t m_wakerId = 0;
+  bool m_hasWaker = false;
+};
+
+} // namespace ns3
+
+#endif // HTTP_SIM_WORKLOAD_H
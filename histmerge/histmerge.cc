@@ -0,0 +1,43 @@
+// Merges latency histograms written with --histFile from replicated runs and
+// prints the combined percentiles.
+//
+//   ./ns3 run "histmerge run1.hist run2.hist run3.hist"
+//   ./ns3 run "histmerge -o all.hist run*.hist"     (also save the merged set)
+
+#include "../common/latency-histogram.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+int main(int argc, char* argv[]) {
+  std::string outPath;
+  LatencyHistograms merged;
+  int nFiles = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      outPath = argv[++i];
+      continue;
+    }
+    if (!merged.MergeFile(argv[i])) {
+      std::fprintf(stderr, "%s: not a readable histogram file\n", argv[i]);
+      return 1;
+    }
+    ++nFiles;
+  }
+  if (nFiles == 0) {
+    std::fprintf(stderr, "usage: %s [-o merged.hist] <run.hist>...\n", argv[0]);
+    return 2;
+  }
+
+  std::cout << "Merged " << nFiles << " histogram file(s)" << std::endl;
+  PrintLatencyPercentiles(merged, std::cout);
+  if (!outPath.empty() && !merged.Save(outPath, "histmerge")) {
+    std::fprintf(stderr, "cannot write %s\n", outPath.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -13,12 +13,31 @@
 #include "ns3/tcp-header.h"
 #include "ns3/tcp-socket-base.h"
 
+#include "../common/arrivals.h"
+#include "../common/byte-accounting.h"
+#include "../common/completion-coordinator.h"
+#include "../common/distributions.h"
+#include "../common/event-trace.h"
+#include "../common/latency-histogram.h"
+#include "../common/periodic-sampler.h"
+#include "../common/request-timeline.h"
+#include "../common/run-cost.h"
+#include "../common/sim-log.h"
+#include "../common/sim-results.h"
+#include "../common/sim-stats.h"
+#include "../common/tcp-probe.h"
+#include "../common/tcp-rx-hol.h"
+#include "../common/workload.h"
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("Http1Dot1Sim");
 
 //TCP count
 static std::vector<uint32_t> g_respSizes;
+static Workload g_workload; // --harFile objects, looked up by request path
+static RequestDistributions g_dists; // --*Dist draws (header sizes, think times)
+static ArrivalSchedule g_arrivals;   // --arrivalRate / --arrivalTrace (open loop)
 static uint64_t g_retxCount = 0;
 static void OnTcpRetransmission(Ptr<const Packet> p,
                                 const ns3::TcpHeader& h,
@@ -26,14 +45,20 @@ static void OnTcpRetransmission(Ptr<const Packet> p,
                                 const Address& to,
                                 Ptr<const ns3::TcpSocketBase> sock) {
   ++g_retxCount;
+  if (GlobalTracer().IsEnabled()) {
+    GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), sock->GetNode()->GetId(),
+                          TRACE_TCP_RETX, 0, p->GetSize(), h.GetSequenceNumber().GetValue());
+  }
 }
 
-//Data packet tracking function
-static void TxTrace(Ptr<const Packet> packet) {
-  std::cout << "[Trace] Packet sent, size=" << packet->GetSize() << std::endl;
+//Data packet tracking function (bound to the node id per device)
+static void TxTrace(uint32_t node, Ptr<const Packet> packet) {
+  GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), node, TRACE_MAC_TX, 0, packet->GetSize());
+  SIM_LOG(SIM_LOG_TRACE, "[Trace] Packet sent, size=" << packet->GetSize());
 }
-static void RxTrace(Ptr<const Packet> packet) {
-  std::cout << "[Trace] Packet received, size=" << packet->GetSize() << std::endl;
+static void RxTrace(uint32_t node, Ptr<const Packet> packet) {
+  GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), node, TRACE_MAC_RX, 0, packet->GetSize());
+  SIM_LOG(SIM_LOG_TRACE, "[Trace] Packet received, size=" << packet->GetSize());
 }
 
 // listen to TCP -- server 
@@ -50,6 +75,25 @@ public:
     m_respHdrBytes = respHdrBytes;
   }
 
+  // Periodic sampling summed over accepted connections; runs while responses
+  // are unacknowledged, pauses when idle and resumes on the next request.
+  // cwndLog prints the same "CWND_LOG,t,cwnd,inflight" lines as HTTP/3.
+  void EnableSampling(Time interval, bool cwndLog) {
+    m_sampler.AddProbe("cwnd", [this] { return double(m_tcpProbes.TotalCwnd()); });
+    m_sampler.AddProbe("bytes_in_flight", [this] { return double(m_tcpProbes.TotalBytesInFlight()); });
+    m_sampler.AddProbe("srtt_s", [this] { return m_tcpProbes.MeanSrttSeconds(); });
+    m_sampler.AddProbe("tx_buffered_bytes", [this] { return double(m_tcpProbes.TotalTxBuffered()); });
+    m_sampler.AddProbe("tx_available", [this] { return double(m_tcpProbes.TotalTxAvailable()); });
+    m_sampler.SetBusyCheck([this] { return m_tcpProbes.TotalTxBuffered() > 0; });
+    if (cwndLog) {
+      m_sampler.SetRowHook([](const std::vector<double>& row) {
+        std::cout << "CWND_LOG," << row[0] << "," << row[1] << "," << row[2] << std::endl;
+      });
+    }
+    m_sampler.Enable(interval);
+  }
+  PeriodicSampler& GetSampler() { return m_sampler; }
+
 //Create a TCP listening socket
 private:
   virtual void StartApplication() override {
@@ -74,20 +118,49 @@ private:
     if (tcpSock) {
       // 确保 trace 签名匹配
       tcpSock->TraceConnectWithoutContext("Retransmission", MakeCallback(&OnTcpRetransmission));
+      m_tcpProbes.Watch(tcpSock);
     }
   }
   //HandleRead function
   void HandleRead(Ptr<Socket> s) {
-    Ptr<Packet> packet = s->Recv();
-    if (!packet || packet->GetSize() == 0) return;
-
+    SIM_PROFILE_SCOPE("HandleRead (server)");
+    // A request can span several segments (large headers) and one segment can
+    // carry several requests, so buffer per socket and answer complete ones
+    std::string &buf = m_rxBufMap[s];
+    Ptr<Packet> packet;
+    while ((packet = s->Recv()) && packet->GetSize() > 0) {
+      size_t old = buf.size();
+      buf.resize(old + packet->GetSize());
+      packet->CopyData(reinterpret_cast<uint8_t*>(&buf[old]), packet->GetSize());
+    }
+    while (true) {
+      size_t headerEnd = buf.find("\r\n\r\n");
+      if (headerEnd == std::string::npos) break;
+      std::string header = buf.substr(0, headerEnd + 4);
+      size_t reqLen = header.size() + ContentLength(header);
+      if (buf.size() < reqLen) break;
+      buf.erase(0, reqLen);
+      Respond(s, RequestPath(header));
+    }
+  }
+  // One response for a complete request for `path`
+  void Respond(Ptr<Socket> s, const std::string& path) {
     // 每个 socket 的已处理请求计数
     uint32_t &m_reqsHandled = m_reqsHandledMap[s];
 
     if (m_reqsHandled < m_maxReqs) {
       m_reqsHandled++;
-      uint32_t rIdx = g_respSizes.empty() ? 0 : std::min<uint32_t>(m_reqsHandled - 1, g_respSizes.size() - 1);
+      // Workload replay: the object is named by the request line; otherwise
+      // the path carries the global request id the per-request draws use
+      int64_t obj = g_workload.Find(path);
+      uint32_t id = obj >= 0 ? static_cast<uint32_t>(obj) : RequestIdOfPath(path, m_reqsHandled - 1);
+      uint32_t rIdx = g_respSizes.empty() ? 0 : std::min<uint32_t>(id, g_respSizes.size() - 1);
       uint32_t thisRespSize = g_respSizes.empty() ? m_respSize : g_respSizes[rIdx];
+      uint32_t hdrBytes = g_dists.RespHeaderBytes(id, m_respHdrBytes);
+      if (obj >= 0) {
+        thisRespSize = g_workload.Get(obj).bodyBytes;
+        if (g_workload.Get(obj).respHeaderBytes > 0) hdrBytes = g_workload.Get(obj).respHeaderBytes;
+      }
       
       std::ostringstream oss;
       oss << "HTTP/1.1 200 OK\r\n"
@@ -96,7 +169,7 @@ private:
           << "Content-Length: " << thisRespSize << "\r\n"
           << "Connection: keep-alive\r\n";
       std::string base = oss.str();
-      size_t need = (m_respHdrBytes > base.size() + 4) ? (m_respHdrBytes - (base.size() + 4)) : 0;
+      size_t need = (hdrBytes > base.size() + 4) ? (hdrBytes - (base.size() + 4)) : 0;
       if (need > 0) oss << "X-Fill: " << std::string(need, 'y') << "\r\n";
       oss << "\r\n";
       std::string header = oss.str();
@@ -105,10 +178,30 @@ private:
       Ptr<Packet> resp = Create<Packet>(reinterpret_cast<const uint8_t*>(header.data()), header.size());
       Ptr<Packet> body = Create<Packet>(thisRespSize);
       s->Send(resp);
-      s->Send(body);
+      if (thisRespSize > 0) s->Send(body);
+      uint32_t node = GetNode()->GetId();
+      GlobalBytes().Add(node, BYTES_HEADERS, BYTES_DATA, header.size());
+      GlobalBytes().Add(node, BYTES_BODY, BYTES_DATA, thisRespSize);
+      m_sampler.Wake();
       NS_LOG_INFO("[Server] Sent response " << m_reqsHandled << ", size=" << thisRespSize << ", header size=" << header.size());
     }
   }
+  // Path of the "GET <path> HTTP/1.1" request line
+  static std::string RequestPath(const std::string& header) {
+    if (header.compare(0, 4, "GET ") != 0) return std::string();
+    size_t end = header.find(' ', 4);
+    return end == std::string::npos ? std::string() : header.substr(4, end - 4);
+  }
+  // Request body bytes following the header (0 without Content-Length)
+  static uint32_t ContentLength(const std::string& header) {
+    size_t pos = header.find("Content-Length: ");
+    if (pos == std::string::npos) return 0;
+    try {
+      return static_cast<uint32_t>(std::stoul(header.substr(pos + 16, header.find("\r\n", pos) - (pos + 16))));
+    } catch (...) {
+      return 0;
+    }
+  }
   //set up 
   Ptr<Socket> m_socket; //Server socket
   Ptr<Socket> m_clientSocket; //Client socket
@@ -116,7 +209,10 @@ private:
   uint32_t m_respSize;// Response size
   uint32_t m_maxReqs; // Maximum number of requests
   std::map<Ptr<Socket>, uint32_t> m_reqsHandledMap; // 替换原来的 uint32_t m_reqsHandled = 0;
+  std::map<Ptr<Socket>, std::string> m_rxBufMap; // Request bytes not yet answered, per socket
   uint32_t m_respHdrBytes; // Fixed response header size
+  TcpProbeSet m_tcpProbes; // Congestion state of accepted connections
+  PeriodicSampler m_sampler; // Periodic cwnd/queue sampling
 };
 
 
@@ -142,6 +238,17 @@ public:
   const std::vector<double>& GetRespRecvTimes() const { return m_respRecvTimes; }
   double GetInterval() const { return m_interval; }
   const std::vector<uint32_t>& GetDoneSizes() const { return m_doneSizes; }
+  const RequestTimeline& GetTimeline() const { return m_timeline; }
+  RxHolStats GetRxHolStats() const { return m_rxHol.GetStats(); }
+  // Workload replay: request i fetches object ids[i], no earlier than its start offset
+  void SetWorkload(Workload* workload, std::vector<uint32_t> ids) { m_workload.Assign(workload, ids); }
+  // Open loop: requests arrive at these offsets from start and wait in a backlog of at most maxBacklog (0 = unbounded)
+  void SetArrivals(std::vector<double> offsets, uint32_t maxBacklog) { m_arrivals.Assign(offsets, maxBacklog); }
+  ArrivalStats GetArrivalStats() const { return m_arrivals.GetStats(); }
+  // Connection index of nConns: request k is global request k * nConns + index
+  void SetConnection(uint32_t index, uint32_t nConns) { m_connIndex = index; m_nConns = nConns; }
+  // Invoked once when the last of m_nReqs responses has been received
+  void SetDoneCallback(Callback<void> cb) { m_doneCallback = cb; }
 
 //create TCP socket
 private:
@@ -161,6 +268,8 @@ private:
     if (tcpSock) {
       tcpSock->SetAttribute("TcpNoDelay", BooleanValue(true));
       tcpSock->TraceConnectWithoutContext("Retransmission", MakeCallback(&OnTcpRetransmission));
+      m_tcpProbes.Watch(tcpSock);
+      m_rxHol.Watch(tcpSock);
     }
 
 //Send the first request immediately
@@ -172,27 +281,62 @@ private:
     m_waitingResp = false;
     m_bytesToRecv = 0;
     m_bodyStart = 0;
+    m_firstByteTime = -1.0;
+    m_timeline.Clear();
+    m_workload.Start(Simulator::Now().GetSeconds());
+    m_workload.SetWaker([this] { Simulator::ScheduleNow(&HttpClientApp::OnWorkloadProgress, this); });
+    if (!m_arrivals.Active()) m_timeline.MarkQueued(0, m_workload.QueueTime(0, Simulator::Now().GetSeconds()));
+    m_arrivals.Start([this] { SendNextRequest(); });
     SendNextRequest();
   }
 
 //stop connection
   virtual void StopApplication() override {
+    Simulator::Cancel(m_deferredSend);
+    m_workload.ClearWaker();
+    m_arrivals.Stop();
     if (m_socket) m_socket->Close();
   }
   //Construct the HTTP/1.1 request line and the Host header
   void SendNextRequest() {
+    SIM_PROFILE_SCOPE("SendNextRequest (client)");
     if (m_reqsSent < m_nReqs) {
+      // Workload replay: one request at a time, held until its object is due
+      // (unknown while a dependency is outstanding: OnWorkloadProgress retries)
+      if ((m_workload.Active() || m_arrivals.Active()) && m_waitingResp) return;
+      double now = Simulator::Now().GetSeconds();
+      double wait = m_workload.Wait(m_reqsSent, now);
+      if (wait > 0) {
+        m_timeline.MarkQueued(m_reqsSent, m_workload.QueueTime(m_reqsSent, now));
+        if (std::isfinite(wait) && !m_deferredSend.IsPending()) {
+          m_deferredSend = Simulator::Schedule(Seconds(wait), &HttpClientApp::SendNextRequest, this);
+        }
+        return;
+      }
+      // Open loop: the oldest arrival goes next; with none waiting the next arrival retries
+      if (m_arrivals.Active()) {
+        if (m_arrivals.Empty()) return;
+        m_timeline.MarkQueued(m_reqsSent, m_arrivals.Take(m_reqsSent));
+      }
       // 构造固定大小的请求头
       std::ostringstream oss;
-      if (m_thirdParty) {
+      uint32_t reqId = GlobalRequestId(m_connIndex, m_nConns, m_reqsSent);
+      uint32_t hdrBytes = g_dists.ReqHeaderBytes(reqId, m_reqHdrBytes);
+      if (m_workload.Active()) {
+        const WorkloadObject& obj = m_workload.At(m_reqsSent);
+        if (obj.reqHeaderBytes > 0) hdrBytes = obj.reqHeaderBytes;
+        oss << "GET " << obj.path << " HTTP/1.1\r\n"
+            << "Host: " << obj.host << "\r\n"
+            << "Connection: keep-alive\r\n";
+      } else if (m_thirdParty) {
         // Alternate among domains to mimic third-party resources
         const char* domains[] = {"firstparty.example", "cdn.example", "ads.example"};
         const char* host = domains[m_reqsSent % 3];
-        oss << "GET /file" << m_reqsSent << " HTTP/1.1\r\n"
+        oss << "GET " << RequestIdPath(reqId) << " HTTP/1.1\r\n"
             << "Host: " << host << "\r\n"
             << "Connection: keep-alive\r\n";
       } else {
-        oss << "GET /file" << m_reqsSent << " HTTP/1.1\r\n"
+        oss << "GET " << RequestIdPath(reqId) << " HTTP/1.1\r\n"
             << "Host: server\r\n"
             << "Connection: keep-alive\r\n";
       }
@@ -200,10 +344,14 @@ private:
       // 添加常见头部，便于凑到稳定尺寸
       oss << "User-Agent: ns3-http1/0.1\r\n"
           << "Accept: */*\r\n";
+      // 请求最小长度控制（保留原有逻辑）：不足 reqSize 的部分作为请求体，
+      // 带 Content-Length 以便服务器分帧；回放的 GET 不带请求体
+      uint32_t bodyLen = (!m_workload.Active() && m_reqSize > hdrBytes) ? m_reqSize - hdrBytes : 0;
+      if (bodyLen > 0) oss << "Content-Length: " << bodyLen << "\r\n";
       
       // 填充X-Fill头部到目标大小
       std::string base = oss.str();
-      size_t need = (m_reqHdrBytes > base.size() + 4) ? (m_reqHdrBytes - (base.size() + 4)) : 0;
+      size_t need = (hdrBytes > base.size() + 4) ? (hdrBytes - (base.size() + 4)) : 0;
       if (need > 0) {
         oss << "X-Fill: " << std::string(need, 'x') << "\r\n";
       }
@@ -211,9 +359,7 @@ private:
 
       std::string header = oss.str();
       uint32_t headerLen = static_cast<uint32_t>(header.size());
-      
-      // 请求最小长度控制（保留原有逻辑）
-      uint32_t desiredSize = std::max(m_reqSize, headerLen);
+      uint32_t desiredSize = headerLen + bodyLen;
 
       // 创建 packet 时使用 const 指针
       Ptr<Packet> p = Create<Packet>(reinterpret_cast<const uint8_t*>(header.data()), headerLen);
@@ -223,8 +369,15 @@ private:
       }
       // record the time of sending request 
       m_socket->Send(p);
+      GlobalBytes().Add(GetNode()->GetId(), BYTES_HEADERS, BYTES_DATA, headerLen);
+      GlobalBytes().Add(GetNode()->GetId(), BYTES_BODY, BYTES_DATA, desiredSize - headerLen);
       m_reqSendTimes.push_back(Simulator::Now().GetSeconds());
+      m_timeline.MarkSent(m_reqsSent, 0, m_reqSendTimes.back());
       m_reqsSent++;
+      // 下一个请求排在这个响应之后
+      if (m_reqsSent < m_nReqs && !m_arrivals.Active()) {
+        m_timeline.MarkQueued(m_reqsSent, m_workload.QueueTime(m_reqsSent, m_reqSendTimes.back()));
+      }
       m_waitingResp = true;
       m_bytesToRecv = 0;
       m_bytesRcvd = 0;
@@ -233,15 +386,21 @@ private:
   }
   //read all the readable data in socket 
   void HandleRead(Ptr<Socket> s) {
+    SIM_PROFILE_SCOPE("HandleRead (client)");
     while (Ptr<Packet> packet = s->Recv()) {
       if (packet->GetSize() == 0) break;
       std::string data;
       data.resize(packet->GetSize());
       packet->CopyData((uint8_t*)&data[0], packet->GetSize());
       m_buffer += data;
+      m_rxBytes += data.size();
+      if (m_waitingResp && m_firstByteTime < 0) {
+        m_firstByteTime = Simulator::Now().GetSeconds();
+        GlobalHistograms().ttfb.RecordSeconds(m_firstByteTime - m_reqSendTimes.back());
+      }
 
       while (m_waitingResp) {
-        if (m_bytesToRecv == 0) {
+        if (m_bodyStart == 0) {
           size_t headerEnd = m_buffer.find("\r\n\r\n");
           if (headerEnd == std::string::npos) break;
             size_t pos = m_buffer.find("Content-Length: ");
@@ -256,30 +415,50 @@ private:
             break;
           }
               m_bodyStart = headerEnd + 4;
+          m_timeline.MarkHeaders(m_respsRcvd, m_bytesToRecv, Simulator::Now().GetSeconds());
+        }
+        size_t bodyBytes = (m_buffer.size() > m_bodyStart) ? (m_buffer.size() - m_bodyStart) : 0;
+        if (bodyBytes > 0) m_timeline.MarkFirstData(m_respsRcvd, Simulator::Now().GetSeconds());
+        // Content-Length: 0 (redirects, 204/304) completes right at the end of the headers
+        if (bodyBytes < m_bytesToRecv) break;
+        // Response occupies [bufStart, bufStart + header + body) of the receive stream
+        uint64_t bufStart = m_rxBytes - m_buffer.size();
+        HolShare hol = m_rxHol.Consume(bufStart, bufStart + m_bodyStart + m_bytesToRecv);
+        m_timeline.AddHol(m_respsRcvd, hol.bytes, hol.seconds);
+        m_timeline.MarkDone(m_respsRcvd, Simulator::Now().GetSeconds());
+        m_workload.Complete(m_respsRcvd, Simulator::Now().GetSeconds());
+        m_arrivals.Complete(m_respsRcvd, Simulator::Now().GetSeconds());
+        m_respsRcvd++;
+        m_waitingResp = false;
+        m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
+        GlobalHistograms().request.RecordSeconds(m_respRecvTimes.back() - m_reqSendTimes.back());
+        GlobalHistograms().stream.RecordSeconds(m_respRecvTimes.back() - m_firstByteTime);
+        m_firstByteTime = -1.0;
+        // 记录实际接收的响应大小
+        m_doneSizes.push_back(m_bytesToRecv);
+        GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), GetNode()->GetId(),
+                              TRACE_STREAM_DONE, m_respsRcvd, m_bytesToRecv);
+        SIM_LOG(SIM_LOG_INFO, "[Client] Received response " << m_respsRcvd << " at " << Simulator::Now().GetSeconds() << "s, size=" << m_bytesToRecv << " bytes");
+        if (m_arrivals.Active()) {
+          // Open loop: the next waiting arrival goes out right away, no think time
+          Simulator::ScheduleNow(&HttpClientApp::SendNextRequest, this);
+        } else if (m_respsRcvd < m_nReqs) {
+          double think = g_dists.ThinkSeconds(GlobalRequestId(m_connIndex, m_nConns, m_respsRcvd - 1), m_interval);
+          Simulator::Schedule(Seconds(think), &HttpClientApp::SendNextRequest, this);
         }
-        if (m_bytesToRecv > 0) {
-          size_t bodyBytes = (m_buffer.size() > m_bodyStart) ? (m_buffer.size() - m_bodyStart) : 0;
-          if (bodyBytes >= m_bytesToRecv) {
-            m_respsRcvd++;
-            m_waitingResp = false;
-            m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
-            // 记录实际接收的响应大小
-            m_doneSizes.push_back(m_bytesToRecv);
-            std::cout << "[Client] Received response " << m_respsRcvd << " at " << Simulator::Now().GetSeconds() << "s, size=" << m_bytesToRecv << " bytes" << std::endl;
-            if (m_respsRcvd < m_nReqs) {
-              Simulator::Schedule(Seconds(m_interval), &HttpClientApp::SendNextRequest, this);
-            }
-            // 安全地截断 buffer
-            size_t cutPos = m_bodyStart + m_bytesToRecv;
-            if (cutPos <= m_buffer.size()) {
-              m_buffer = m_buffer.substr(cutPos);
-            } else {
-              m_buffer.clear();
-            }
-            m_bytesToRecv = 0;
-            m_bodyStart = 0;
-          } else break;
+        // Arrivals dropped at a full backlog never get a response
+        if (m_respsRcvd == m_nReqs - m_arrivals.Dropped() && !m_doneCallback.IsNull()) {
+          m_doneCallback();
         }
+        // 安全地截断 buffer
+        size_t cutPos = m_bodyStart + m_bytesToRecv;
+        if (cutPos <= m_buffer.size()) {
+          m_buffer = m_buffer.substr(cutPos);
+        } else {
+          m_buffer.clear();
+        }
+        m_bytesToRecv = 0;
+        m_bodyStart = 0;
       }
     }
   }
@@ -288,12 +467,16 @@ private:
     
     // Record connection establishment time
     double connectionTime = (Simulator::Now() - m_connectionStartTime).GetMilliSeconds();
-    std::cout << "Connection time: " << connectionTime << " ms" << std::endl;
+    SIM_LOG(SIM_LOG_INFO, "Connection time: " << connectionTime << " ms");
     
     SendNextRequest();
   }
   void ConnectionFailed(Ptr<Socket> socket) {
-    std::cout << "Connection failed." << std::endl;
+    SIM_LOG(SIM_LOG_ERROR, "Connection failed.");
+  }
+  // Some page object arrived (on any connection): a blocked request may be due
+  void OnWorkloadProgress() {
+    if (!m_waitingResp) SendNextRequest();
   }
   Ptr<Socket> m_socket;
   Address m_servAddr;
@@ -309,11 +492,22 @@ private:
   std::vector<double> m_respRecvTimes;
   std::string m_buffer;
   uint32_t m_bodyStart = 0;
+  double m_firstByteTime = -1.0; // 当前响应首字节到达时间（<0 表示尚未到达）
+  RequestTimeline m_timeline;    // 逐请求时间线（--waterfallFile）
+  TcpProbeSet m_tcpProbes;       // Congestion state of this connection
+  TcpRxHolTracker m_rxHol;       // Out-of-order receive buffer (transport HoL)
+  uint64_t m_rxBytes = 0;        // Bytes read from the socket so far
   double m_interval = 0.01;  // 默认间隔为 0.01 秒
   bool m_thirdParty = false;
   uint32_t m_reqHdrBytes; // Fixed request header size
+  WorkloadQueue m_workload; // --harFile / --pageFile / --pageGraph share
+  EventId m_deferredSend;   // Waiting for the next object to become due
+  ArrivalQueue m_arrivals;  // Open-loop backlog (--arrivalRate / --arrivalTrace)
+  uint32_t m_connIndex = 0; // This connection's index ...
+  uint32_t m_nConns = 1;    // ... of this many (global request ids)
   std::vector<uint32_t> m_doneSizes; // 记录每个响应的实际接收大小
   Time m_connectionStartTime; // Added to track connection establishment time
+  Callback<void> m_doneCallback; // Completion coordinator notification
 };
 
 // ===================== Main =====================
@@ -340,6 +534,33 @@ int main(int argc, char *argv[]) {
   bool thirdParty = false;     // single domain
   uint32_t reqHdrBytes = 256;  // fixed request header
   uint32_t respHdrBytes = 256; // fixed response header
+  bool autoStop = true;        // stop once every client is done
+  std::string logLevel = "info"; // error|warn|info|debug|trace
+  bool quiet = false;          // shorthand for --logLevel=warn
+  bool macTrace = false;       // per-packet MAC Tx/Rx trace (needs logLevel=trace)
+  bool enableFlowmon = false;  // FlowMonitor per-flow stats (console + --resultsFile)
+  std::string flowStatsFile = ""; // per-flow counters only (.json or .csv; empty = off)
+  std::string flowmonXml = "";    // full FlowMonitor XML with histograms/probes (empty = off)
+  std::string traceFile = "";  // binary event trace (see trace2csv); empty = off
+  uint32_t traceCapacity = 1 << 20; // ring size in records (32 B each)
+  double drainTime = 0.5;      // seconds to keep running after the last response
+  std::string resultsFile = ""; // machine-readable results (.json, or .csv for one flat row)
+  std::string histFile = "";    // latency histograms for histmerge (empty = off)
+  bool profile = false;         // simulator self-profiling report
+  std::string waterfallFile = ""; // per-request timeline CSV (empty = off)
+  double sampleInterval = 0.01;   // periodic state sampling interval (s)
+  std::string sampleFile = "";    // sampled columns (.csv, else binary for trace2csv; empty = off)
+  bool cwndLog = false;           // print CWND_LOG lines on every sample
+  std::string harFile = "";       // HAR workload to replay (overrides nRequests/respSize/mixedSizes/thirdParty; empty = synthetic)
+  std::string pageFile = "";      // page dependency graph (JSON, see common/workload.h; empty = off)
+  bool pageGraph = false;         // synthetic page graph of nRequests objects (HTML -> CSS/JS -> images)
+  std::string respSizeDist = "";  // seeded response size distribution (see common/distributions.h; empty = respSize/mixedSizes)
+  std::string reqHdrDist = "";    // seeded request header size distribution (empty = reqHdrBytes)
+  std::string respHdrDist = "";   // seeded response header size distribution (empty = respHdrBytes)
+  std::string thinkDist = "";     // seeded think time between requests in seconds (empty = interval)
+  double arrivalRate = 0.0;       // open loop: Poisson arrivals in req/s (0 = closed loop; see common/arrivals.h)
+  std::string arrivalTrace = "";  // open loop: arrival times file (rescaled to arrivalRate if set; empty = off)
+  uint32_t maxBacklog = 0;        // open loop: waiting requests per connection before arrivals are dropped (0 = unbounded)
 
   CommandLine cmd;
   cmd.AddValue("nRequests", "Number of HTTP requests", nRequests);
@@ -356,7 +577,82 @@ int main(int argc, char *argv[]) {
   cmd.AddValue("thirdParty", "Simulate third-party domains in Host header", thirdParty);
   cmd.AddValue("reqHdrBytes", "Fixed request header size (bytes)", reqHdrBytes);
   cmd.AddValue("respHdrBytes", "Fixed response header size (bytes)", respHdrBytes);
+  cmd.AddValue("simTime", "Simulation time upper bound in seconds", simTime);
+  cmd.AddValue("autoStop", "Stop the simulation once every client has all responses", autoStop);
+  cmd.AddValue("drainTime", "Seconds to keep simulating after the last response (with autoStop)", drainTime);
+  cmd.AddValue("logLevel", "Progress log level: error|warn|info|debug|trace", logLevel);
+  cmd.AddValue("quiet", "Only print warnings, errors and the summary (same as --logLevel=warn)", quiet);
+  cmd.AddValue("macTrace", "Print per-packet MAC Tx/Rx events (at --logLevel=trace)", macTrace);
+  cmd.AddValue("flowmon", "Install FlowMonitor and report per-flow delay/jitter/loss", enableFlowmon);
+  cmd.AddValue("flowStatsFile", "Write per-flow rxPackets/delaySum/jitterSum/lost to this file (.json or .csv; implies --flowmon)", flowStatsFile);
+  cmd.AddValue("flowmonXml", "Write the full FlowMonitor XML (histograms and probes) to this file (implies --flowmon)", flowmonXml);
+  cmd.AddValue("traceFile", "Write a binary event trace to this file at the end of the run", traceFile);
+  cmd.AddValue("traceCapacity", "Event trace ring size in records; older records are overwritten", traceCapacity);
+  cmd.AddValue("resultsFile", "Write config, metrics, per-request timings and flow stats to this file (.json or .csv)", resultsFile);
+  cmd.AddValue("histFile", "Save request/TTFB/stream/RTT latency histograms to this file (mergeable with histmerge)", histFile);
+  cmd.AddValue("profile", "Report event rate, wall-clock per simulated second, per-callback time and peak RSS", profile);
+  cmd.AddValue("waterfallFile", "Write the per-request timeline (queued/sent/headers/first byte/last byte) as CSV", waterfallFile);
+  cmd.AddValue("sampleInterval", "Periodic state sampling interval in seconds (paused while idle)", sampleInterval);
+  cmd.AddValue("sampleFile", "Write sampled cwnd/in-flight/srtt/queue columns to this file (.csv, or binary for trace2csv)", sampleFile);
+  cmd.AddValue("cwndLog", "Print CWND_LOG lines (server cwnd and bytes in flight) on every sample", cwndLog);
+  cmd.AddValue("harFile", "Replay the objects of this HAR capture (sizes, hosts, priorities, start offsets) instead of the synthetic workload", harFile);
+  cmd.AddValue("pageFile", "Fetch the objects of this page dependency graph; children are requested once their parents arrived and were processed", pageFile);
+  cmd.AddValue("pageGraph", "Fetch a synthetic page of nRequests objects with HTML/CSS/JS discovery dependencies", pageGraph);
+  cmd.AddValue("respSizeDist", "Response sizes: fixed|uniform|exponential|lognormal|pareto|zipf|empirical:<args> (seeded by RngRun)", respSizeDist);
+  cmd.AddValue("reqHdrDist", "Request header sizes, same syntax as respSizeDist", reqHdrDist);
+  cmd.AddValue("respHdrDist", "Response header sizes, same syntax as respSizeDist", respHdrDist);
+  cmd.AddValue("thinkDist", "Think time in seconds before each next request, same syntax as respSizeDist", thinkDist);
+  cmd.AddValue("arrivalRate", "Open loop: Poisson request arrivals at this rate (req/s) instead of request-after-response", arrivalRate);
+  cmd.AddValue("arrivalTrace", "Open loop: request arrival times (s, one per line) from this file; rescaled to arrivalRate if given", arrivalTrace);
+  cmd.AddValue("maxBacklog", "Open loop: drop arrivals that find this many requests waiting on their connection (0 = unbounded)", maxBacklog);
   cmd.Parse(argc, argv);
+  if (!SetSimLogLevel(quiet ? "warn" : logLevel)) {
+    std::cerr << "Unknown --logLevel '" << logLevel << "', using info" << std::endl;
+  }
+  if (!traceFile.empty()) GlobalTracer().Enable(traceCapacity);
+  CallbackProfiler::Get().Enable(profile);
+  if (!harFile.empty() || !pageFile.empty()) {
+    std::string error;
+    bool ok = harFile.empty() ? g_workload.LoadPage(pageFile, error) : g_workload.LoadHar(harFile, error);
+    if (!ok) {
+      std::cerr << "Cannot load workload: " << error << std::endl;
+      return 1;
+    }
+  } else if (pageGraph) {
+    g_workload.BuildPage(nRequests);
+  }
+  if (!g_workload.Empty()) {
+    g_workload.Print(std::cout);
+    nRequests = g_workload.Size();
+  }
+  std::string arrivalError;
+  if (!g_arrivals.LoadTrace(arrivalTrace, arrivalError) || !g_arrivals.Setup(arrivalRate, nRequests, arrivalError)) {
+    std::cerr << "Bad arrivals: " << arrivalError << std::endl;
+    return 1;
+  }
+  if (g_arrivals.Active()) {
+    if (!g_workload.Empty()) {
+      std::cerr << "--arrivalRate/--arrivalTrace cannot be combined with --harFile/--pageFile/--pageGraph" << std::endl;
+      return 1;
+    }
+    g_arrivals.Print(std::cout, maxBacklog);
+    nRequests = g_arrivals.Size();
+  }
+
+  SimResults results("http/1.1");
+  results.SetCommandLine(argc, argv);
+  results.Config().Field("nRequests", nRequests).Field("respSize", respSize).Field("reqSize", reqSize)
+                  .Field("errorRate", errorRate).Field("dataRate", dataRate).Field("delay", delay)
+                  .Field("interval", interval).Field("nConnections", nConnections)
+                  .Field("mixedSizes", mixedSizes).Field("thirdParty", thirdParty)
+                  .Field("reqHdrBytes", reqHdrBytes).Field("respHdrBytes", respHdrBytes)
+                  .Field("simTime", simTime).Field("autoStop", autoStop).Field("drainTime", drainTime)
+                  .Field("harFile", harFile)
+                  .Field("pageFile", pageFile).Field("pageGraph", pageGraph)
+                  .Field("respSizeDist", respSizeDist).Field("reqHdrDist", reqHdrDist)
+                  .Field("respHdrDist", respHdrDist).Field("thinkDist", thinkDist)
+                  .Field("arrivalRate", arrivalRate).Field("arrivalTrace", arrivalTrace).Field("maxBacklog", maxBacklog)
+                  .Field("rngSeed", RngSeedManager::GetSeed()).Field("rngRun", RngSeedManager::GetRun());
 
   //构造每个请求的响应体大小数组
   g_respSizes.clear();
@@ -377,6 +673,13 @@ int main(int argc, char *argv[]) {
       }
     }
   }
+  std::string distError;
+  if (!g_dists.Setup(respSizeDist, reqHdrDist, respHdrDist, thinkDist, nRequests, distError)) {
+    std::cerr << "Bad distribution " << distError << std::endl;
+    return 1;
+  }
+  if (!g_dists.RespSizes().empty()) g_respSizes = g_dists.RespSizes();
+  if (g_dists.Any()) g_dists.Print(std::cout);
 
 //Create two nodes: one for the client and one for the server
   NodeContainer nodes;
@@ -397,10 +700,17 @@ int main(int argc, char *argv[]) {
   Ipv4AddressHelper address;
   address.SetBase("10.1.1.0", "255.255.255.0");
   Ipv4InterfaceContainer interfaces = address.Assign(devices);
+  GlobalBytes().SetServerNode(nodes.Get(1)->GetId());
+  GlobalBytes().TapDevices(devices);
 
   // HTTP/1.1 Application
   Ptr<HttpServerApp> serverApp = CreateObject<HttpServerApp>();
   serverApp->Setup(httpPort, respSize, nRequests, respHdrBytes);
+  if (cwndLog || !sampleFile.empty()) {
+    serverApp->EnableSampling(Seconds(sampleInterval), cwndLog);
+    Ptr<Queue<Packet>> serverQueue = DynamicCast<PointToPointNetDevice>(devices.Get(1))->GetQueue();
+    serverApp->GetSampler().AddProbe("link_queue_packets", [serverQueue] { return double(serverQueue->GetNPackets()); });
+  }
   nodes.Get(1)->AddApplication(serverApp);
   serverApp->SetStartTime(Seconds(0.5));
   serverApp->SetStopTime(Seconds(simTime));  // 使用动态仿真时间
@@ -408,12 +718,26 @@ int main(int argc, char *argv[]) {
   // 多连接客户端
   std::vector<Ptr<HttpClientApp>> clients;
   std::vector<std::vector<double>> allSendTimes, allRecvTimes;
+  CompletionCoordinator coordinator(autoStop, Seconds(drainTime));
   uint32_t baseReqs = nRequests / nConnections;
   uint32_t rem = nRequests % nConnections;
   for (uint32_t i = 0; i < nConnections; ++i) {
     uint32_t reqs = baseReqs + (i < rem ? 1 : 0); // 平均分配请求
     Ptr<HttpClientApp> client = CreateObject<HttpClientApp>();
+    if (!g_workload.Empty()) {
+      // Replay: objects are dealt round robin over the connections in start order
+      std::vector<uint32_t> share = g_workload.Share(i, nConnections);
+      reqs = share.size();
+      client->SetWorkload(&g_workload, share);
+    } else if (g_arrivals.Active()) {
+      // Open loop: arrivals are dealt round robin over the connections
+      std::vector<double> share = g_arrivals.Share(i, nConnections);
+      reqs = share.size();
+      client->SetArrivals(share, maxBacklog);
+    }
     client->Setup(interfaces.GetAddress(1), httpPort, reqSize, reqs, interval, thirdParty, reqHdrBytes);
+    client->SetConnection(i, nConnections);
+    if (reqs > 0) client->SetDoneCallback(coordinator.Register()); // idle clients never report in
     nodes.Get(0)->AddApplication(client);
     client->SetStartTime(Seconds(1.0 + i * 0.01)); // 避免完全同时启动
     client->SetStopTime(Seconds(simTime));  // 使用动态仿真时间
@@ -431,18 +755,23 @@ int main(int argc, char *argv[]) {
   em1->SetAttribute("ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
   devices.Get(1)->SetAttribute("ReceiveErrorModel", PointerValue(em1));
 
-//install flow monitor
+//install flow monitor (optional)
   FlowMonitorHelper flowmonHelper;
-  Ptr<FlowMonitor> flowmon = flowmonHelper.InstallAll();
+  Ptr<FlowMonitor> flowmon;
+  if (enableFlowmon || !flowStatsFile.empty() || !flowmonXml.empty()) {
+    ConfigureFlowMonitor(flowmonHelper, !flowmonXml.empty());
+    flowmon = flowmonHelper.InstallAll();
+  }
 
 
 //链路层发/收事件挂到你的 TxTrace/RxTrace
-  Config::ConnectWithoutContext(
-    "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacTx",
-    MakeCallback(&TxTrace));
-  Config::ConnectWithoutContext(
-    "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacRx",
-    MakeCallback(&RxTrace));
+  if (macTrace || GlobalTracer().IsEnabled()) {
+    for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n) {
+      std::string dev = "/NodeList/" + std::to_string(n) + "/DeviceList/*/$ns3::PointToPointNetDevice/";
+      Config::ConnectWithoutContext(dev + "MacTx", MakeBoundCallback(&TxTrace, n));
+      Config::ConnectWithoutContext(dev + "MacRx", MakeBoundCallback(&RxTrace, n));
+    }
+  }
 
 
   // TCP MSS consistency
@@ -456,7 +785,10 @@ int main(int argc, char *argv[]) {
   Config::SetDefault("ns3::TcpL4Protocol::SocketType", TypeIdValue(TcpNewReno::GetTypeId()));
   
   Simulator::Stop(Seconds(simTime));
+  RunCost runCost;
+  runCost.Start();
   Simulator::Run();
+  runCost.Stop();
 
   // HTTP/1.1 Application 统计
   uint32_t totalResps = 0;
@@ -475,6 +807,20 @@ int main(int argc, char *argv[]) {
   double pageFirstSend = std::numeric_limits<double>::infinity();
   double pageLastRecv = 0.0;
   
+  // 逐请求时间线：写入 --resultsFile 的 requests 与 --waterfallFile
+  std::vector<RequestTiming> timeline;
+  for (uint32_t ci = 0; ci < clients.size(); ++ci) {
+    for (RequestTiming t : clients[ci]->GetTimeline().Get()) {
+      t.conn = ci;
+      results.AddRequest(t);
+      timeline.push_back(t);
+    }
+  }
+  if (!waterfallFile.empty() && !WriteWaterfall(waterfallFile, timeline)) {
+    std::cerr << "Cannot write waterfall to " << waterfallFile << std::endl;
+  }
+
+  std::vector<double> transits; // 每个请求的响应时间（同一连接上按序配对）
   //统计每个客户端的响应数、发送时间、接收时间
   for (auto& client : clients) {
     totalResps += client->GetRespsRcvd();
@@ -496,6 +842,7 @@ int main(int argc, char *argv[]) {
       double transit = r[i] - s[i];
       sumDelay += transit;
       ++nDone;
+      transits.push_back(transit);
       if (havePrevTransit) {
         double D = std::abs(transit - prevTransit);
         rfcJitter += (D - rfcJitter) / 16.0;
@@ -517,47 +864,34 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  // 修复HoL统计：基于响应完成间隔，而不是发送间隔
-  uint64_t holEvents = 0;
-  double holBlockedTime = 0.0;
-  for (auto& client : clients) {
-    const auto& r = client->GetRespRecvTimes();
-    if (r.size() > 1) {
-      // 计算响应完成间隔，如果间隔过大说明有阻塞
-      for (size_t i = 1; i < r.size(); ++i) {
-        double respInterval = r[i] - r[i-1];
-        // 如果响应间隔超过理想间隔的2倍，认为是HoL阻塞
-        double idealInterval = client->GetInterval() * 1.5; // 允许一些容差
-        if (respInterval > idealInterval) {
-        ++holEvents;
-          holBlockedTime += (respInterval - idealInterval);
-        }
-      }
-    }
-  }
+  // HoL: time/bytes held in each client's TCP out-of-order receive buffer behind a missing segment
+  RxHolStats rxHol;
+  for (auto& client : clients) rxHol.Add(client->GetRxHolStats());
+  uint64_t holEvents = rxHol.episodes;
+  double holBlockedTime = rxHol.seconds;
 
   // 在统计输出前，添加 pageTime sanity check
   // 添加调试信息，显示pageFirstSend和pageLastRecv的值
-  std::cout << "DEBUG: For file size [" << respSize << "], first send time is: " << pageFirstSend << std::endl;
-  std::cout << "DEBUG: For file size [" << respSize << "], last receive time is: " << pageLastRecv << std::endl;
+  SIM_LOG(SIM_LOG_DEBUG, "DEBUG: For file size [" << respSize << "], first send time is: " << pageFirstSend);
+  SIM_LOG(SIM_LOG_DEBUG, "DEBUG: For file size [" << respSize << "], last receive time is: " << pageLastRecv);
   
   // 确保pageTime是有效的值
   double pageTime = 0.0;
   if (pageFirstSend != std::numeric_limits<double>::infinity() && pageLastRecv > pageFirstSend) {
     pageTime = pageLastRecv - pageFirstSend;
   } else {
-    std::cout << "DEBUG: Invalid page times detected, using fallback values:" << std::endl;
+    SIM_LOG(SIM_LOG_DEBUG, "DEBUG: Invalid page times detected, using fallback values:");
     if (firstSend != std::numeric_limits<double>::infinity() && lastRecv > firstSend) {
       pageTime = lastRecv - firstSend;
-      std::cout << "DEBUG: Using global times: " << firstSend << " to " << lastRecv << std::endl;
+      SIM_LOG(SIM_LOG_DEBUG, "DEBUG: Using global times: " << firstSend << " to " << lastRecv);
     } else {
       // 如果仍然无效，使用理论值
       double theoretical_transfer_time = (respSize * 8) / (1000 * 1e6); // 假设1000Mbps
       pageTime = theoretical_transfer_time + 0.0015; // 加上TCP握手和HTTP开销
-      std::cout << "DEBUG: Using theoretical time: " << pageTime << std::endl;
+      SIM_LOG(SIM_LOG_DEBUG, "DEBUG: Using theoretical time: " << pageTime);
     }
   }
-  std::cout << "DEBUG: Calculated pageTime is: " << pageTime << std::endl;
+  SIM_LOG(SIM_LOG_DEBUG, "DEBUG: Calculated pageTime is: " << pageTime);
 
   if (nDone > 0 && lastRecv > firstSend) {
     double avgDelay = sumDelay / static_cast<double>(nDone);
@@ -579,33 +913,83 @@ int main(int argc, char *argv[]) {
               << "  rate: " << (g_retxCount / (pageTime > 0 ? pageTime : 1.0)) << " /s" << std::endl;
     std::cout << "RFC3550 jitter estimate: " << rfcJitter << " s" << std::endl;
     std::cout << "HoL events: " << holEvents << "  HoL blocked time: " << holBlockedTime << " s" << std::endl;
+    std::cout << "HoL held bytes: " << rxHol.heldBytes << "  peak: " << rxHol.maxHeldBytes
+              << " B  byte-seconds: " << rxHol.byteSeconds << std::endl;
     std::cout << "Fixed header sizes - Request: " << reqHdrBytes << "B, Response: " << respHdrBytes << "B" << std::endl;
     std::cout << "------------------------------------------" << std::endl;
-  }
 
-  flowmon->CheckForLostPackets();
-
-  // Report per-flow delay/jitter using FlowMonitor statistics
-  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-  if (classifier) {
-    const auto& stats = flowmon->GetFlowStats();
-    for (const auto& kv : stats) {
-      uint32_t flowId = kv.first;
-      const FlowMonitor::FlowStats& st = kv.second;
-      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
-      double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
-      double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
-      std::cout << "Flow " << flowId
-                << " src=" << t.sourceAddress << ":" << t.sourcePort
-                << " -> dst=" << t.destinationAddress << ":" << t.destinationPort
-                << " proto=" << (uint32_t)t.protocol
-                << " rxPackets=" << st.rxPackets
-                << " avgDelay=" << avgDelay << " s"
-                << " avgJitter=" << avgJitter << " s"
-                << std::endl;
+    results.Metrics().Field("page_load_time_s", pageTime).Field("avg_delay_s", avgDelay)
+                     .Field("mean_response_time_s", SampleMean(transits))
+                     .Field("p95_response_time_s", SamplePercentile(transits, 95.0))
+                     .Field("downlink_bytes", totalActualBytes).Field("throughput_mbps", throughput)
+                     .Field("total_time_s", totalTime);
+  }
+  if (!g_workload.Empty()) {
+    CriticalPathInfo cp = g_workload.CriticalPath(2 * Time(delay).GetSeconds(), DataRate(dataRate).GetBitRate() / 8.0);
+    g_workload.PrintCriticalPath(std::cout, cp);
+    results.Metrics().Field("critical_path_s", cp.seconds).Field("critical_path_objects", cp.objects.size())
+                     .Field("critical_path_processing_s", cp.processSeconds)
+                     .Field("workload_plt_s", g_workload.LoadTime());
+  }
+  if (g_arrivals.Active()) {
+    ArrivalStats arrivals;
+    for (auto& client : clients) arrivals.Add(client->GetArrivalStats());
+    arrivals.Print(std::cout, g_arrivals.OfferedRate());
+    arrivals.AddMetrics(results.Metrics(), g_arrivals.OfferedRate());
+  }
+  PrintLatencyPercentiles(GlobalHistograms(), std::cout);
+  GlobalBytes().Print(std::cout);
+  GlobalBytes().AddMetrics(results.Metrics());
+  results.Metrics().Field("completed_responses", totalResps).Field("requested_responses", nRequests)
+                   .Field("retransmissions", g_retxCount).Field("jitter_s", rfcJitter)
+                   .Field("hol_events", holEvents).Field("hol_blocked_time_s", holBlockedTime)
+                   .Field("hol_held_bytes", rxHol.heldBytes).Field("hol_peak_held_bytes", rxHol.maxHeldBytes)
+                   .Field("hol_byte_seconds", rxHol.byteSeconds);
+  results.AddLatencyPercentiles(GlobalHistograms());
+  if (profile) runCost.PrintProfile(std::cout);
+  results.Metrics().Field("sim_events", runCost.GetEvents()).Field("wall_s", runCost.GetWallSeconds())
+                   .Field("peak_rss_kb", PeakRssKb());
+
+  if (flowmon) {
+    flowmon->CheckForLostPackets();
+
+    // Report per-flow delay/jitter using FlowMonitor statistics
+    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
+    if (classifier) {
+      const auto& stats = flowmon->GetFlowStats();
+      for (const auto& kv : stats) {
+        uint32_t flowId = kv.first;
+        const FlowMonitor::FlowStats& st = kv.second;
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
+        double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
+        double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
+        std::cout << "Flow " << flowId
+                  << " src=" << t.sourceAddress << ":" << t.sourcePort
+                  << " -> dst=" << t.destinationAddress << ":" << t.destinationPort
+                  << " proto=" << (uint32_t)t.protocol
+                  << " rxPackets=" << st.rxPackets
+                  << " avgDelay=" << avgDelay << " s"
+                  << " avgJitter=" << avgJitter << " s"
+                  << std::endl;
+      }
+    }
+    results.AddFlows(flowmon, classifier);
+    if (!flowStatsFile.empty() && !results.WriteFlows(flowStatsFile)) {
+      std::cerr << "Cannot write flow stats to " << flowStatsFile << std::endl;
     }
+    if (!flowmonXml.empty()) flowmon->SerializeToXmlFile(flowmonXml, true, true);
+  }
+  DumpGlobalTrace(traceFile, "http1.1", std::cout);
+  if (!sampleFile.empty() && !serverApp->GetSampler().Write(sampleFile)) {
+    std::cerr << "Cannot write samples to " << sampleFile << std::endl;
+  }
+  if (!histFile.empty() && !GlobalHistograms().Save(histFile, "http1.1")) {
+    std::cerr << "Cannot write histograms to " << histFile << std::endl;
+  }
+  if (!resultsFile.empty()) {
+    if (results.Write(resultsFile)) std::cout << "Results written to " << resultsFile << std::endl;
+    else std::cerr << "Cannot write results to " << resultsFile << std::endl;
   }
-  flowmon->SerializeToXmlFile("flowmon.xml", true, true);
 
   Simulator::Destroy();
 
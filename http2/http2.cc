@@ -14,6 +14,25 @@
 #include <map>
 #include <string>
 #include <iomanip>
+#include <limits>
+
+#include "../common/arrivals.h"
+#include "../common/byte-accounting.h"
+#include "../common/completion-coordinator.h"
+#include "../common/distributions.h"
+#include "../common/event-trace.h"
+#include "../common/hpack.h"
+#include "../common/latency-histogram.h"
+#include "../common/periodic-sampler.h"
+#include "../common/request-timeline.h"
+#include "../common/run-cost.h"
+#include "../common/sim-log.h"
+#include "../common/sim-results.h"
+#include "../common/sim-stats.h"
+#include "../common/stream-scheduler.h"
+#include "../common/tcp-probe.h"
+#include "../common/tcp-rx-hol.h"
+#include "../common/workload.h"
 
 
 using namespace ns3;
@@ -23,20 +42,31 @@ NS_LOG_COMPONENT_DEFINE("HTTP2App");
 
 
 // HTTP/2 Frame Type
-enum FrameType { HEADERS, DATA, PUSH_PROMISE, WINDOW_UPDATE };
+enum FrameType { HEADERS, DATA, PUSH_PROMISE, WINDOW_UPDATE, SETTINGS, RST_STREAM };
+
+// Frame flags (RFC 7540 §6). END_STREAM is defined for HEADERS/DATA, ACK for SETTINGS.
+static const uint8_t FLAG_END_STREAM = 0x1;
+static const uint8_t FLAG_ACK = 0x1;
+
+// RST_STREAM error code (RFC 7540 §7): the stream was refused before any processing
+static const uint32_t H2_REFUSED_STREAM = 0x7;
 
 
 // HTTP/2 Frame with stream ID prefix for lightweight multiplexing
 struct HTTP2Frame {
-   uint32_t streamId;
-   FrameType type;
-   uint32_t length;
+   uint32_t streamId = 0;
+   FrameType type = HEADERS;
+   uint8_t flags = 0;
+   uint32_t length = 0;
    std::string payload;
   
+   bool HasFlag(uint8_t f) const { return (flags & f) != 0; }
+  
    // Serialize frame with stream ID prefix for multiplexing
    std::string Serialize() const {
        std::ostringstream oss;
-       oss << "SID:" << streamId << "|TYPE:" << (int)type << "|LEN:" << length << "|";
+       oss << "SID:" << streamId << "|TYPE:" << (int)type << "|FLAGS:" << (int)flags
+           << "|LEN:" << length << "|";
        oss << payload;
        return oss.str();
    }
@@ -83,7 +113,7 @@ struct HTTP2Frame {
                    std::string typeStr = data.substr(pos, end - pos);
                    if (!typeStr.empty() && typeStr.find_first_not_of("0123456789") == std::string::npos) {
                        int typeVal = std::stoi(typeStr);
-                       if (typeVal >= 0 && typeVal <= 3) { // Valid FrameType range
+                       if (typeVal >= 0 && typeVal <= SETTINGS) { // Valid FrameType range
                            frame.type = static_cast<FrameType>(typeVal);
                            pos = end + 1;
                        } else {
@@ -103,6 +133,28 @@ struct HTTP2Frame {
                return frame;
            }
           
+           // Parse FLAGS
+           if (pos < data.length() && data.substr(pos, 6) == "FLAGS:") {
+               pos += 6;
+               size_t end = data.find('|', pos);
+               if (end != std::string::npos && end > pos) {
+                   std::string flagStr = data.substr(pos, end - pos);
+                   if (flagStr.find_first_not_of("0123456789") == std::string::npos) {
+                       frame.flags = static_cast<uint8_t>(std::stoi(flagStr));
+                       pos = end + 1;
+                   } else {
+                       NS_LOG_ERROR("Frame parsing failed: invalid FLAGS format: " << flagStr);
+                       return frame;
+                   }
+               } else {
+                   NS_LOG_ERROR("Frame parsing failed: missing FLAGS delimiter");
+                   return frame;
+               }
+           } else {
+               NS_LOG_ERROR("Frame parsing failed: missing FLAGS prefix");
+               return frame;
+           }
+          
            // Parse LEN
            if (pos < data.length() && data.substr(pos, 4) == "LEN:") {
                pos += 4;
@@ -143,6 +195,7 @@ struct HTTP2Frame {
            // Return empty frame to indicate parsing failure
            frame.streamId = 0;
            frame.type = HEADERS;
+           frame.flags = 0;
            frame.length = 0;
            frame.payload = "";
        }
@@ -152,6 +205,142 @@ struct HTTP2Frame {
 };
 
 
+// 基于 LEN 字段从接收缓冲中切出完整帧（客户端与服务器共用）
+// 头部格式：SID:...|TYPE:...|FLAGS:...|LEN:...|payload；不完整的尾部留在缓冲中等待下次读取
+// starts（可选）：每帧在调用前缓冲中的起点，跳过的坏字节不会打乱偏移
+static std::vector<std::string> ExtractFrames(std::string& buffer, std::vector<size_t>* starts = nullptr) {
+   static const char* const keys[] = {"TYPE:", "FLAGS:", "LEN:"};
+   std::vector<std::string> frames;
+   size_t pos = 0;
+   while (true) {
+       size_t frameStart = buffer.find("SID:", pos);
+       if (frameStart == std::string::npos) {
+           // 末尾可能是被 TCP 分段截断的 "S"/"SI"/"SID"，保留最后 3 字节
+           pos = std::max(pos, buffer.size() > 3 ? buffer.size() - 3 : size_t(0));
+           break;
+       }
+
+       // 依次定位 SID / TYPE / FLAGS / LEN 字段
+       size_t fieldEnd = buffer.find('|', frameStart + 4);
+       if (fieldEnd == std::string::npos) { pos = frameStart; break; } // 等待更多数据
+       size_t lenVal = 0;
+       bool malformed = false, incomplete = false;
+       for (const char* key : keys) {
+           size_t keyPos = fieldEnd + 1;
+           size_t keyLen = std::char_traits<char>::length(key);
+           if (keyPos + keyLen > buffer.size()) { incomplete = true; break; }
+           if (buffer.compare(keyPos, keyLen, key) != 0) { malformed = true; break; }
+           lenVal = keyPos + keyLen;
+           fieldEnd = buffer.find('|', lenVal);
+           if (fieldEnd == std::string::npos) { incomplete = true; break; }
+       }
+       if (incomplete) { pos = frameStart; break; }
+       if (malformed) { pos = frameStart + 1; continue; }
+
+       // 计算整帧结束位置
+       uint32_t payloadLen = 0;
+       try { payloadLen = static_cast<uint32_t>(std::stoul(buffer.substr(lenVal, fieldEnd - lenVal))); }
+       catch (...) { pos = frameStart + 1; continue; }
+       size_t frameEnd = fieldEnd + 1 + payloadLen;
+       if (buffer.size() < frameEnd) { pos = frameStart; break; } // 等待完整 payload
+
+       frames.push_back(buffer.substr(frameStart, frameEnd - frameStart));
+       if (starts) starts->push_back(frameStart);
+       pos = frameEnd;
+   }
+   // 只保留不完整的尾部（可能是不完整帧）
+   buffer.erase(0, pos);
+   return frames;
+}
+
+
+// Stream states (RFC 7540 §5.1); the reserved states used by server push are not modelled
+enum class H2StreamState { IDLE, OPEN, HALF_CLOSED_LOCAL, HALF_CLOSED_REMOTE, CLOSED };
+
+static const char* H2StreamStateName(H2StreamState st) {
+   switch (st) {
+       case H2StreamState::IDLE: return "idle";
+       case H2StreamState::OPEN: return "open";
+       case H2StreamState::HALF_CLOSED_LOCAL: return "half-closed(local)";
+       case H2StreamState::HALF_CLOSED_REMOTE: return "half-closed(remote)";
+       case H2StreamState::CLOSED: return "closed";
+   }
+   return "?";
+}
+
+// Transition on an END_STREAM flag sent (local=true) or received (local=false)
+static H2StreamState H2OnEndStream(H2StreamState st, bool local) {
+   switch (st) {
+       case H2StreamState::OPEN:
+           return local ? H2StreamState::HALF_CLOSED_LOCAL : H2StreamState::HALF_CLOSED_REMOTE;
+       case H2StreamState::HALF_CLOSED_LOCAL:
+           return local ? st : H2StreamState::CLOSED;
+       case H2StreamState::HALF_CLOSED_REMOTE:
+           return local ? H2StreamState::CLOSED : st;
+       default:
+           return st;
+   }
+}
+
+// Largest stream identifier (31 bits)
+static const uint32_t H2_MAX_STREAM_ID = 0x7fffffffu;
+
+// SETTINGS payload, serialized as "NAME=value;" pairs. Only the parameters the
+// sim acts on are carried; unknown names are ignored on receipt.
+struct H2Settings {
+   // SETTINGS_MAX_CONCURRENT_STREAMS; the initial value is unlimited
+   uint32_t maxConcurrentStreams = std::numeric_limits<uint32_t>::max();
+   // SETTINGS_HEADER_TABLE_SIZE: HPACK dynamic table the sender's decoder allows
+   uint32_t headerTableSize = 4096;
+
+   std::string Serialize() const {
+       std::ostringstream oss;
+       oss << "MAX_CONCURRENT_STREAMS=" << maxConcurrentStreams << ";"
+           << "HEADER_TABLE_SIZE=" << headerTableSize << ";";
+       return oss.str();
+   }
+
+   static H2Settings Parse(const std::string& payload) {
+       H2Settings settings;
+       std::istringstream iss(payload);
+       std::string item;
+       while (std::getline(iss, item, ';')) {
+           size_t eq = item.find('=');
+           if (eq == std::string::npos) continue;
+           std::string name = item.substr(0, eq);
+           try {
+               uint32_t value = static_cast<uint32_t>(std::stoul(item.substr(eq + 1)));
+               if (name == "MAX_CONCURRENT_STREAMS") settings.maxConcurrentStreams = value;
+               else if (name == "HEADER_TABLE_SIZE") settings.headerTableSize = value;
+           } catch (...) {
+               NS_LOG_WARN("Ignoring malformed SETTINGS parameter: " << item);
+           }
+       }
+       return settings;
+   }
+};
+
+// Builds a SETTINGS frame (always on stream 0); an ACK carries no payload
+static HTTP2Frame MakeSettingsFrame(const H2Settings& settings, bool ack) {
+   HTTP2Frame frame;
+   frame.streamId = 0;
+   frame.type = SETTINGS;
+   frame.flags = ack ? FLAG_ACK : 0;
+   frame.payload = ack ? std::string() : settings.Serialize();
+   frame.length = frame.payload.size();
+   return frame;
+}
+
+// Builds an RST_STREAM frame; the payload carries the error code
+static HTTP2Frame MakeRstStreamFrame(uint32_t streamId, uint32_t errorCode) {
+   HTTP2Frame frame;
+   frame.streamId = streamId;
+   frame.type = RST_STREAM;
+   frame.payload = std::to_string(errorCode);
+   frame.length = frame.payload.size();
+   return frame;
+}
+
 // Enhanced pending item with flow control and metrics
 struct PendingItem {
    uint32_t streamId;
@@ -160,10 +349,12 @@ struct PendingItem {
    uint32_t retryCount;        // 重试次数
    double lastRetryTime;       // 上次重试时间
    bool isPaused;              // 流是否暂停
+   double enqueueTime;         // 入队时间（SRPT aging 使用）
+   uint8_t urgency;            // RFC 9218 urgency，来自请求的 priority 头
   
-   PendingItem(uint32_t sid, uint32_t total) 
+   PendingItem(uint32_t sid, uint32_t total, double enq = 0.0, uint8_t u = 3) 
        : streamId(sid), remainingBytes(total), totalBytes(total), 
-         retryCount(0), lastRetryTime(0.0), isPaused(false) {}
+         retryCount(0), lastRetryTime(0.0), isPaused(false), enqueueTime(enq), urgency(u) {}
 };
 
 // Stream metrics for detailed performance tracking
@@ -183,6 +374,9 @@ struct StreamMetrics {
 
 // Global variables for metrics
 static std::vector<uint32_t> g_respSizes;
+static Workload g_workload;                 // --harFile：按 :path 查对象
+static RequestDistributions g_dists;        // --*Dist 抽样（头部大小、思考时间）
+static ArrivalSchedule g_arrivals;          // --arrivalRate / --arrivalTrace 开环到达
 static uint64_t g_retxCount = 0;
 
 
@@ -192,15 +386,21 @@ static void OnTcpRetransmission(Ptr<const Packet> p,
                                const Address& to,
                                Ptr<const ns3::TcpSocketBase> sock) {
  ++g_retxCount;
+ if (GlobalTracer().IsEnabled()) {
+     GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), sock->GetNode()->GetId(),
+                           TRACE_TCP_RETX, 0, p->GetSize(), h.GetSequenceNumber().GetValue());
+ }
 }
 
 
-//Data packet tracking function
-static void TxTrace(Ptr<const Packet> packet) {
- std::cout << "[Trace] Packet sent, size=" << packet->GetSize() << std::endl;
+//Data packet tracking function (bound to the node id per device)
+static void TxTrace(uint32_t node, Ptr<const Packet> packet) {
+ GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), node, TRACE_MAC_TX, 0, packet->GetSize());
+ SIM_LOG(SIM_LOG_TRACE, "[Trace] Packet sent, size=" << packet->GetSize());
 }
-static void RxTrace(Ptr<const Packet> packet) {
- std::cout << "[Trace] Packet received, size=" << packet->GetSize() << std::endl;
+static void RxTrace(uint32_t node, Ptr<const Packet> packet) {
+ GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), node, TRACE_MAC_RX, 0, packet->GetSize());
+ SIM_LOG(SIM_LOG_TRACE, "[Trace] Packet received, size=" << packet->GetSize());
 }
 
 
@@ -212,6 +412,18 @@ Ptr<Packet> SerializeFrame(const HTTP2Frame& frame) {
 }
 
 
+// Byte accounting of a frame handed to TCP: the frame prefix is framing,
+// the payload is header block or body; SETTINGS/WINDOW_UPDATE/RST_STREAM are control.
+static void CountFrameBytes(uint32_t node, const HTTP2Frame& frame, uint32_t wireSize) {
+   if (frame.type == SETTINGS || frame.type == WINDOW_UPDATE || frame.type == RST_STREAM) {
+       GlobalBytes().Add(node, BYTES_FRAMING, BYTES_CONTROL, wireSize);
+       return;
+   }
+   GlobalBytes().Add(node, BYTES_FRAMING, BYTES_DATA, wireSize - frame.payload.size());
+   GlobalBytes().Add(node, frame.type == DATA ? BYTES_BODY : BYTES_HEADERS, BYTES_DATA, frame.payload.size());
+}
+
+
 // Enhanced HTTP/2 Multiplexing Session with flow control
 class HTTP2Session : public Object {
 public:
@@ -221,6 +433,8 @@ public:
          m_connWindowBytes(32u * 1024u * 1024u),
          m_connWindowInit(32u * 1024u * 1024u) {
        // 初始化默认流窗口大小和连接级窗口
+       // 发送缓冲腾出空间时写出排队的帧
+       m_socket->SetSendCallback(MakeCallback(&HTTP2Session::OnSendReady, this));
    }
   
    void SendFrame(const HTTP2Frame& frame) {
@@ -232,10 +446,10 @@ public:
        // 仅 DATA 受流控约束；HEADERS 不扣减
        if (frame.type == DATA) {
            if (m_connWindowBytes < frame.length || m_streamWindows[frame.streamId] < frame.length) {
-               std::cout << "[FLOW_CONTROL_BLOCKED] sid=" << frame.streamId
-                         << " connWin=" << m_connWindowBytes
-                         << " streamWin=" << m_streamWindows[frame.streamId]
-                         << " need=" << frame.length << std::endl;
+               SIM_LOG(SIM_LOG_DEBUG, "[FLOW_CONTROL_BLOCKED] sid=" << frame.streamId
+                                      << " connWin=" << m_connWindowBytes
+                                      << " streamWin=" << m_streamWindows[frame.streamId]
+                                      << " need=" << frame.length);
                NS_LOG_WARN("Flow control: blocked sid=" << frame.streamId
                            << " connWin=" << m_connWindowBytes
                            << " streamWin=" << m_streamWindows[frame.streamId]
@@ -245,29 +459,39 @@ public:
            }
        }
        
-       std::cout << "[Session] Sending frame: sid=" << frame.streamId 
-                 << ", type=" << (int)frame.type << ", len=" << frame.length << std::endl;
-       
-       Ptr<Packet> p = SerializeFrame(frame);
-       std::cout << "[Session] Serialized packet size: " << p->GetSize() << " bytes" << std::endl;
-       
-       int sent = m_socket->Send(p);
+       SIM_LOG(SIM_LOG_DEBUG, "[Session] Sending frame: sid=" << frame.streamId 
+                              << ", type=" << (int)frame.type << ", len=" << frame.length);
        
-       if (sent > 0) {
-           if (frame.type == DATA) {
-               // 用应用层有效载荷长度扣减，而不是 TCP 实际写入的 bytes
-               m_connWindowBytes -= frame.length;
-               UpdateStreamWindow(frame.streamId, frame.length);
+       if (frame.type == DATA) {
+           // 用应用层有效载荷长度扣减，而不是 TCP 实际写入的 bytes
+           m_connWindowBytes -= frame.length;
+           UpdateStreamWindow(frame.streamId, frame.length);
+       }
+       m_streams[frame.streamId] = true; // Ensure stream exists
+       // 帧一经编码（HPACK 动态表已变）就不能丢：按序排队，发送缓冲不足时等 OnSendReady
+       m_txQueue.push_back(frame);
+       FlushTxQueue();
+   }
+   
+   // 按序写出排队的帧，直到发送缓冲放不下队首
+   void FlushTxQueue() {
+       while (!m_txQueue.empty()) {
+           const HTTP2Frame& frame = m_txQueue.front();
+           Ptr<Packet> p = SerializeFrame(frame);
+           if (m_socket->GetTxAvailable() < p->GetSize()) return;
+           int sent = m_socket->Send(p);
+           if (sent <= 0) {
+               NS_LOG_WARN("Frame send failed: sid=" << frame.streamId << ", error=" << sent << ", kept queued");
+               return;
            }
-           m_streams[frame.streamId] = true; // Ensure stream exists
+           CountFrameBytes(m_socket->GetNode()->GetId(), frame, p->GetSize());
            NS_LOG_INFO("Frame sent successfully: sid=" << frame.streamId 
                        << ", type=" << (int)frame.type << ", bytes=" << sent);
-       } else {
-           NS_LOG_WARN("Frame send failed: sid=" << frame.streamId << ", error=" << sent);
-           // 触发重传逻辑
-           HandleSendFailure(frame.streamId);
+           m_txQueue.pop_front();
        }
    }
+   
+   void OnSendReady(Ptr<Socket>, uint32_t) { FlushTxQueue(); }
   
    void OnReceive(Ptr<Socket> socket) {
        Ptr<Packet> packet;
@@ -339,20 +563,8 @@ public:
        }
    }
    
-   void HandleSendFailure(uint32_t streamId) {
-       // 指数退避重传策略
-       static std::map<uint32_t, uint32_t> retryCounts;
-       
-       double backoffTime = std::pow(2.0, static_cast<double>(retryCounts[streamId])) * 0.01; // 指数退避（秒）
-       retryCounts[streamId] = std::min(retryCounts[streamId] + 1, 5u); // 限制最大重试次数
-       
-       NS_LOG_INFO("Scheduling retransmission for stream " << streamId 
-                   << " in " << backoffTime << "s (attempt " << retryCounts[streamId] << ")");
-       
-       Simulator::Schedule(Seconds(backoffTime), &HTTP2Session::ResumeStream, this, streamId);
-   }
-  
    std::map<uint32_t, bool> m_streams;
+   std::deque<HTTP2Frame> m_txQueue; // 已编码、等发送缓冲的帧（按序）
    std::map<uint32_t, uint32_t> m_streamWindows; // 每个流的窗口大小
    Ptr<Socket> m_socket;
    uint32_t m_defaultWindowSize; // 默认流窗口大小
@@ -379,10 +591,33 @@ public:
        m_nStreams = nStreams;
    }
    
+   // HPACK: SETTINGS_HEADER_TABLE_SIZE advertised for responses, Huffman for requests
+   void SetHpack(uint32_t tableSize, bool huffman) {
+       m_hpackTableSize = tableSize;
+       m_hpackEncoder = HpackEncoder(huffman);
+       m_hpackDecoder = HpackDecoder(tableSize);
+   }
+   const HpackStats& GetHpackStats() const { return m_hpackEncoder.GetStats(); }
+   
+   // 按工作负载回放：第 i 个请求取对象 ids[i]，不早于其 startOffset 发出
+   void SetWorkload(Workload* workload, std::vector<uint32_t> ids) { m_workload.Assign(workload, ids); }
+   // 开环：请求在启动后 offsets 时刻到达，在至多 maxBacklog 个（0 = 不限）的积压中等空闲流
+   void SetArrivals(std::vector<double> offsets, uint32_t maxBacklog) { m_arrivals.Assign(offsets, maxBacklog); }
+   ArrivalStats GetArrivalStats() const { return m_arrivals.GetStats(); }
+   // 第 index 条连接（共 nConns 条）：第 k 个请求的全局请求号为 k * nConns + index
+   void SetConnection(uint32_t index, uint32_t nConns) { m_connIndex = index; m_nConns = nConns; }
+   
    uint32_t GetRespsRcvd() const { return m_respsRcvd; }
+   uint64_t GetDoneBytes() const { return m_doneBytes; }  // 已完成响应的响应体字节
    const std::vector<double>& GetReqSendTimes() const { return m_reqSendTimes; }
    const std::vector<double>& GetRespRecvTimes() const { return m_respRecvTimes; }
+   // Per-request response times (HEADERS sent -> last DATA byte), in completion order
+   const std::vector<double>& GetResponseTimes() const { return m_respTimes; }
+   const RequestTimeline& GetTimeline() const { return m_timeline; }
+   RxHolStats GetRxHolStats() const { return m_rxHol.GetStats(); }
    double GetInterval() const { return m_interval; }
+   // Invoked once when the last of m_nReqs responses has completed
+   void SetDoneCallback(Callback<void> cb) { m_doneCallback = cb; }
    
    // 新增: 窗口更新阈值和计数器 - 移到public部分
    uint64_t m_windowUpdateThreshold = 16384; // 16KB
@@ -399,9 +634,9 @@ public:
        frame.payload = oss.str();
        frame.length = frame.payload.size();
        
-       std::cout << "[CLIENT_WINDOW_UPDATE] t=" << Simulator::Now().GetSeconds() 
-                 << "s, replenishing " << bytesToAdd << " bytes for stream " 
-                 << streamId << std::endl;
+       SIM_LOG(SIM_LOG_DEBUG, "[CLIENT_WINDOW_UPDATE] t=" << Simulator::Now().GetSeconds() 
+                              << "s, replenishing " << bytesToAdd << " bytes for stream " 
+                              << streamId);
        
        m_session->SendFrame(frame);
    }
@@ -418,103 +653,29 @@ public:
        frame.payload = oss.str();
        frame.length = frame.payload.size();
        
-       std::cout << "[CLIENT_CONN_WINDOW_UPDATE] t=" << Simulator::Now().GetSeconds() 
-                 << "s, replenishing " << bytesToAdd << " bytes for connection" << std::endl;
+       SIM_LOG(SIM_LOG_DEBUG, "[CLIENT_CONN_WINDOW_UPDATE] t=" << Simulator::Now().GetSeconds() 
+                              << "s, replenishing " << bytesToAdd << " bytes for connection");
        
        m_session->SendFrame(frame);
    }
    
-   // ★ New: finalize any streams that reached target but were not marked completed (end-of-sim safety)
+   // End-of-sim safety: a stream whose body fully arrived but whose END_STREAM was never
+   // parsed is finalized here. With END_STREAM on the last DATA frame this should not trigger.
    void FinalizePendingCompletions() {
-       for (const auto &entry : m_streamTargetBytes) {
-           uint32_t streamId = entry.first;
-           uint32_t target = entry.second;
-           uint32_t bytes = 0;
-           if (m_streamBytes.count(streamId)) {
-               bytes = m_streamBytes[streamId];
-           }
-           if (!m_streamCompleted[streamId] && target > 0 && bytes >= target) {
-               m_streamCompleted[streamId] = true;
-               if (m_inflight.count(streamId)) {
-                   m_inflight[streamId] = false;
-               }
-                               ++m_respsRcvd;
-                m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
-                std::cout << "[Client] Finalized completion for stream " << streamId
-                          << " at end: " << bytes << "/" << target << std::endl;
-                if (m_reqsSent < m_nReqs) {
-                    Simulator::Schedule(Seconds(m_interval), &HTTP2ClientApp::SendNextRequest, this);
-                }
-           }
-       }
-   }
-   
-   // ★ New: periodic finalize checker for highly fragmented cases
-   void PeriodicFinalizeCheck() {
-       FinalizePendingCompletions();
-       // Grace finalize for highly fragmented tail: within one frameChunk and stalled >20ms
-       for (auto &kv : m_streamTargetBytes) {
-           uint32_t sid = kv.first;
-           uint32_t target = kv.second;
-           if (target == 0) continue;
-           if (m_streamCompleted[sid]) continue;
+       for (const auto &entry : m_streamState) {
+           uint32_t sid = entry.first;
+           if (entry.second != H2StreamState::HALF_CLOSED_LOCAL) continue;
+           uint32_t target = m_streamTargetBytes.count(sid) ? m_streamTargetBytes[sid] : 0;
            uint32_t bytes = m_streamBytes.count(sid) ? m_streamBytes[sid] : 0;
-           if (bytes >= target) continue;
-           // if close enough (within 400B) and stalled
-           double lastT = 0.0;
-           if (m_streamMetrics.count(sid)) lastT = m_streamMetrics[sid].lastByteTime;
-           double nowT = Simulator::Now().GetSeconds();
-                       if (bytes + 1200 >= target && lastT > 0.0 && (nowT - lastT) > 0.02) {
-                m_streamCompleted[sid] = true;
-                if (m_inflight.count(sid)) m_inflight[sid] = false;
-                ++m_respsRcvd;
-                m_respRecvTimes.push_back(nowT);
-                std::cout << "[Client] Grace-finalized stream " << sid
-                          << " at " << bytes << "/" << target << std::endl;
-                if (m_reqsSent < m_nReqs) {
-                    Simulator::Schedule(Seconds(m_interval), &HTTP2ClientApp::SendNextRequest, this);
-                }
+           if (target > 0 && bytes >= target) {
+               SIM_LOG(SIM_LOG_WARN, "[Client] Finalized stream " << sid << " without END_STREAM: "
+                                     << bytes << "/" << target);
+               CompleteStream(sid);
            }
        }
-                       // Extra fallback finalize: when all requests sent but some streams linger very close to target
-                if (m_reqsSent >= m_nReqs && m_respsRcvd < m_nReqs) {
-                    double nowT2 = Simulator::Now().GetSeconds();
-                    for (auto &kv2 : m_streamTargetBytes) {
-                        uint32_t sid2 = kv2.first;
-                        uint32_t target2 = kv2.second;
-                        if (target2 == 0) continue;
-                        if (m_streamCompleted[sid2]) continue;
-                        uint32_t bytes2 = m_streamBytes.count(sid2) ? m_streamBytes[sid2] : 0;
-                        double lastT2 = 0.0;
-                        if (m_streamMetrics.count(sid2)) lastT2 = m_streamMetrics[sid2].lastByteTime;
-                        if (bytes2 + 1200 >= target2 && lastT2 > 0.0 && (nowT2 - lastT2) > 0.05) {
-                            m_streamCompleted[sid2] = true;
-                            if (m_inflight.count(sid2)) m_inflight[sid2] = false;
-                            ++m_respsRcvd;
-                            m_respRecvTimes.push_back(nowT2);
-                            std::cout << "[Client] Fallback-finalized stream " << sid2
-                                      << " at " << bytes2 << "/" << target2 << std::endl;
-                        }
-                    }
-                    // ★ 新增：对未收到 HEADERS 的滞留流进行 HEADERS 重发
-                    for (uint32_t sid = 1; sid <= m_nStreams; ++sid) {
-                        if (m_inflight[sid] && (!m_streamTargetBytes.count(sid) || m_streamTargetBytes[sid] == 0)) {
-                            double last = m_sidReqSendTime.count(sid) ? m_sidReqSendTime[sid] : 0.0;
-                            if (last > 0.0 && (nowT2 - last) > 0.05) {
-                                uint32_t reqIdx = m_sidToReqIndex.count(sid) ? m_sidToReqIndex[sid] : m_reqsSent;
-                                SendHeadersForSid(sid, reqIdx);
-                                m_sidReqSendTime[sid] = nowT2;
-                                std::cout << "[Client] Resent HEADERS on stream " << sid
-                                          << " for req #" << reqIdx << std::endl;
-                            }
-                        }
-                    }
-                }
-                if (m_respsRcvd < m_nReqs && m_socket) {
-                    Simulator::Schedule(MilliSeconds(2), &HTTP2ClientApp::PeriodicFinalizeCheck, this);
-                }
    }
 
+
 private:
    virtual void StartApplication() override {
        m_socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
@@ -534,6 +695,8 @@ private:
        Ptr<TcpSocketBase> tcpSock = DynamicCast<TcpSocketBase>(m_socket);
        if (tcpSock) {
            tcpSock->TraceConnectWithoutContext("Retransmission", MakeCallback(&OnTcpRetransmission));
+           m_tcpProbes.Watch(tcpSock);
+           m_rxHol.Watch(tcpSock);
        }
        
        m_session = CreateObject<HTTP2Session>(m_socket);
@@ -547,236 +710,321 @@ private:
        
        m_reqsSent = 0;
        m_respsRcvd = 0;
+       m_doneBytes = 0;
        m_reqSendTimes.clear();
        m_respRecvTimes.clear();
+       m_respTimes.clear();
        m_buffer.clear();
        m_streamBytes.clear();
        m_streamTargetBytes.clear();
-       m_streamCompleted.clear(); // 追踪流完成状态
-      
-       // 初始化所有流的状态
-       for (uint32_t i = 1; i <= m_nStreams; ++i) {
-           m_streamBytes[i] = 0;
-           m_streamTargetBytes[i] = 0;
-           m_streamCompleted[i] = false;
-           m_inflight[i] = false;  // ★ 新增：标记流为空闲状态
-           // 初始化性能指标
-           m_streamMetrics[i] = StreamMetrics();
-       }
+       m_streamState.clear();
+       m_streamMetrics.clear();
+       m_sidToReqIndex.clear();
+       m_retryReqs.clear();
+       m_timeline.Clear();
+       m_workload.Start(Simulator::Now().GetSeconds());
+       m_workload.SetWaker([this] { Simulator::ScheduleNow(&HTTP2ClientApp::SendNextRequest, this); });
+       if (m_nReqs > 0 && !m_arrivals.Active()) m_timeline.MarkQueued(0, m_workload.QueueTime(0, Simulator::Now().GetSeconds()));
+       // 连接建立前到达的请求留在积压中，ConnectionSucceeded 再发
+       m_arrivals.Start([this] { if (m_connected) SendNextRequest(); });
+       // 客户端发起的流使用奇数且单调递增的 ID，不复用
+       m_nextStreamId = 1;
+       m_activeStreams = 0;
+       m_peerMaxConcurrent = std::numeric_limits<uint32_t>::max();
        
        // 不要立即发送请求，等待连接建立
        m_connected = false;
    }
    
    virtual void StopApplication() override {
+       Simulator::Cancel(m_deferredSend);
+       m_workload.ClearWaker();
+       m_arrivals.Stop();
        if (m_socket) m_socket->Close();
    }
    
    // 连接成功回调
    void ConnectionSucceeded(Ptr<Socket> socket) {
-       std::cout << "[Client] TCP connection established successfully" << std::endl;
+       SIM_LOG(SIM_LOG_INFO, "[Client] TCP connection established successfully");
        m_connected = true;
        
        // Record connection establishment time
        double connectionTime = (Simulator::Now() - m_connectionStartTime).GetMilliSeconds();
-       std::cout << "Connection time: " << connectionTime << " ms" << std::endl;
+       SIM_LOG(SIM_LOG_INFO, "Connection time: " << connectionTime << " ms");
+       
+       // 连接前言：先通告本端 SETTINGS
+       H2Settings local;
+       local.maxConcurrentStreams = m_nStreams;
+       local.headerTableSize = m_hpackTableSize;
+       m_session->SendFrame(MakeSettingsFrame(local, false));
        
-       // 周期性 finalize 检查，缓解小分片边界遗漏
-       Simulator::Schedule(MilliSeconds(2), &HTTP2ClientApp::PeriodicFinalizeCheck, this);
-       // 连接建立后开始发送请求
+       // 无需等待服务器 SETTINGS：在收到之前按本端上限并发（RFC 7540 §6.5.2 初始值不限）
        SendNextRequest();
    }
    
    // 连接失败回调
    void ConnectionFailed(Ptr<Socket> socket) {
-       std::cout << "[Client] TCP connection failed!" << std::endl;
+       SIM_LOG(SIM_LOG_ERROR, "[Client] TCP connection failed!");
        m_connected = false;
    }
    
-   // 选择空闲的流ID
-   uint32_t PickFreeSid() {
-       for (uint32_t sid = 1; sid <= m_nStreams; ++sid) {
-           if (!m_inflight[sid]) {
-               return sid;
-           }
+   // 可同时打开的流数：本端配置与对端 SETTINGS_MAX_CONCURRENT_STREAMS 取小
+   uint32_t ConcurrencyLimit() const {
+       return std::min(m_nStreams, m_peerMaxConcurrent);
+   }
+   
+   // 按请求索引（而不是完成顺序）计算响应时间，调度器打乱完成顺序时仍然正确
+   void RecordResponseTime(uint32_t streamId) {
+       auto it = m_sidToReqIndex.find(streamId);
+       if (it == m_sidToReqIndex.end() || it->second >= m_reqSendTimes.size()) return;
+       m_respTimes.push_back(Simulator::Now().GetSeconds() - m_reqSendTimes[it->second]);
+       GlobalHistograms().request.RecordSeconds(m_respTimes.back());
+       auto m = m_streamMetrics.find(streamId);
+       if (m != m_streamMetrics.end()) {
+           GlobalHistograms().stream.RecordSeconds(Simulator::Now().GetSeconds() - m->second.firstByteTime);
        }
-       return 0; // 没有空闲流
    }
    
    void SendNextRequest() {
        if (!m_connected) {
-           std::cout << "[Client] Connection not ready, skipping request" << std::endl;
+           SIM_LOG(SIM_LOG_WARN, "[Client] Connection not ready, skipping request");
            return;
        }
        
-       if (m_reqsSent < m_nReqs) {
-           // 使用空闲流发送请求，确保HTTP/2流状态管理正确
-           uint32_t reqsToSend = 0;
-           
-           for (uint32_t i = 0; i < m_nStreams && m_reqsSent < m_nReqs; ++i) {
-               uint32_t streamId = PickFreeSid();
-               if (streamId == 0) {
-                   // 没有空闲流，等待某个流完成后再发送
-                   std::cout << "[Client] No free streams available, waiting for completion" << std::endl;
-                   return; // 不要继续调度，等待流完成回调
+       std::vector<uint32_t> opened;
+       while ((m_reqsSent < m_nReqs || !m_retryReqs.empty()) && m_activeStreams < ConcurrencyLimit()) {
+           // 被服务器拒绝（REFUSED_STREAM）的请求优先在新流上重发，已经过了等待/到达检查
+           bool retry = !m_retryReqs.empty();
+           uint32_t reqIndex = retry ? m_retryReqs.front() : m_reqsSent;
+           if (!retry) {
+               // 回放时下一个对象还没到发出时间：到点再来；依赖未到齐（wait 为 inf）时由 waker 唤醒
+               double wait = m_workload.Wait(m_reqsSent, Simulator::Now().GetSeconds());
+               if (wait > 0) {
+                   if (std::isfinite(wait) && !m_deferredSend.IsPending()) {
+                       m_deferredSend = Simulator::Schedule(Seconds(wait), &HTTP2ClientApp::SendNextRequest, this);
+                   }
+                   break;
                }
-               
-               // ★ 关键修复：每次复用前复位该流状态
-               m_streamCompleted[streamId] = false;
-               m_streamBytes[streamId] = 0;
-               m_streamTargetBytes[streamId] = 0;
-               m_inflight[streamId] = true;  // 标记流为活跃状态
-              
+               // 开环：积压为空时等下一个到达
+               if (m_arrivals.Active() && m_arrivals.Empty()) break;
+           }
+           if (m_nextStreamId > H2_MAX_STREAM_ID) {
+               // 流 ID 耗尽；真实实现会新建连接，这里只记录
+               NS_LOG_WARN("Stream identifiers exhausted on this connection");
+               break;
+           }
+           uint32_t streamId = m_nextStreamId;
+           m_nextStreamId += 2;
+           if (retry) {
+               m_retryReqs.pop_front();
+           } else if (m_arrivals.Active()) {
+               m_timeline.MarkQueued(m_reqsSent, m_arrivals.Take(m_reqsSent));
+           }
+          
            HTTP2Frame frame;
-               frame.streamId = streamId;
+           frame.streamId = streamId;
            frame.type = HEADERS;
-              
-               std::ostringstream oss;
-               if (m_thirdParty) {
-                   // 模拟第三方资源
-                   const char* domains[] = {"firstparty.example", "cdn.example", "ads.example"};
-                   const char* host = domains[m_reqsSent % 3];
-                   oss << "GET /file" << m_reqsSent << " HTTP/2.0\r\nHost: " << host << "\r\n\r\n";
-               } else {
-                   oss << "GET /file" << m_reqsSent << " HTTP/2.0\r\nHost: server\r\n\r\n";
-               }
-              
-               frame.payload = oss.str();
-               frame.length = frame.payload.size();
-              
-               // 控制请求大小
-               uint32_t headerLen = static_cast<uint32_t>(frame.payload.size());
-               uint32_t desiredSize = std::max(m_reqSize, headerLen);
-               if (desiredSize > headerLen) {
-                   frame.payload += std::string(desiredSize - headerLen, ' ');
-                   frame.length = desiredSize;
-               }
-              
-               std::cout << "[Client] Sending request on stream " << streamId
-                         << ", request #" << m_reqsSent 
-                         << ", frame type=" << (int)frame.type << " (HEADERS=" << (int)HEADERS << ")" << std::endl;
-               
-               // 记录该流当前承载的请求索引与发送时间，用于必要时重发
-               m_sidToReqIndex[streamId] = m_reqsSent;
-               m_sidReqSendTime[streamId] = Simulator::Now().GetSeconds();
-               
-               if (m_session) {
-                   std::cout << "[Client] m_session is valid, calling SendFrame" << std::endl;
-                   m_session->SendFrame(frame);
-               } else {
-                   std::cout << "[Client] ERROR: m_session is null!" << std::endl;
-               }
+           frame.flags = FLAG_END_STREAM; // GET 没有请求体，HEADERS 即结束本端方向
+          
+           std::string host = "server";
+           uint32_t reqId = GlobalRequestId(m_connIndex, m_nConns, reqIndex);
+           std::string path = RequestIdPath(reqId);
+           uint32_t reqSize = g_dists.ReqHeaderBytes(reqId, m_reqSize);
+           uint8_t urgency = 3;
+           if (m_workload.Active()) {
+               const WorkloadObject& obj = m_workload.At(reqIndex);
+               host = obj.host;
+               path = obj.path;
+               if (obj.reqHeaderBytes > 0) reqSize = obj.reqHeaderBytes;
+               urgency = obj.urgency;
+           } else if (m_thirdParty) {
+               // 模拟第三方资源
+               const char* domains[] = {"firstparty.example", "cdn.example", "ads.example"};
+               host = domains[reqIndex % 3];
+           }
+          
+           // 请求头按 reqSize（未压缩的 HTTP/1.1 文本大小）构造，经 HPACK 编码后发送
+           HttpHeaderList headers = BrowserRequestHeaders(host, path, reqSize, urgency);
+           frame.payload = m_hpackEncoder.Encode(headers);
+           frame.length = frame.payload.size();
+          
+           // idle -> open -> half-closed(local)
+           m_streamState[streamId] = H2OnEndStream(H2StreamState::OPEN, true);
+           m_streamBytes[streamId] = 0;
+           m_streamTargetBytes[streamId] = 0;
+           m_sidToReqIndex[streamId] = reqIndex;
+           ++m_activeStreams;
+          
+           SIM_LOG(SIM_LOG_DEBUG, "[Client] Sending request on stream " << streamId
+                                  << ", request #" << reqIndex 
+                                  << ", frame type=" << (int)frame.type << " (HEADERS=" << (int)HEADERS << ")");
+           
+           if (m_session) {
+               m_session->SendFrame(frame);
+           } else {
+               SIM_LOG(SIM_LOG_ERROR, "[Client] ERROR: m_session is null!");
+           }
+           // 重发保留首次发出时间：被拒绝的那一轮往返计入响应时间
+           if (!retry) {
                m_reqSendTimes.push_back(Simulator::Now().GetSeconds());
                m_reqsSent++;
-               reqsToSend++; // 修复：增加计数
-              
-               // HTTP/2 HEADERS帧本身就包含了完整的请求信息，不需要额外的DATA帧
-               // 注释掉空的DATA帧发送，避免帧丢失问题
-               /*
-               HTTP2Frame dataFrame;
-               dataFrame.streamId = streamId;
-               dataFrame.type = DATA;
-               dataFrame.length = 0;
-               dataFrame.payload = "";
-               std::cout << "[Client] Sending DATA frame on stream " << streamId 
-                         << ", frame type=" << (int)dataFrame.type << " (DATA=" << (int)DATA << ")" << std::endl;
-               m_session->SendFrame(dataFrame);
-               */
            }
-          
-           std::cout << "[Client] Sent " << reqsToSend << " concurrent requests on streams: ";
-           for (uint32_t i = 1; i <= reqsToSend; ++i) {
-               std::cout << i << " ";
+           m_timeline.MarkSent(reqIndex, streamId, Simulator::Now().GetSeconds());
+           opened.push_back(streamId);
+       }
+       // 并发名额用完：下一个请求从此刻开始排队（开环时从到达时刻算）
+       if (m_reqsSent < m_nReqs && !m_arrivals.Active()) {
+           m_timeline.MarkQueued(m_reqsSent, m_workload.QueueTime(m_reqsSent, Simulator::Now().GetSeconds()));
+       }
+      
+       if (!opened.empty()) {
+           std::ostringstream sids;
+           for (uint32_t sid : opened) {
+               sids << sid << " ";
            }
-           std::cout << ", total sent: " << m_reqsSent << std::endl;
-           
-           // 不要在这里继续调度，等待流完成回调
+           SIM_LOG(SIM_LOG_DEBUG, "[Client] Sent " << opened.size() << " concurrent requests on streams: "
+                                  << sids.str() << ", total sent: " << m_reqsSent
+                                  << ", active: " << m_activeStreams << "/" << ConcurrencyLimit());
        }
+       // 其余请求等待流关闭后再发送
    }
    
-   // ★ 新增：在指定流上重发对应请求的 HEADERS（不增加 m_reqsSent）
-   void SendHeadersForSid(uint32_t streamId, uint32_t reqIndex) {
-       if (!m_connected || !m_session) return;
-       HTTP2Frame frame;
-       frame.streamId = streamId;
-       frame.type = HEADERS;
-       std::ostringstream oss;
-       if (m_thirdParty) {
-           const char* domains[] = {"firstparty.example", "cdn.example", "ads.example"};
-           const char* host = domains[reqIndex % 3];
-           oss << "GET /file" << reqIndex << " HTTP/2.0\r\nHost: " << host << "\r\n\r\n";
-       } else {
-           oss << "GET /file" << reqIndex << " HTTP/2.0\r\nHost: server\r\n\r\n";
+   // 流进入 closed：统计完成并释放一个并发名额
+   void CompleteStream(uint32_t streamId) {
+       m_streamState[streamId] = H2StreamState::CLOSED;
+       if (m_activeStreams > 0) --m_activeStreams;
+       if (m_session) m_session->CloseStream(streamId);
+       m_respsRcvd++;
+       m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
+       RecordResponseTime(streamId);
+       auto ri = m_sidToReqIndex.find(streamId);
+       if (ri != m_sidToReqIndex.end()) {
+           m_timeline.MarkDone(ri->second, Simulator::Now().GetSeconds());
+           m_workload.Complete(ri->second, Simulator::Now().GetSeconds());
+           m_arrivals.Complete(ri->second, Simulator::Now().GetSeconds());
        }
-       frame.payload = oss.str();
-       frame.length = frame.payload.size();
-       uint32_t headerLen = static_cast<uint32_t>(frame.payload.size());
-       uint32_t desiredSize = std::max(m_reqSize, headerLen);
-       if (desiredSize > headerLen) {
-           frame.payload += std::string(desiredSize - headerLen, ' ');
-           frame.length = desiredSize;
+       
+       uint32_t target = m_streamTargetBytes[streamId];
+       m_doneBytes += target;
+       GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), GetNode()->GetId(),
+                             TRACE_STREAM_DONE, streamId, m_streamBytes[streamId]);
+       if (m_streamBytes[streamId] != target) {
+           NS_LOG_WARN("Stream " << streamId << " closed with " << m_streamBytes[streamId]
+                       << " of " << target << " bytes");
+       }
+       
+       // 记录最终性能指标
+       auto mit = m_streamMetrics.find(streamId);
+       if (mit != m_streamMetrics.end() && mit->second.frameCount > 0) {
+           double completionTime = Simulator::Now().GetSeconds() - mit->second.firstByteTime;
+           SIM_LOG(SIM_LOG_DEBUG, "[Client] Stream " << streamId << " completed in " 
+                                  << std::fixed << std::setprecision(3) << completionTime << "s"
+                                  << ", frames=" << mit->second.frameCount
+                                  << ", avg delay=" << (mit->second.totalDelay / mit->second.frameCount) << "s");
+       }
+       
+       SIM_LOG(SIM_LOG_INFO, "[Client] Stream " << streamId << " completed, total responses: "
+                             << m_respsRcvd << " at " << Simulator::Now().GetSeconds() << "s");
+      
+       // 如果还有请求需要发送，继续发送
+       if (m_arrivals.Active() || !m_retryReqs.empty()) {
+           // 开环或有待重发的请求：空出的流立即交给它们，没有思考时间
+           Simulator::ScheduleNow(&HTTP2ClientApp::SendNextRequest, this);
+       } else if (m_reqsSent < m_nReqs) {
+           double think = g_dists.ThinkSeconds(GlobalRequestId(m_connIndex, m_nConns, m_respsRcvd - 1), m_interval);
+           Simulator::Schedule(Seconds(think), &HTTP2ClientApp::SendNextRequest, this);
+       }
+       // 积压满时被丢弃的到达不会有响应
+       if (m_respsRcvd == m_nReqs - m_arrivals.Dropped() && !m_doneCallback.IsNull()) {
+           m_doneCallback();
        }
-       m_session->SendFrame(frame);
    }
   
    void HandleRead(Ptr<Socket> s) {
+       SIM_PROFILE_SCOPE("HandleRead (client)");
        while (Ptr<Packet> packet = s->Recv()) {
            if (packet->GetSize() == 0) break;
            std::string data;
            data.resize(packet->GetSize());
            packet->CopyData((uint8_t*)&data[0], packet->GetSize());
            m_buffer += data;
+           m_rxBytes += data.size();
           
-           // 基于 LEN 字段的稳健帧解析
-           size_t pos = 0;
-           while (true) {
-               size_t frameStart = m_buffer.find("SID:", pos);
-               if (frameStart == std::string::npos) break;
-
-               // 解析头部：SID:...|TYPE:...|LEN:...|
-               size_t sidKey = frameStart;
-               size_t sidVal = sidKey + 4;
-               size_t sidEnd = m_buffer.find('|', sidVal);
-               if (sidEnd == std::string::npos) break; // 等待更多数据
-
-               size_t typeKey = sidEnd + 1;
-               if (typeKey + 5 > m_buffer.size() || m_buffer.compare(typeKey, 5, "TYPE:") != 0) { pos = frameStart + 1; continue; }
-               size_t typeVal = typeKey + 5;
-               size_t typeEnd = m_buffer.find('|', typeVal);
-               if (typeEnd == std::string::npos) break; // 等待更多数据
-
-               size_t lenKey = typeEnd + 1;
-               if (lenKey + 4 > m_buffer.size() || m_buffer.compare(lenKey, 4, "LEN:") != 0) { pos = frameStart + 1; continue; }
-               size_t lenVal = lenKey + 4;
-               size_t lenEnd = m_buffer.find('|', lenVal);
-               if (lenEnd == std::string::npos) break; // 等待更多数据
-
-               // 计算整帧结束位置
-               uint32_t payloadLen = 0;
-               try { payloadLen = static_cast<uint32_t>(std::stoul(m_buffer.substr(lenVal, lenEnd - lenVal))); }
-               catch (...) { pos = frameStart + 1; continue; }
-               size_t headerEnd = lenEnd + 1;
-               size_t frameEnd = headerEnd + payloadLen;
-               if (m_buffer.size() < frameEnd) break; // 等待完整 payload
-
-               // 提取并处理帧
-               std::string frameData = m_buffer.substr(frameStart, frameEnd - frameStart);
-               ProcessFrame(frameData);
-
-               pos = frameEnd;
-               if (pos >= m_buffer.size()) break;
-           }
-          
-           // 只保留不完整的尾部（可能是不完整帧）
-           if (pos > 0) {
-               m_buffer.erase(0, pos);
+           // 基于 LEN 字段的稳健帧解析；offset = 帧在 TCP 接收字节流中的起点（用于 HoL 归属）
+           uint64_t bufStart = m_rxBytes - m_buffer.size();
+           std::vector<size_t> starts;
+           std::vector<std::string> frames = ExtractFrames(m_buffer, &starts);
+           for (size_t i = 0; i < frames.size(); ++i) {
+               ProcessFrame(frames[i], bufStart + starts[i]);
            }
        }
    }
+   
+   void ProcessSettings(const HTTP2Frame& frame) {
+       if (frame.HasFlag(FLAG_ACK)) {
+           SIM_LOG(SIM_LOG_INFO, "[Client] SETTINGS acknowledged by server");
+           return;
+       }
+       H2Settings peer = H2Settings::Parse(frame.payload);
+       m_peerMaxConcurrent = peer.maxConcurrentStreams;
+       if (peer.headerTableSize != m_hpackEncoder.GetTable().MaxSize()) m_hpackEncoder.SetMaxTableSize(peer.headerTableSize);
+       SIM_LOG(SIM_LOG_INFO, "[Client] Server SETTINGS: MAX_CONCURRENT_STREAMS=" << m_peerMaxConcurrent
+                             << ", effective limit " << ConcurrencyLimit());
+       m_session->SendFrame(MakeSettingsFrame(H2Settings(), true));
+       // 上限可能变大，尝试补发
+       SendNextRequest();
+   }
+  
+   // 服务器拒绝的流没有被处理（RFC 7540 §8.1.4），释放名额后在新流上重发同一请求
+   void ProcessRstStream(const HTTP2Frame& frame) {
+       auto st = m_streamState.find(frame.streamId);
+       if (st == m_streamState.end() || st->second == H2StreamState::CLOSED) return;
+       st->second = H2StreamState::CLOSED;
+       if (m_activeStreams > 0) --m_activeStreams;
+       if (m_session) m_session->CloseStream(frame.streamId);
+       uint32_t errorCode = 0;
+       try {
+           errorCode = static_cast<uint32_t>(std::stoul(frame.payload));
+       } catch (const std::exception&) {
+       }
+       auto ri = m_sidToReqIndex.find(frame.streamId);
+       if (errorCode != H2_REFUSED_STREAM || ri == m_sidToReqIndex.end()) {
+           NS_LOG_WARN("Stream " << frame.streamId << " reset by server, error code " << errorCode);
+           return;
+       }
+       SIM_LOG(SIM_LOG_INFO, "[Client] Stream " << frame.streamId << " refused by server, retrying request #"
+                             << ri->second);
+       m_retryReqs.push_back(ri->second);
+       Simulator::ScheduleNow(&HTTP2ClientApp::SendNextRequest, this);
+   }
   
-   void ProcessFrame(const std::string& frameData) {
+   void ProcessFrame(const std::string& frameData, uint64_t offset) {
        try {
            HTTP2Frame frame = HTTP2Frame::Parse(frameData);
+
+           // 该帧在 TCP 乱序缓冲中等待缺失报文段的字节，记到所属请求
+           HolShare hol = m_rxHol.Consume(offset, offset + frameData.size());
+           auto holReq = m_sidToReqIndex.find(frame.streamId);
+           if (hol.bytes > 0 && holReq != m_sidToReqIndex.end()) {
+               m_timeline.AddHol(holReq->second, hol.bytes, hol.seconds);
+           }
+           
+           if (frame.type == SETTINGS && frame.streamId == 0) {
+               ProcessSettings(frame);
+               return;
+           }
+           
+           if (frame.type == RST_STREAM) {
+               ProcessRstStream(frame);
+               return;
+           }
+           
+           // 每个头部块都要解码（即使流随后被忽略），以保持 HPACK 动态表同步
+           HttpHeaderList respHeaders;
+           if (frame.type == HEADERS && !m_hpackDecoder.Decode(frame.payload, respHeaders)) {
+               NS_LOG_WARN("HPACK decoding failed on stream " << frame.streamId << " (COMPRESSION_ERROR)");
+               return;
+           }
            
            // 只接受 HEADERS(0) / DATA(1)；其余直接丢弃
            if (frame.streamId == 0 || (frame.type != HEADERS && frame.type != DATA)) {
@@ -784,15 +1032,22 @@ private:
                return;
            }
            
-           std::cout << "[Client] Processing frame for sid=" << frame.streamId
-                     << " type=" << (int)frame.type << std::endl;
+           // 只有 half-closed(local) 的流还能接收响应帧
+           auto st = m_streamState.find(frame.streamId);
+           if (st == m_streamState.end() || st->second != H2StreamState::HALF_CLOSED_LOCAL) {
+               NS_LOG_WARN("Frame on stream " << frame.streamId << " in state "
+                           << (st == m_streamState.end() ? "idle" : H2StreamStateName(st->second))
+                           << " ignored");
+               return;
+           }
+           
+           SIM_LOG(SIM_LOG_DEBUG, "[Client] Processing frame for sid=" << frame.streamId
+                                  << " type=" << (int)frame.type);
           
            if (frame.type == HEADERS) {
-               // 解析Content-Length
-               size_t pos = frame.payload.find("Content-Length: ");
-               if (pos != std::string::npos) {
-                   size_t end = frame.payload.find("\r\n", pos);
-                   std::string lenStr = frame.payload.substr(pos + 16, end - (pos + 16));
+               // 解析 content-length
+               std::string lenStr = FindHeader(respHeaders, "content-length");
+               if (!lenStr.empty()) {
                    m_streamTargetBytes[frame.streamId] = std::stoi(lenStr);
                    m_streamBytes[frame.streamId] = 0;
                    
@@ -800,18 +1055,22 @@ private:
                    m_streamMetrics[frame.streamId] = StreamMetrics();
                    m_streamMetrics[frame.streamId].totalBytes = m_streamTargetBytes[frame.streamId];
                    m_streamMetrics[frame.streamId].firstByteTime = Simulator::Now().GetSeconds();
+                   auto ri = m_sidToReqIndex.find(frame.streamId);
+                   if (ri != m_sidToReqIndex.end() && ri->second < m_reqSendTimes.size()) {
+                       GlobalHistograms().ttfb.RecordSeconds(Simulator::Now().GetSeconds() - m_reqSendTimes[ri->second]);
+                       m_timeline.MarkHeaders(ri->second, m_streamTargetBytes[frame.streamId], Simulator::Now().GetSeconds());
+                   }
                   
-                   std::cout << "[Client] Received HEADERS for stream " << frame.streamId
-                             << ", expecting " << m_streamTargetBytes[frame.streamId] << " bytes" << std::endl;
+                   SIM_LOG(SIM_LOG_DEBUG, "[Client] Received HEADERS for stream " << frame.streamId
+                                          << ", expecting " << m_streamTargetBytes[frame.streamId] << " bytes");
                }
            } else if (frame.type == DATA) {
-               // 确保流已初始化
-               if (m_streamBytes.find(frame.streamId) == m_streamBytes.end()) {
-                   m_streamBytes[frame.streamId] = 0;
-               }
-              
                // 累计此流的字节
                m_streamBytes[frame.streamId] += frame.payload.size();
+               auto ri = m_sidToReqIndex.find(frame.streamId);
+               if (ri != m_sidToReqIndex.end() && !frame.payload.empty()) {
+                   m_timeline.MarkFirstData(ri->second, Simulator::Now().GetSeconds());
+               }
                
                // 更新性能指标
                if (m_streamMetrics.find(frame.streamId) != m_streamMetrics.end()) {
@@ -823,20 +1082,21 @@ private:
                    m_streamMetrics[frame.streamId].totalDelay = currentDelay;
                }
               
-               std::cout << "[Client] Received DATA for stream " << frame.streamId
-                         << ", " << m_streamBytes[frame.streamId] << "/"
-                         << (m_streamTargetBytes.count(frame.streamId) ?
-                             m_streamTargetBytes[frame.streamId] : 0) << " bytes" << std::endl;
+               SIM_LOG(SIM_LOG_DEBUG, "[Client] Received DATA for stream " << frame.streamId
+                                      << ", " << m_streamBytes[frame.streamId] << "/"
+                                      << m_streamTargetBytes[frame.streamId] << " bytes");
                
-               // 新增: 累计处理的字节数并触发窗口更新
-               m_streamBytesProcessed[frame.streamId] += frame.payload.size();
+               // 新增: 累计处理的字节数并触发窗口更新（流即将关闭时无需流级更新）
                m_connBytesProcessed += frame.payload.size();
-               
-               // 检查是否需要发送流级窗口更新
-               if (m_streamBytesProcessed[frame.streamId] >= m_windowUpdateThreshold) {
-                   uint32_t bytesToAdd = m_streamBytesProcessed[frame.streamId];
-                   m_streamBytesProcessed[frame.streamId] = 0;
-                   SendWindowUpdate(frame.streamId, bytesToAdd);
+               if (!frame.HasFlag(FLAG_END_STREAM)) {
+                   m_streamBytesProcessed[frame.streamId] += frame.payload.size();
+                   if (m_streamBytesProcessed[frame.streamId] >= m_windowUpdateThreshold) {
+                       uint32_t bytesToAdd = m_streamBytesProcessed[frame.streamId];
+                       m_streamBytesProcessed[frame.streamId] = 0;
+                       SendWindowUpdate(frame.streamId, bytesToAdd);
+                   }
+               } else {
+                   m_streamBytesProcessed.erase(frame.streamId);
                }
                
                // 检查是否需要发送连接级窗口更新
@@ -845,35 +1105,11 @@ private:
                    m_connBytesProcessed = 0;
                    SendConnectionWindowUpdate(bytesToAdd);
                }
-              
-               // 检查流是否完成
-               if (m_streamTargetBytes.find(frame.streamId) != m_streamTargetBytes.end() &&
-                   m_streamBytes[frame.streamId] >= m_streamTargetBytes[frame.streamId] &&
-                   !m_streamCompleted[frame.streamId]) {  // 确保每个流只完成一次
-                  
-                   m_streamCompleted[frame.streamId] = true;
-                   m_inflight[frame.streamId] = false;  // ★ 释放流，标记为空闲状态
-                   m_respsRcvd++;
-                   m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
-                   
-                   // 记录最终性能指标
-                   if (m_streamMetrics.find(frame.streamId) != m_streamMetrics.end()) {
-                       double completionTime = Simulator::Now().GetSeconds() - m_streamMetrics[frame.streamId].firstByteTime;
-                       std::cout << "[Client] Stream " << frame.streamId << " completed in " 
-                                 << std::fixed << std::setprecision(3) << completionTime << "s"
-                                 << ", frames=" << m_streamMetrics[frame.streamId].frameCount
-                                 << ", avg delay=" << (m_streamMetrics[frame.streamId].totalDelay / m_streamMetrics[frame.streamId].frameCount) << "s"
-                                 << std::endl;
-                   }
-                   
-                   std::cout << "[Client] Stream " << frame.streamId << " completed, total responses: "
-                             << m_respsRcvd << " at " << Simulator::Now().GetSeconds() << "s" << std::endl;
-                  
-                   // 如果还有请求需要发送，继续发送
-                   if (m_reqsSent < m_nReqs) {
-                       Simulator::Schedule(Seconds(m_interval), &HTTP2ClientApp::SendNextRequest, this);
-                   }
-               }
+           }
+           
+           // END_STREAM: half-closed(local) -> closed，响应完整
+           if (frame.HasFlag(FLAG_END_STREAM)) {
+               CompleteStream(frame.streamId);
            }
        } catch (const std::exception& e) {
            NS_LOG_WARN("Failed to parse frame: " << e.what());
@@ -885,24 +1121,40 @@ private:
    uint16_t m_port;
    uint32_t m_reqSize;
    uint32_t m_nReqs;
+   uint32_t m_hpackTableSize = 4096;
+   HpackEncoder m_hpackEncoder; // 请求头
+   HpackDecoder m_hpackDecoder; // 响应头
    uint32_t m_reqsSent = 0;
    uint32_t m_respsRcvd = 0;
+   uint64_t m_doneBytes = 0;  // 已完成流的 Content-Length 之和
    bool m_waitingResp = false;
    std::vector<double> m_reqSendTimes;
    std::vector<double> m_respRecvTimes;
+   std::vector<double> m_respTimes; // Per-request response times
    std::string m_buffer;
    double m_interval = 0.01;  // Default interval 0.01 seconds
    bool m_thirdParty = false;
+   WorkloadQueue m_workload;  // --harFile / --pageFile / --pageGraph 回放
+   EventId m_deferredSend;    // 等下一个对象到期
+   ArrivalQueue m_arrivals;   // 开环积压（--arrivalRate / --arrivalTrace）
+   uint32_t m_connIndex = 0;  // 本连接序号 / 连接数（全局请求号）
+   uint32_t m_nConns = 1;
    uint32_t m_nStreams = 3;  // HTTP/2: Number of concurrent streams
    Ptr<HTTP2Session> m_session;
   
    // Stream tracking for multiplexing
    std::map<uint32_t, uint32_t> m_streamBytes;      // Bytes received per stream
    std::map<uint32_t, uint32_t> m_streamTargetBytes; // Target bytes per stream
-   std::map<uint32_t, bool> m_streamCompleted;      // Track which streams are completed
-   // ★ 新增：每个流当前承载的请求索引与其 HEADERS 最近一次发送时间
-   std::map<uint32_t, uint32_t> m_sidToReqIndex;
-   std::map<uint32_t, double> m_sidReqSendTime;
+   std::map<uint32_t, H2StreamState> m_streamState; // Per-stream lifecycle state
+   std::map<uint32_t, uint32_t> m_sidToReqIndex;    // Request index carried by each stream
+   RequestTimeline m_timeline;                      // 逐请求时间线（--waterfallFile）
+   TcpProbeSet m_tcpProbes;                         // 本连接的 TCP 拥塞状态
+   TcpRxHolTracker m_rxHol;                         // TCP 乱序接收缓冲（传输层 HoL）
+   uint64_t m_rxBytes = 0;                          // 已从 socket 读出的字节数
+   uint32_t m_nextStreamId = 1;     // Next client-initiated (odd) stream ID
+   uint32_t m_activeStreams = 0;    // Streams not yet closed
+   uint32_t m_peerMaxConcurrent = std::numeric_limits<uint32_t>::max(); // From server SETTINGS
+   std::deque<uint32_t> m_retryReqs; // Request indices refused by the server, to be re-sent
    
    // Enhanced stream metrics tracking
    std::map<uint32_t, StreamMetrics> m_streamMetrics; // Detailed performance metrics per stream
@@ -910,15 +1162,13 @@ private:
    // Connection state
    bool m_connected = false; // TCP connection status
    
-   // Stream state management for HTTP/2 compliance
-   std::map<uint32_t, bool> m_inflight; // Track which streams are currently active
-   
    // 新增: 窗口更新阈值和计数器
    std::map<uint32_t, uint64_t> m_streamBytesProcessed; // 每个流已处理但未发送更新的字节数
    uint64_t m_connBytesProcessed = 0; // 连接级已处理但未发送更新的字节数
    
    // Connection time tracking
    Time m_connectionStartTime; // Added to track connection establishment time
+   Callback<void> m_doneCallback; // Completion coordinator notification
 };
 
 
@@ -929,7 +1179,7 @@ public:
    virtual ~HTTP2ServerApp() { m_socket = 0; }
   
    void Setup(uint16_t port, uint32_t respSize, uint32_t maxReqs, uint32_t nStreams,
-              uint32_t frameChunk, uint32_t tickUs, uint32_t headerSize, double hpackRatio,
+              uint32_t frameChunk, uint32_t tickUs, uint32_t headerSize,
               uint32_t connWindowMB = 32, uint32_t streamWindowMB = 32) {
        m_port = port;
        m_respSize = respSize;
@@ -938,13 +1188,44 @@ public:
        m_frameChunk = frameChunk;
        m_tickUs = tickUs;
        m_headerSize = headerSize;
-       m_hpackRatio = hpackRatio;
        m_connWindowInit = (uint64_t)connWindowMB * 1024u * 1024u;
-       m_connWindowBytes = m_connWindowInit;
        m_streamWindowInit = (uint64_t)streamWindowMB * 1024u * 1024u;
    }
+   
+   // 选择 DATA 交错发送的调度策略（默认 RR）
+   void SetScheduler(const StreamScheduler& scheduler) { m_scheduler = scheduler; }
+   
+   // HPACK: SETTINGS_HEADER_TABLE_SIZE advertised for requests, Huffman for responses
+   void SetHpack(uint32_t tableSize, bool huffman) {
+       m_hpackTableSize = tableSize;
+       m_hpackHuffman = huffman;
+   }
+   // 响应头编码统计（所有连接求和）
+   HpackStats GetHpackStats() const {
+       HpackStats stats;
+       for (const auto& kv : m_conns) stats.Add(kv.second.encoder.GetStats());
+       return stats;
+   }
   
 private:
+   // 每个连接独立的状态：流 ID 只在连接内唯一
+   struct Connection {
+       std::string buffer;                            // 接收缓冲（按帧解析）
+       std::deque<PendingItem> pendingQueue;          // 待发送的响应
+       std::deque<HTTP2Frame> ctrlQueue;              // 已编码的 HEADERS/SETTINGS 等，先于 DATA 写出
+       std::map<uint32_t, H2StreamState> streamState; // 每个流的生命周期状态
+       std::map<uint32_t, uint64_t> streamSendWindow; // 每个流的当前发送窗口大小
+       uint64_t connWindowBytes = 0;                  // 连接级发送窗口
+       uint32_t lastPeerStreamId = 0;                 // 对端已使用的最大流 ID
+       uint32_t activeStreams = 0;                    // 未关闭的流数
+       uint32_t reqsHandled = 0;                      // 本连接已处理的请求数
+       bool tickPending = false;                      // 已安排下一次节奏 tick
+       bool waitingForBuffer = false;                 // 等待 TCP 发送缓冲腾出空间
+       double stallStart = -1.0;                      // 当前 HoL 停滞开始时间
+       HpackEncoder encoder;                          // 响应头
+       HpackDecoder decoder;                          // 请求头
+   };
+
    virtual void StartApplication() override {
        m_socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
        InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), m_port);
@@ -959,291 +1240,396 @@ private:
    }
   
    void HandleAccept(Ptr<Socket> s, const Address &from) {
-       std::cout << "[Server] New client connection accepted from " << from << std::endl;
+       SIM_LOG(SIM_LOG_INFO, "[Server] New client connection accepted from " << from);
        s->SetRecvCallback(MakeCallback(&HTTP2ServerApp::HandleRead, this));
-       m_clientSocket = s;
-       m_reqsHandled = 0;
-       m_pendingQueue.clear(); // 清空队列
-       m_sending = false;      // 重置发送状态
+       // 发送缓冲腾出空间时由 TCP 回调恢复写出，而不是定时重试
+       s->SetSendCallback(MakeCallback(&HTTP2ServerApp::HandleSend, this));
+       Connection& conn = m_conns[s];
+       conn = Connection();
+       conn.connWindowBytes = m_connWindowInit;
+       conn.encoder = HpackEncoder(m_hpackHuffman);
+       conn.decoder = HpackDecoder(m_hpackTableSize);
       
        Ptr<TcpSocketBase> tcpSock = DynamicCast<TcpSocketBase>(s);
        if (tcpSock) {
            tcpSock->TraceConnectWithoutContext("Retransmission", MakeCallback(&OnTcpRetransmission));
+           m_tcpProbes.Watch(tcpSock);
        }
+       
+       // 连接前言：通告 SETTINGS_MAX_CONCURRENT_STREAMS
+       H2Settings local;
+       local.maxConcurrentStreams = m_nStreams;
+       local.headerTableSize = m_hpackTableSize;
+       QueueControl(s, conn, MakeSettingsFrame(local, false));
    }
   
    void HandleRead(Ptr<Socket> s) {
+       SIM_PROFILE_SCOPE("HandleRead (server)");
+       Connection& conn = m_conns[s];
        Ptr<Packet> packet;
-       std::cout << "[Server] HandleRead called, checking for data..." << std::endl;
-       
        // 1) 把 socket 里能读到的都读出来
        while ((packet = s->Recv())) {
            if (packet->GetSize() == 0) break;
            
-           std::cout << "[Server] Received packet of size " << packet->GetSize() << " bytes" << std::endl;
+           SIM_LOG(SIM_LOG_DEBUG, "[Server] Received packet of size " << packet->GetSize() << " bytes");
 
            // 2) 追加到缓冲区
            std::string chunk;
            chunk.resize(packet->GetSize());
            packet->CopyData(reinterpret_cast<uint8_t*>(&chunk[0]), packet->GetSize());
-           m_buffer += chunk;
-
-           // 3) 在缓冲里"按帧"解析（以下一个 "SID:" 作为帧边界）
-           size_t pos = 0;
-           std::cout << "[Server] Parsing buffer: '" << m_buffer << "' (size=" << m_buffer.size() << ")" << std::endl;
-           
-           while (true) {
-               size_t frameStart = m_buffer.find("SID:", pos);
-               if (frameStart == std::string::npos) {
-                   std::cout << "[Server] No frame start found in buffer" << std::endl;
-                   break;
-               }
-               std::cout << "[Server] Found frame start at position " << frameStart << std::endl;
-               
-               size_t nextStart = m_buffer.find("SID:", frameStart + 4);
-               size_t frameEnd;
-               
-               // 找不到下一个 SID:，那当前帧的"终点"就是缓冲区末尾 => 仍然处理当前帧
-               //（因为我们的数据负载里不会出现 "SID:"，所以这就是一个完整帧）
-               if (nextStart == std::string::npos) {
-                   frameEnd = m_buffer.size();
-               } else {
-                   frameEnd = nextStart;
-               }
+           conn.buffer += chunk;
 
-               std::string frameData = m_buffer.substr(frameStart, frameEnd - frameStart);
-               std::cout << "[Server] Extracted frame data: '" << frameData << "'" << std::endl;
-               
+           // 3) 基于 LEN 字段按帧解析，不完整的尾部留在缓冲中
+           for (const std::string& frameData : ExtractFrames(conn.buffer)) {
                HTTP2Frame frame = HTTP2Frame::Parse(frameData);
-               std::cout << "[Server] Parsed frame: sid=" << frame.streamId << ", type=" << (int)frame.type << ", len=" << frame.length << std::endl;
-
-               // 新增: 处理WINDOW_UPDATE帧
-               if (frame.type == WINDOW_UPDATE) {
-                   uint32_t bytesToAdd = 0;
-                   try {
-                       bytesToAdd = std::stoul(frame.payload);
-                   } catch (const std::exception& e) {
-                       std::cout << "[Server] Failed to parse WINDOW_UPDATE payload: " << e.what() << std::endl;
-                       bytesToAdd = 16384; // 默认值
-                   }
-                   
-                   if (frame.streamId == 0) {
-                       // 连接级窗口更新
-                       m_connWindowBytes = std::min(m_connWindowBytes + bytesToAdd, m_connWindowInit);
-                       std::cout << "[SERVER_WINDOW_REPLENISHED] t=" << Simulator::Now().GetSeconds() 
-                                 << "s, connWin is now " << m_connWindowBytes << " bytes." << std::endl;
-                   } else {
-                       // 流级窗口更新
-                       if (m_streamSendWindow.find(frame.streamId) != m_streamSendWindow.end()) {
-                           m_streamSendWindow[frame.streamId] = std::min(
-                               m_streamSendWindow[frame.streamId] + bytesToAdd, 
-                               m_streamWindowInit
-                           );
-                           std::cout << "[SERVER_STREAM_WINDOW_REPLENISHED] t=" << Simulator::Now().GetSeconds() 
-                                     << "s, stream " << frame.streamId << " window is now " 
-                                     << m_streamSendWindow[frame.streamId] << " bytes." << std::endl;
-                       }
-                   }
-                   
-                   // 如果之前因为流控阻塞而停止发送，现在恢复发送
-                   if (!m_sending && !m_pendingQueue.empty()) {
-                       m_sending = true;
-                       Simulator::Schedule(MicroSeconds(m_tickUs),
-                                          &HTTP2ServerApp::SendTick, this, s);
-                   }
-               }
-               else if (frame.type == HEADERS) {
-                   std::cout << "[Server] Processing HEADERS frame for stream " << frame.streamId << std::endl;
-                   if (m_reqsHandled < m_maxReqs) {
-                       m_reqsHandled++;
-                       std::cout << "[Server] Received request on stream " << frame.streamId
-                                 << ", req #" << m_reqsHandled << std::endl;
-
-
-                       // 解析/决定响应大小
-                       uint32_t respSize = m_respSize;
-                       if (!g_respSizes.empty()) {
-                           uint32_t idx = std::min<uint32_t>(m_reqsHandled - 1, g_respSizes.size() - 1);
-                           respSize = g_respSizes[idx];
-                       }
-
-
-                       // 先发 HEADERS (应用HPACK压缩效果)
-                       HTTP2Frame headerFrame;
-                       headerFrame.streamId = frame.streamId;
-                       headerFrame.type = HEADERS;
-                      
-                       // 计算HPACK压缩后的头部大小
-                       uint32_t actualHeaderSize = std::max(20u, static_cast<uint32_t>(m_headerSize * m_hpackRatio));
-                      
-                       std::ostringstream oss;
-                       oss << "HTTP/2.0 200 OK\r\nContent-Length: " << respSize << "\r\n\r\n";
-                       std::string baseHeaders = oss.str();
-                      
-                       // 避免截断基础头部（否则可能丢失Content-Length）
-                       if (actualHeaderSize < baseHeaders.size()) {
-                           headerFrame.payload = baseHeaders;  // 保持完整头部
-                       } else {
-                           headerFrame.payload = baseHeaders + std::string(actualHeaderSize - baseHeaders.size(), ' ');
-                       }
-                      
-                       headerFrame.length = headerFrame.payload.size();
-                      
-                       // 记录HPACK压缩效果
-                       std::cout << "[Server] HPACK: original=" << m_headerSize << "B, compressed="
-                                 << actualHeaderSize << "B, ratio=" << std::fixed << std::setprecision(2)
-                                 << (double)actualHeaderSize / m_headerSize << std::endl;
-                      
-                       s->Send(SerializeFrame(headerFrame));
-
-
-                       // 把"整个响应大小"入队，后续 tick 交错发送
-                       std::cout << "[Server] Enqueuing stream " << frame.streamId
-                                 << " with size " << respSize << " bytes" << std::endl;
-                       m_pendingQueue.emplace_back(frame.streamId, respSize);
-                       m_streamSendWindow[frame.streamId] = m_streamWindowInit;
-
-
-                       if (!m_sending) {
-                           m_sending = true;
-                           Simulator::Schedule(MicroSeconds(m_tickUs),
-                                              &HTTP2ServerApp::SendTick, this, s);
-                       }
-                   }
+               SIM_LOG(SIM_LOG_DEBUG, "[Server] Parsed frame: sid=" << frame.streamId << ", type=" << (int)frame.type
+                                      << ", flags=" << (int)frame.flags << ", len=" << frame.length);
+
+               if (frame.type == SETTINGS) {
+                   HandleSettings(s, conn, frame);
+               } else if (frame.type == WINDOW_UPDATE) {
+                   HandleWindowUpdate(s, conn, frame);
+               } else if (frame.type == HEADERS) {
+                   HandleHeaders(s, conn, frame);
                } else if (frame.type == DATA) {
-                   // 按需处理 DATA（大多数请求体为空可忽略）
+                   // 请求体为空，客户端不会发送 DATA
                } else {
                    // 其他类型（PUSH_PROMISE 等）按需扩展
                }
-
-               pos = frameEnd;
            }
-
-           // 4) 只保留未处理完的尾部（可能是不完整帧）
-           if (pos < m_buffer.size()) {
-               m_buffer.erase(0, pos);
-           } else {
-               m_buffer.clear();
+       }
+   }
+   
+   void HandleSettings(Ptr<Socket> s, Connection& conn, const HTTP2Frame& frame) {
+       if (frame.HasFlag(FLAG_ACK)) {
+           SIM_LOG(SIM_LOG_INFO, "[Server] SETTINGS acknowledged by client");
+           return;
+       }
+       H2Settings peer = H2Settings::Parse(frame.payload);
+       SIM_LOG(SIM_LOG_INFO, "[Server] Client SETTINGS: MAX_CONCURRENT_STREAMS=" << peer.maxConcurrentStreams);
+       if (peer.headerTableSize != conn.encoder.GetTable().MaxSize()) conn.encoder.SetMaxTableSize(peer.headerTableSize);
+       QueueControl(s, conn, MakeSettingsFrame(H2Settings(), true));
+   }
+   
+   void HandleWindowUpdate(Ptr<Socket> s, Connection& conn, const HTTP2Frame& frame) {
+       uint32_t bytesToAdd = 0;
+       try {
+           bytesToAdd = std::stoul(frame.payload);
+       } catch (const std::exception& e) {
+           SIM_LOG(SIM_LOG_WARN, "[Server] Failed to parse WINDOW_UPDATE payload: " << e.what());
+           bytesToAdd = 16384; // 默认值
+       }
+       
+       if (frame.streamId == 0) {
+           // 连接级窗口更新
+           conn.connWindowBytes = std::min(conn.connWindowBytes + bytesToAdd, m_connWindowInit);
+           SIM_LOG(SIM_LOG_DEBUG, "[SERVER_WINDOW_REPLENISHED] t=" << Simulator::Now().GetSeconds() 
+                                  << "s, connWin is now " << conn.connWindowBytes << " bytes.");
+       } else {
+           // 流级窗口更新（已关闭的流不再有窗口）
+           auto it = conn.streamSendWindow.find(frame.streamId);
+           if (it != conn.streamSendWindow.end()) {
+               it->second = std::min(it->second + bytesToAdd, m_streamWindowInit);
+               SIM_LOG(SIM_LOG_DEBUG, "[SERVER_STREAM_WINDOW_REPLENISHED] t=" << Simulator::Now().GetSeconds() 
+                                      << "s, stream " << frame.streamId << " window is now " 
+                                      << it->second << " bytes.");
            }
        }
+       
+       // 如果之前因为流控阻塞而停止发送，现在恢复发送
+       if (!conn.pendingQueue.empty()) {
+           KickWriter(s, conn);
+       }
    }
-   void SendTick(Ptr<Socket> s) {
-       if (m_pendingQueue.empty()) { m_sending = false; return; }
-
-       PendingItem item = m_pendingQueue.front();
-       m_pendingQueue.pop_front();
-
-       // 流/连接窗口：仅对 DATA 有效，且我们在这里就是发 DATA
-       uint32_t winCap = (uint32_t)std::min<uint64_t>(m_connWindowBytes,
-                          m_streamSendWindow[item.streamId]);
-       if (winCap == 0) {
-           // 流控阻塞：保持轮转，稍后再试
-           std::cout << "[SERVER_FLOW_CONTROL_BLOCKED] sid=" << item.streamId
-                     << " connWin=" << m_connWindowBytes
-                     << " streamWin=" << m_streamSendWindow[item.streamId] << std::endl;
-           m_pendingQueue.push_back(item);
-           Simulator::Schedule(MicroSeconds(m_tickUs), &HTTP2ServerApp::SendTick, this, s);
+   
+   void HandleHeaders(Ptr<Socket> s, Connection& conn, const HTTP2Frame& frame) {
+       // 先解码：被拒绝的请求也会改变 HPACK 动态表
+       HttpHeaderList reqHeaders;
+       if (!conn.decoder.Decode(frame.payload, reqHeaders)) {
+           NS_LOG_WARN("HPACK decoding failed on stream " << frame.streamId << " (COMPRESSION_ERROR)");
            return;
        }
+       // 客户端发起的流必须是奇数且严格递增（RFC 7540 §5.1.1），否则视为协议错误
+       if (frame.streamId % 2 == 0 || frame.streamId <= conn.lastPeerStreamId) {
+           NS_LOG_WARN("Protocol error: HEADERS on stream " << frame.streamId
+                       << " (last peer stream " << conn.lastPeerStreamId << ")");
+           return;
+       }
+       conn.lastPeerStreamId = frame.streamId;
+       // 超出通告的 SETTINGS_MAX_CONCURRENT_STREAMS：不处理，回 RST_STREAM(REFUSED_STREAM) 让客户端重试
+       if (conn.activeStreams >= m_nStreams) {
+           NS_LOG_WARN("Refusing stream " << frame.streamId << ": SETTINGS_MAX_CONCURRENT_STREAMS="
+                       << m_nStreams << " reached");
+           QueueControl(s, conn, MakeRstStreamFrame(frame.streamId, H2_REFUSED_STREAM));
+           return;
+       }
+       if (conn.reqsHandled >= m_maxReqs) return;
+       conn.reqsHandled++;
+
+       // idle -> open；请求 HEADERS 带 END_STREAM 则进入 half-closed(remote)
+       H2StreamState st = H2StreamState::OPEN;
+       if (frame.HasFlag(FLAG_END_STREAM)) st = H2OnEndStream(st, false);
+       conn.streamState[frame.streamId] = st;
+       ++conn.activeStreams;
+       SIM_LOG(SIM_LOG_INFO, "[Server] Received request on stream " << frame.streamId
+                             << ", req #" << conn.reqsHandled << " " << FindHeader(reqHeaders, ":path")
+                             << ", state " << H2StreamStateName(st));
+
+
+       // 解析/决定响应大小：回放时按 :path 找对象，否则按路径里的全局请求号
+       std::string reqPath = FindHeader(reqHeaders, ":path");
+       int64_t obj = g_workload.Find(reqPath);
+       uint32_t id = obj >= 0 ? static_cast<uint32_t>(obj) : RequestIdOfPath(reqPath, conn.reqsHandled - 1);
+       uint32_t respSize = m_respSize;
+       uint32_t respHdrSize = g_dists.RespHeaderBytes(id, m_headerSize);
+       if (obj >= 0) {
+           respSize = g_workload.Get(obj).bodyBytes;
+           if (g_workload.Get(obj).respHeaderBytes > 0) respHdrSize = g_workload.Get(obj).respHeaderBytes;
+       } else if (!g_respSizes.empty()) {
+           uint32_t idx = std::min<uint32_t>(id, g_respSizes.size() - 1);
+           respSize = g_respSizes[idx];
+       }
 
-       uint32_t sendBytes = std::min({m_frameChunk, item.remainingBytes, winCap});
-
-       HTTP2Frame dataFrame;
-       dataFrame.streamId = item.streamId;
-       dataFrame.type = DATA;
-       dataFrame.length = sendBytes;
-       dataFrame.payload = std::string(sendBytes, 'D');
-
-       Ptr<Packet> pkt = SerializeFrame(dataFrame);
 
-       // 如果 TCP 发送缓冲不够，看作"HoL 停滞"开始/持续
-       if (s->GetTxAvailable() < pkt->GetSize()) {
-           if (m_stallStart < 0) m_stallStart = Simulator::Now().GetSeconds();
-           m_pendingQueue.push_front(item);
-           Simulator::Schedule(MicroSeconds(m_tickUs * 2), &HTTP2ServerApp::SendTick, this, s);
+       // 先发 HEADERS：响应头按 headerSize（未压缩大小）构造，经本连接的 HPACK 编码器压缩
+       HTTP2Frame headerFrame;
+       headerFrame.streamId = frame.streamId;
+       headerFrame.type = HEADERS;
+       if (respSize == 0) headerFrame.flags = FLAG_END_STREAM; // 空响应：HEADERS 即结束
+      
+       HttpHeaderList respHeaders = OriginResponseHeaders(respSize, id, "ns3-http2/0.1", respHdrSize);
+       headerFrame.payload = conn.encoder.Encode(respHeaders);
+       headerFrame.length = headerFrame.payload.size();
+      
+       SIM_LOG(SIM_LOG_DEBUG, "[Server] HPACK: original=" << HeaderListPlainBytes(respHeaders) << "B, compressed="
+                              << headerFrame.length << "B, dynamic table=" << conn.encoder.GetTable().Size() << "B");
+      
+       QueueControl(s, conn, headerFrame);
+       if (respSize == 0) {
+           CloseStream(conn, frame.streamId);
            return;
        }
 
-               int sent = s->Send(pkt);
-        uint32_t pktSize = pkt->GetSize();
-        if (sent <= 0) {
-            if (m_stallStart < 0) m_stallStart = Simulator::Now().GetSeconds();
-            item.retryCount++;
-            item.lastRetryTime = Simulator::Now().GetSeconds();
-            
-            if (item.retryCount > 5) {
-                // 重试次数过多，暂停流
-                item.isPaused = true;
-                NS_LOG_WARN("Stream " << item.streamId << " paused due to excessive retries: " << item.retryCount);
-            }
-            
-            m_pendingQueue.push_front(item); // 放回队首，优先重试
-            Simulator::Schedule(MicroSeconds(m_tickUs * 3), &HTTP2ServerApp::SendTick, this, s);
-            return;
-        }
-        if ((uint32_t)sent < pktSize) {
-            // 部分写入：不扣减任何窗口/剩余字节，视作背压，稍后重试
-            if (m_stallStart < 0) m_stallStart = Simulator::Now().GetSeconds();
-            m_pendingQueue.push_front(item);
-            uint32_t factor = (item.remainingBytes <= m_frameChunk ? 5u : 3u);
-            Simulator::Schedule(MicroSeconds(m_tickUs * factor), &HTTP2ServerApp::SendTick, this, s);
-            return;
-        }
-
-        // 一旦成功发送，结束本次停滞计时
-        if (m_stallStart >= 0) {
-            m_totalHolStall += (Simulator::Now().GetSeconds() - m_stallStart);
-            m_stallStart = -1.0;
-        }
 
-        // 成功后才真正扣减窗口/剩余字节
-        m_connWindowBytes -= sendBytes;
-        m_streamSendWindow[item.streamId] -= sendBytes;
-        item.remainingBytes -= sendBytes;
+       // 把"整个响应大小"入队，后续 tick 交错发送
+       SIM_LOG(SIM_LOG_DEBUG, "[Server] Enqueuing stream " << frame.streamId
+                              << " with size " << respSize << " bytes");
+       conn.pendingQueue.emplace_back(frame.streamId, respSize, Simulator::Now().GetSeconds(),
+                                      ParseUrgency(FindHeader(reqHeaders, "priority")));
+       conn.streamSendWindow[frame.streamId] = m_streamWindowInit;
+       m_sampler.Wake();
 
-       std::cout << "[H2] TX sid=" << item.streamId
-                 << " len=" << sendBytes
-                 << " remain=" << item.remainingBytes
-                 << " connWin=" << m_connWindowBytes
-                 << " streamWin=" << m_streamSendWindow[item.streamId]
-                 << " t=" << Simulator::Now().GetSeconds() << "s" << std::endl;
 
-       if (item.remainingBytes > 0) {
-           m_pendingQueue.push_back(item); // 轮转 -> 等价 RR
+       KickWriter(s, conn);
+   }
+   
+   // 本端发出 END_STREAM：half-closed(remote) -> closed
+   void CloseStream(Connection& conn, uint32_t streamId) {
+       auto it = conn.streamState.find(streamId);
+       if (it == conn.streamState.end()) return;
+       it->second = H2OnEndStream(it->second, true);
+       if (it->second == H2StreamState::CLOSED) {
+           conn.streamState.erase(it);
+           conn.streamSendWindow.erase(streamId);
+           if (conn.activeStreams > 0) --conn.activeStreams;
+       }
+   }
+   
+   // 有新数据或新窗口时唤醒写出；已有 tick 在途或正在等待发送缓冲时无需重复唤醒
+   void KickWriter(Ptr<Socket> s, Connection& conn) {
+       if (conn.tickPending || conn.waitingForBuffer) return;
+       if (m_tickUs > 0) {
+           ArmTick(s, conn);
        } else {
-           // 流完成，记录统计信息
-           NS_LOG_INFO("Stream " << item.streamId << " completed successfully");
+           WriteData(s);
        }
-
+   }
+   
+   void ArmTick(Ptr<Socket> s, Connection& conn) {
+       conn.tickPending = true;
        Simulator::Schedule(MicroSeconds(m_tickUs), &HTTP2ServerApp::SendTick, this, s);
    }
+   
+   // 可选的人工交错节奏：每个 tick 最多写一个 DATA 块（--tickUs=0 关闭）
+   void SendTick(Ptr<Socket> s) {
+       SIM_PROFILE_SCOPE("SendTick (server)");
+       Connection& conn = m_conns[s];
+       conn.tickPending = false;
+       if (conn.waitingForBuffer) return; // 由发送回调接手
+       WriteData(s);
+   }
+   
+   // 非 DATA 帧排在 DATA 之前按序写出。HEADERS 一经 HPACK 编码就改变了动态表，
+   // 丢掉会让对端解码器失步，所以发送缓冲不足时留在队列里等 HandleSend
+   void QueueControl(Ptr<Socket> s, Connection& conn, const HTTP2Frame& frame) {
+       conn.ctrlQueue.push_back(frame);
+       if (!conn.waitingForBuffer) FlushControl(s, conn);
+   }
+
+   // 写出排队的控制帧；队首放不下时置 waitingForBuffer 并返回 false
+   bool FlushControl(Ptr<Socket> s, Connection& conn) {
+       while (!conn.ctrlQueue.empty()) {
+           const HTTP2Frame& frame = conn.ctrlQueue.front();
+           Ptr<Packet> p = SerializeFrame(frame);
+           if (s->GetTxAvailable() < p->GetSize() || s->Send(p) <= 0) {
+               conn.waitingForBuffer = true;
+               return false;
+           }
+           CountFrameBytes(GetNode()->GetId(), frame, p->GetSize());
+           conn.ctrlQueue.pop_front();
+       }
+       return true;
+   }
+
+   // TCP 发送回调：缓冲腾出空间后恢复写出
+   void HandleSend(Ptr<Socket> s, uint32_t txAvailable) {
+       SIM_PROFILE_SCOPE("HandleSend (server)");
+       Connection& conn = m_conns[s];
+       if (!conn.waitingForBuffer || txAvailable == 0) return;
+       conn.waitingForBuffer = false;
+       if (!conn.tickPending) WriteData(s);
+   }
+
+   // DATA 写出循环。只由 tick、发送回调或窗口更新驱动，阻塞时停下等待事件，不做轮询：
+   //   发送缓冲不足 -> 等 HandleSend；窗口耗尽 -> 等 WINDOW_UPDATE
+   void WriteData(Ptr<Socket> s) {
+       SIM_PROFILE_SCOPE("WriteData (server)");
+       Connection& conn = m_conns[s];
+       ++m_writerWakeups;
+       if (!FlushControl(s, conn)) return; // 控制帧先行，DATA 不能越过本流的 HEADERS
+       uint32_t framesSent = 0;
+       std::vector<PendingItem> streamBlocked; // 本轮流级窗口为 0 的流
+       
+       while (!conn.pendingQueue.empty() && conn.connWindowBytes > 0) {
+           PendingItem item = m_scheduler.Take(conn.pendingQueue, Simulator::Now().GetSeconds());
+           uint64_t streamWin = conn.streamSendWindow[item.streamId];
+           if (streamWin == 0) {
+               streamBlocked.push_back(item);
+               continue;
+           }
+
+           uint32_t winCap = (uint32_t)std::min<uint64_t>(conn.connWindowBytes, streamWin);
+           uint32_t sendBytes = std::min({m_frameChunk, item.remainingBytes, winCap});
+
+           HTTP2Frame dataFrame;
+           dataFrame.streamId = item.streamId;
+           dataFrame.type = DATA;
+           dataFrame.length = sendBytes;
+           dataFrame.payload = std::string(sendBytes, 'D');
+           if (sendBytes == item.remainingBytes) dataFrame.flags = FLAG_END_STREAM; // 最后一块
+
+           Ptr<Packet> pkt = SerializeFrame(dataFrame);
+
+           // TCP 发送缓冲不够：HoL 停滞开始/持续，等发送回调
+           int sent = (s->GetTxAvailable() < pkt->GetSize()) ? 0 : s->Send(pkt);
+           if (sent <= 0) {
+               if (conn.stallStart < 0) conn.stallStart = Simulator::Now().GetSeconds();
+               conn.pendingQueue.push_front(item);
+               conn.waitingForBuffer = true;
+               ++m_bufferWaits;
+               break;
+           }
+
+           CountFrameBytes(GetNode()->GetId(), dataFrame, pkt->GetSize());
+
+           // 一旦成功发送，结束本次停滞计时
+           if (conn.stallStart >= 0) {
+               m_totalSendStall += (Simulator::Now().GetSeconds() - conn.stallStart);
+               conn.stallStart = -1.0;
+           }
+
+           conn.connWindowBytes -= sendBytes;
+           conn.streamSendWindow[item.streamId] -= sendBytes;
+           item.remainingBytes -= sendBytes;
+           ++framesSent;
+
+           SIM_LOG(SIM_LOG_DEBUG, "[H2] TX sid=" << item.streamId
+                                  << " len=" << sendBytes
+                                  << " remain=" << item.remainingBytes
+                                  << " connWin=" << conn.connWindowBytes
+                                  << " streamWin=" << conn.streamSendWindow[item.streamId]
+                                  << " t=" << Simulator::Now().GetSeconds() << "s");
+
+           if (item.remainingBytes > 0) {
+               m_scheduler.Requeue(conn.pendingQueue, item); // RR 轮转 / SRPT 留在队首
+           } else {
+               // END_STREAM 已发出，流关闭
+               CloseStream(conn, item.streamId);
+               NS_LOG_INFO("Stream " << item.streamId << " completed successfully");
+           }
+
+           if (m_tickUs > 0) {
+               if (!conn.pendingQueue.empty() || !streamBlocked.empty()) ArmTick(s, conn);
+               break;
+           }
+       }
+       
+       for (const PendingItem& item : streamBlocked) conn.pendingQueue.push_back(item);
+       if (framesSent == 0) ++m_wastedWakeups;
+       
+       // 流控阻塞：停止写出，等 WINDOW_UPDATE 唤醒
+       if (!conn.pendingQueue.empty() && !conn.tickPending && !conn.waitingForBuffer) {
+           SIM_LOG(SIM_LOG_DEBUG, "[SERVER_FLOW_CONTROL_BLOCKED] pending=" << conn.pendingQueue.size()
+                                  << " connWin=" << conn.connWindowBytes);
+       }
+   }
 
   
    Ptr<Socket> m_socket; //Server socket
-   Ptr<Socket> m_clientSocket; //Client socket
    uint16_t m_port; // Port number
    uint32_t m_respSize;// Response size
    uint32_t m_maxReqs; // Maximum number of requests
-   uint32_t m_reqsHandled = 0; // The number of processed requests
-   uint32_t m_nStreams = 3; // Number of concurrent streams for multiplexing
+   uint32_t m_nStreams = 3; // SETTINGS_MAX_CONCURRENT_STREAMS advertised to clients
    uint32_t m_frameChunk = 1200; // Frame chunk size in bytes
-   uint32_t m_tickUs = 500; // Tick interval in microseconds for interleaving
-   bool m_sending = false; // Whether interleaved sending is active
-   std::deque<PendingItem> m_pendingQueue; // Queue for pending responses
-   std::string m_buffer; // Server-side receive buffer for frame parsing
-   uint32_t m_headerSize = 200; // Base header size in bytes (before HPACK compression)
-   double m_hpackRatio = 0.3; // HPACK compression ratio
+   uint32_t m_tickUs = 500; // Optional pacing interval between DATA chunks (0 = none)
+   std::map<Ptr<Socket>, Connection> m_conns; // Per-connection state
+   StreamScheduler m_scheduler; // Picks which pending response gets the next DATA chunk
+   uint32_t m_headerSize = 200; // Response header size in bytes (before HPACK compression)
+   uint32_t m_hpackTableSize = 4096; // SETTINGS_HEADER_TABLE_SIZE advertised to clients
+   bool m_hpackHuffman = true; // Huffman-code response header strings
    uint64_t m_connWindowInit = 0; // Connection-level window size in bytes
-   uint64_t m_connWindowBytes = 0; // Current connection-level window size in bytes
    uint64_t m_streamWindowInit = 0; // Stream-level window size in bytes
-   std::map<uint32_t, uint64_t> m_streamSendWindow; // 每个流的当前发送窗口大小
    
-   // HoL stall measurement
-   double m_stallStart = -1.0;
-   double m_totalHolStall = 0.0;
+   // Time the TCP send buffer was full with DATA waiting (summed over connections)
+   double m_totalSendStall = 0.0;
+   
+   // Writer activity: every WriteData invocation, those that sent nothing, and send-buffer waits
+   uint64_t m_writerWakeups = 0;
+   uint64_t m_wastedWakeups = 0;
+   uint64_t m_bufferWaits = 0;
+   
+   TcpProbeSet m_tcpProbes;    // 已接受连接的 TCP 拥塞状态
+   PeriodicSampler m_sampler;  // 拥塞/队列状态周期采样
    
 public:
-   double GetHolStallSeconds() const { return m_totalHolStall; }
+   // 周期采样（所有连接求和）：有待发响应或在途/未确认字节时运行，空闲即暂停，新请求到达时恢复
+   // cwndLog 打印与 HTTP/3 相同的 "CWND_LOG,t,cwnd,inflight" 行
+   void EnableSampling(Time interval, bool cwndLog) {
+       m_sampler.AddProbe("cwnd", [this] { return double(m_tcpProbes.TotalCwnd()); });
+       m_sampler.AddProbe("bytes_in_flight", [this] { return double(m_tcpProbes.TotalBytesInFlight()); });
+       m_sampler.AddProbe("srtt_s", [this] { return m_tcpProbes.MeanSrttSeconds(); });
+       m_sampler.AddProbe("tx_buffered_bytes", [this] { return double(m_tcpProbes.TotalTxBuffered()); });
+       m_sampler.AddProbe("pending_streams", [this] { return double(PendingStreams()); });
+       m_sampler.AddProbe("tx_available", [this] { return double(m_tcpProbes.TotalTxAvailable()); });
+       m_sampler.SetBusyCheck([this] { return PendingStreams() > 0 || m_tcpProbes.TotalTxBuffered() > 0; });
+       if (cwndLog) {
+           m_sampler.SetRowHook([](const std::vector<double>& row) {
+               std::cout << "CWND_LOG," << row[0] << "," << row[1] << "," << row[2] << std::endl;
+           });
+       }
+       m_sampler.Enable(interval);
+   }
+   PeriodicSampler& GetSampler() { return m_sampler; }
+   size_t PendingStreams() const {
+       size_t n = 0;
+       for (const auto& kv : m_conns) n += kv.second.pendingQueue.size();
+       return n;
+   }
+
+   double GetSendStallSeconds() const { return m_totalSendStall; }
+   uint64_t GetWriterWakeups() const { return m_writerWakeups; }
+   uint64_t GetWastedWakeups() const { return m_wastedWakeups; }
+   uint64_t GetBufferWaits() const { return m_bufferWaits; }
 };
 
 
@@ -1259,16 +1645,46 @@ int main(int argc, char *argv[]) {
    uint32_t nConnections = 1;    // 并发连接数：同时建立的HTTP连接数
    bool mixedSizes = false;      // 是否使用混合对象大小分布
    bool thirdParty = false;      // 是否模拟第三方域（仅影响请求Host与统计标签）
-   uint32_t nStreams = 3;        // HTTP/2: Number of concurrent streams
+   uint32_t nStreams = 3;        // HTTP/2: SETTINGS_MAX_CONCURRENT_STREAMS
    uint32_t frameChunk = 1200;   // Frame chunk size in bytes
    uint32_t tickUs = 500;        // Tick interval in microseconds for interleaving
-   uint32_t headerSize = 200;    // Base header size in bytes (before HPACK compression)
-   double hpackRatio = 0.3;      // HPACK compression ratio (0.3 = 70% compression)
+   uint32_t headerSize = 200;    // Response header size in bytes (before HPACK compression)
+   uint32_t hpackTableSize = 4096; // SETTINGS_HEADER_TABLE_SIZE (HPACK dynamic table)
+   bool hpackHuffman = true;     // HPACK Huffman coding of header strings
    uint32_t defaultWindowSize = 65535; // Default flow control window size
    uint32_t maxRetries = 5;      // Maximum retry attempts before pausing stream
    uint32_t connWindowMB = 32;   // Connection-level window size in MB
    uint32_t streamWindowMB = 32; // Stream-level window size in MB
    double simTime = 60.0;        // 默认仿真时间 60s
+   std::string scheduler = "rr"; // DATA scheduling: rr | srpt
+   double srptAging = 0.0;       // SRPT aging rate (bytes/s of waiting credited to an item)
+   bool autoStop = true;         // 所有客户端完成后提前结束仿真
+   double drainTime = 0.5;       // 最后一个响应之后继续仿真的时间（秒）
+   std::string logLevel = "info"; // error|warn|info|debug|trace
+   bool quiet = false;           // 等价于 --logLevel=warn
+   bool macTrace = false;        // 逐包 MAC Tx/Rx 跟踪（需 logLevel=trace 才会输出）
+   bool enableFlowmon = false;   // FlowMonitor 逐流统计（控制台 + --resultsFile）
+   std::string flowStatsFile = ""; // 仅逐流计数器（.json 或 .csv）；空 = 关闭
+   std::string flowmonXml = "";    // 完整 FlowMonitor XML（含直方图/探针）；空 = 关闭
+   std::string traceFile = "";   // 二进制事件跟踪文件（trace2csv 转 CSV）；空 = 关闭
+   uint32_t traceCapacity = 1 << 20; // 环形缓冲记录数（每条 32 B）
+   std::string resultsFile = "";  // 机器可读结果（.json，或 .csv 单行）；空 = 不写
+   std::string histFile = "";     // 延迟直方图文件（histmerge 合并）；空 = 不写
+   bool profile = false;          // 仿真器自身性能剖析报告
+   std::string waterfallFile = "";  // 逐请求时间线 CSV；空 = 不写
+   double sampleInterval = 0.01;  // 周期采样间隔（秒）
+   std::string sampleFile = "";   // 采样列式输出（.csv 为 CSV，否则二进制，trace2csv 可读）；空 = 关闭
+   bool cwndLog = false;          // 每次采样打印 CWND_LOG 行
+   std::string harFile = "";      // HAR 工作负载回放（覆盖 nRequests/respSize/mixedSizes/thirdParty）；空 = 合成负载
+   std::string pageFile = "";     // 页面依赖图（JSON，见 common/workload.h）；空 = 不用
+   bool pageGraph = false;        // 按 nRequests 生成合成页面依赖图（HTML -> CSS/JS -> 图片）
+   std::string respSizeDist = ""; // 响应大小分布（见 common/distributions.h，RngRun 决定抽样）；空 = respSize/mixedSizes
+   std::string reqHdrDist = "";   // 请求头大小分布；空 = reqSize
+   std::string respHdrDist = "";  // 响应头大小分布；空 = headerSize
+   std::string thinkDist = "";    // 请求间思考时间分布（秒）；空 = interval
+   double arrivalRate = 0.0;      // 开环：泊松到达速率（req/s，见 common/arrivals.h）；0 = 闭环
+   std::string arrivalTrace = ""; // 开环：到达时刻文件（给了 arrivalRate 则按其缩放）；空 = 不用
+   uint32_t maxBacklog = 0;       // 开环：每连接积压上限，满了丢弃新到达；0 = 不限
    
    // 新增窗口更新相关参数
    uint32_t windowUpdateThreshold = 16384; // 16KB
@@ -1276,7 +1692,7 @@ int main(int argc, char *argv[]) {
    CommandLine cmd;
    cmd.AddValue("nRequests", "Number of HTTP requests", nRequests);
    cmd.AddValue("respSize", "HTTP response size (bytes)", respSize);
-   cmd.AddValue("reqSize", "HTTP request size (bytes)", reqSize);
+   cmd.AddValue("reqSize", "HTTP request header size before HPACK compression (bytes)", reqSize);
    cmd.AddValue("httpPort", "HTTP server port", httpPort);
    cmd.AddValue("errorRate", "Packet loss rate", errorRate);
    cmd.AddValue("dataRate", "Link bandwidth", dataRate);
@@ -1286,18 +1702,99 @@ int main(int argc, char *argv[]) {
    cmd.AddValue("nConnections", "Number of parallel HTTP/2 connections", nConnections);
    cmd.AddValue("mixedSizes", "Use mixed object size distribution (HTML/CSS/JS/images)", mixedSizes);
    cmd.AddValue("thirdParty", "Simulate third-party domains in Host header", thirdParty);
-   cmd.AddValue("nStreams", "Number of concurrent HTTP/2 streams", nStreams);
+   cmd.AddValue("nStreams", "SETTINGS_MAX_CONCURRENT_STREAMS advertised by client and server", nStreams);
    cmd.AddValue("frameChunk", "Frame chunk size in bytes for interleaving", frameChunk);
-   cmd.AddValue("tickUs", "Tick interval in microseconds for interleaving", tickUs);
-   cmd.AddValue("headerSize", "Base header size in bytes (before HPACK compression)", headerSize);
-   cmd.AddValue("hpackRatio", "HPACK compression ratio (0.3 = 70% compression)", hpackRatio);
+   cmd.AddValue("tickUs", "Artificial DATA pacing interval in microseconds (0 = write until TCP buffer is full)", tickUs);
+   cmd.AddValue("headerSize", "HTTP response header size before HPACK compression (bytes)", headerSize);
+   cmd.AddValue("hpackTableSize", "SETTINGS_HEADER_TABLE_SIZE advertised by client and server (bytes)", hpackTableSize);
+   cmd.AddValue("hpackHuffman", "Huffman-code HPACK header strings", hpackHuffman);
    cmd.AddValue("defaultWindowSize", "Default flow control window size", defaultWindowSize);
    cmd.AddValue("maxRetries", "Maximum retry attempts before pausing stream", maxRetries);
    cmd.AddValue("connWindowMB", "Connection-level flow control window size in MB", connWindowMB);
    cmd.AddValue("streamWindowMB", "Stream-level flow control window size in MB", streamWindowMB);
    cmd.AddValue("simTime", "Simulation time in seconds", simTime);
    cmd.AddValue("windowUpdateThreshold", "Threshold for sending WINDOW_UPDATE frames (bytes)", windowUpdateThreshold);
+   cmd.AddValue("scheduler", "Server DATA scheduling policy: rr | srpt", scheduler);
+   cmd.AddValue("srptAging", "SRPT aging rate in bytes per second waited (0 = pure SRPT)", srptAging);
+   cmd.AddValue("autoStop", "Stop the simulation once every client has all responses", autoStop);
+   cmd.AddValue("drainTime", "Seconds to keep simulating after the last response (with autoStop)", drainTime);
+   cmd.AddValue("logLevel", "Progress log level: error|warn|info|debug|trace", logLevel);
+   cmd.AddValue("quiet", "Only print warnings, errors and the summary (same as --logLevel=warn)", quiet);
+   cmd.AddValue("macTrace", "Print per-packet MAC Tx/Rx events (at --logLevel=trace)", macTrace);
+   cmd.AddValue("flowmon", "Install FlowMonitor and report per-flow delay/jitter/loss", enableFlowmon);
+   cmd.AddValue("flowStatsFile", "Write per-flow rxPackets/delaySum/jitterSum/lost to this file (.json or .csv; implies --flowmon)", flowStatsFile);
+   cmd.AddValue("flowmonXml", "Write the full FlowMonitor XML (histograms and probes) to this file (implies --flowmon)", flowmonXml);
+   cmd.AddValue("traceFile", "Write a binary event trace to this file at the end of the run", traceFile);
+   cmd.AddValue("traceCapacity", "Event trace ring size in records; older records are overwritten", traceCapacity);
+   cmd.AddValue("resultsFile", "Write config, metrics, per-request timings and flow stats to this file (.json or .csv)", resultsFile);
+   cmd.AddValue("histFile", "Save request/TTFB/stream/RTT latency histograms to this file (mergeable with histmerge)", histFile);
+   cmd.AddValue("profile", "Report event rate, wall-clock per simulated second, per-callback time and peak RSS", profile);
+   cmd.AddValue("waterfallFile", "Write the per-request timeline (queued/sent/headers/first byte/last byte) as CSV", waterfallFile);
+   cmd.AddValue("sampleInterval", "Periodic state sampling interval in seconds (paused while idle)", sampleInterval);
+   cmd.AddValue("sampleFile", "Write sampled cwnd/in-flight/srtt/queue columns to this file (.csv, or binary for trace2csv)", sampleFile);
+   cmd.AddValue("cwndLog", "Print CWND_LOG lines (server cwnd and bytes in flight) on every sample", cwndLog);
+   cmd.AddValue("harFile", "Replay the objects of this HAR capture (sizes, hosts, priorities, start offsets) instead of the synthetic workload", harFile);
+   cmd.AddValue("pageFile", "Fetch the objects of this page dependency graph; children are requested once their parents arrived and were processed", pageFile);
+   cmd.AddValue("pageGraph", "Fetch a synthetic page of nRequests objects with HTML/CSS/JS discovery dependencies", pageGraph);
+   cmd.AddValue("respSizeDist", "Response sizes: fixed|uniform|exponential|lognormal|pareto|zipf|empirical:<args> (seeded by RngRun)", respSizeDist);
+   cmd.AddValue("reqHdrDist", "Request header sizes, same syntax as respSizeDist", reqHdrDist);
+   cmd.AddValue("respHdrDist", "Response header sizes, same syntax as respSizeDist", respHdrDist);
+   cmd.AddValue("thinkDist", "Think time in seconds before each next request, same syntax as respSizeDist", thinkDist);
+   cmd.AddValue("arrivalRate", "Open loop: Poisson request arrivals at this rate (req/s) instead of request-after-response", arrivalRate);
+   cmd.AddValue("arrivalTrace", "Open loop: request arrival times (s, one per line) from this file; rescaled to arrivalRate if given", arrivalTrace);
+   cmd.AddValue("maxBacklog", "Open loop: drop arrivals that find this many requests waiting on their connection (0 = unbounded)", maxBacklog);
    cmd.Parse(argc, argv);
+   if (!SetSimLogLevel(quiet ? "warn" : logLevel)) {
+       std::cerr << "Unknown --logLevel '" << logLevel << "', using info" << std::endl;
+   }
+   if (!traceFile.empty()) GlobalTracer().Enable(traceCapacity);
+   CallbackProfiler::Get().Enable(profile);
+   if (!harFile.empty() || !pageFile.empty()) {
+       std::string error;
+       bool ok = harFile.empty() ? g_workload.LoadPage(pageFile, error) : g_workload.LoadHar(harFile, error);
+       if (!ok) {
+           std::cerr << "Cannot load workload: " << error << std::endl;
+           return 1;
+       }
+   } else if (pageGraph) {
+       g_workload.BuildPage(nRequests);
+   }
+   if (!g_workload.Empty()) {
+       g_workload.Print(std::cout);
+       nRequests = g_workload.Size();
+   }
+   std::string arrivalError;
+   if (!g_arrivals.LoadTrace(arrivalTrace, arrivalError) || !g_arrivals.Setup(arrivalRate, nRequests, arrivalError)) {
+       std::cerr << "Bad arrivals: " << arrivalError << std::endl;
+       return 1;
+   }
+   if (g_arrivals.Active()) {
+       if (!g_workload.Empty()) {
+           std::cerr << "--arrivalRate/--arrivalTrace cannot be combined with --harFile/--pageFile/--pageGraph" << std::endl;
+           return 1;
+       }
+       g_arrivals.Print(std::cout, maxBacklog);
+       nRequests = g_arrivals.Size();
+   }
+
+   SimResults results("http/2");
+   results.SetCommandLine(argc, argv);
+   results.Config().Field("nRequests", nRequests).Field("respSize", respSize).Field("reqSize", reqSize)
+                   .Field("errorRate", errorRate).Field("dataRate", dataRate).Field("delay", delay)
+                   .Field("interval", interval).Field("nConnections", nConnections)
+                   .Field("mixedSizes", mixedSizes).Field("thirdParty", thirdParty)
+                   .Field("nStreams", nStreams).Field("frameChunk", frameChunk).Field("tickUs", tickUs)
+                   .Field("headerSize", headerSize).Field("hpackTableSize", hpackTableSize)
+                   .Field("hpackHuffman", hpackHuffman)
+                   .Field("connWindowMB", connWindowMB).Field("streamWindowMB", streamWindowMB)
+                   .Field("scheduler", scheduler).Field("srptAging", srptAging)
+                   .Field("simTime", simTime).Field("autoStop", autoStop).Field("drainTime", drainTime)
+                   .Field("harFile", harFile)
+                   .Field("pageFile", pageFile).Field("pageGraph", pageGraph)
+                   .Field("respSizeDist", respSizeDist).Field("reqHdrDist", reqHdrDist)
+                   .Field("respHdrDist", respHdrDist).Field("thinkDist", thinkDist)
+                   .Field("arrivalRate", arrivalRate).Field("arrivalTrace", arrivalTrace).Field("maxBacklog", maxBacklog)
+                   .Field("rngSeed", RngSeedManager::GetSeed()).Field("rngRun", RngSeedManager::GetRun());
 
 
    // Build per-request response sizes
@@ -1319,6 +1816,13 @@ int main(int argc, char *argv[]) {
            }
        }
    }
+   std::string distError;
+   if (!g_dists.Setup(respSizeDist, reqHdrDist, respHdrDist, thinkDist, nRequests, distError)) {
+       std::cerr << "Bad distribution " << distError << std::endl;
+       return 1;
+   }
+   if (!g_dists.RespSizes().empty()) g_respSizes = g_dists.RespSizes();
+   if (g_dists.Any()) g_dists.Print(std::cout);
 
 
    NodeContainer nodes;
@@ -1339,11 +1843,25 @@ int main(int argc, char *argv[]) {
    Ipv4AddressHelper address;
    address.SetBase("10.1.1.0", "255.255.255.0");
    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+   GlobalBytes().SetServerNode(nodes.Get(1)->GetId());
+   GlobalBytes().TapDevices(devices);
 
 
    // HTTP/2 Application
    Ptr<HTTP2ServerApp> serverApp = CreateObject<HTTP2ServerApp>();
-   serverApp->Setup(httpPort, respSize, nRequests, nStreams, frameChunk, tickUs, headerSize, hpackRatio, connWindowMB, streamWindowMB);
+   serverApp->Setup(httpPort, respSize, nRequests, nStreams, frameChunk, tickUs, headerSize, connWindowMB, streamWindowMB);
+   serverApp->SetHpack(hpackTableSize, hpackHuffman);
+   SchedulerPolicy schedulerPolicy;
+   if (!StreamScheduler::ParsePolicy(scheduler, schedulerPolicy)) {
+       std::cerr << "Unknown --scheduler '" << scheduler << "', using rr" << std::endl;
+   }
+   StreamScheduler dataScheduler(schedulerPolicy, srptAging);
+   serverApp->SetScheduler(dataScheduler);
+   if (cwndLog || !sampleFile.empty()) {
+       serverApp->EnableSampling(Seconds(sampleInterval), cwndLog);
+       Ptr<Queue<Packet>> serverQueue = DynamicCast<PointToPointNetDevice>(devices.Get(1))->GetQueue();
+       serverApp->GetSampler().AddProbe("link_queue_packets", [serverQueue] { return double(serverQueue->GetNPackets()); });
+   }
    nodes.Get(1)->AddApplication(serverApp);
    serverApp->SetStartTime(Seconds(0.5));
    serverApp->SetStopTime(Seconds(simTime));
@@ -1352,13 +1870,28 @@ int main(int argc, char *argv[]) {
    // 多连接客户端
    std::vector<Ptr<HTTP2ClientApp>> clients;
    std::vector<std::vector<double>> allSendTimes, allRecvTimes;
+   CompletionCoordinator coordinator(autoStop, Seconds(drainTime));
    uint32_t baseReqs = nRequests / nConnections;
    uint32_t rem = nRequests % nConnections;
    for (uint32_t i = 0; i < nConnections; ++i) {
        uint32_t reqs = baseReqs + (i < rem ? 1 : 0); // 平均分配请求
        Ptr<HTTP2ClientApp> client = CreateObject<HTTP2ClientApp>();
+       if (!g_workload.Empty()) {
+           // 回放：对象按发出顺序轮流分给各连接
+           std::vector<uint32_t> share = g_workload.Share(i, nConnections);
+           reqs = share.size();
+           client->SetWorkload(&g_workload, share);
+       } else if (g_arrivals.Active()) {
+           // 开环：到达按时间顺序轮流分给各连接
+           std::vector<double> share = g_arrivals.Share(i, nConnections);
+           reqs = share.size();
+           client->SetArrivals(share, maxBacklog);
+       }
        client->Setup(interfaces.GetAddress(1), httpPort, reqSize, reqs, interval, thirdParty, nStreams);
+       client->SetConnection(i, nConnections);
        client->m_windowUpdateThreshold = windowUpdateThreshold; // 设置窗口更新阈值
+       client->SetHpack(hpackTableSize, hpackHuffman);
+       if (reqs > 0) client->SetDoneCallback(coordinator.Register()); // 无请求的客户端不参与
        nodes.Get(0)->AddApplication(client);
        client->SetStartTime(Seconds(1.0 + i * 0.01)); // 避免完全同时启动
        client->SetStopTime(Seconds(simTime));
@@ -1380,15 +1913,20 @@ int main(int argc, char *argv[]) {
 
 
    FlowMonitorHelper flowmonHelper;
-   Ptr<FlowMonitor> flowmon = flowmonHelper.InstallAll();
+   Ptr<FlowMonitor> flowmon;
+   if (enableFlowmon || !flowStatsFile.empty() || !flowmonXml.empty()) {
+      ConfigureFlowMonitor(flowmonHelper, !flowmonXml.empty());
+      flowmon = flowmonHelper.InstallAll();
+   }
 
 
-   Config::ConnectWithoutContext(
-       "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacTx",
-       MakeCallback(&TxTrace));
-   Config::ConnectWithoutContext(
-       "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacRx",
-       MakeCallback(&RxTrace));
+   if (macTrace || GlobalTracer().IsEnabled()) {
+       for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n) {
+           std::string dev = "/NodeList/" + std::to_string(n) + "/DeviceList/*/$ns3::PointToPointNetDevice/";
+           Config::ConnectWithoutContext(dev + "MacTx", MakeBoundCallback(&TxTrace, n));
+           Config::ConnectWithoutContext(dev + "MacRx", MakeBoundCallback(&RxTrace, n));
+       }
+   }
 
 
    // TCP MSS consistency
@@ -1400,7 +1938,10 @@ int main(int argc, char *argv[]) {
 
 
    Simulator::Stop(Seconds(simTime));
+   RunCost runCost;
+   runCost.Start();
    Simulator::Run();
+   runCost.Stop();
 
 
    // HTTP/2 Application 统计
@@ -1414,6 +1955,7 @@ int main(int argc, char *argv[]) {
    double rfcJitter = 0.0;
    bool havePrevTransit = false;
    double prevTransit = 0.0;
+   std::vector<double> respTimes; // 按请求配对的响应时间（与完成顺序无关）
    for (auto& client : clients) {
        totalResps += client->GetRespsRcvd();
        const auto& s = client->GetReqSendTimes();
@@ -1439,27 +1981,41 @@ int main(int argc, char *argv[]) {
        sendTimes.insert(sendTimes.end(), s.begin(), s.end());
        recvTimes.insert(recvTimes.end(), r.begin(), r.end());
    }
-   // HoL proxy metrics: send gaps exceeding configured interval on each connection
-   uint64_t holEvents = 0;
-   double holBlockedTime = 0.0;
-   for (auto& client : clients) {
-       const auto& s = client->GetReqSendTimes();
-       double iv = client->GetInterval();
-       for (size_t i = 1; i < s.size(); ++i) {
-           double idealNext = s[i - 1] + iv;
-           double extra = s[i] - idealNext;
-           if (extra > 1e-9) { // consider as head-of-line blocking time
-               ++holEvents;
-               holBlockedTime += extra;
-           }
-       }
-   }
+   // HoL：各客户端 TCP 乱序接收缓冲中有数据等待缺失报文段的次数/时间（接收端实测）
+   RxHolStats rxHol;
+   for (auto& client : clients) rxHol.Add(client->GetRxHolStats());
+   uint64_t holEvents = rxHol.episodes;
+   double holBlockedTime = rxHol.seconds;
+   // HPACK：实测的请求/响应头部块（编码前大小按 HTTP/1.1 文本计）
+   HpackStats reqHpack;
+   HpackStats respHpack = serverApp->GetHpackStats();
+   for (auto& client : clients) reqHpack.Add(client->GetHpackStats());
    // End-of-sim safety: let each client finalize any pending completions before computing summary
     for (auto &client : clients) {
         client->FinalizePendingCompletions();
     }
     totalResps = 0;
-    for (auto &client : clients) totalResps += client->GetRespsRcvd();
+    uint64_t doneBytes = 0; // 各客户端已完成响应的响应体字节
+    for (auto &client : clients) {
+        totalResps += client->GetRespsRcvd();
+        doneBytes += client->GetDoneBytes();
+        const auto& rt = client->GetResponseTimes();
+        respTimes.insert(respTimes.end(), rt.begin(), rt.end());
+    }
+    // 逐请求时间线：写入 --resultsFile 的 requests 与 --waterfallFile
+    std::vector<RequestTiming> timeline;
+    uint32_t holStreams = 0; // 有数据被 TCP 乱序缓冲挡住过的流
+    for (uint32_t ci = 0; ci < clients.size(); ++ci) {
+        for (RequestTiming t : clients[ci]->GetTimeline().Get()) {
+            t.conn = ci;
+            if (t.holBytes > 0) ++holStreams;
+            results.AddRequest(t);
+            timeline.push_back(t);
+        }
+    }
+    if (!waterfallFile.empty() && !WriteWaterfall(waterfallFile, timeline)) {
+        std::cerr << "Cannot write waterfall to " << waterfallFile << std::endl;
+    }
 
     // Always print at least the completed responses summary for tooling to parse
  std::cout << "------------------------------------------" << std::endl;
@@ -1469,23 +2025,24 @@ int main(int argc, char *argv[]) {
  if (nDone > 0 && lastRecv > firstSend) {
        double avgDelay = sumDelay / static_cast<double>(nDone);
       
-       // 计算HPACK压缩后的头部大小
-       double headerCompressed = std::max(20.0, headerSize * hpackRatio);
+       // 每个响应/请求的平均 HPACK 头部块大小
+       double headerCompressed = respHpack.blocks ? double(respHpack.encodedBytes) / respHpack.blocks : 0.0;
+       double reqHeaderCompressed = reqHpack.blocks ? double(reqHpack.encodedBytes) / reqHpack.blocks : 0.0;
       
-       // 计算下行吞吐量（DATA + 响应HEADERS）
-       double totalBytesDown = static_cast<double>(nDone) * (respSize + headerCompressed);
+       // 计算下行吞吐量（实际完成的 DATA + 响应HEADERS；respSizeDist / 回放时大小各异）
+       double totalBytesDown = static_cast<double>(doneBytes) + static_cast<double>(nDone) * headerCompressed;
        double totalTime = lastRecv - firstSend;
        double throughputDown = (totalBytesDown * 8.0) / (totalTime * 1e6); // Mbps
       
        // 计算双向吞吐量（包括上行请求HEADERS）
-       double totalBytesUp = static_cast<double>(nDone) * headerCompressed; // 上行请求头
+       double totalBytesUp = static_cast<double>(nDone) * reqHeaderCompressed; // 上行请求头
        double totalBytesBi = totalBytesDown + totalBytesUp;
        double throughputBi = (totalBytesBi * 8.0) / (totalTime * 1e6); // Mbps
       
-       // 计算头部压缩节省的带宽
-       double originalBytes = static_cast<double>(nDone) * (respSize + headerSize);
-       double savedBytes = originalBytes - totalBytesDown;
-       double compressionRatio = (savedBytes / originalBytes) * 100.0;
+       // 计算头部压缩节省的带宽（两个方向，相对未压缩头部）
+       double plainHeaderBytes = static_cast<double>(reqHpack.plainBytes + respHpack.plainBytes);
+       double savedBytes = plainHeaderBytes - static_cast<double>(reqHpack.encodedBytes + respHpack.encodedBytes);
+       double compressionRatio = plainHeaderBytes > 0 ? (savedBytes / plainHeaderBytes) * 100.0 : 0.0;
       
        std::cout << "The HTTP/2 experiment has ended. The total number of responses received by the client is: " << totalResps << "/" << nRequests << std::endl;
        std::cout << "Average delay of HTTP/2: " << avgDelay << " s" << std::endl;
@@ -1494,7 +2051,7 @@ int main(int argc, char *argv[]) {
        std::cout << "------------------------------------------" << std::endl;
                std::cout << "HTTP/2 Experiment Summary" << std::endl;
         std::cout << "completedResponses (nDone): " << totalResps << "/" << nRequests << std::endl;
-       std::cout << "dataPerResp (bytes): " << respSize << std::endl;
+       std::cout << "dataPerResp (bytes): " << std::fixed << std::setprecision(0) << static_cast<double>(doneBytes) / totalResps << std::endl;
        std::cout << "hpackPerResp (bytes): " << std::fixed << std::setprecision(0) << headerCompressed << std::endl;
        std::cout << "firstSend: " << std::fixed << std::setprecision(6) << firstSend << "s" << std::endl;
        std::cout << "lastRecv: " << std::fixed << std::setprecision(6) << lastRecv << "s" << std::endl;
@@ -1511,50 +2068,120 @@ int main(int argc, char *argv[]) {
       
        std::cout << "HPACK compression: saved " << std::fixed << std::setprecision(0) << savedBytes << " bytes ("
                  << std::fixed << std::setprecision(1) << compressionRatio << "%)" << std::endl;
+       std::cout << "HPACK requests: " << reqHpack.plainBytes << " -> " << reqHpack.encodedBytes
+                 << " B (ratio " << std::setprecision(3) << reqHpack.Ratio() << ")  responses: "
+                 << respHpack.plainBytes << " -> " << respHpack.encodedBytes
+                 << " B (ratio " << respHpack.Ratio() << ")" << std::endl;
       
        double pageLoadTime = lastRecv - firstSend;
        std::cout << "Page Load Time (onLoad): " << std::fixed << std::setprecision(6) << pageLoadTime << " s" << std::endl;
+       std::cout << "Scheduler: " << dataScheduler.GetName() << " (aging=" << std::setprecision(0) << srptAging << " B/s)" << std::endl;
+       std::cout << "Mean response time: " << std::fixed << std::setprecision(6) << SampleMean(respTimes) << " s" << std::endl;
+       std::cout << "p95 response time: " << std::fixed << std::setprecision(6) << SamplePercentile(respTimes, 95.0) << " s" << std::endl;
        std::cout << "TCP retransmissions: " << g_retxCount
                  << "  rate: " << std::fixed << std::setprecision(3) << (g_retxCount / (totalTime > 0 ? totalTime : 1.0)) << " /s" << std::endl;
        std::cout << "RFC3550 jitter estimate: " << std::fixed << std::setprecision(6) << rfcJitter << " s" << std::endl;
        std::cout << "HoL events: " << holEvents << "  HoL blocked time: " << std::fixed << std::setprecision(6) << holBlockedTime << " s" << std::endl;
+       std::cout << "HoL held bytes: " << rxHol.heldBytes << "  peak: " << rxHol.maxHeldBytes
+                 << " B  byte-seconds: " << std::setprecision(6) << rxHol.byteSeconds
+                 << "  streams affected: " << holStreams << std::endl;
        
-       // TCP级HoL停滞统计
-       double holStall = serverApp->GetHolStallSeconds();
-       double holStallRatio = ( (lastRecv > firstSend) ? (holStall / (lastRecv - firstSend)) : 0.0 );
+       // 发送端停滞：服务器 TCP 发送缓冲满的时间（与上面的接收端 HoL 不同）
+       double sendStall = serverApp->GetSendStallSeconds();
+       double sendStallRatio = ( (lastRecv > firstSend) ? (sendStall / (lastRecv - firstSend)) : 0.0 );
        
-       std::cout << "TCP-level HoL stall time: " << std::fixed << std::setprecision(6)
-                 << holStall << " s  (stall ratio=" << std::setprecision(3)
-                 << (holStallRatio * 100.0) << "%)" << std::endl;
+       std::cout << "Send-buffer stall time: " << std::fixed << std::setprecision(6)
+                 << sendStall << " s  (stall ratio=" << std::setprecision(3)
+                 << (sendStallRatio * 100.0) << "%)" << std::endl;
+       std::cout << "Writer wakeups: " << serverApp->GetWriterWakeups()
+                 << "  wasted: " << serverApp->GetWastedWakeups()
+                 << "  send-buffer waits: " << serverApp->GetBufferWaits() << std::endl;
        
        std::cout << "------------------------------------------" << std::endl;
-   }
-
 
-   flowmon->CheckForLostPackets();
-
-
-   // Report per-flow delay/jitter using FlowMonitor statistics
-   Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-   if (classifier) {
-       const auto& stats = flowmon->GetFlowStats();
-       for (const auto& kv : stats) {
-           uint32_t flowId = kv.first;
-           const FlowMonitor::FlowStats& st = kv.second;
-           Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
-           double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
-           double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
-           std::cout << "Flow " << flowId
-                     << " src=" << t.sourceAddress << ":" << t.sourcePort
-                     << " -> dst=" << t.destinationAddress << ":" << t.destinationPort
-                     << " proto=" << (uint32_t)t.protocol
-                     << " rxPackets=" << st.rxPackets
-                     << " avgDelay=" << avgDelay << " s"
-                     << " avgJitter=" << avgJitter << " s"
-                     << std::endl;
+       results.Metrics().Field("page_load_time_s", pageLoadTime).Field("avg_delay_s", avgDelay)
+                        .Field("mean_response_time_s", SampleMean(respTimes))
+                        .Field("p95_response_time_s", SamplePercentile(respTimes, 95.0))
+                        .Field("downlink_bytes", totalBytesDown).Field("throughput_mbps", throughputDown)
+                        .Field("bidirectional_bytes", totalBytesBi).Field("bidirectional_throughput_mbps", throughputBi)
+                        .Field("hpack_saved_bytes", savedBytes)
+                        .Field("send_buffer_stall_s", sendStall).Field("send_buffer_stall_ratio", sendStallRatio)
+                        .Field("writer_wakeups", serverApp->GetWriterWakeups())
+                        .Field("wasted_wakeups", serverApp->GetWastedWakeups())
+                        .Field("send_buffer_waits", serverApp->GetBufferWaits());
+   }
+   if (!g_workload.Empty()) {
+       CriticalPathInfo cp = g_workload.CriticalPath(2 * Time(delay).GetSeconds(), DataRate(dataRate).GetBitRate() / 8.0);
+       g_workload.PrintCriticalPath(std::cout, cp);
+       results.Metrics().Field("critical_path_s", cp.seconds).Field("critical_path_objects", cp.objects.size())
+                        .Field("critical_path_processing_s", cp.processSeconds)
+                        .Field("workload_plt_s", g_workload.LoadTime());
+   }
+   if (g_arrivals.Active()) {
+       ArrivalStats arrivals;
+       for (auto& client : clients) arrivals.Add(client->GetArrivalStats());
+       arrivals.Print(std::cout, g_arrivals.OfferedRate());
+       arrivals.AddMetrics(results.Metrics(), g_arrivals.OfferedRate());
+   }
+   PrintLatencyPercentiles(GlobalHistograms(), std::cout);
+   GlobalBytes().Print(std::cout);
+   GlobalBytes().AddMetrics(results.Metrics());
+   results.Metrics().Field("completed_responses", totalResps).Field("requested_responses", nRequests)
+                    .Field("retransmissions", g_retxCount).Field("jitter_s", rfcJitter)
+                    .Field("hol_events", holEvents).Field("hol_blocked_time_s", holBlockedTime)
+                    .Field("hol_held_bytes", rxHol.heldBytes).Field("hol_peak_held_bytes", rxHol.maxHeldBytes)
+                    .Field("hol_byte_seconds", rxHol.byteSeconds).Field("hol_streams", holStreams)
+                    .Field("hpack_req_plain_bytes", reqHpack.plainBytes).Field("hpack_req_encoded_bytes", reqHpack.encodedBytes)
+                    .Field("hpack_resp_plain_bytes", respHpack.plainBytes).Field("hpack_resp_encoded_bytes", respHpack.encodedBytes)
+                    .Field("hpack_req_ratio", reqHpack.Ratio()).Field("hpack_resp_ratio", respHpack.Ratio());
+   results.AddLatencyPercentiles(GlobalHistograms());
+   if (profile) runCost.PrintProfile(std::cout);
+   else runCost.Print(std::cout);
+   results.Metrics().Field("sim_events", runCost.GetEvents()).Field("wall_s", runCost.GetWallSeconds())
+                    .Field("peak_rss_kb", PeakRssKb());
+
+
+   if (flowmon) {
+       flowmon->CheckForLostPackets();
+
+
+       // Report per-flow delay/jitter using FlowMonitor statistics
+       Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
+       if (classifier) {
+           const auto& stats = flowmon->GetFlowStats();
+           for (const auto& kv : stats) {
+               uint32_t flowId = kv.first;
+               const FlowMonitor::FlowStats& st = kv.second;
+               Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
+               double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
+               double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
+               std::cout << "Flow " << flowId
+                         << " src=" << t.sourceAddress << ":" << t.sourcePort
+                         << " -> dst=" << t.destinationAddress << ":" << t.destinationPort
+                         << " proto=" << (uint32_t)t.protocol
+                         << " rxPackets=" << st.rxPackets
+                         << " avgDelay=" << avgDelay << " s"
+                         << " avgJitter=" << avgJitter << " s"
+                         << std::endl;
+           }
        }
+       results.AddFlows(flowmon, classifier);
+       if (!flowStatsFile.empty() && !results.WriteFlows(flowStatsFile)) {
+         std::cerr << "Cannot write flow stats to " << flowStatsFile << std::endl;
+      }
+      if (!flowmonXml.empty()) flowmon->SerializeToXmlFile(flowmonXml, true, true);
+   }
+   DumpGlobalTrace(traceFile, "http2", std::cout);
+   if (!sampleFile.empty() && !serverApp->GetSampler().Write(sampleFile)) {
+       std::cerr << "Cannot write samples to " << sampleFile << std::endl;
+   }
+   if (!histFile.empty() && !GlobalHistograms().Save(histFile, "http2")) {
+       std::cerr << "Cannot write histograms to " << histFile << std::endl;
+   }
+   if (!resultsFile.empty()) {
+       if (results.Write(resultsFile)) std::cout << "Results written to " << resultsFile << std::endl;
+       else std::cerr << "Cannot write results to " << resultsFile << std::endl;
    }
-   flowmon->SerializeToXmlFile("flowmon.xml", true, true);
 
 
    Simulator::Destroy();
@@ -72,15 +72,15 @@ def extract_metrics(output):
     if jitter_match:
         metrics["jitter"] = float(jitter_match.group(1))
     
-    # Extract HoL blocking time
-    hol_match = re.search(r"TCP-level HoL stall time: ([\d\.]+) s", output)
-    if hol_match:
-        metrics["hol_stall_time"] = float(hol_match.group(1))
+    # Extract server send-buffer stall time
+    stall_match = re.search(r"Send-buffer stall time: ([\d\.]+) s", output)
+    if stall_match:
+        metrics["send_stall_time"] = float(stall_match.group(1))
     
-    # Extract HoL blocking ratio
-    hol_ratio_match = re.search(r"stall ratio=([\d\.]+)%", output)
-    if hol_ratio_match:
-        metrics["hol_stall_ratio"] = float(hol_ratio_match.group(1))
+    # Extract send-buffer stall ratio
+    stall_ratio_match = re.search(r"stall ratio=([\d\.]+)%", output)
+    if stall_ratio_match:
+        metrics["send_stall_ratio"] = float(stall_ratio_match.group(1))
     
     return metrics
 
@@ -484,24 +484,24 @@ def generate_summary_report(result_dir, all_results):
         
         # Add latency test data table
         f.write("<h3>Latency Test Data</h3>")
-        f.write("<table><tr><th>Delay</th><th>Page Load Time (s)</th><th>Throughput (Mbps)</th><th>Average Request Delay (s)</th><th>HoL Blocking Time (s)</th></tr>")
+        f.write("<table><tr><th>Delay</th><th>Page Load Time (s)</th><th>Throughput (Mbps)</th><th>Average Request Delay (s)</th><th>Send-Buffer Stall Time (s)</th></tr>")
         for result in all_results["latency_test"]:
-            f.write(f"<tr><td>{result['delay']}</td><td>{result.get('page_load_time', 'N/A')}</td><td>{result.get('throughput', 'N/A')}</td><td>{result.get('avg_delay', 'N/A')}</td><td>{result.get('hol_stall_time', 'N/A')}</td></tr>")
+            f.write(f"<tr><td>{result['delay']}</td><td>{result.get('page_load_time', 'N/A')}</td><td>{result.get('throughput', 'N/A')}</td><td>{result.get('avg_delay', 'N/A')}</td><td>{result.get('send_stall_time', 'N/A')}</td></tr>")
         f.write("</table>")
         
         # Add packet loss test data table
         f.write("<h3>Packet Loss Test Data</h3>")
-        f.write("<table><tr><th>Packet Loss Rate</th><th>Page Load Time (s)</th><th>TCP Retransmissions</th><th>HoL Blocking Time (s)</th><th>Throughput (Mbps)</th></tr>")
+        f.write("<table><tr><th>Packet Loss Rate</th><th>Page Load Time (s)</th><th>TCP Retransmissions</th><th>Send-Buffer Stall Time (s)</th><th>Throughput (Mbps)</th></tr>")
         for result in all_results["packet_loss_test"]:
-            f.write(f"<tr><td>{result['error_rate']}</td><td>{result.get('page_load_time', 'N/A')}</td><td>{result.get('tcp_retransmissions', 'N/A')}</td><td>{result.get('hol_stall_time', 'N/A')}</td><td>{result.get('throughput', 'N/A')}</td></tr>")
+            f.write(f"<tr><td>{result['error_rate']}</td><td>{result.get('page_load_time', 'N/A')}</td><td>{result.get('tcp_retransmissions', 'N/A')}</td><td>{result.get('send_stall_time', 'N/A')}</td><td>{result.get('throughput', 'N/A')}</td></tr>")
         f.write("</table>")
         
         # Add concurrent streams test data table
         f.write("<h3>Concurrent Streams Test Data</h3>")
-        f.write("<table><tr><th>Concurrent Streams</th><th>Page Load Time (s)</th><th>Throughput (Mbps)</th><th>Request Completion Rate (%)</th><th>HoL Blocking Ratio (%)</th></tr>")
+        f.write("<table><tr><th>Concurrent Streams</th><th>Page Load Time (s)</th><th>Throughput (Mbps)</th><th>Request Completion Rate (%)</th><th>Send-Buffer Stall Ratio (%)</th></tr>")
         for result in all_results["streams_test"]:
             completion_rate = result.get("completed_responses", 0) / result.get("total_requests", 1) * 100
-            f.write(f"<tr><td>{result['streams']}</td><td>{result.get('page_load_time', 'N/A')}</td><td>{result.get('throughput', 'N/A')}</td><td>{completion_rate:.1f}</td><td>{result.get('hol_stall_ratio', 'N/A')}</td></tr>")
+            f.write(f"<tr><td>{result['streams']}</td><td>{result.get('page_load_time', 'N/A')}</td><td>{result.get('throughput', 'N/A')}</td><td>{completion_rate:.1f}</td><td>{result.get('send_stall_ratio', 'N/A')}</td></tr>")
         f.write("</table>")
         
         f.write("""
@@ -17,6 +17,27 @@
 #include <numeric>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "../common/arrivals.h"
+#include "../common/byte-accounting.h"
+#include "../common/completion-coordinator.h"
+#include "../common/distributions.h"
+#include "../common/event-trace.h"
+#include "../common/hol-ledger.h"
+#include "../common/http-headers.h"
+#include "../common/latency-histogram.h"
+#include "../common/periodic-sampler.h"
+#include "../common/qlog-writer.h"
+#include "../common/qpack.h"
+#include "../common/request-timeline.h"
+#include "../common/run-cost.h"
+#include "../common/sim-log.h"
+#include "../common/sim-results.h"
+#include "../common/sim-stats.h"
+#include "../common/stream-scheduler.h"
+#include "../common/workload.h"
 
 using namespace ns3;
 
@@ -29,7 +50,7 @@ static const uint64_t kQuicMssBytes = 1200; // simulated QUIC datagram payload s
 enum QuicFrameType { QF_STREAM, QF_ACK, QF_PING };
 
 // HTTP/3 Frame Types (reusing H2-like app framing)
-enum FrameType { HEADERS, DATA, PUSH_PROMISE };
+enum FrameType { HEADERS, DATA, PUSH_PROMISE, SETTINGS };
 
 // -------------------- QUIC Frame --------------------
 struct QuicFrame {
@@ -231,6 +252,12 @@ struct HTTP3Frame {
   }
 };
 
+// 应用帧字节记账：帧前缀计 framing，负载按帧类型计 headers / body
+static void CountFrameBytes(uint32_t node, const HTTP3Frame& frame, uint32_t wireSize) {
+  GlobalBytes().Add(node, BYTES_FRAMING, BYTES_DATA, wireSize - frame.payload.size());
+  GlobalBytes().Add(node, frame.type == DATA ? BYTES_BODY : BYTES_HEADERS, BYTES_DATA, frame.payload.size());
+}
+
 // -------------------- Pending Item --------------------
 struct PendingItem {
   uint32_t streamId;
@@ -238,18 +265,23 @@ struct PendingItem {
   uint32_t totalBytes;
   uint32_t sentBytes;   // 新增：严格核对已发送字节数
   uint32_t tickCount;  // 跟踪该流被处理的次数
-  PendingItem(uint32_t sid, uint32_t total) : streamId(sid), remainingBytes(total), totalBytes(total), sentBytes(0), tickCount(0) {}
+  double enqueueTime;  // 入队时间（SRPT aging 使用）
+  uint8_t urgency;     // RFC 9218 urgency，来自请求的 priority 头
+  PendingItem(uint32_t sid, uint32_t total, double enq = 0.0, uint8_t u = 3) : streamId(sid), remainingBytes(total), totalBytes(total), sentBytes(0), tickCount(0), enqueueTime(enq), urgency(u) {}
 };
 
 // -------------------- Globals --------------------
 static std::vector<uint32_t> g_respSizes;
+static Workload g_workload;   // --harFile：按 :path 查对象
+static RequestDistributions g_dists; // --*Dist 抽样（头部大小、思考时间）
+static ArrivalSchedule g_arrivals;   // --arrivalRate / --arrivalTrace 开环到达
 static uint64_t g_retxCount = 0;
 
 // -------------------- QUIC Session --------------------
 class QuicSession : public Object {
 public:
-  QuicSession(Ptr<Socket> udp, bool quiet = false)
-  : m_udp(udp), m_nextPktNum(1), m_mtu(1200), m_largestToAck(0), m_largestAcked(0), m_quiet(quiet) {
+  explicit QuicSession(Ptr<Socket> udp)
+  : m_udp(udp), m_nextPktNum(1), m_mtu(1200), m_largestToAck(0), m_largestAcked(0) {
     m_udp->SetRecvCallback(MakeCallback(&QuicSession::OnUdpRecv, this));
     
     // 初始化拥塞控制参数
@@ -262,9 +294,6 @@ public:
     m_bytesInFlight = 0;
     m_lastLossTs = Seconds(0);
     
-    // ★ 更改 2: 将流量控制窗口从256MB降低到更现实的16MB
-    m_connWindowBytes = 16 * 1024 * 1024;
-    
     // 初始化ACK相关
     m_ackDelay = MilliSeconds(1);     // 最小化ACK延迟 (2ms -> 1ms)
   }
@@ -306,6 +335,20 @@ public:
   // 注册ACK唤醒回调
   void SetWakeupCallback(Callback<void> cb) { m_wakeupCb = cb; }
 
+  // 发送受阻原因；排队的数据包只在 ACK 到达或 pacer 放行时出队
+  enum SendBlock { SEND_OK = 0, BLOCKED_CWND, BLOCKED_PACING, SEND_BLOCK_REASONS };
+
+  // 会话级 pacing：开启后相邻数据包间隔 GetPacingDelay(size)（默认关闭，应用层 SendTick 自行控速）
+  void SetPacingEnabled(bool enabled) { m_pacingEnabled = enabled; }
+  bool HasQueuedFrames() const { return !m_sendQueue.empty(); }
+  size_t GetQueuedPackets() const { return m_sendQueue.size(); }
+  // 队首数据包因某原因受阻的累计时间（含当前未结束的区间）
+  double GetBlockedSeconds(SendBlock why) const {
+    Time t = m_blockedTime[why];
+    if (why == m_blockReason && why != SEND_OK) t += Simulator::Now() - m_blockStart;
+    return t.GetSeconds();
+  }
+
   void SendFrames(const std::vector<QuicFrame>& batch) {
     std::vector<QuicFrame> currentBatch;
     size_t currentSize = 0;
@@ -336,6 +379,7 @@ public:
   }
 
   void OnUdpRecv(Ptr<Socket> s) {
+    SIM_PROFILE_SCOPE("OnUdpRecv (quic)");
     Address from;
     Ptr<Packet> packet;
     while ((packet = s->RecvFrom(from))) {
@@ -346,6 +390,7 @@ public:
       packet->CopyData(reinterpret_cast<uint8_t*>(&data[0]), packet->GetSize());
 
       QuicPacket qp = QuicPacket::Parse(data);
+      if (m_qlog) QlogPacket("transport:packet_received", qp, packet->GetSize());
       ProcessPacket(qp);
     }
   }
@@ -364,8 +409,9 @@ public:
     f.fin = fin;
 
     // 记录发送FIN的情况
-    if (f.fin) std::cout << "[QUIC] SEND FIN sid=" << f.streamId << " pkt=" << m_nextPktNum << std::endl;
+    if (f.fin) SIM_LOG(SIM_LOG_DEBUG, "[QUIC] SEND FIN sid=" << f.streamId << " pkt=" << m_nextPktNum);
 
+    if (m_qlog) QlogDataMoved(sid, f.offset, len, "application", "transport");
     SendFrames({f});
     m_streamOffsets[sid] += len;
   }
@@ -374,12 +420,43 @@ public:
     m_onStreamData = cb;
   }
 
+  // 该流按 offset 重组后按序、恰好一次交付（控制流与 QPACK 编码器/解码器流需要）；
+  // 其余流仍是到达即交付，由应用层按帧自行重组
+  void SetOrderedStream(uint32_t sid) { m_orderedRx[sid]; }
+
+  // 开启本端 qlog（JSON-SEQ）；vantage 为 "client" 或 "server"。文件无法创建时返回 false
+  bool EnableQlog(const std::string& path, const std::string& title, const std::string& vantage) {
+    m_qlog.reset(new QlogWriter);
+    if (!m_qlog->Open(path, title, vantage)) { m_qlog.reset(); return false; }
+    return true;
+  }
+  void CloseQlog() { if (m_qlog) m_qlog->Close(); }
+
 private:
   void SendPacket(const std::vector<QuicFrame>& frames, bool isRetransmission = false) {
     // 判断是否 ACK-only 包
     bool ackOnly = true;
     for (const auto &f : frames) { if (f.type != QF_ACK) { ackOnly = false; break; } }
 
+    // 仅对非重传、非ACK-only的包进行拥塞/pacing 检查；受阻则进入会话发送队列
+    if (!ackOnly && !isRetransmission) {
+      // 已有排队数据包时直接排到队尾，保证 FIFO，不插队
+      if (!m_sendQueue.empty()) {
+        m_sendQueue.push_back(frames);
+        return;
+      }
+      SendBlock why = CheckSendBlock(frames);
+      if (why != SEND_OK) {
+        m_sendQueue.push_back(frames);
+        NoteBlocked(why);
+        return;
+      }
+    }
+    Transmit(frames, ackOnly, isRetransmission);
+  }
+
+  // 分配包号、登记在途并交给 UDP
+  void Transmit(const std::vector<QuicFrame>& frames, bool ackOnly, bool isRetransmission = false) {
     QuicPacket p;
     p.pktNum = m_nextPktNum++;
     p.frames = frames;
@@ -387,40 +464,6 @@ private:
     std::string s = p.Serialize();
     uint32_t sz = s.size();
     
-    // ★ 关键修复 ★
-    // 仅对非重传、非ACK-only的包进行拥塞控制检查
-    if (!ackOnly && !isRetransmission) {
-      if (!CanSend(sz)) {
-        // 限频打印
-        static Time lastLog = Seconds(0);
-        Time now = Simulator::Now();
-        if ((now - lastLog) >= MilliSeconds(1)) {
-          std::cout << "[QUIC] Congestion control blocked: cwnd=" << m_cwnd 
-                    << " bytesInFlight=" << m_bytesInFlight << " need=" << sz << std::endl;
-          lastLog = now;
-        }
-        // 将帧重新排队，RTT驱动退避
-        Time backoff = std::max(MilliSeconds(1), m_srtt > MilliSeconds(0) ? m_srtt/4 : MilliSeconds(2));
-        Simulator::Schedule(backoff, &QuicSession::SendFrames, this, frames);
-        return;
-      }
-    }
-    
-    // 流控检查（对STREAM帧）；ACK-only 不需检查
-    if (!ackOnly) {
-      for (const auto& frame : frames) {
-        if (frame.type == QF_STREAM) {
-          if (!CanSendStreamData(frame.streamId, sz)) {
-            // 流控阻塞，重新排队
-            Time backoff = std::max(MilliSeconds(1), m_srtt > MilliSeconds(0) ? m_srtt/4 : MilliSeconds(2));
-            Simulator::Schedule(backoff, &QuicSession::SendFrames, this, frames);
-            return;
-          }
-          break;  // 只需要检查第一个STREAM帧
-        }
-      }
-    }
-    
     // 只有非 ACK-only 才入未确认表并计入 in-flight
     if (!ackOnly) {
       m_unacked[p.pktNum] = {p, Simulator::Now(), sz};
@@ -428,24 +471,99 @@ private:
       // 启动RTO定时器
       ArmRto();
       ArmPto(); // ★ 新增：启动PTO定时器 ★
+      if (m_pacingEnabled) m_nextSendTime = Simulator::Now() + GetPacingDelay(sz);
     }
     
     Ptr<Packet> udpPkt = Create<Packet>(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+    udpPkt->AddPacketTag(BytePurposeTag(CountPacketBytes(frames, sz, ackOnly, isRetransmission)));
     if (!(m_peer == Address())) m_udp->SendTo(udpPkt, 0, m_peer);
     else                        m_udp->Send(udpPkt);
+    if (m_qlog) QlogPacket("transport:packet_sent", p, sz);
     
     // 添加调试信息（仅对含数据的包）
-    if (!ackOnly && !m_quiet) {
+    if (!ackOnly && SimLogEnabled(SIM_LOG_DEBUG)) {
       for (const auto& f : frames) {
         if (f.type == QF_STREAM) {
-          std::cout << "[QUIC] Sent packet " << p.pktNum << " with STREAM frame for stream " 
-                    << f.streamId << " size=" << f.payload.size() << " fin=" << f.fin 
-                    << " (bytesInFlight=" << m_bytesInFlight << ")" << std::endl;
+          SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Sent packet " << p.pktNum << " with STREAM frame for stream " 
+                                 << f.streamId << " size=" << f.payload.size() << " fin=" << f.fin 
+                                 << " (bytesInFlight=" << m_bytesInFlight << ")");
         }
       }
     }
   }
 
+  // QUIC 层字节记账，返回该包的用途（供链路层 tap 使用）。重传包整包计 quic/retx，
+  // ACK-only 包整包计 quic/ack；否则 STREAM 负载已由应用层计入，其余包头/帧头按用途计入 quic 层，ACK 帧计 ack
+  BytePurpose CountPacketBytes(const std::vector<QuicFrame>& frames, uint32_t sz, bool ackOnly, bool isRetransmission) {
+    uint32_t node = m_udp->GetNode()->GetId();
+    if (isRetransmission || ackOnly) {
+      BytePurpose purpose = isRetransmission ? BYTES_RETX : BYTES_ACK;
+      GlobalBytes().Add(node, BYTES_QUIC, purpose, sz);
+      return purpose;
+    }
+    bool pingOnly = true;
+    uint64_t appBytes = 0, ackBytes = 0;
+    for (const auto& f : frames) {
+      if (f.type != QF_PING) pingOnly = false;
+      if (f.type == QF_STREAM) appBytes += f.payload.size();
+      if (f.type == QF_ACK) {
+        std::string fs = f.Serialize();
+        ackBytes += 6 + std::to_string(fs.size()).size() + fs.size(); // 含 "FLEN:n|" 前缀
+      }
+    }
+    BytePurpose purpose = pingOnly ? BYTES_CONTROL : BYTES_DATA;
+    GlobalBytes().Add(node, BYTES_QUIC, BYTES_ACK, ackBytes);
+    GlobalBytes().Add(node, BYTES_QUIC, purpose, sz - std::min<uint64_t>(sz, appBytes + ackBytes));
+    return purpose;
+  }
+
+  // 判断这一批帧现在能否发出（先拥塞窗口，再 pacing）。不模拟接收端流控
+  // （MAX_DATA / MAX_STREAM_DATA），所以没有流控受阻这一原因
+  SendBlock CheckSendBlock(const std::vector<QuicFrame>& frames) {
+    QuicPacket probe; probe.pktNum = m_nextPktNum; probe.frames = frames;
+    uint32_t sz = static_cast<uint32_t>(probe.Serialize().size());
+    if (!CanSend(sz)) return BLOCKED_CWND;
+    if (m_pacingEnabled && Simulator::Now() < m_nextSendTime) return BLOCKED_PACING;
+    return SEND_OK;
+  }
+
+  // 按 FIFO 发出排队的数据包，直到队首再次受阻
+  void DrainSendQueue() {
+    while (!m_sendQueue.empty()) {
+      SendBlock why = CheckSendBlock(m_sendQueue.front());
+      if (why != SEND_OK) {
+        NoteBlocked(why);
+        return;
+      }
+      std::vector<QuicFrame> frames = std::move(m_sendQueue.front());
+      m_sendQueue.pop_front();
+      Transmit(frames, false);
+    }
+    NoteBlocked(SEND_OK);
+  }
+
+  // 切换当前受阻原因并累计上一段受阻时间；pacing 受阻时只保留一个 pacer 事件
+  void NoteBlocked(SendBlock why) {
+    Time now = Simulator::Now();
+    if (why != m_blockReason) {
+      if (m_blockReason != SEND_OK) m_blockedTime[m_blockReason] += now - m_blockStart;
+      m_blockReason = why;
+      m_blockStart = now;
+      if (why == BLOCKED_CWND) {
+        SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Congestion control blocked: cwnd=" << m_cwnd
+                               << " bytesInFlight=" << m_bytesInFlight << " queued=" << m_sendQueue.size());
+      }
+    }
+    if (why == BLOCKED_PACING && !m_pacerEvent.IsPending()) {
+      m_pacerEvent = Simulator::Schedule(m_nextSendTime - now, &QuicSession::OnPacerRelease, this);
+    }
+  }
+
+  void OnPacerRelease() {
+    DrainSendQueue();
+    if (m_sendQueue.empty() && !m_wakeupCb.IsNull()) m_wakeupCb();
+  }
+
   void ProcessPacket(const QuicPacket& packet) {
     bool ackEliciting = false;
     
@@ -456,15 +574,17 @@ private:
       if (f.type != QF_ACK) ackEliciting = true;
 
       if (f.type == QF_STREAM) {
-        if (!m_quiet) {
-          std::cout << "[QUIC] Received packet " << packet.pktNum << " with STREAM frame for stream " 
-                  << f.streamId << " size=" << f.payload.size() << " fin=" << f.fin << std::endl;
-        }
+        SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Received packet " << packet.pktNum << " with STREAM frame for stream " 
+                               << f.streamId << " size=" << f.payload.size() << " fin=" << f.fin);
         // 记录收到FIN的情况
         if (f.fin) {
-          std::cout << "[QUIC] Received FIN for stream " << f.streamId << " in packet " << packet.pktNum << std::endl;
+          SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Received FIN for stream " << f.streamId << " in packet " << packet.pktNum);
         }
-        if (!m_onStreamData.IsNull()) {
+        if (m_qlog) QlogDataMoved(f.streamId, f.offset, f.payload.size(), "transport", "application");
+        auto ordered = m_orderedRx.find(f.streamId);
+        if (ordered != m_orderedRx.end()) {
+          DeliverInOrder(f, ordered->second);
+        } else if (!m_onStreamData.IsNull()) {
           m_onStreamData(f.streamId,
                          reinterpret_cast<const uint8_t*>(f.payload.data()),
                          f.payload.size(),
@@ -515,6 +635,7 @@ private:
   }
  
   void OnAckReceived(uint64_t largest, const std::string& payloadMaskStr) {
+    SIM_PROFILE_SCOPE("OnAckReceived (quic)");
     // Parse mask (支持累计ACK：空payload表示累计ACK)
     uint64_t mask = 0;
     bool cumulativeAck = payloadMaskStr.empty();
@@ -524,15 +645,18 @@ private:
 
     // RTT from largest if present
     auto itLargest = m_unacked.find(largest);
+    Time latestRtt;
     if (itLargest != m_unacked.end()) {
       Time rtt = Simulator::Now() - itLargest->second.sent;
+      latestRtt = rtt;
+      GlobalHistograms().rtt.Record(rtt.GetNanoSeconds());
       if (m_srtt == MilliSeconds(0)) { m_srtt = rtt; m_rttvar = rtt / 2; }
       else { Time diff = (rtt > m_srtt) ? (rtt - m_srtt) : (m_srtt - rtt); m_rttvar = (3 * m_rttvar + diff) / 4; m_srtt = (7 * m_srtt + rtt) / 8; }
       m_rto = std::max(m_srtt + 4 * m_rttvar, MilliSeconds(100));
-      if (!m_quiet) {
-        std::cout << "[QUIC] RTT update: " << rtt.GetMilliSeconds() << "ms, SRTT: "
-                  << m_srtt.GetMilliSeconds() << "ms, RTO: " << m_rto.GetMilliSeconds() << "ms" << std::endl;
-      }
+      // 与 TCP 探针同格式的 RTT/RTO 记录，便于 TCP/QUIC 叠加对比
+      TraceRttRto(rtt);
+      SIM_LOG(SIM_LOG_DEBUG, "[QUIC] RTT update: " << rtt.GetMilliSeconds() << "ms, SRTT: "
+                             << m_srtt.GetMilliSeconds() << "ms, RTO: " << m_rto.GetMilliSeconds() << "ms");
     }
 
     // Track largest acked for loss heuristics
@@ -558,6 +682,12 @@ private:
       if (it != m_unacked.end()) bytesAcked += it->second.size;
     }
 
+    if (m_qlog && bytesAcked > 0) {
+      std::vector<uint64_t> newlyAcked;
+      for (uint64_t pn : acked) if (m_unacked.count(pn)) newlyAcked.push_back(pn);
+      m_qlog->Event(NowMs(), "recovery:packets_acked", JsonObject().Field("packet_numbers", newlyAcked));
+    }
+
     // 然后再删除这些已确认包并从 bytesInFlight 扣除
     for (uint64_t pn : acked) {
       auto it = m_unacked.find(pn);
@@ -578,9 +708,7 @@ private:
     for (uint64_t pn : to_remove_implicitly) {
         auto it = m_unacked.find(pn);
         if (it != m_unacked.end()) {
-            if (!m_quiet) {
-                std::cout << "[QUIC] Implicitly ACKed and removing stale packet " << pn << std::endl;
-            }
+            SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Implicitly ACKed and removing stale packet " << pn);
             // 从在途字节中减去，并从map中删除
             uint32_t sz = it->second.size;
             m_bytesInFlight = (m_bytesInFlight >= sz ? m_bytesInFlight - sz : 0);
@@ -606,8 +734,8 @@ private:
     // const uint64_t kCwndCap = 256 * kQuicMssBytes;
     // if (m_cwnd > kCwndCap) m_cwnd = kCwndCap;
     // 更详细的ACK日志，包括bytesAcked和重传计数
-    std::cout << "[QUIC] ACK largest=" << largest << " bytesAcked=" << bytesAcked
-              << " cwnd=" << m_cwnd << " inflight=" << m_bytesInFlight << " retx=" << g_retxCount << std::endl;
+    SIM_LOG(SIM_LOG_DEBUG, "[QUIC] ACK largest=" << largest << " bytesAcked=" << bytesAcked
+                           << " cwnd=" << m_cwnd << " inflight=" << m_bytesInFlight << " retx=" << g_retxCount);
 
     // Loss detection by packet threshold (3) with time threshold
     {
@@ -630,8 +758,8 @@ private:
       for (uint64_t pn : toRetx) {
         auto itCheck = m_unacked.find(pn);
         if (itCheck != m_unacked.end()) {
-          std::cout << "[QUIC] Loss pn=" << pn << " -> retransmit as new" << std::endl;
-          Retransmit(pn);
+          SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Loss pn=" << pn << " -> retransmit as new");
+          Retransmit(pn, "reordering_threshold");
         }
       }
       // 拥塞响应：每个RTT最多降低一次，避免连环收缩
@@ -647,6 +775,10 @@ private:
         m_lastLossTs = Simulator::Now();
     }
     }
+    if (m_qlog) {
+      QlogCongestionState();
+      QlogMetrics(latestRtt);
+    }
 
     if (!m_unacked.empty()) {
       ArmRto();
@@ -655,7 +787,8 @@ private:
       if (m_retxTimer.IsPending()) m_retxTimer.Cancel();
       if (m_ptoTimer.IsPending()) m_ptoTimer.Cancel(); // ★ 新增：取消PTO定时器 ★
     }
-    // ACK驱动：收到ACK后尝试唤醒发送方
+    // ACK 时钟：先按 FIFO 发出排队的数据包，再唤醒应用层
+    DrainSendQueue();
     if (!m_wakeupCb.IsNull()) m_wakeupCb();
   }
 
@@ -668,6 +801,30 @@ private:
   std::map<uint64_t, std::pair<QuicPacket, Time>> m_unackedPackets;
   Callback<void, uint32_t, const uint8_t*, uint32_t, bool> m_onStreamData;
 
+  // 按序交付流的接收状态：已交付到的 offset，及其后提前到达的片段
+  struct OrderedRx {
+    uint64_t next = 0;
+    std::map<uint64_t, std::string> pending;
+  };
+  std::map<uint32_t, OrderedRx> m_orderedRx;
+
+  void DeliverInOrder(const QuicFrame& f, OrderedRx& rx) {
+    if (f.offset + f.payload.size() <= rx.next) return; // 重传的重复片段
+    rx.pending.emplace(f.offset, f.payload);
+    while (!rx.pending.empty() && rx.pending.begin()->first <= rx.next) {
+      auto it = rx.pending.begin();
+      uint64_t skip = rx.next - it->first;
+      if (skip < it->second.size()) {
+        std::string chunk = it->second.substr(skip);
+        rx.next += chunk.size();
+        if (!m_onStreamData.IsNull()) {
+          m_onStreamData(f.streamId, reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size(), false);
+        }
+      }
+      rx.pending.erase(it);
+    }
+  }
+
   uint64_t m_largestToAck;
   uint64_t m_largestAcked;
   EventId  m_ackTimer;
@@ -684,10 +841,6 @@ private:
   Time m_rto;                // 重传超时
   uint64_t m_bytesInFlight;  // 在途字节数
   
-  // 流控相关成员
-  uint64_t m_connWindowBytes;      // 连接级流控窗口
-  std::map<uint32_t, uint64_t> m_streamWindows;  // 流级流控窗口
-  
   // 未确认包表
   struct OutPkt { 
     QuicPacket p; 
@@ -701,51 +854,112 @@ private:
   // 发送唤醒回调
   Callback<void> m_wakeupCb;
   
-  // 拥塞控制检查
-  bool CanSend(uint32_t sz) { 
-    return m_bytesInFlight + sz <= m_cwnd; 
+  // 会话发送队列：因拥塞窗口/pacing 受阻的数据包，FIFO
+  std::deque<std::vector<QuicFrame>> m_sendQueue;
+  bool m_pacingEnabled{false};
+  Time m_nextSendTime;       // pacing 允许下一个数据包发出的时间
+  EventId m_pacerEvent;      // 唯一的 pacer 放行事件
+  SendBlock m_blockReason{SEND_OK};
+  Time m_blockStart;
+  Time m_blockedTime[SEND_BLOCK_REASONS];
+
+  // qlog：未开启时为空，所有埋点只做一次指针判断
+  std::unique_ptr<QlogWriter> m_qlog;
+  const char* m_ccState{"slow_start"};
+
+  static double NowMs() { return Simulator::Now().GetSeconds() * 1000.0; }
+
+  static std::string QlogAckRanges(uint64_t largest, const std::string& maskStr) {
+    if (maskStr.empty()) return "[[1," + std::to_string(largest) + "]]";  // 累计ACK
+    uint64_t mask = 0;
+    try { mask = std::stoull(maskStr); } catch (...) { mask = 0; }
+    // bit (i-1) 表示 largest-i 已收到；按降序把连续包号合并成 [lo,hi] 区间
+    std::vector<uint64_t> pns{largest};
+    for (int i = 1; i <= 64 && largest >= static_cast<uint64_t>(i); ++i) {
+      if (mask & (1ULL << (i - 1))) pns.push_back(largest - i);
+    }
+    std::string out = "[";
+    size_t i = 0;
+    while (i < pns.size()) {
+      size_t j = i;
+      while (j + 1 < pns.size() && pns[j + 1] + 1 == pns[j]) ++j;
+      if (out.size() > 1) out += ',';
+      out += "[" + std::to_string(pns[j]) + "," + std::to_string(pns[i]) + "]";
+      i = j + 1;
+    }
+    return out + "]";
   }
-  
-  // 流控检查
-  bool CanSendStreamData(uint32_t streamId, uint32_t sz) {
-    // 检查连接级流控
-    if (m_bytesInFlight + sz > m_connWindowBytes) {
-      if (!m_quiet) {
-        std::cout << "[QUIC] Connection flow control blocked: connWin=" << m_connWindowBytes 
-                  << " bytesInFlight=" << m_bytesInFlight << " need=" << sz << std::endl;
-      }
-      return false;
-    }
-    
-    // 检查流级流控
-    auto it = m_streamWindows.find(streamId);
-    if (it != m_streamWindows.end() && it->second < sz) {
-      if (!m_quiet) {
-        std::cout << "[QUIC] Stream flow control blocked: sid=" << streamId 
-                  << " streamWin=" << it->second << " need=" << sz << std::endl;
-      }
-      return false;
+
+  static JsonObject QlogFrame(const QuicFrame& f) {
+    JsonObject j;
+    switch (f.type) {
+      case QF_STREAM:
+        j.Field("frame_type", "stream").Field("stream_id", f.streamId).Field("offset", f.offset)
+         .Field("length", f.payload.size()).Field("fin", f.fin);
+        break;
+      case QF_ACK:
+        j.Field("frame_type", "ack").Raw("acked_ranges", QlogAckRanges(f.offset, f.payload));
+        break;
+      case QF_PING:
+        j.Field("frame_type", "ping");
+        break;
+    }
+    return j;
+  }
+
+  void QlogPacket(const char* name, const QuicPacket& p, uint32_t size) {
+    std::vector<JsonObject> frames;
+    frames.reserve(p.frames.size());
+    for (const auto& f : p.frames) frames.push_back(QlogFrame(f));
+    JsonObject header;
+    header.Field("packet_type", "1RTT").Field("packet_number", p.pktNum);
+    m_qlog->Event(NowMs(), name, JsonObject().Field("header", header)
+                                           .Field("raw", JsonObject().Field("length", size))
+                                           .Field("frames", frames));
+  }
+
+  void QlogDataMoved(uint32_t sid, uint64_t offset, uint64_t length, const char* from, const char* to) {
+    m_qlog->Event(NowMs(), "transport:data_moved",
+                  JsonObject().Field("stream_id", sid).Field("offset", offset).Field("length", length)
+                            .Field("from", from).Field("to", to));
+  }
+
+  void QlogMetrics(Time latestRtt) {
+    JsonObject m;
+    m.Field("congestion_window", m_cwnd).Field("bytes_in_flight", m_bytesInFlight);
+    if (m_ssthresh != UINT64_MAX) m.Field("ssthresh", m_ssthresh);
+    if (m_srtt > MilliSeconds(0)) {
+      m.Field("smoothed_rtt", m_srtt.GetSeconds() * 1000.0).Field("rtt_variance", m_rttvar.GetSeconds() * 1000.0);
     }
-    
-    return true;
+    if (latestRtt > Time(0)) m.Field("latest_rtt", latestRtt.GetSeconds() * 1000.0);
+    m_qlog->Event(NowMs(), "recovery:metrics_updated", m);
   }
-  
-  // 设置流窗口
-  void SetStreamWindow(uint32_t streamId, uint64_t windowBytes) {
-    m_streamWindows[streamId] = windowBytes;
+
+  // 最近一个 SRTT 内发生过窗口收缩视为 recovery，否则按 cwnd/ssthresh 区分
+  void QlogCongestionState() {
+    const char* next;
+    if (m_lastLossTs > Time(0) && Simulator::Now() - m_lastLossTs < std::max(m_srtt, MilliSeconds(1))) {
+      next = "recovery";
+    } else {
+      next = m_cwnd < m_ssthresh ? "slow_start" : "congestion_avoidance";
+    }
+    if (std::strcmp(next, m_ccState) == 0) return;
+    m_qlog->Event(NowMs(), "recovery:congestion_state_updated",
+                  JsonObject().Field("old", m_ccState).Field("new", next));
+    m_ccState = next;
   }
   
-  // 更新连接窗口
-  void UpdateConnWindow(uint64_t windowBytes) {
-    m_connWindowBytes = windowBytes;
+  // 拥塞控制检查
+  bool CanSend(uint32_t sz) { 
+    return m_bytesInFlight + sz <= m_cwnd; 
   }
   
   // 重传处理
-  void Retransmit(uint64_t pktNum) {
+  void Retransmit(uint64_t pktNum, const char* trigger) {
     // 检测重复重传
     static std::set<uint64_t> retransmitted;
     if (retransmitted.count(pktNum)) {
-      std::cout << "[WARN] Duplicate retransmission of packet " << pktNum << std::endl;
+      SIM_LOG(SIM_LOG_WARN, "[WARN] Duplicate retransmission of packet " << pktNum);
       return;
     }
     retransmitted.insert(pktNum);
@@ -755,6 +969,11 @@ private:
     // Take frames of lost packet
     auto frames = it->second.p.frames;
     uint32_t sz = it->second.size;
+    if (m_qlog) {
+      JsonObject header;
+      header.Field("packet_type", "1RTT").Field("packet_number", pktNum);
+      m_qlog->Event(NowMs(), "recovery:packet_lost", JsonObject().Field("header", header).Field("trigger", trigger));
+    }
 
     // Remove old packet from inflight and table
     m_bytesInFlight = (m_bytesInFlight >= sz ? m_bytesInFlight - sz : 0);
@@ -762,13 +981,22 @@ private:
 
     // Send as a new packet (will assign new pktNum and re-add to unacked)
     g_retxCount++; // 确保重传计数增加
-    if (!m_quiet) {
-      std::cout << "[QUIC] Retransmitting packet " << pktNum << " (total retx: " << g_retxCount << ")" << std::endl;
-    }
+    GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), m_udp->GetNode()->GetId(),
+                          TRACE_QUIC_RETX, 0, sz, pktNum);
+    SIM_LOG(SIM_LOG_DEBUG, "[QUIC] Retransmitting packet " << pktNum << " (total retx: " << g_retxCount << ")");
     // MODIFIED: 调用 SendPacket 时，传入 true 表示这是重传包
     SendPacket(frames, true);
   }
   
+  // RTT 样本（rtt > 0 时）与当前 RTO 写入事件追踪；stream 固定为 0（单连接）
+  void TraceRttRto(Time rtt) {
+    if (!GlobalTracer().IsEnabled()) return;
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    uint32_t node = m_udp->GetNode()->GetId();
+    if (rtt > Time(0)) GlobalTracer().Record(now, node, TRACE_RTT, 0, 0, rtt.GetNanoSeconds());
+    GlobalTracer().Record(now, node, TRACE_RTO, 0, 0, m_rto.GetNanoSeconds());
+  }
+
   void ArmRto() {
     if (m_unacked.empty()) { if (m_retxTimer.IsPending()) m_retxTimer.Cancel(); return; }
     if (!m_retxTimer.IsPending())
@@ -795,9 +1023,7 @@ void OnPto() {
           return; 
       }
       
-      if (!m_quiet) {
-        std::cout << "[QUIC] PTO Fired! Sending a PING frame to elicit an ACK." << std::endl;
-      }
+      SIM_LOG(SIM_LOG_DEBUG, "[QUIC] PTO Fired! Sending a PING frame to elicit an ACK.");
 
       // 1. 创建一个探测帧 (PING)。
       //    PING 帧是 "ack-eliciting"，意味着接收方收到后必须回复一个 ACK。
@@ -834,7 +1060,7 @@ void OnPto() {
     
     // 超时重传最早的包
     auto it = m_unacked.begin();
-    Retransmit(it->first);
+    Retransmit(it->first, "pto_expired");
     
     // 拥塞控制：只在"距离上次收缩 >= SRTT"时收缩一次，且别太狠
     if (m_srtt == MilliSeconds(0) || (Simulator::Now() - m_lastLossTs) >= m_srtt) {
@@ -849,13 +1075,192 @@ void OnPto() {
       m_lastLossTs = Simulator::Now();
     }
     m_rto = std::min(Seconds(3), m_rto*2);
+    TraceRttRto(Time(0));
+    if (m_qlog) {
+      QlogCongestionState();
+      QlogMetrics(Time(0));
+    }
     
     // 重新启动RTO定时器
     ArmRto();
   }
 
   Time m_lastLossTs;  // 上次执行拥塞收缩的时间
-  bool m_quiet{false};  // 添加安静模式标志
+};
+
+// -------------------- HTTP/3 控制流与 QPACK --------------------
+// 每端各开三条单向流：控制流（首帧 SETTINGS）、QPACK 编码器流、QPACK 解码器流。
+// 流号放在 uint32 顶端，避开请求流（1 起）与推送流（1001 起）；末位沿用 QUIC 约定：
+// 2 = 客户端发起的单向流，3 = 服务器发起的单向流
+static const uint32_t kH3UniStreamBase = 0xffffff00;
+enum H3UniStreamType { H3_CONTROL_STREAM = 0x00, H3_QPACK_ENCODER_STREAM = 0x04, H3_QPACK_DECODER_STREAM = 0x08 };
+
+static uint32_t H3UniStreamId(H3UniStreamType type, bool clientInitiated) {
+  return kH3UniStreamBase + type + (clientInitiated ? 2 : 3);
+}
+static bool IsH3UniStream(uint32_t sid) { return sid >= kH3UniStreamBase; }
+
+// SETTINGS：本端 QPACK 解码器允许对端编码器使用的动态表容量与可阻塞流数（RFC 9204 §5）
+struct H3Settings {
+  uint64_t qpackMaxTableCapacity = 0;
+  uint64_t qpackBlockedStreams = 0;
+
+  std::string Serialize() const {
+    std::ostringstream oss;
+    oss << "QPACK_MAX_TABLE_CAPACITY=" << qpackMaxTableCapacity << ";"
+        << "QPACK_BLOCKED_STREAMS=" << qpackBlockedStreams << ";";
+    return oss.str();
+  }
+
+  static H3Settings Parse(const std::string& payload) {
+    H3Settings settings;
+    std::istringstream iss(payload);
+    std::string item;
+    while (std::getline(iss, item, ';')) {
+      size_t eq = item.find('=');
+      if (eq == std::string::npos) continue;
+      std::string name = item.substr(0, eq);
+      try {
+        uint64_t value = std::stoull(item.substr(eq + 1));
+        if (name == "QPACK_MAX_TABLE_CAPACITY") settings.qpackMaxTableCapacity = value;
+        else if (name == "QPACK_BLOCKED_STREAMS") settings.qpackBlockedStreams = value;
+      } catch (...) {
+        NS_LOG_WARN("Ignoring malformed SETTINGS parameter: " << item);
+      }
+    }
+    return settings;
+  }
+};
+
+// 一端的 QPACK 状态：本端编码器（对端 SETTINGS 到达前不用动态表）、本端解码器，
+// 以及三条单向流的收发。三条流都由 QuicSession 按序交付，所以编码器流指令按发送顺序
+// 生效：携带新条目的包丢失时，引用它的 HEADERS 要等重传到达才能解码（QPACK 的队头阻塞）
+class QpackChannel {
+public:
+  // 会话创建后调用；对端的三条单向流登记为按序交付
+  void Setup(Ptr<QuicSession> session, bool isClient, uint32_t node,
+             uint64_t maxTableCapacity, uint64_t blockedStreams, bool huffman) {
+    m_session = session; m_isClient = isClient; m_node = node; m_open = false;
+    m_local.qpackMaxTableCapacity = maxTableCapacity;
+    m_local.qpackBlockedStreams = blockedStreams;
+    m_encoder = QpackEncoder(huffman);
+    m_decoder = QpackDecoder(maxTableCapacity, blockedStreams);
+    m_controlBuf.clear();
+    m_settingsReceived = false;
+    m_session->SetOrderedStream(H3UniStreamId(H3_CONTROL_STREAM, !isClient));
+    m_session->SetOrderedStream(H3UniStreamId(H3_QPACK_ENCODER_STREAM, !isClient));
+    m_session->SetOrderedStream(H3UniStreamId(H3_QPACK_DECODER_STREAM, !isClient));
+  }
+
+  // 阻塞的字段段解码后回调 (streamId, headers, 阻塞秒数)
+  void SetUnblockedCallback(Callback<void, uint32_t, const HttpHeaderList&, double> cb) { m_onUnblocked = cb; }
+
+  // 编码请求/响应流上的字段段；新增条目的编码器流指令先于该段发出
+  std::string Encode(uint32_t sid, const HttpHeaderList& headers, bool allowDynamic = true) {
+    EnsureOpen();
+    std::string section = m_encoder.Encode(sid, headers, allowDynamic);
+    FlushEncoderStream();
+    return section;
+  }
+
+  QpackDecoder::Result Decode(uint32_t sid, const std::string& section, HttpHeaderList& headers) {
+    EnsureOpen();
+    QpackDecoder::Result r = m_decoder.Decode(sid, section, headers, Simulator::Now().GetSeconds());
+    FlushDecoderStream();
+    return r;
+  }
+
+  // 对端单向流上的数据（已按序）
+  void OnUniStreamData(uint32_t sid, const uint8_t* data, uint32_t len) {
+    std::string bytes(reinterpret_cast<const char*>(data), len);
+    if (sid == H3UniStreamId(H3_CONTROL_STREAM, !m_isClient)) {
+      m_controlBuf += bytes;
+      OnControlStream();
+    } else if (sid == H3UniStreamId(H3_QPACK_ENCODER_STREAM, !m_isClient)) {
+      std::vector<QpackDecoder::Unblocked> unblocked;
+      if (!m_decoder.OnEncoderStream(bytes, Simulator::Now().GetSeconds(), unblocked)) {
+        SIM_LOG(SIM_LOG_ERROR, "[ERROR] QPACK encoder stream error");
+      }
+      FlushDecoderStream();
+      for (const QpackDecoder::Unblocked& u : unblocked) {
+        SIM_LOG(SIM_LOG_DEBUG, "[QPACK] HEADERS unblocked on stream " << u.streamId
+                               << " after " << u.blockedSeconds << " s");
+        if (!m_onUnblocked.IsNull()) m_onUnblocked(u.streamId, u.headers, u.blockedSeconds);
+      }
+    } else if (sid == H3UniStreamId(H3_QPACK_DECODER_STREAM, !m_isClient)) {
+      if (!m_encoder.OnDecoderStream(bytes)) SIM_LOG(SIM_LOG_ERROR, "[ERROR] QPACK decoder stream error");
+    }
+  }
+
+  const QpackStats& GetEncoderStats() const { return m_encoder.GetStats(); }
+  const QpackDecoderStats& GetDecoderStats() const { return m_decoder.GetStats(); }
+
+private:
+  // 首次编解码时再打开本端单向流并发 SETTINGS：服务器要等收到客户端数据后才知道对端地址
+  void EnsureOpen() {
+    if (m_open) return;
+    m_open = true;
+    for (H3UniStreamType t : {H3_CONTROL_STREAM, H3_QPACK_ENCODER_STREAM, H3_QPACK_DECODER_STREAM}) {
+      m_session->OpenStream(H3UniStreamId(t, m_isClient));
+    }
+    HTTP3Frame settings;
+    settings.streamId = H3UniStreamId(H3_CONTROL_STREAM, m_isClient);
+    settings.type = SETTINGS;
+    settings.payload = m_local.Serialize();
+    settings.length = settings.payload.size();
+    std::string ss = settings.Serialize();
+    m_session->SendStreamData(settings.streamId, reinterpret_cast<const uint8_t*>(ss.data()), ss.size(), false);
+    GlobalBytes().Add(m_node, BYTES_FRAMING, BYTES_CONTROL, ss.size());
+  }
+
+  // 控制流只承载一个 SETTINGS 帧
+  void OnControlStream() {
+    if (m_settingsReceived) return;
+    size_t lenStart = m_controlBuf.find("LEN:");
+    size_t lenEnd = lenStart == std::string::npos ? std::string::npos : m_controlBuf.find('|', lenStart);
+    size_t offEnd = lenEnd == std::string::npos ? std::string::npos : m_controlBuf.find('|', lenEnd + 1);
+    if (offEnd == std::string::npos) return;
+    uint32_t len = 0;
+    try { len = std::stoul(m_controlBuf.substr(lenStart + 4, lenEnd - lenStart - 4)); } catch (...) { return; }
+    if (m_controlBuf.size() < offEnd + 1 + len) return;
+    HTTP3Frame f = HTTP3Frame::Parse(m_controlBuf);
+    if (f.type != SETTINGS) {
+      SIM_LOG(SIM_LOG_ERROR, "[ERROR] First frame on the control stream is not SETTINGS");
+      return;
+    }
+    m_settingsReceived = true;
+    H3Settings peer = H3Settings::Parse(f.payload);
+    SIM_LOG(SIM_LOG_DEBUG, "[QPACK] Peer SETTINGS: " << f.payload);
+    m_encoder.SetPeerSettings(peer.qpackMaxTableCapacity, peer.qpackBlockedStreams);
+    FlushEncoderStream();
+  }
+
+  void FlushEncoderStream() {
+    std::string bytes = m_encoder.TakeEncoderStream();
+    if (!bytes.empty()) SendUni(H3_QPACK_ENCODER_STREAM, bytes, BYTES_DATA);
+  }
+  void FlushDecoderStream() {
+    std::string bytes = m_decoder.TakeDecoderStream();
+    if (!bytes.empty()) SendUni(H3_QPACK_DECODER_STREAM, bytes, BYTES_CONTROL);
+  }
+  // 编码器/解码器流直接承载 QPACK 指令（无 HTTP/3 帧），计入 headers 层
+  void SendUni(H3UniStreamType type, const std::string& bytes, BytePurpose purpose) {
+    EnsureOpen();
+    m_session->SendStreamData(H3UniStreamId(type, m_isClient), reinterpret_cast<const uint8_t*>(bytes.data()),
+                              bytes.size(), false);
+    GlobalBytes().Add(m_node, BYTES_HEADERS, purpose, bytes.size());
+  }
+
+  Ptr<QuicSession> m_session;
+  bool m_isClient{true};
+  uint32_t m_node{0};
+  bool m_open{false};
+  bool m_settingsReceived{false};
+  H3Settings m_local;
+  QpackEncoder m_encoder;
+  QpackDecoder m_decoder;
+  std::string m_controlBuf;
+  Callback<void, uint32_t, const HttpHeaderList&, double> m_onUnblocked;
 };
 
 // -------------------- HTTP/3 Client --------------------
@@ -863,21 +1268,54 @@ class Http3ClientApp : public Application {
 public:
   Http3ClientApp() : m_socket(0), m_port(0) {}
   // ★ 更改 4a: 在Setup方法中增加一个Time类型的参数来接收链路延迟
-  void Setup(Address servAddr, uint16_t port, uint32_t reqSize, uint32_t nReqs, double interval, bool thirdParty, uint32_t nStreams, Time linkDelay, bool quiet = false) {
+  void Setup(Address servAddr, uint16_t port, uint32_t reqSize, uint32_t nReqs, double interval, bool thirdParty, uint32_t nStreams, Time linkDelay) {
     m_servAddr = servAddr; m_port = port; m_reqSize = reqSize; m_nReqs = nReqs;
     m_interval = interval; m_thirdParty = thirdParty; m_nStreams = nStreams;
     m_linkDelay = linkDelay; // 存储延迟值
-    m_quiet = quiet;
   }
   // ★ 兼容重载：保留旧签名，默认 linkDelay=0ms
-  void Setup(Address servAddr, uint16_t port, uint32_t reqSize, uint32_t nReqs, double interval, bool thirdParty, uint32_t nStreams, bool quiet = false) {
-    Setup(servAddr, port, reqSize, nReqs, interval, thirdParty, nStreams, MilliSeconds(0), quiet);
+  void Setup(Address servAddr, uint16_t port, uint32_t reqSize, uint32_t nReqs, double interval, bool thirdParty, uint32_t nStreams) {
+    Setup(servAddr, port, reqSize, nReqs, interval, thirdParty, nStreams, MilliSeconds(0));
   }
 
   uint32_t GetRespsRcvd() const { return m_respsRcvd; }
+  uint64_t GetDoneBytes() const { return m_doneBytes; }  // 已完成响应的响应体字节
   const std::vector<double>& GetReqSendTimes() const { return m_reqSendTimes; }
   const std::vector<double>& GetRespRecvTimes() const { return m_respRecvTimes; }
+  // Per-request response times (request sent -> response complete), in completion order
+  const std::vector<double>& GetResponseTimes() const { return m_respTimes; }
+  const RequestTimeline& GetTimeline() const { return m_timeline; }
+  // 流级 HoL：各流缺口统计之和（episodes = 缺口次数，seconds = 各流阻塞时间之和）
+  RxHolStats GetStreamHolStats() const {
+    RxHolStats sum;
+    for (const auto& kv : m_streamHol) sum.Add(kv.second.GetStats(Simulator::Now().GetSeconds()));
+    return sum;
+  }
+  // 连接级 HoL：至少一个流有数据等在缺口后的次数/时间/峰值字节（与 TCP 乱序缓冲口径一致）
+  RxHolStats GetConnHolStats() const {
+    RxHolStats s = m_connHol;
+    if (m_connBlockedSince >= 0) s.seconds += Simulator::Now().GetSeconds() - m_connBlockedSince;
+    return s;
+  }
   double GetInterval() const { return m_interval; }
+  // Invoked once when the last of m_nReqs responses has completed
+  void SetDoneCallback(Callback<void> cb) { m_doneCallback = cb; }
+  // 本端 qlog 输出路径（空 = 不记录），在 StartApplication 创建会话时生效
+  void SetQlogFile(const std::string& path) { m_qlogFile = path; }
+  void CloseQlog() { if (m_session) m_session->CloseQlog(); }
+  // 本端 SETTINGS_QPACK_MAX_TABLE_CAPACITY / SETTINGS_QPACK_BLOCKED_STREAMS 与 Huffman 编码
+  void SetQpack(uint32_t tableCapacity, uint32_t blockedStreams, bool huffman) {
+    m_qpackCapacity = tableCapacity; m_qpackBlocked = blockedStreams; m_qpackHuffman = huffman;
+  }
+  const QpackStats& GetQpackStats() const { return m_qpack.GetEncoderStats(); }
+  const QpackDecoderStats& GetQpackDecoderStats() const { return m_qpack.GetDecoderStats(); }
+  // 按工作负载回放：第 i 个请求取对象 ids[i]，不早于其 startOffset 发出
+  void SetWorkload(Workload* workload, std::vector<uint32_t> ids) { m_workload.Assign(workload, ids); }
+  // 开环：请求在启动后 offsets 时刻到达，在至多 maxBacklog 个（0 = 不限）的积压中等空闲流名额
+  void SetArrivals(std::vector<double> offsets, uint32_t maxBacklog) { m_arrivals.Assign(offsets, maxBacklog); }
+  ArrivalStats GetArrivalStats() const { return m_arrivals.GetStats(); }
+  // 第 index 条连接（共 nConns 条）：第 k 个请求的全局请求号为 k * nConns + index
+  void SetConnection(uint32_t index, uint32_t nConns) { m_connIndex = index; m_nConns = nConns; }
 
   // push stats
   uint32_t GetPushStreams() const { return m_pushStreams; }
@@ -893,8 +1331,8 @@ public:
         if (targetIt != m_streamTargetBytes.end()) {
           uint64_t target = targetIt->second;
           if (target != receivedBytes) {
-            std::cout << "[ERROR] Data Integrity Fail on Stream " << sid
-                      << ": Expected " << target << ", Got " << receivedBytes << std::endl;
+            SIM_LOG(SIM_LOG_ERROR, "[ERROR] Data Integrity Fail on Stream " << sid
+                                   << ": Expected " << target << ", Got " << receivedBytes);
           }
         }
       }
@@ -905,11 +1343,26 @@ private:
   void StartApplication() override {
     m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
     m_socket->Connect(InetSocketAddress(Ipv4Address::ConvertFrom(m_servAddr), m_port));
-    m_session = CreateObject<QuicSession>(m_socket, m_quiet);  // 传递quiet参数
+    m_session = CreateObject<QuicSession>(m_socket);
+    if (!m_qlogFile.empty() && !m_session->EnableQlog(m_qlogFile, "http3 client", "client")) {
+      std::cerr << "Cannot open qlog file " << m_qlogFile << std::endl;
+    }
     m_session->SetStreamDataCallback(MakeCallback(&Http3ClientApp::OnStreamData, this));
+    m_qpack.Setup(m_session, true, GetNode()->GetId(), m_qpackCapacity, m_qpackBlocked, m_qpackHuffman);
+    m_qpack.SetUnblockedCallback(MakeCallback(&Http3ClientApp::OnHeadersUnblocked, this));
+    m_headersSeen.clear();
 
     m_reqsSent = m_respsRcvd = 0;
-    m_reqSendTimes.clear(); m_respRecvTimes.clear();
+    m_doneBytes = 0;
+    m_reqSendTimes.clear(); m_respRecvTimes.clear(); m_respTimes.clear(); m_streamReqIndex.clear();
+    m_firstByteTime.clear();
+    m_timeline.Clear();
+    m_workload.Start(Simulator::Now().GetSeconds());
+    m_workload.SetWaker([this] { Simulator::ScheduleNow(&Http3ClientApp::PumpWorkload, this); });
+    if (m_nReqs > 0 && !m_arrivals.Active()) m_timeline.MarkQueued(0, m_workload.QueueTime(0, Simulator::Now().GetSeconds()));
+    // 握手完成前到达的请求留在积压中
+    m_handshakeDone = false;
+    m_arrivals.Start([this] { PumpArrivals(); });
     m_rxBuf.clear(); m_streamBytes.clear(); m_streamTargetBytes.clear(); m_streamCompleted.clear();
     m_streamDataFrames.clear();  // 新增
     m_pushBytes.clear(); m_pushTargetBytes.clear(); m_pushCompleted=0; m_pushStreams=0;
@@ -923,19 +1376,28 @@ private:
     // 握手时间约等于一个往返时间(RTT)，即2倍的单向链路延迟
     double handshakeDelay = 2 * m_linkDelay.GetSeconds();
     
-    if (!m_quiet) {
-      std::cout << "[QUIC] Link one-way delay: " << m_linkDelay.GetMilliSeconds() << "ms, simulating 1-RTT handshake delay of: " 
-                << (handshakeDelay * 1000) << "ms" << std::endl;
-    }
+    SIM_LOG(SIM_LOG_INFO, "[QUIC] Link one-way delay: " << m_linkDelay.GetMilliSeconds() << "ms, simulating 1-RTT handshake delay of: " 
+                          << (handshakeDelay * 1000) << "ms");
     
     // 延迟发送第一个请求，模拟握手过程
     Simulator::Schedule(Seconds(handshakeDelay), &Http3ClientApp::SendNextRequest, this);
   }
 
-  void StopApplication() override { if (m_socket) m_socket->Close(); }
+  void StopApplication() override {
+    Simulator::Cancel(m_deferredSend);
+    m_workload.ClearWaker();
+    m_arrivals.Stop();
+    if (m_socket) m_socket->Close();
+  }
 
   // 原来的 SendNextRequest 改名为 StartRequests，在开始时调用
   void SendNextRequest() {
+    if (m_arrivals.Active()) {
+      // 开环：握手完成，发出积压中的请求
+      m_handshakeDone = true;
+      PumpArrivals();
+      return;
+    }
     uint32_t reqsToSend = std::min(m_nReqs - m_reqsSent, m_nStreams);
     for (uint32_t i = 0; i < reqsToSend; ++i) {
       SendSingleRequest();
@@ -943,12 +1405,15 @@ private:
   }
 
   void OnStreamData(uint32_t streamId, const uint8_t* data, uint32_t len, bool fin) {
+    SIM_PROFILE_SCOPE("OnStreamData (client)");
+    if (IsH3UniStream(streamId)) {
+      m_qpack.OnUniStreamData(streamId, data, len);
+      return;
+    }
     // ① 先把数据追加到该流的专属缓冲
     std::string& buf = m_rxBuf[streamId];
     buf.append(reinterpret_cast<const char*>(data), len);
-    if (!m_quiet) { // 已有
-      std::cout << "[DEBUG] Stream " << streamId << " buffer size: " << buf.size() << " after adding " << len << " bytes" << std::endl;
-    }
+    SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Stream " << streamId << " buffer size: " << buf.size() << " after adding " << len << " bytes");
 
     // ② 在该流的缓冲里，用 LEN: 精确切帧
     size_t pos = 0;
@@ -981,13 +1446,11 @@ private:
       std::string frameData = buf.substr(frameStart, payloadStart - frameStart + frameLen);
       
       // MODIFIED: Wrap the log
-      if (!m_quiet) {
-        std::cout << "[DEBUG] Parsing frame: start=" << frameStart 
-                  << " payloadStart=" << payloadStart 
-                  << " frameLen=" << frameLen 
-                  << " actualSize=" << frameData.size() 
-                  << " for stream " << streamId << std::endl;
-      }
+      SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Parsing frame: start=" << frameStart 
+                             << " payloadStart=" << payloadStart 
+                             << " frameLen=" << frameLen 
+                             << " actualSize=" << frameData.size() 
+                             << " for stream " << streamId);
       ProcessFrame(streamId, frameData);
 
       pos = frameStart + frameData.size();
@@ -996,9 +1459,7 @@ private:
     // ③ 丢掉已消费的前缀，留下不完整的尾巴
     if (pos > 0) {
       // MODIFIED: Wrap the log
-      if (!m_quiet) {
-        std::cout << "[DEBUG] Stream " << streamId << " removing " << pos << " bytes, remaining: " << (buf.size() - pos) << std::endl;
-      }
+      SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Stream " << streamId << " removing " << pos << " bytes, remaining: " << (buf.size() - pos));
       buf.erase(0, pos);
     }
 
@@ -1008,15 +1469,13 @@ private:
         uint64_t have = BytesReceived(streamId);
         uint64_t need = m_streamTargetBytes[streamId];
         if (have < need) {
-          std::cout << "[WARN] FIN before target on stream " << streamId
-                    << " got=" << have
-                    << " need=" << need << "\n";
+          SIM_LOG(SIM_LOG_WARN, "[WARN] FIN before target on stream " << streamId
+                                << " got=" << have
+                                << " need=" << need);
         }
       }
       // MODIFIED: Wrap the log
-      if (!m_quiet) {
-        std::cout << "[DEBUG] Received FIN for stream " << streamId << std::endl;
-      }
+      SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Received FIN for stream " << streamId);
       CheckStreamCompletion(streamId);
     }
   }
@@ -1030,34 +1489,28 @@ private:
 
       // 仅用于调试：如果帧内 SID 与外层不一致，打印一下，便于排查
       if (f.streamId != 0 && f.streamId != quicSid) {
-        std::cout << "[WARN] HTTP3 SID(" << f.streamId
-                  << ") != QUIC SID(" << quicSid << "), using QUIC SID" << std::endl;
+        SIM_LOG(SIM_LOG_WARN, "[WARN] HTTP3 SID(" << f.streamId
+                              << ") != QUIC SID(" << quicSid << "), using QUIC SID");
       }
 
-      bool isPush = (sid >= 1000) || (f.payload.find("x-push: 1") != std::string::npos);
+      bool isPush = (sid >= 1000);
 
       if (f.type == HEADERS) {
         // MODIFIED: Wrap the log
-        if (!m_quiet) {
-          std::cout << "[DEBUG] Received HEADERS for stream " << sid << std::endl;
+        SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Received HEADERS for stream " << sid);
+        // 重传可能再次交付同一 HEADERS；字段段只解码一次（每次解码都会确认）
+        if (!m_headersSeen.insert(sid).second) return;
+        HttpHeaderList headers;
+        QpackDecoder::Result r = m_qpack.Decode(sid, f.payload, headers);
+        if (r == QpackDecoder::QPACK_BLOCKED) {
+          SIM_LOG(SIM_LOG_DEBUG, "[QPACK] HEADERS on stream " << sid << " blocked on the encoder stream");
+          return; // 编码器流追上后由 OnHeadersUnblocked 继续
         }
-        size_t p = f.payload.find("Content-Length: ");
-        if (p != std::string::npos) {
-          size_t e = f.payload.find("\r\n", p);
-          uint32_t len = std::stoi(f.payload.substr(p + 16, e - (p + 16)));
-          if (isPush) {
-            m_pushTargetBytes[sid] = len; m_pushBytes[sid] = 0; ++m_pushStreams;
-          } else {
-            m_streamTargetBytes[sid] = len; m_streamBytes[sid] = 0;
-            // MODIFIED: Wrap the log
-            if (!m_quiet) {
-              std::cout << "[DEBUG] Set target for stream " << sid << ": " << len << " bytes" << std::endl;
-            }
-          }
-        } else {
-          // 健壮性检查：若没解析到Content-Length，立刻报警
-          std::cout << "[ERROR] No Content-Length in HEADERS (sid=" << sid << "), payload: " << f.payload << std::endl;
+        if (r == QpackDecoder::QPACK_FAILED) {
+          SIM_LOG(SIM_LOG_ERROR, "[ERROR] QPACK decompression failed (sid=" << sid << ")");
+          return;
         }
+        OnResponseHeaders(sid, headers);
         return;
       }
 
@@ -1068,8 +1521,8 @@ private:
 
         // 额外稳固：检查LEN字段与payload大小的一致性
         if (f.length != f.payload.size()) {
-          std::cout << "[WARN] Stream " << sid << " LEN(" << f.length 
-                    << ") != payload.size(" << f.payload.size() << "), using LEN" << std::endl;
+          SIM_LOG(SIM_LOG_WARN, "[WARN] Stream " << sid << " LEN(" << f.length 
+                                << ") != payload.size(" << f.payload.size() << "), using LEN");
         }
 
         if (isPush || m_pushTargetBytes.count(sid)) {
@@ -1081,34 +1534,41 @@ private:
           return;
         }
 
-        // 健壮性检查：若没收到HEADERS就收到DATA，给出警告
-        if (!m_streamTargetBytes.count(sid)) {
-          std::cout << "[WARN] DATA before Content-Length (sid=" << sid << "), dataLen=" << dataLen << std::endl;
+        // 健壮性检查：若没收到HEADERS就收到DATA，给出警告（HEADERS 在等编码器流时不算）
+        if (!m_streamTargetBytes.count(sid) && !m_headersSeen.count(sid)) {
+          SIM_LOG(SIM_LOG_WARN, "[WARN] DATA before Content-Length (sid=" << sid << "), dataLen=" << dataLen);
         }
 
         // 使用offset进行流重组
         MarkReceived(sid, dataOffset, dataLen);
+        auto target = m_streamTargetBytes.find(sid);
+        TrackGap(sid, dataOffset, dataLen);
+        auto ri = m_streamReqIndex.find(sid);
+        if (ri != m_streamReqIndex.end() && dataLen > 0) {
+          m_timeline.MarkFirstData(ri->second, Simulator::Now().GetSeconds());
+        }
         
+        // HEADERS 还在等编码器流：目标未知，由 OnResponseHeaders 收尾
+        if (target == m_streamTargetBytes.end()) return;
+
         // 按缺口"催一下"重传
-        if (!HasFullPrefix(sid, m_streamTargetBytes[sid])) {
+        if (!HasFullPrefix(sid, target->second)) {
           QuicFrame ack; ack.type = QF_ACK; ack.offset = 0; ack.payload = ""; // 累计ACK
           m_session->SendFrames({ack});
         }
         
         // 检查是否完成
         uint64_t have = BytesReceived(sid);
-        uint64_t need = m_streamTargetBytes[sid];
+        uint64_t need = target->second;
         
-        if (need > 0 && HasFullPrefix(sid, need)) {
+        if (HasFullPrefix(sid, need)) {
           Complete(sid);
         } else {
           // MODIFIED: Wrap the log
-          if (!m_quiet) {
-            // 调试信息：显示流进度
-            std::cout << "[DEBUG] Stream " << sid << " received DATA: offset=" << dataOffset 
-                      << " len=" << dataLen << " total: " << have << "/" << need 
-                      << " bytes" << std::endl;
-          }
+          // 调试信息：显示流进度
+          SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Stream " << sid << " received DATA: offset=" << dataOffset 
+                                 << " len=" << dataLen << " total: " << have << "/" << need 
+                                 << " bytes");
         }
       }
     } catch (const std::exception& e) {
@@ -1116,63 +1576,167 @@ private:
     }
   }
 
+  // 已解码的响应头：登记 Content-Length 目标，推送流另记
+  void OnResponseHeaders(uint32_t sid, const HttpHeaderList& headers) {
+    bool isPush = (sid >= 1000) || FindHeader(headers, "x-push") == "1";
+    std::string contentLength = FindHeader(headers, "content-length");
+    if (contentLength.empty()) {
+      // 健壮性检查：若没解析到Content-Length，立刻报警
+      SIM_LOG(SIM_LOG_ERROR, "[ERROR] No content-length in HEADERS (sid=" << sid << ")");
+      return;
+    }
+    uint32_t len = std::stoul(contentLength);
+    if (isPush) {
+      m_pushTargetBytes[sid] = len; m_pushBytes.emplace(sid, 0); ++m_pushStreams;
+      return;
+    }
+    m_streamTargetBytes[sid] = len; m_streamBytes[sid] = 0;
+    if (!m_firstByteTime.count(sid)) {
+      m_firstByteTime[sid] = Simulator::Now().GetSeconds();
+      auto ri = m_streamReqIndex.find(sid);
+      if (ri != m_streamReqIndex.end() && ri->second < m_reqSendTimes.size()) {
+        GlobalHistograms().ttfb.RecordSeconds(m_firstByteTime[sid] - m_reqSendTimes[ri->second]);
+        m_timeline.MarkHeaders(ri->second, len, m_firstByteTime[sid]);
+      }
+    }
+    // MODIFIED: Wrap the log
+    SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Set target for stream " << sid << ": " << len << " bytes");
+    // 头部阻塞期间响应体可能已经收齐；Content-Length 为 0 时 HEADERS 即完成（同 HTTP/2 的 END_STREAM）
+    if (HasFullPrefix(sid, len)) Complete(sid);
+  }
+
+  void OnHeadersUnblocked(uint32_t sid, const HttpHeaderList& headers, double blockedSeconds) {
+    auto ri = m_streamReqIndex.find(sid);
+    if (ri != m_streamReqIndex.end()) m_timeline.AddHeaderBlocked(ri->second, blockedSeconds);
+    OnResponseHeaders(sid, headers);
+  }
+
   void CheckStreamCompletion(uint32_t streamId) {
     if (!m_streamTargetBytes.count(streamId)) return;
     uint64_t need = m_streamTargetBytes[streamId];
     uint64_t have = BytesReceived(streamId);
-    if (need > 0 && HasFullPrefix(streamId, need) && !m_streamCompleted[streamId]) {
+    if (HasFullPrefix(streamId, need) && !m_streamCompleted[streamId]) {
       m_streamCompleted[streamId] = true;
+      RecordStreamHol(streamId);
       ++m_respsRcvd;
+      m_doneBytes += need;
       m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
-      if (!m_quiet) {
-        std::cout << "[DEBUG] Stream " << streamId << " completed! Total: " << m_respsRcvd << "/" << m_nReqs << std::endl;
-      }
+      RecordResponseTime(streamId);
+      GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), GetNode()->GetId(),
+                            TRACE_STREAM_DONE, streamId, need);
+      SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Stream " << streamId << " completed! Total: " << m_respsRcvd << "/" << m_nReqs);
       
       // ★ 关键修复 ★
       // 如果还有请求需要发送，立即发送下一个，而不是等待
-      if (m_respsRcvd < m_nReqs && m_reqsSent < m_nReqs) {
-        SendSingleRequest();
+      if (m_arrivals.Active()) {
+        // 开环：空出的名额交给积压中的请求，没有思考时间
+        PumpArrivals();
+      } else if (m_respsRcvd < m_nReqs && m_reqsSent < m_nReqs) {
+        if (g_dists.HasThinkTimes()) {
+          // --thinkDist：下一个请求在思考时间之后发出
+          Simulator::Schedule(Seconds(g_dists.ThinkSeconds(GlobalRequestId(m_connIndex, m_nConns, m_respsRcvd - 1), 0.0)), &Http3ClientApp::SendSingleRequest, this);
+        } else {
+          SendSingleRequest();
+        }
       }
-    } else if (!m_quiet) {
-      std::cout << "[DEBUG] Stream " << streamId << " progress: " 
-              << have << "/" << need 
-                << " bytes" << std::endl;
+      NotifyIfDone();
+    } else {
+      SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Stream " << streamId << " progress: " 
+                             << have << "/" << need << " bytes");
     }
   }
   
   // ★ 新增一个辅助函数 ★
   void SendSingleRequest() {
     if (m_reqsSent >= m_nReqs) return;
+    if (m_workload.Active()) {
+      PumpWorkload();
+      return;
+    }
+    IssueRequest();
+  }
 
+  // 回放：空闲名额内按序发出已到期的请求；下一个未到期时定时再来，依赖未到齐时等 waker
+  void PumpWorkload() {
+    while (m_reqsSent < m_nReqs && m_reqsSent - m_respsRcvd < m_nStreams) {
+      double now = Simulator::Now().GetSeconds();
+      double wait = m_workload.Wait(m_reqsSent, now);
+      if (wait > 0) {
+        m_timeline.MarkQueued(m_reqsSent, m_workload.QueueTime(m_reqsSent, now));
+        if (std::isfinite(wait) && !m_deferredSend.IsPending()) {
+          m_deferredSend = Simulator::Schedule(Seconds(wait), &Http3ClientApp::PumpWorkload, this);
+        }
+        return;
+      }
+      IssueRequest();
+    }
+  }
+
+  // 开环：空闲名额内按到达顺序发出积压中的请求；积压为空时由下一个到达唤醒
+  void PumpArrivals() {
+    while (m_handshakeDone && !m_arrivals.Empty() && m_reqsSent - m_respsRcvd < m_nStreams) {
+      m_timeline.MarkQueued(m_reqsSent, m_arrivals.Take(m_reqsSent));
+      IssueRequest();
+    }
+  }
+
+  void IssueRequest() {
     uint32_t streamId = m_nextStreamId++;
     m_session->OpenStream(streamId);
 
     HTTP3Frame h;
     h.streamId = streamId;
     h.type = HEADERS;
-    std::ostringstream oss;
-    if (m_thirdParty) {
+    std::string host = "server";
+    uint32_t reqId = GlobalRequestId(m_connIndex, m_nConns, m_reqsSent);
+    std::string path = RequestIdPath(reqId);
+    uint32_t reqSize = g_dists.ReqHeaderBytes(reqId, m_reqSize);
+    uint8_t urgency = 3;
+    if (m_workload.Active()) {
+      const WorkloadObject& obj = m_workload.At(m_reqsSent);
+      host = obj.host; path = obj.path; urgency = obj.urgency;
+      if (obj.reqHeaderBytes > 0) reqSize = obj.reqHeaderBytes;
+    } else if (m_thirdParty) {
       const char* domains[] = {"firstparty.example","cdn.example","ads.example"};
-      const char* host = domains[m_reqsSent % 3];
-      oss << "GET /file" << m_reqsSent << " HTTP/3.0\r\nHost: " << host << "\r\n\r\n";
-    } else {
-      oss << "GET /file" << m_reqsSent << " HTTP/3.0\r\nHost: server\r\n\r\n";
+      host = domains[m_reqsSent % 3];
     }
-    h.payload = oss.str();
+    // 请求头：浏览器式字段集（reqSize 为其 HTTP/1.1 文本大小），经 QPACK 编码
+    h.payload = m_qpack.Encode(streamId, BrowserRequestHeaders(host, path, reqSize, urgency));
     h.length  = h.payload.size();
-    uint32_t desired = std::max(m_reqSize, (uint32_t)h.payload.size());
-    if (desired > h.payload.size()) { h.payload.append(desired - h.payload.size(), ' '); h.length = desired; }
 
     std::string hs = h.Serialize();
     m_session->SendStreamData(streamId, reinterpret_cast<const uint8_t*>(hs.data()), hs.size(), false);
+    CountFrameBytes(GetNode()->GetId(), h, hs.size());
 
     HTTP3Frame end;
     end.streamId = streamId; end.type = DATA; end.length = 0; end.payload = "";
     std::string es = end.Serialize();
     m_session->SendStreamData(streamId, reinterpret_cast<const uint8_t*>(es.data()), es.size(), true);
+    CountFrameBytes(GetNode()->GetId(), end, es.size());
 
+    m_streamReqIndex[streamId] = m_reqsSent;
     m_reqSendTimes.push_back(Simulator::Now().GetSeconds());
+    m_timeline.MarkSent(m_reqsSent, streamId, m_reqSendTimes.back());
     ++m_reqsSent;
+    // 下一个请求要等到有流完成后才发出，从此刻开始排队（开环时从到达时刻算）
+    if (m_reqsSent < m_nReqs && !m_arrivals.Active()) {
+      m_timeline.MarkQueued(m_reqsSent, m_workload.QueueTime(m_reqsSent, m_reqSendTimes.back()));
+    }
+  }
+
+  // 按请求索引配对发送时间；调度器打乱完成顺序时仍然正确
+  void RecordResponseTime(uint32_t streamId) {
+    auto it = m_streamReqIndex.find(streamId);
+    if (it == m_streamReqIndex.end() || it->second >= m_reqSendTimes.size()) return;
+    m_respTimes.push_back(Simulator::Now().GetSeconds() - m_reqSendTimes[it->second]);
+    GlobalHistograms().request.RecordSeconds(m_respTimes.back());
+    m_timeline.MarkDone(it->second, Simulator::Now().GetSeconds());
+    m_workload.Complete(it->second, Simulator::Now().GetSeconds());
+    m_arrivals.Complete(it->second, Simulator::Now().GetSeconds());
+    auto fb = m_firstByteTime.find(streamId);
+    if (fb != m_firstByteTime.end()) {
+      GlobalHistograms().stream.RecordSeconds(Simulator::Now().GetSeconds() - fb->second);
+    }
   }
 
   Ptr<Socket> m_socket;
@@ -1180,13 +1744,29 @@ private:
   uint16_t m_port;
   uint32_t m_reqSize, m_nReqs;
   uint32_t m_reqsSent{0}, m_respsRcvd{0};
+  uint64_t m_doneBytes{0};                      // 已完成响应的 Content-Length 之和
   std::vector<double> m_reqSendTimes, m_respRecvTimes;
+  std::vector<double> m_respTimes;              // 每个请求的响应时间
+  std::map<uint32_t, uint32_t> m_streamReqIndex; // streamId -> 请求索引
+  std::map<uint32_t, double> m_firstByteTime;    // streamId -> 响应 HEADERS 到达时间
+  RequestTimeline m_timeline;                    // 逐请求时间线（--waterfallFile）
   std::map<uint32_t, std::string> m_rxBuf;   // 每条流独立的接收缓冲
   double m_interval{0.01};
   bool m_thirdParty{false};
+  WorkloadQueue m_workload;  // --harFile / --pageFile / --pageGraph 回放
+  EventId m_deferredSend;    // 等下一个对象到期
+  ArrivalQueue m_arrivals;   // 开环积压（--arrivalRate / --arrivalTrace）
+  bool m_handshakeDone{false}; // 开环：握手完成后才从积压中发请求
+  uint32_t m_connIndex{0};     // 本连接序号 / 连接数（全局请求号）
+  uint32_t m_nConns{1};
   uint32_t m_nStreams{3};
   Ptr<QuicSession> m_session;
   Time m_linkDelay; // ★ 更改 4b: 新增一个成员变量来存储链路延迟
+  QpackChannel m_qpack;              // 请求头编码 / 响应头解码
+  uint32_t m_qpackCapacity{4096};
+  uint32_t m_qpackBlocked{16};
+  bool m_qpackHuffman{true};
+  std::set<uint32_t> m_headersSeen;  // 已收到（可能仍在阻塞）HEADERS 的流
 
   std::map<uint32_t,uint32_t> m_streamBytes, m_streamTargetBytes;
   std::map<uint32_t,bool>     m_streamCompleted;
@@ -1203,6 +1783,11 @@ private:
   // 区间重组结构
   struct Range { uint64_t lo; uint64_t hi; };
   std::map<uint32_t, std::vector<Range>> m_ranges;   // sid -> ranges
+  std::map<uint32_t, HolLedger> m_streamHol;         // sid -> 缺口等待记录
+  RxHolStats m_connHol;                              // 连接级 HoL（seconds 不含进行中的一段）
+  uint64_t m_connHeld{0};                            // 当前各流等在缺口后的字节总数
+  uint32_t m_blockedStreams{0};                      // 当前有缺口等待的流数
+  double m_connBlockedSince{-1.0};
 
   void AddRange(uint32_t sid, uint64_t off, uint32_t len) {
     if (!len) return;
@@ -1225,6 +1810,44 @@ private:
     v.swap(out);
   }
 
+  // 从 0 开始的连续已收字节数（区间已合并且有序）
+  uint64_t ContiguousPrefix(uint32_t sid) const {
+    auto it = m_ranges.find(sid);
+    if (it == m_ranges.end() || it->second.empty() || it->second.front().lo != 0) return 0;
+    return it->second.front().hi;
+  }
+
+  // 流级 HoL：落在缺口之后的数据在重组缓冲中等待，缺口补齐时释放
+  void TrackGap(uint32_t sid, uint64_t off, uint32_t len) {
+    double now = Simulator::Now().GetSeconds();
+    uint64_t prefix = ContiguousPrefix(sid);
+    HolLedger& gap = m_streamHol[sid];
+    uint64_t before = gap.HeldBytes();
+    gap.Hold(off, off + len, prefix, now);
+    gap.Advance(prefix, now);
+    gap.Consume(0, prefix, now); // 已按序可读的部分不再需要
+    uint64_t after = gap.HeldBytes();
+
+    m_connHeld = m_connHeld - before + after;
+    m_connHol.maxHeldBytes = std::max(m_connHol.maxHeldBytes, m_connHeld);
+    if (before == 0 && after > 0 && m_blockedStreams++ == 0) {
+      m_connBlockedSince = now;
+      ++m_connHol.episodes;
+    } else if (before > 0 && after == 0 && --m_blockedStreams == 0) {
+      m_connHol.seconds += now - m_connBlockedSince;
+      m_connBlockedSince = -1.0;
+    }
+  }
+
+  // 流完成时把该流的缺口等待记入请求时间线
+  void RecordStreamHol(uint32_t sid) {
+    auto g = m_streamHol.find(sid);
+    auto ri = m_streamReqIndex.find(sid);
+    if (g == m_streamHol.end() || ri == m_streamReqIndex.end()) return;
+    RxHolStats st = g->second.GetStats(Simulator::Now().GetSeconds());
+    m_timeline.AddHol(ri->second, st.heldBytes, st.maxWait);
+  }
+
   bool HasFullPrefix(uint32_t sid, uint64_t need) const {
     auto it = m_ranges.find(sid);
     if (it == m_ranges.end()) return need == 0;
@@ -1243,11 +1866,9 @@ private:
   // 流重组核心方法：基于offset的区间合并
   void MarkReceived(uint32_t streamId, uint64_t offset, uint32_t length) {
     AddRange(streamId, offset, length);
-    if (!m_quiet) {
-      std::cout << "[DEBUG] MarkReceived: stream=" << streamId
-                << " offset=" << offset << " len=" << length
-                << " total=" << BytesReceived(streamId) << " bytes" << std::endl;
-    }
+    SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] MarkReceived: stream=" << streamId
+                           << " offset=" << offset << " len=" << length
+                           << " total=" << BytesReceived(streamId) << " bytes");
   }
   
   uint64_t BytesReceived(uint32_t streamId) const {
@@ -1263,23 +1884,39 @@ private:
     if (m_streamCompleted[streamId]) return;
     
     m_streamCompleted[streamId] = true;
+    RecordStreamHol(streamId);
     ++m_respsRcvd;
     m_respRecvTimes.push_back(Simulator::Now().GetSeconds());
+    RecordResponseTime(streamId);
     
     uint64_t totalSize = m_streamTargetBytes[streamId];
+    m_doneBytes += totalSize;
     std::cout << "STREAM_COMPLETED_LOG," << Simulator::Now().GetSeconds()
               << "," << streamId << "," << totalSize << std::endl;
+    GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), GetNode()->GetId(),
+                          TRACE_STREAM_DONE, streamId, totalSize);
     
-    if (!m_quiet) {
-      std::cout << "[DEBUG] Stream " << streamId << " completed via offset reassembly! Total: " 
-                << m_respsRcvd << "/" << m_nReqs << std::endl;
-    }
+    SIM_LOG(SIM_LOG_DEBUG, "[DEBUG] Stream " << streamId << " completed via offset reassembly! Total: " 
+                           << m_respsRcvd << "/" << m_nReqs);
     
-    if (m_respsRcvd < m_nReqs && m_reqsSent < m_nReqs) {
-      Simulator::Schedule(Seconds(m_interval), &Http3ClientApp::SendNextRequest, this);
+    if (m_arrivals.Active()) {
+      PumpArrivals();
+    } else if (m_respsRcvd < m_nReqs && m_reqsSent < m_nReqs) {
+      Simulator::Schedule(Seconds(g_dists.ThinkSeconds(GlobalRequestId(m_connIndex, m_nConns, m_respsRcvd - 1), m_interval)), &Http3ClientApp::SendNextRequest, this);
+    }
+    NotifyIfDone();
+  }
+
+  void NotifyIfDone() {
+    // 积压满时被丢弃的到达不会有响应
+    if (m_respsRcvd == m_nReqs - m_arrivals.Dropped() && !m_doneCallback.IsNull()) {
+      Callback<void> cb = m_doneCallback;
+      m_doneCallback.Nullify(); // 只通知一次
+      cb();
     }
   }
-  bool m_quiet{false};
+  Callback<void> m_doneCallback;  // 完成协调器通知
+  std::string m_qlogFile;         // 空 = 不输出 qlog
 };
 
 // -------------------- HTTP/3 Server --------------------
@@ -1287,41 +1924,79 @@ class Http3ServerApp : public Application {
 public:
   Http3ServerApp() : m_socket(0), m_port(0) {}
   void Setup(uint16_t port, uint32_t respSize, uint32_t maxReqs, uint32_t nStreams,
-             uint32_t frameChunk, uint32_t tickUs, uint32_t headerSize, double hpackRatio,
-             bool enablePush, uint32_t pushSize, bool quiet = false) {
+             uint32_t frameChunk, uint32_t tickUs, uint32_t headerSize,
+             bool enablePush, uint32_t pushSize) {
     m_port = port; m_respSize = respSize; m_maxReqs = maxReqs; m_nStreams = nStreams;
     m_frameChunk = frameChunk; m_tickUs = tickUs; m_headerSize = headerSize;
-    m_hpackRatio = hpackRatio; m_enablePush = enablePush; m_pushSize = pushSize;
-    m_quiet = quiet;
+    m_enablePush = enablePush; m_pushSize = pushSize;
   }
 
-  uint64_t GetHolEvents() const { return m_srvHolEvents; }
-  double GetHolBlockedTime() const { return m_srvHolBlockedTime; }
+  // 本端 SETTINGS_QPACK_MAX_TABLE_CAPACITY / SETTINGS_QPACK_BLOCKED_STREAMS 与 Huffman 编码
+  void SetQpack(uint32_t tableCapacity, uint32_t blockedStreams, bool huffman) {
+    m_qpackCapacity = tableCapacity; m_qpackBlocked = blockedStreams; m_qpackHuffman = huffman;
+  }
+  const QpackStats& GetQpackStats() const { return m_qpack.GetEncoderStats(); }
+  const QpackDecoderStats& GetQpackDecoderStats() const { return m_qpack.GetDecoderStats(); }
+  // 全局请求号 -> 请求头块在服务器端等编码器流的时间
+  const std::map<uint32_t, double>& GetRequestBlocked() const { return m_reqBlocked; }
+
+  // 选择 DATA 交错发送的调度策略（默认 RR）
+  void SetScheduler(const StreamScheduler& scheduler) { m_scheduler = scheduler; }
+
+  // 会话级 pacing（需在启动前设置）
+  void SetSessionPacing(bool enabled) { m_sessionPacing = enabled; }
+  void SetQlogFile(const std::string& path) { m_qlogFile = path; }
+  void CloseQlog() { if (m_session) m_session->CloseQlog(); }
+  double GetSendBlockedSeconds(QuicSession::SendBlock why) const {
+    return m_session ? m_session->GetBlockedSeconds(why) : 0.0;
+  }
 
-  // 在Http3ServerApp类中添加LogCongestionState方法
-  void LogCongestionState() {
-    if (m_session) {
-      std::cout << "CWND_LOG," << Simulator::Now().GetSeconds() << ","
-                << m_session->CwndBytes() << "," << m_session->BytesInFlight() << std::endl;
-    }
-    Simulator::Schedule(MilliSeconds(10), &Http3ServerApp::LogCongestionState, this);
+  // 周期采样：服务器有工作（待发 DATA 或在途字节）时每 interval 一次，空闲即暂停，新请求到达时恢复。
+  // cwndLog 保留旧的 stdout "CWND_LOG,t,cwnd,inflight" 行（Python 驱动脚本依赖）
+  void EnableSampling(Time interval, bool cwndLog) {
+    m_cwndLog = cwndLog;
+    m_sampler.AddProbe("cwnd", [this] { return m_session ? double(m_session->CwndBytes()) : 0.0; });
+    m_sampler.AddProbe("bytes_in_flight", [this] { return m_session ? double(m_session->BytesInFlight()) : 0.0; });
+    m_sampler.AddProbe("srtt_s", [this] { return m_session ? m_session->Srtt().GetSeconds() : 0.0; });
+    m_sampler.AddProbe("queued_packets", [this] { return m_session ? double(m_session->GetQueuedPackets()) : 0.0; });
+    m_sampler.AddProbe("pending_streams", [this] { return double(m_pendingQueue.size()); });
+    m_sampler.AddProbe("tx_available", [this] { return m_socket ? double(m_socket->GetTxAvailable()) : 0.0; });
+    m_sampler.SetBusyCheck([this] { return !m_pendingQueue.empty() || (m_session && m_session->BytesInFlight() > 0); });
+    m_sampler.SetRowHook([this](const std::vector<double>&) { OnSample(); });
+    m_sampler.Enable(interval);
   }
+  PeriodicSampler& GetSampler() { return m_sampler; }
 
 private:
   void StartApplication() override {
     m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
     m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port));
-    m_session = CreateObject<QuicSession>(m_socket, m_quiet);  // 传递quiet参数
+    m_session = CreateObject<QuicSession>(m_socket);
+    if (!m_qlogFile.empty() && !m_session->EnableQlog(m_qlogFile, "http3 server", "server")) {
+      std::cerr << "Cannot open qlog file " << m_qlogFile << std::endl;
+    }
+    m_session->SetPacingEnabled(m_sessionPacing);
     m_session->SetStreamDataCallback(MakeCallback(&Http3ServerApp::OnStreamData, this));
+    m_qpack.Setup(m_session, false, GetNode()->GetId(), m_qpackCapacity, m_qpackBlocked, m_qpackHuffman);
+    m_qpack.SetUnblockedCallback(MakeCallback(&Http3ServerApp::OnRequestUnblocked, this));
+    m_reqSeen.clear();
+    m_reqBlocked.clear();
     // 绑定ACK唤醒回调：收到ACK后立即尝试继续发送
     m_session->SetWakeupCallback(MakeCallback(&Http3ServerApp::OnCanSend, this));
     m_reqsHandled = 0; m_pendingQueue.clear(); m_sending = false; m_nextPushSid = 1001; m_reqBuf.clear();
     m_streamOffsets.clear();  // 初始化流偏移
-    // 服务器侧HoL统计
-    m_srvHolBlockedTime = 0.0; m_srvHolEvents = 0; m_blocking = false; m_blockStart = Seconds(0);
     
-    // 添加拥塞控制日志
-    Simulator::Schedule(MilliSeconds(10), &Http3ServerApp::LogCongestionState, this);
+    // 采样在第一个请求到达时启动（m_sampler.Wake()）
+  }
+
+  void OnSample() {
+    if (!m_session) return;
+    if (m_cwndLog) {
+      std::cout << "CWND_LOG," << Simulator::Now().GetSeconds() << ","
+                << m_session->CwndBytes() << "," << m_session->BytesInFlight() << std::endl;
+    }
+    GlobalTracer().Record(Simulator::Now().GetNanoSeconds(), GetNode()->GetId(), TRACE_CWND,
+                          0, m_session->BytesInFlight(), m_session->CwndBytes());
   }
 
   void OnCanSend() {
@@ -1334,6 +2009,11 @@ private:
   void StopApplication() override { if (m_socket) m_socket->Close(); }
 
   void OnStreamData(uint32_t streamId, const uint8_t* data, uint32_t len, bool fin) {
+    SIM_PROFILE_SCOPE("OnStreamData (server)");
+    if (IsH3UniStream(streamId)) {
+      m_qpack.OnUniStreamData(streamId, data, len);
+      return;
+    }
     std::string& buf = m_reqBuf[streamId];
     buf.append(reinterpret_cast<const char*>(data), len);
 
@@ -1377,74 +2057,102 @@ private:
     try {
       HTTP3Frame f = HTTP3Frame::Parse(frameData);
       if (f.type == HEADERS) {
-        if (m_reqsHandled >= m_maxReqs) return;
-        ++m_reqsHandled;
-
-        uint32_t rsz = m_respSize;
-        if (!g_respSizes.empty()) {
-          uint32_t idx = std::min<uint32_t>(m_reqsHandled - 1, g_respSizes.size() - 1);
-          rsz = g_respSizes[idx];
-        }
-
-        // QPACK (模拟) 压缩后头部大小 - 修复：绝不截断头部
-        std::ostringstream oss;
-        oss << "HTTP/3.0 200 OK\r\nContent-Length: " << rsz << "\r\n\r\n";
-        std::string baseHeaders = oss.str();
-        
-        uint32_t want = std::max<uint32_t>(baseHeaders.size(), (uint32_t)(m_headerSize * m_hpackRatio));
-        // 仅在不足时用空格填充，绝不截断
-        std::string hdr = baseHeaders;
-        if (want > baseHeaders.size()) {
-          hdr.append(want - baseHeaders.size(), ' ');
-        }
-
-        // 发响应 HEADERS（序列化为 HTTP3Frame）
-        HTTP3Frame hf;
-        hf.streamId = f.streamId; hf.type = HEADERS; hf.payload = hdr; hf.length = hdr.size();
-        std::string hs = hf.Serialize();
-        m_session->SendStreamData(f.streamId, reinterpret_cast<const uint8_t*>(hs.data()), hs.size(), false);
-
-        // enqueue DATA
-        m_pendingQueue.emplace_back(f.streamId, rsz);
-
-        // shadow push
-        if (m_enablePush) {
-          uint32_t psid = m_nextPushSid++;
-          
-          // 显式打开推送流
-          m_session->OpenStream(psid);
-
-          HTTP3Frame promise; // attach to parent stream
-          promise.streamId = f.streamId; promise.type = PUSH_PROMISE;
-          std::ostringstream pss; pss << "PUSH /p" << psid << " promised-stream: " << psid << "\r\n";
-          promise.payload = pss.str(); promise.length = promise.payload.size();
-          std::string pm = promise.Serialize();
-          m_session->SendStreamData(f.streamId, reinterpret_cast<const uint8_t*>(pm.data()), pm.size(), false);
-
-          HTTP3Frame ph;
-          ph.streamId = psid; ph.type = HEADERS;
-          std::ostringstream hss;
-          hss << "HTTP/3.0 200 OK\r\nContent-Length: " << m_pushSize << "\r\nx-push: 1\r\n\r\n";
-          ph.payload = hss.str(); ph.length = ph.payload.size();
-          std::string ss = ph.Serialize();
-          m_session->SendStreamData(psid, reinterpret_cast<const uint8_t*>(ss.data()), ss.size(), false);
-
-          m_pendingQueue.emplace_back(psid, m_pushSize);
-        }
-
-        // ★ 关键修改 ★
-        // 如果当前没有在发送，则立即启动发送循环
-        if (!m_sending) { 
-          m_sending = true; 
-          Simulator::ScheduleNow(&Http3ServerApp::SendTick, this); 
+        // 重传可能再次交付同一 HEADERS；每个请求流只解码、响应一次
+        if (!m_reqSeen.insert(f.streamId).second) return;
+        HttpHeaderList reqHeaders;
+        QpackDecoder::Result r = m_qpack.Decode(f.streamId, f.payload, reqHeaders);
+        if (r == QpackDecoder::QPACK_BLOCKED) return; // 编码器流追上后由 OnRequestUnblocked 继续
+        if (r == QpackDecoder::QPACK_FAILED) {
+          SIM_LOG(SIM_LOG_ERROR, "[ERROR] QPACK decompression failed (sid=" << f.streamId << ")");
+          return;
         }
+        HandleRequest(f.streamId, reqHeaders);
       }
     } catch (const std::exception& e) {
       NS_LOG_WARN("Failed to parse frame: " << e.what());
     }
   }
 
+  void OnRequestUnblocked(uint32_t sid, const HttpHeaderList& headers, double blockedSeconds) {
+    HandleRequest(sid, headers, blockedSeconds);
+  }
+
+  void HandleRequest(uint32_t sid, const HttpHeaderList& reqHeaders, double blockedSeconds = 0.0) {
+    if (m_reqsHandled >= m_maxReqs) return;
+    ++m_reqsHandled;
+
+    // 回放时按 :path 找对象，否则按路径里的全局请求号
+    std::string reqPath = FindHeader(reqHeaders, ":path");
+    int64_t obj = g_workload.Find(reqPath);
+    uint32_t id = obj >= 0 ? static_cast<uint32_t>(obj) : RequestIdOfPath(reqPath, m_reqsHandled - 1);
+    if (blockedSeconds > 0) m_reqBlocked[id] += blockedSeconds;
+    uint32_t rsz = m_respSize;
+    uint32_t hdrSize = g_dists.RespHeaderBytes(id, m_headerSize);
+    if (obj >= 0) {
+      rsz = g_workload.Get(obj).bodyBytes;
+      if (g_workload.Get(obj).respHeaderBytes > 0) hdrSize = g_workload.Get(obj).respHeaderBytes;
+    } else if (!g_respSizes.empty()) {
+      uint32_t idx = std::min<uint32_t>(id, g_respSizes.size() - 1);
+      rsz = g_respSizes[idx];
+    }
+
+    // 响应 HEADERS：源站式字段集（m_headerSize 为其 HTTP/1.1 文本大小），经 QPACK 编码
+    HTTP3Frame hf;
+    hf.streamId = sid; hf.type = HEADERS;
+    hf.payload = m_qpack.Encode(sid, OriginResponseHeaders(rsz, id, "ns3-http3/0.1", hdrSize));
+    hf.length = hf.payload.size();
+    std::string hs = hf.Serialize();
+    // 空响应体（Content-Length: 0）没有 DATA，FIN 随 HEADERS 一起发
+    m_session->SendStreamData(sid, reinterpret_cast<const uint8_t*>(hs.data()), hs.size(), rsz == 0);
+    CountFrameBytes(GetNode()->GetId(), hf, hs.size());
+
+    // enqueue DATA
+    if (rsz > 0) {
+      m_pendingQueue.emplace_back(sid, rsz, Simulator::Now().GetSeconds(), ParseUrgency(FindHeader(reqHeaders, "priority")));
+    }
+
+    // shadow push
+    if (m_enablePush) {
+      uint32_t psid = m_nextPushSid++;
+
+      // 显式打开推送流
+      m_session->OpenStream(psid);
+
+      // PUSH_PROMISE 挂在父流上；承诺的请求头不引用动态表（RIC = 0），客户端无需等编码器流
+      HTTP3Frame promise;
+      promise.streamId = sid; promise.type = PUSH_PROMISE;
+      HttpHeaderList promised = {
+        {":method", "GET"}, {":scheme", "https"}, {":authority", "server"}, {":path", "/p" + std::to_string(psid)},
+      };
+      promise.payload = m_qpack.Encode(sid, promised, false); promise.length = promise.payload.size();
+      std::string pm = promise.Serialize();
+      m_session->SendStreamData(sid, reinterpret_cast<const uint8_t*>(pm.data()), pm.size(), false);
+      CountFrameBytes(GetNode()->GetId(), promise, pm.size());
+
+      HTTP3Frame ph;
+      ph.streamId = psid; ph.type = HEADERS;
+      HttpHeaderList pushHeaders = OriginResponseHeaders(m_pushSize, psid, "ns3-http3/0.1", 0);
+      pushHeaders.push_back(HttpHeader{"x-push", "1"});
+      ph.payload = m_qpack.Encode(psid, pushHeaders); ph.length = ph.payload.size();
+      std::string ss = ph.Serialize();
+      m_session->SendStreamData(psid, reinterpret_cast<const uint8_t*>(ss.data()), ss.size(), false);
+      CountFrameBytes(GetNode()->GetId(), ph, ss.size());
+
+      m_pendingQueue.emplace_back(psid, m_pushSize, Simulator::Now().GetSeconds());
+    }
+
+    m_sampler.Wake();
+
+    // ★ 关键修改 ★
+    // 如果当前没有在发送，则立即启动发送循环
+    if (!m_sending) {
+      m_sending = true;
+      Simulator::ScheduleNow(&Http3ServerApp::SendTick, this);
+    }
+  }
+
   void SendTick() {
+    SIM_PROFILE_SCOPE("SendTick (server)");
     // 如果队列已空，停止发送循环
     if (m_pendingQueue.empty()) {
         m_sending = false;
@@ -1453,16 +2161,15 @@ private:
 
     // ★ 关键修复 1: 在每次Tick的开始就检查拥塞窗口 ★
     // 如果窗口已满，则停止发送，等待网络事件(ACK)通过 OnCanSend() 唤醒
-    if (m_session->BytesInFlight() >= m_session->CwndBytes()) {
+    if (m_session->BytesInFlight() >= m_session->CwndBytes() || m_session->HasQueuedFrames()) {
         m_sending = false; // 等待被唤醒
         return;
     }
 
     // ★ 关键修复 2: 实现真正的轮询调度（一次只处理一个任务）★
 
-    // 1. 从队列头部取出一个任务
-    PendingItem item = m_pendingQueue.front();
-    m_pendingQueue.pop_front();
+    // 1. 由调度器取出一个任务（RR: 队首；SRPT: 剩余字节最少）
+    PendingItem item = m_scheduler.Take(m_pendingQueue, Simulator::Now().GetSeconds());
 
     // 2. 为这个任务发送一小块数据（一个数据包的量）
     const uint32_t effMtu = 1200 - 28; // 估算MTU
@@ -1485,21 +2192,16 @@ private:
         bool isLast = (item.remainingBytes <= sendBytes);
         std::string s = df.Serialize();
         m_session->SendStreamData(item.streamId, reinterpret_cast<const uint8_t*>(s.data()), s.size(), isLast);
+        CountFrameBytes(GetNode()->GetId(), df, s.size());
 
         m_streamOffsets[item.streamId] += sendBytes;
         item.remainingBytes -= sendBytes;
         item.sentBytes += sendBytes;
-        
-        // 若之前处于阻塞，首包发出时结束一次HoL计时
-        if (m_blocking) { 
-            m_srvHolBlockedTime += (Simulator::Now() - m_blockStart).GetSeconds(); 
-            m_blocking = false; 
-        }
     }
 
-    // 3. 如果这个任务还没完成，就把它放回队列的尾部
+    // 3. 如果这个任务还没完成，就放回队列（RR 放队尾，SRPT 留在队首）
     if (item.remainingBytes > 0) {
-        m_pendingQueue.push_back(item);
+        m_scheduler.Requeue(m_pendingQueue, item);
     }
 
     // ★ 关键修复 3: 只要队列中还有任务，就立即调度下一次Tick ★
@@ -1523,9 +2225,15 @@ private:
   uint32_t m_tickUs{500};
   bool m_sending{false};
   std::deque<PendingItem> m_pendingQueue;
+  StreamScheduler m_scheduler;  // 决定下一个 DATA 块发给哪个流
   std::map<uint32_t, std::string> m_reqBuf;  // 每条流独立的接收缓冲（请求方向）
   uint32_t m_headerSize{200};
-  double m_hpackRatio{0.3};
+  QpackChannel m_qpack;           // 请求头解码 / 响应头编码
+  uint32_t m_qpackCapacity{4096};
+  uint32_t m_qpackBlocked{16};
+  bool m_qpackHuffman{true};
+  std::set<uint32_t> m_reqSeen;   // 已收到（可能仍在阻塞）请求 HEADERS 的流
+  std::map<uint32_t, double> m_reqBlocked; // 全局请求号 -> 请求头阻塞时间
   bool m_enablePush{false};
   uint32_t m_pushSize{12*1024};
   uint32_t m_nextPushSid{1001};
@@ -1533,12 +2241,10 @@ private:
   
   // 流偏移跟踪
   std::map<uint32_t, uint64_t> m_streamOffsets;  // 每个流的当前偏移
-  // 服务器侧HoL统计
-  double m_srvHolBlockedTime{0.0};
-  uint64_t m_srvHolEvents{0};
-  bool m_blocking{false};
-  Time m_blockStart;
-  bool m_quiet{false};
+  PeriodicSampler m_sampler;    // 拥塞/队列状态周期采样
+  bool m_cwndLog{true};         // 采样时是否同时打印 CWND_LOG 行
+  bool m_sessionPacing{false};  // QuicSession 级 pacing
+  std::string m_qlogFile;       // 空 = 不输出 qlog
 };
 
 // -------------------- main --------------------
@@ -1558,12 +2264,44 @@ int main(int argc, char* argv[]) {
   uint32_t frameChunk = std::min(1200u - 28u - 32u, 1200u); // 限制不跨UDP包
   uint32_t tickUs     = 500;
   uint32_t headerSize = 200;
-  double   hpackRatio = 0.3;   // simulate QPACK ratio
+  uint32_t qpackTableCapacity = 4096; // SETTINGS_QPACK_MAX_TABLE_CAPACITY（QPACK 动态表）
+  uint32_t qpackBlockedStreams = 16;  // SETTINGS_QPACK_BLOCKED_STREAMS
+  bool qpackHuffman = true;           // QPACK Huffman 编码字段字符串
   bool enablePush = false;
   uint32_t pushSize = 12*1024;
   double pushHitRate = 1.0;
   double simTime = 120.0;  // 默认更长仿真时间
-  bool quiet = false;  // 添加安静模式标志
+  std::string scheduler = "rr"; // DATA scheduling: rr | srpt
+  double srptAging = 0.0;       // SRPT aging rate (bytes/s of waiting credited to an item)
+  bool quicPacing = false;      // 服务器 QuicSession 级 pacing
+  bool autoStop = true;         // 所有客户端完成后提前结束仿真
+  double drainTime = 0.5;       // 最后一个响应之后继续仿真的时间（秒）
+  std::string logLevel = "info"; // error|warn|info|debug|trace
+  bool quiet = false;           // 等价于 --logLevel=warn
+  bool enableFlowmon = false;   // FlowMonitor 逐流统计（控制台 + --resultsFile）
+  std::string flowStatsFile = ""; // 仅逐流计数器（.json 或 .csv）；空 = 关闭
+  std::string flowmonXml = "";    // 完整 FlowMonitor XML（含直方图/探针）；空 = 关闭
+  std::string traceFile = "";   // 二进制事件跟踪文件（trace2csv 转 CSV）；空 = 关闭
+  uint32_t traceCapacity = 1 << 20; // 环形缓冲记录数（每条 32 B）
+  std::string qlog = "none";    // qlog 输出端：none|client|server|both
+  std::string qlogPrefix = "h3"; // qlog 文件前缀：<prefix>-server.sqlog / <prefix>-client<i>.sqlog
+  std::string resultsFile = "";  // 机器可读结果（.json，或 .csv 单行）；空 = 不写
+  std::string histFile = "";     // 延迟直方图文件（histmerge 合并）；空 = 不写
+  bool profile = false;          // 仿真器自身性能剖析报告
+  std::string waterfallFile = "";  // 逐请求时间线 CSV；空 = 不写
+  double sampleInterval = 0.01;  // 周期采样间隔（秒）
+  std::string sampleFile = "";   // 采样列式输出（.csv 为 CSV，否则二进制，trace2csv 可读）；空 = 不写
+  bool cwndLog = true;           // 打印 CWND_LOG 行
+  std::string harFile = "";      // HAR 工作负载回放（覆盖 nRequests/respSize/mixedSizes/thirdParty）；空 = 合成负载
+  std::string pageFile = "";     // 页面依赖图（JSON，见 common/workload.h）；空 = 不用
+  bool pageGraph = false;        // 按 nRequests 生成合成页面依赖图（HTML -> CSS/JS -> 图片）
+  std::string respSizeDist = ""; // 响应大小分布（见 common/distributions.h，RngRun 决定抽样）；空 = respSize/mixedSizes
+  std::string reqHdrDist = "";   // 请求头大小分布；空 = reqSize
+  std::string respHdrDist = "";  // 响应头大小分布；空 = headerSize
+  std::string thinkDist = "";    // 请求间思考时间分布（秒）；空 = interval
+  double arrivalRate = 0.0;      // 开环：泊松到达速率（req/s，见 common/arrivals.h）；0 = 闭环
+  std::string arrivalTrace = ""; // 开环：到达时刻文件（给了 arrivalRate 则按其缩放）；空 = 不用
+  uint32_t maxBacklog = 0;       // 开环：每连接积压上限，满了丢弃新到达；0 = 不限
 
   CommandLine cmd;
   cmd.AddValue("nRequests", "Number of HTTP requests", nRequests);
@@ -1582,13 +2320,96 @@ int main(int argc, char* argv[]) {
   cmd.AddValue("frameChunk", "Frame chunk size", frameChunk);
   cmd.AddValue("tickUs", "Tick interval (us)", tickUs);
   cmd.AddValue("headerSize", "Base header size", headerSize);
-  cmd.AddValue("hpackRatio", "QPACK ratio", hpackRatio);
+  cmd.AddValue("qpackTableCapacity", "SETTINGS_QPACK_MAX_TABLE_CAPACITY advertised by client and server (bytes, 0 = static table only)", qpackTableCapacity);
+  cmd.AddValue("qpackBlockedStreams", "SETTINGS_QPACK_BLOCKED_STREAMS advertised by client and server", qpackBlockedStreams);
+  cmd.AddValue("qpackHuffman", "Huffman-code QPACK field strings", qpackHuffman);
   cmd.AddValue("enablePush", "Enable shadow server push", enablePush);
   cmd.AddValue("pushSize", "Push object size (bytes)", pushSize);
   cmd.AddValue("pushHitRate", "Push hit probability", pushHitRate);
   cmd.AddValue("simTime", "Simulation time in seconds", simTime);
-  cmd.AddValue("quiet", "Disable verbose per-packet/frame logs for performance", quiet);  // 添加quiet参数
+  cmd.AddValue("scheduler", "Server DATA scheduling policy: rr | srpt", scheduler);
+  cmd.AddValue("srptAging", "SRPT aging rate in bytes per second waited (0 = pure SRPT)", srptAging);
+  cmd.AddValue("quicPacing", "Pace packets inside the server QuicSession (cwnd/srtt rate)", quicPacing);
+  cmd.AddValue("autoStop", "Stop the simulation once every client has all responses", autoStop);
+  cmd.AddValue("drainTime", "Seconds to keep simulating after the last response (with autoStop)", drainTime);
+  cmd.AddValue("logLevel", "Progress log level: error|warn|info|debug|trace", logLevel);
+  cmd.AddValue("quiet", "Only print warnings, errors and the summary (same as --logLevel=warn)", quiet);
+  cmd.AddValue("flowmon", "Install FlowMonitor and report per-flow delay/jitter/loss", enableFlowmon);
+  cmd.AddValue("flowStatsFile", "Write per-flow rxPackets/delaySum/jitterSum/lost to this file (.json or .csv; implies --flowmon)", flowStatsFile);
+  cmd.AddValue("flowmonXml", "Write the full FlowMonitor XML (histograms and probes) to this file (implies --flowmon)", flowmonXml);
+  cmd.AddValue("traceFile", "Write a binary event trace to this file at the end of the run", traceFile);
+  cmd.AddValue("traceCapacity", "Event trace ring size in records; older records are overwritten", traceCapacity);
+  cmd.AddValue("qlog", "Write qlog (JSON-SEQ) for: none|client|server|both", qlog);
+  cmd.AddValue("qlogPrefix", "qlog file prefix: <prefix>-server.sqlog, <prefix>-client<i>.sqlog", qlogPrefix);
+  cmd.AddValue("resultsFile", "Write config, metrics, per-request timings and flow stats to this file (.json or .csv)", resultsFile);
+  cmd.AddValue("histFile", "Save request/TTFB/stream/RTT latency histograms to this file (mergeable with histmerge)", histFile);
+  cmd.AddValue("profile", "Report event rate, wall-clock per simulated second, per-callback time and peak RSS", profile);
+  cmd.AddValue("waterfallFile", "Write the per-request timeline (queued/sent/headers/first byte/last byte) as CSV", waterfallFile);
+  cmd.AddValue("sampleInterval", "Periodic state sampling interval in seconds (paused while idle)", sampleInterval);
+  cmd.AddValue("sampleFile", "Write sampled cwnd/in-flight/srtt/queue columns to this file (.csv, or binary for trace2csv)", sampleFile);
+  cmd.AddValue("cwndLog", "Print CWND_LOG lines on every sample", cwndLog);
+  cmd.AddValue("harFile", "Replay the objects of this HAR capture (sizes, hosts, priorities, start offsets) instead of the synthetic workload", harFile);
+  cmd.AddValue("pageFile", "Fetch the objects of this page dependency graph; children are requested once their parents arrived and were processed", pageFile);
+  cmd.AddValue("pageGraph", "Fetch a synthetic page of nRequests objects with HTML/CSS/JS discovery dependencies", pageGraph);
+  cmd.AddValue("respSizeDist", "Response sizes: fixed|uniform|exponential|lognormal|pareto|zipf|empirical:<args> (seeded by RngRun)", respSizeDist);
+  cmd.AddValue("reqHdrDist", "Request header sizes, same syntax as respSizeDist", reqHdrDist);
+  cmd.AddValue("respHdrDist", "Response header sizes, same syntax as respSizeDist", respHdrDist);
+  cmd.AddValue("thinkDist", "Think time in seconds before each next request, same syntax as respSizeDist", thinkDist);
+  cmd.AddValue("arrivalRate", "Open loop: Poisson request arrivals at this rate (req/s) instead of request-after-response", arrivalRate);
+  cmd.AddValue("arrivalTrace", "Open loop: request arrival times (s, one per line) from this file; rescaled to arrivalRate if given", arrivalTrace);
+  cmd.AddValue("maxBacklog", "Open loop: drop arrivals that find this many requests waiting on their connection (0 = unbounded)", maxBacklog);
   cmd.Parse(argc, argv);
+  if (!SetSimLogLevel(quiet ? "warn" : logLevel)) {
+    std::cerr << "Unknown --logLevel '" << logLevel << "', using info" << std::endl;
+  }
+  if (!traceFile.empty()) GlobalTracer().Enable(traceCapacity);
+  CallbackProfiler::Get().Enable(profile);
+  if (!harFile.empty() || !pageFile.empty()) {
+    std::string error;
+    bool ok = harFile.empty() ? g_workload.LoadPage(pageFile, error) : g_workload.LoadHar(harFile, error);
+    if (!ok) {
+      std::cerr << "Cannot load workload: " << error << std::endl;
+      return 1;
+    }
+  } else if (pageGraph) {
+    g_workload.BuildPage(nRequests);
+  }
+  if (!g_workload.Empty()) {
+    g_workload.Print(std::cout);
+    nRequests = g_workload.Size();
+  }
+  std::string arrivalError;
+  if (!g_arrivals.LoadTrace(arrivalTrace, arrivalError) || !g_arrivals.Setup(arrivalRate, nRequests, arrivalError)) {
+    std::cerr << "Bad arrivals: " << arrivalError << std::endl;
+    return 1;
+  }
+  if (g_arrivals.Active()) {
+    if (!g_workload.Empty()) {
+      std::cerr << "--arrivalRate/--arrivalTrace cannot be combined with --harFile/--pageFile/--pageGraph" << std::endl;
+      return 1;
+    }
+    g_arrivals.Print(std::cout, maxBacklog);
+    nRequests = g_arrivals.Size();
+  }
+
+  SimResults results("http/3");
+  results.SetCommandLine(argc, argv);
+  results.Config().Field("nRequests", nRequests).Field("respSize", respSize).Field("reqSize", reqSize)
+                  .Field("errorRate", errorRate).Field("dataRate", dataRate).Field("delay", delay)
+                  .Field("interval", interval).Field("nConnections", nConnections)
+                  .Field("mixedSizes", mixedSizes).Field("thirdParty", thirdParty)
+                  .Field("nStreams", nStreams).Field("frameChunk", frameChunk).Field("tickUs", tickUs)
+                  .Field("headerSize", headerSize).Field("qpackTableCapacity", qpackTableCapacity)
+                  .Field("qpackBlockedStreams", qpackBlockedStreams).Field("qpackHuffman", qpackHuffman)
+                  .Field("enablePush", enablePush).Field("pushSize", pushSize).Field("pushHitRate", pushHitRate)
+                  .Field("scheduler", scheduler).Field("srptAging", srptAging).Field("quicPacing", quicPacing)
+                  .Field("simTime", simTime).Field("autoStop", autoStop).Field("drainTime", drainTime)
+                  .Field("harFile", harFile)
+                  .Field("pageFile", pageFile).Field("pageGraph", pageGraph)
+                  .Field("respSizeDist", respSizeDist).Field("reqHdrDist", reqHdrDist)
+                  .Field("respHdrDist", respHdrDist).Field("thinkDist", thinkDist)
+                  .Field("arrivalRate", arrivalRate).Field("arrivalTrace", arrivalTrace).Field("maxBacklog", maxBacklog)
+                  .Field("rngSeed", RngSeedManager::GetSeed()).Field("rngRun", RngSeedManager::GetRun());
 
   g_respSizes.clear(); g_respSizes.reserve(nRequests);
   if (!mixedSizes) {
@@ -1601,6 +2422,13 @@ int main(int argc, char* argv[]) {
       else g_respSizes.push_back(200*1024);
     }
   }
+  std::string distError;
+  if (!g_dists.Setup(respSizeDist, reqHdrDist, respHdrDist, thinkDist, nRequests, distError)) {
+    std::cerr << "Bad distribution " << distError << std::endl;
+    return 1;
+  }
+  if (!g_dists.RespSizes().empty()) g_respSizes = g_dists.RespSizes();
+  if (g_dists.Any()) g_dists.Print(std::cout);
 
   NodeContainer nodes; nodes.Create(2);
   PointToPointHelper p2p; p2p.SetDeviceAttribute("DataRate", StringValue(dataRate));
@@ -1612,21 +2440,55 @@ int main(int argc, char* argv[]) {
 
   Ipv4AddressHelper addr; addr.SetBase("10.1.1.0","255.255.255.0");
   Ipv4InterfaceContainer ifs = addr.Assign(devs);
+  GlobalBytes().SetServerNode(nodes.Get(1)->GetId());
+  GlobalBytes().TapDevices(devs);
 
   Ptr<Http3ServerApp> server = CreateObject<Http3ServerApp>();
   server->Setup(httpPort, respSize, nRequests, nStreams, frameChunk, tickUs,
-                headerSize, hpackRatio, enablePush, pushSize, quiet);
+                headerSize, enablePush, pushSize);
+  server->SetQpack(qpackTableCapacity, qpackBlockedStreams, qpackHuffman);
+  SchedulerPolicy schedulerPolicy;
+  if (!StreamScheduler::ParsePolicy(scheduler, schedulerPolicy)) {
+    std::cerr << "Unknown --scheduler '" << scheduler << "', using rr" << std::endl;
+  }
+  StreamScheduler dataScheduler(schedulerPolicy, srptAging);
+  server->SetScheduler(dataScheduler);
+  server->SetSessionPacing(quicPacing);
+  bool qlogServer = (qlog == "server" || qlog == "both");
+  bool qlogClient = (qlog == "client" || qlog == "both");
+  if (qlogServer) server->SetQlogFile(qlogPrefix + "-server.sqlog");
+  if (cwndLog || !sampleFile.empty() || GlobalTracer().IsEnabled()) {
+    server->EnableSampling(Seconds(sampleInterval), cwndLog);
+    Ptr<Queue<Packet>> serverQueue = DynamicCast<PointToPointNetDevice>(devs.Get(1))->GetQueue();
+    server->GetSampler().AddProbe("link_queue_packets", [serverQueue] { return double(serverQueue->GetNPackets()); });
+  }
   nodes.Get(1)->AddApplication(server);
   server->SetStartTime(Seconds(0.5));
   server->SetStopTime(Seconds(simTime));
 
   std::vector< Ptr<Http3ClientApp> > clients;
+  CompletionCoordinator coordinator(autoStop, Seconds(drainTime));
   uint32_t baseReqs = nRequests / nConnections;
   uint32_t rem = nRequests % nConnections;
   for (uint32_t i=0;i<nConnections;++i) {
     uint32_t reqs = baseReqs + (i < rem ? 1 : 0);
     Ptr<Http3ClientApp> c = CreateObject<Http3ClientApp>();
-    c->Setup(ifs.GetAddress(1), httpPort, reqSize, reqs, interval, thirdParty, nStreams, quiet);  // 传递quiet参数
+    if (!g_workload.Empty()) {
+      // 回放：对象按发出顺序轮流分给各连接
+      std::vector<uint32_t> share = g_workload.Share(i, nConnections);
+      reqs = share.size();
+      c->SetWorkload(&g_workload, share);
+    } else if (g_arrivals.Active()) {
+      // 开环：到达按时间顺序轮流分给各连接
+      std::vector<double> share = g_arrivals.Share(i, nConnections);
+      reqs = share.size();
+      c->SetArrivals(share, maxBacklog);
+    }
+    c->Setup(ifs.GetAddress(1), httpPort, reqSize, reqs, interval, thirdParty, nStreams);
+    c->SetConnection(i, nConnections);
+    c->SetQpack(qpackTableCapacity, qpackBlockedStreams, qpackHuffman);
+    if (reqs > 0) c->SetDoneCallback(coordinator.Register());  // 无请求的客户端不参与
+    if (qlogClient) c->SetQlogFile(qlogPrefix + "-client" + std::to_string(i) + ".sqlog");
     nodes.Get(0)->AddApplication(c);
     c->SetStartTime(Seconds(1.0 + i*0.01));
     c->SetStopTime(Seconds(simTime));
@@ -1644,22 +2506,36 @@ int main(int argc, char* argv[]) {
   devs.Get(1)->SetAttribute("ReceiveErrorModel", PointerValue(em1));
 
   FlowMonitorHelper fmHelper;
-  Ptr<FlowMonitor> flowmon = fmHelper.InstallAll();
+  Ptr<FlowMonitor> flowmon;
+  if (enableFlowmon || !flowStatsFile.empty() || !flowmonXml.empty()) {
+    ConfigureFlowMonitor(fmHelper, !flowmonXml.empty());
+    flowmon = fmHelper.InstallAll();
+  }
 
   Simulator::Stop(Seconds(simTime + 1.0));  // 留1s缓冲
+  RunCost runCost;
+  runCost.Start();
   Simulator::Run();
+  runCost.Stop();
+  server->CloseQlog();
+  for (auto& c : clients) c->CloseQlog();
 
   uint32_t totalResps = 0;
+  uint64_t doneBytes = 0;  // 各客户端已完成响应的响应体字节
   std::vector<double> sendTimes, recvTimes;
   double firstSend = std::numeric_limits<double>::infinity();
   double lastRecv = 0.0, sumDelay = 0.0;
   size_t nDone = 0;
   // 修复Jitter计算：按照RFC3550计算interarrival variation
   double rfcJitter = 0.0;
+  std::vector<double> respTimes; // 按请求配对的响应时间（与完成顺序无关）
 
   // 收集所有客户端的数据
   for (auto& c : clients) {
     totalResps += c->GetRespsRcvd();
+    doneBytes += c->GetDoneBytes();
+    const auto& rt = c->GetResponseTimes();
+    respTimes.insert(respTimes.end(), rt.begin(), rt.end());
     const auto& s = c->GetReqSendTimes();
     const auto& r = c->GetRespRecvTimes();
     size_t n = std::min(s.size(), r.size());
@@ -1675,6 +2551,24 @@ int main(int argc, char* argv[]) {
     recvTimes.insert(recvTimes.end(), r.begin(), r.end());
   }
 
+  // 逐请求时间线：写入 --resultsFile 的 requests 与 --waterfallFile
+  std::vector<RequestTiming> timeline;
+  uint32_t holStreams = 0; // 有数据在缺口后等待过的流
+  const std::map<uint32_t, double>& reqBlocked = server->GetRequestBlocked();
+  for (uint32_t ci = 0; ci < clients.size(); ++ci) {
+    for (RequestTiming t : clients[ci]->GetTimeline().Get()) {
+      t.conn = ci;
+      auto rb = reqBlocked.find(GlobalRequestId(ci, nConnections, t.index));
+      if (rb != reqBlocked.end()) t.reqHdrBlockedSeconds = rb->second;
+      if (t.holBytes > 0) ++holStreams;
+      results.AddRequest(t);
+      timeline.push_back(t);
+    }
+  }
+  if (!waterfallFile.empty() && !WriteWaterfall(waterfallFile, timeline)) {
+    std::cerr << "Cannot write waterfall to " << waterfallFile << std::endl;
+  }
+
   // 计算正确的jitter
   if (nDone > 1) {
     // 先排序，避免多客户端插入次序导致0
@@ -1700,9 +2594,22 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  // 修复HoL Events计算：只统计真正的队列阻塞事件
-  uint64_t holEvents = server->GetHolEvents();
-  double holBlockedTime = server->GetHolBlockedTime();
+  // HoL：客户端流重组中数据等在缺口之后（QUIC 流级 HoL，对应 TCP 乱序接收缓冲的口径）
+  RxHolStats connHol, streamHol;
+  for (auto& c : clients) {
+    connHol.Add(c->GetConnHolStats());
+    streamHol.Add(c->GetStreamHolStats());
+  }
+  uint64_t holEvents = connHol.episodes;
+  double holBlockedTime = connHol.seconds;
+  // QPACK：实测的请求/响应字段段与编码器流（编码前大小按 HTTP/1.1 文本计），及解码端等编码器流的阻塞
+  QpackStats reqQpack;
+  QpackStats respQpack = server->GetQpackStats();
+  QpackDecoderStats qpackBlocked = server->GetQpackDecoderStats();
+  for (auto& c : clients) {
+    reqQpack.Add(c->GetQpackStats());
+    qpackBlocked.Add(c->GetQpackDecoderStats());
+  }
 
   // 始终打印最小概要，便于外部工具抓取（无论是否计算出完整统计）
   double completionRate = (nDone > 0) ? (double(nDone) / double(nRequests)) * 100.0 : 0.0;
@@ -1729,19 +2636,20 @@ int main(int argc, char* argv[]) {
       avgDelay = std::accumulate(individualDelays.begin(), individualDelays.end(), 0.0) / individualDelays.size();
     }
   }
-    double headerCompressed = std::max(20.0, headerSize * hpackRatio);
-
-    double totalBytesDown = double(nDone) * (respSize + headerCompressed);
-    // 修复吞吐量计算：只用已完成请求的实际传输时间
-    double bytesPer = (respSize + headerCompressed);
-    double bytesDown = 0.0;
+    // 每个响应/请求的平均 QPACK 头部开销（字段段 + 摊到每段的编码器流指令）
+    double headerCompressed = respQpack.sections
+        ? double(respQpack.encodedBytes + respQpack.encoderStreamBytes) / respQpack.sections : 0.0;
+    double reqHeaderCompressed = reqQpack.sections
+        ? double(reqQpack.encodedBytes + reqQpack.encoderStreamBytes) / reqQpack.sections : 0.0;
+
+    // 下行字节：各客户端实际完成的响应体（respSizeDist / 回放时大小各异）+ 平均头部开销
+    double totalBytesDown = double(doneBytes) + double(nDone) * headerCompressed;
     double timeSum = 0.0;
     size_t n = std::min(sendTimes.size(), recvTimes.size());
     for (size_t i = 0; i < n; ++i) {
       if (recvTimes[i] > sendTimes[i]) {
         double dt = recvTimes[i] - sendTimes[i];
         if (dt > 0 && dt < simTime) {   // 过滤异常
-          bytesDown += bytesPer;
           timeSum += dt;
         }
       }
@@ -1749,42 +2657,31 @@ int main(int argc, char* argv[]) {
     
     // SANITY调试输出
     std::cout << "[SANITY] nDone=" << nDone
-              << " bytesPer=" << (respSize + headerCompressed)
-              << " bytesDown=" << bytesDown
+              << " bytesPer=" << totalBytesDown / nDone
+              << " bytesDown=" << totalBytesDown
               << " timeSum=" << timeSum << "s" << std::endl;
     
     // 修复吞吐量计算：使用实际传输时间窗口，而不是所有请求时间总和
     double actualTransmissionTime = lastRecv - firstSend;
-    double throughputDown = (actualTransmissionTime > 0) ? (bytesDown * 8.0) / (actualTransmissionTime * 1e6) : 0.0;
+    double throughputDown = (actualTransmissionTime > 0) ? (totalBytesDown * 8.0) / (actualTransmissionTime * 1e6) : 0.0;
 
-    double totalBytesUp = double(nDone) * headerCompressed;
+    double totalBytesUp = double(nDone) * reqHeaderCompressed;
     double totalBytesBi = totalBytesDown + totalBytesUp;
     double totalTime = lastRecv - firstSend;
-    // 修复双向吞吐量计算
-    double bytesBiPer = (respSize + headerCompressed + headerCompressed); // 下行+上行
-    double bytesBi = 0.0;
-    double timeSumBi = 0.0;
-    for (size_t i = 0; i < n; ++i) {
-      if (recvTimes[i] > sendTimes[i]) {
-        double dt = recvTimes[i] - sendTimes[i];
-        if (dt > 0 && dt < simTime) {   // 过滤异常
-          bytesBi += bytesBiPer;
-          timeSumBi += dt;
-        }
-      }
-    }
     double throughputBi = (actualTransmissionTime > 0) ? (totalBytesBi * 8.0) / (actualTransmissionTime * 1e6) : 0.0; // 与下行同窗计算
 
-    double originalBytes = double(nDone) * (respSize + headerSize);
-    double savedBytes = originalBytes - totalBytesDown;
-    double compressionRatio = (originalBytes > 0) ? (savedBytes / originalBytes) * 100.0 : 0.0;
+    // 头部压缩节省的字节（两个方向，相对未压缩头部）
+    double plainHeaderBytes = double(reqQpack.plainBytes + respQpack.plainBytes);
+    double savedBytes = plainHeaderBytes - double(reqQpack.encodedBytes + reqQpack.encoderStreamBytes +
+                                                  respQpack.encodedBytes + respQpack.encoderStreamBytes);
+    double compressionRatio = (plainHeaderBytes > 0) ? (savedBytes / plainHeaderBytes) * 100.0 : 0.0;
 
     std::cout << "Average delay of HTTP/3: " << avgDelay << " s" << std::endl;
 
     std::cout << "------------------------------------------\n";
     std::cout << "HTTP/3 Experiment Summary\n";
     std::cout << "completedResponses (nDone): " << nDone << "/" << nRequests << std::endl;
-    std::cout << "dataPerResp (bytes): " << respSize << std::endl;
+    std::cout << "dataPerResp (bytes): " << std::fixed << std::setprecision(0) << double(doneBytes) / totalResps << std::endl;
     std::cout << "qpackPerResp (bytes): " << std::fixed << std::setprecision(0) << headerCompressed << std::endl;
     std::cout << "firstSend: " << std::fixed << std::setprecision(6) << firstSend << "s\n";
     std::cout << "lastRecv: "  << std::fixed << std::setprecision(6) << lastRecv  << "s\n";
@@ -1798,6 +2695,13 @@ int main(int argc, char* argv[]) {
 
     std::cout << "QPACK compression: saved " << std::fixed << std::setprecision(0) << savedBytes
               << " bytes (" << std::fixed << std::setprecision(1) << compressionRatio << "%)\n";
+    std::cout << "QPACK requests: " << reqQpack.plainBytes << " -> " << reqQpack.encodedBytes << " + "
+              << reqQpack.encoderStreamBytes << " B (ratio " << std::setprecision(3) << reqQpack.Ratio()
+              << ")  responses: " << respQpack.plainBytes << " -> " << respQpack.encodedBytes << " + "
+              << respQpack.encoderStreamBytes << " B (ratio " << respQpack.Ratio() << ")\n";
+    std::cout << "QPACK decoder blocked: " << qpackBlocked.blockedSections << " sections  time: "
+              << std::setprecision(6) << qpackBlocked.blockedSeconds << " s  max: "
+              << qpackBlocked.maxBlockedSeconds << " s\n";
       // 修复Page Load Time：使用逐请求的均值
     double pageLoadTime = 0.0;
     if (nDone > 0) {
@@ -1815,10 +2719,24 @@ int main(int argc, char* argv[]) {
       }
     }
     std::cout << "Page Load Time (onLoad): " << std::fixed << std::setprecision(6) << pageLoadTime << " s\n";
+    double meanRespTime = SampleMean(respTimes);
+    double p95RespTime = SamplePercentile(respTimes, 95.0);
+    std::cout << "Scheduler: " << dataScheduler.GetName() << " (aging=" << std::setprecision(0) << srptAging << " B/s)\n";
+    std::cout << "Mean response time: " << std::fixed << std::setprecision(6) << meanRespTime << " s\n";
+    std::cout << "p95 response time: " << std::fixed << std::setprecision(6) << p95RespTime << " s\n";
     std::cout << "QUIC retransmissions: " << g_retxCount
               << "  rate: " << std::fixed << std::setprecision(3) << (g_retxCount / (totalTime > 0 ? totalTime : 1.0)) << " /s\n";
     std::cout << "RFC3550 jitter estimate: " << std::fixed << std::setprecision(6) << rfcJitter << " s\n";
     std::cout << "HoL events: " << holEvents << "  HoL blocked time: " << std::fixed << std::setprecision(6) << holBlockedTime << " s\n";
+    std::cout << "HoL held bytes: " << streamHol.heldBytes << "  peak: " << connHol.maxHeldBytes
+              << " B  byte-seconds: " << std::setprecision(6) << streamHol.byteSeconds
+              << "  streams affected: " << holStreams << "\n";
+    std::cout << "Stream gaps: " << streamHol.episodes << "  stream blocked time (sum over streams): "
+              << streamHol.seconds << " s\n";
+    double blockedCwnd = server->GetSendBlockedSeconds(QuicSession::BLOCKED_CWND);
+    double blockedPacing = server->GetSendBlockedSeconds(QuicSession::BLOCKED_PACING);
+    std::cout << "Server send blocked: cwnd=" << std::fixed << std::setprecision(6) << blockedCwnd
+              << " s  pacing=" << blockedPacing << " s\n";
     std::cout << "------------------------------------------\n";
 
     // ---- Structured one-line summary for CSV harvesting ----
@@ -1851,32 +2769,95 @@ int main(int argc, char* argv[]) {
               << " jitter_s=" << std::setprecision(6) << rfcJitter
               << " hol_events=" << holEvents
               << " hol_time_s=" << std::setprecision(6) << holBlockedTime
+              << " blocked_cwnd_s=" << std::setprecision(6) << blockedCwnd
+              << " blocked_pacing_s=" << blockedPacing
               << " qpack_saved_bytes=" << (long long)std::llround(savedBytes)
               << " qpack_compression_percent=" << std::setprecision(1) << compressionRatio
+              << " scheduler=" << dataScheduler.GetName()
+              << " mean_rt_s=" << std::setprecision(6) << meanRespTime
+              << " p95_rt_s=" << std::setprecision(6) << p95RespTime
               << std::endl;
-  }
 
-  flowmon->CheckForLostPackets();
-  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(fmHelper.GetClassifier());
-  if (classifier) {
-    const auto& stats = flowmon->GetFlowStats();
-    for (const auto& kv : stats) {
-      uint32_t flowId = kv.first;
-      const FlowMonitor::FlowStats& st = kv.second;
-      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
-      double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
-      double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
-      std::cout << "Flow " << flowId
-                << " src=" << t.sourceAddress << ":" << t.sourcePort
-                << " -> dst=" << t.destinationAddress << ":" << t.destinationPort
-                << " proto=" << uint32_t(t.protocol)
-                << " rxPackets=" << st.rxPackets
-                << " avgDelay=" << avgDelay << " s"
-                << " avgJitter=" << avgJitter << " s"
-                << std::endl;
-    }
-  }
-  flowmon->SerializeToXmlFile("flowmon.xml", true, true);
+    results.Metrics().Field("page_load_time_s", pageLoadTime).Field("avg_delay_s", avgDelay)
+                     .Field("mean_response_time_s", meanRespTime).Field("p95_response_time_s", p95RespTime)
+                     .Field("downlink_bytes", totalBytesDown).Field("throughput_mbps", throughputDown)
+                     .Field("bidirectional_bytes", totalBytesBi).Field("bidirectional_throughput_mbps", throughputBi)
+                     .Field("qpack_saved_bytes", savedBytes)
+                     .Field("blocked_cwnd_s", blockedCwnd).Field("blocked_pacing_s", blockedPacing);
+  }
+  if (!g_workload.Empty()) {
+    CriticalPathInfo cp = g_workload.CriticalPath(2 * Time(delay).GetSeconds(), DataRate(dataRate).GetBitRate() / 8.0);
+    g_workload.PrintCriticalPath(std::cout, cp);
+    results.Metrics().Field("critical_path_s", cp.seconds).Field("critical_path_objects", cp.objects.size())
+                     .Field("critical_path_processing_s", cp.processSeconds)
+                     .Field("workload_plt_s", g_workload.LoadTime());
+  }
+  if (g_arrivals.Active()) {
+    ArrivalStats arrivals;
+    for (auto& c : clients) arrivals.Add(c->GetArrivalStats());
+    arrivals.Print(std::cout, g_arrivals.OfferedRate());
+    arrivals.AddMetrics(results.Metrics(), g_arrivals.OfferedRate());
+  }
+  PrintLatencyPercentiles(GlobalHistograms(), std::cout);
+  GlobalBytes().Print(std::cout);
+  GlobalBytes().AddMetrics(results.Metrics());
+  results.Metrics().Field("completed_responses", totalResps).Field("requested_responses", nRequests)
+                   .Field("retransmissions", g_retxCount).Field("jitter_s", rfcJitter)
+                   .Field("hol_events", holEvents).Field("hol_blocked_time_s", holBlockedTime)
+                   .Field("hol_held_bytes", streamHol.heldBytes).Field("hol_peak_held_bytes", connHol.maxHeldBytes)
+                   .Field("hol_byte_seconds", streamHol.byteSeconds).Field("hol_streams", holStreams)
+                   .Field("hol_stream_gaps", streamHol.episodes).Field("hol_stream_blocked_time_s", streamHol.seconds)
+                   .Field("qpack_req_plain_bytes", reqQpack.plainBytes).Field("qpack_req_encoded_bytes", reqQpack.encodedBytes)
+                   .Field("qpack_req_encoder_stream_bytes", reqQpack.encoderStreamBytes)
+                   .Field("qpack_resp_plain_bytes", respQpack.plainBytes).Field("qpack_resp_encoded_bytes", respQpack.encodedBytes)
+                   .Field("qpack_resp_encoder_stream_bytes", respQpack.encoderStreamBytes)
+                   .Field("qpack_req_ratio", reqQpack.Ratio()).Field("qpack_resp_ratio", respQpack.Ratio())
+                   .Field("qpack_blocked_sections", qpackBlocked.blockedSections)
+                   .Field("qpack_blocked_time_s", qpackBlocked.blockedSeconds)
+                   .Field("qpack_max_blocked_s", qpackBlocked.maxBlockedSeconds);
+  results.AddLatencyPercentiles(GlobalHistograms());
+  if (profile) runCost.PrintProfile(std::cout);
+  results.Metrics().Field("sim_events", runCost.GetEvents()).Field("wall_s", runCost.GetWallSeconds())
+                   .Field("peak_rss_kb", PeakRssKb());
+
+  if (flowmon) {
+    flowmon->CheckForLostPackets();
+    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(fmHelper.GetClassifier());
+    if (classifier) {
+      const auto& stats = flowmon->GetFlowStats();
+      for (const auto& kv : stats) {
+        uint32_t flowId = kv.first;
+        const FlowMonitor::FlowStats& st = kv.second;
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
+        double avgDelay = (st.rxPackets > 0) ? st.delaySum.GetSeconds() / st.rxPackets : 0.0;
+        double avgJitter = (st.rxPackets > 1) ? st.jitterSum.GetSeconds() / (st.rxPackets - 1) : 0.0;
+        std::cout << "Flow " << flowId
+                  << " src=" << t.sourceAddress << ":" << t.sourcePort
+                  << " -> dst=" << t.destinationAddress << ":" << t.destinationPort
+                  << " proto=" << uint32_t(t.protocol)
+                  << " rxPackets=" << st.rxPackets
+                  << " avgDelay=" << avgDelay << " s"
+                  << " avgJitter=" << avgJitter << " s"
+                  << std::endl;
+      }
+    }
+    results.AddFlows(flowmon, classifier);
+    if (!flowStatsFile.empty() && !results.WriteFlows(flowStatsFile)) {
+      std::cerr << "Cannot write flow stats to " << flowStatsFile << std::endl;
+    }
+    if (!flowmonXml.empty()) flowmon->SerializeToXmlFile(flowmonXml, true, true);
+  }
+  DumpGlobalTrace(traceFile, "http3", std::cout);
+  if (!sampleFile.empty() && !server->GetSampler().Write(sampleFile)) {
+    std::cerr << "Cannot write samples to " << sampleFile << std::endl;
+  }
+  if (!histFile.empty() && !GlobalHistograms().Save(histFile, "http3")) {
+    std::cerr << "Cannot write histograms to " << histFile << std::endl;
+  }
+  if (!resultsFile.empty()) {
+    if (results.Write(resultsFile)) std::cout << "Results written to " << resultsFile << std::endl;
+    else std::cerr << "Cannot write results to " << resultsFile << std::endl;
+  }
 
   // 验证数据完整性
   std::cout << "\n------ Data Integrity Verification ------\n";
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# loadsweep.py
+# Latency-vs-offered-load curves from the open-loop mode of the sims
+# (--arrivalRate, see common/arrivals.h).
+#
+# Each sim is run once per load point with Poisson arrivals. One CSV row per
+# run records offered and achieved req/s, goodput, and p50/p99 sojourn latency
+# (arrival -> last response byte, so backlog wait is included). The row also
+# holds drop counts. With --plot, throughput and p99 are drawn against offered
+# load.
+#
+#   cd <ns-3-dev>
+#   python3 scratch/loadsweep/loadsweep.py --sims http1.1,http2,http3 \
+#       --loads 0.1,0.3,0.5,0.7,0.8,0.9,0.95,1.0,1.1 --plot -- --delay=10ms --errorRate=0.001
+#
+# Loads are fractions of the link's request capacity,
+# dataRate / (8 * respSize) req/s; header and transport overhead are not
+# counted, so saturation shows up slightly below 1.0. --rates gives absolute
+# req/s instead. Arguments after "--" are passed to every sim unchanged, so
+# they must be flags all three accept (--delay, --dataRate, --errorRate, ...);
+# a sim-specific flag such as --nStreams makes the other sims exit.
+
+import argparse, csv, json, os, re, subprocess, sys
+
+SIMS = {
+    "http1.1": "scratch/http1.1/sim",
+    "http2": "scratch/http2/http2",
+    "http3": "scratch/http3/http3",
+}
+
+COLUMNS = ["sim", "load", "offered_rps", "achieved_rps", "throughput_mbps", "p50_ms", "p99_ms",
+           "completed", "requested", "dropped", "peak_backlog"]
+
+
+def parse_rate_bps(rate):
+    m = re.fullmatch(r"\s*([0-9.]+)\s*([kKMG]?)(bps|b/s|B/s)\s*", rate)
+    if not m:
+        raise ValueError(f"cannot parse dataRate '{rate}', pass --capacity")
+    scale = {"": 1, "k": 1e3, "K": 1e3, "M": 1e6, "G": 1e9}[m.group(2)]
+    return float(m.group(1)) * scale * (8 if m.group(3) == "B/s" else 1)
+
+
+def floats(text):
+    return [float(x) for x in text.split(",") if x.strip()]
+
+
+def run_point(args, sim, rate, capacity, extra):
+    tag = f"{sim}_rate{rate:g}"
+    results = os.path.abspath(os.path.join(args.out, tag + ".json"))
+    # Long enough for every arrival and, past saturation, for the backlog to drain
+    sim_time = 1.0 + 2.0 * args.nRequests / min(rate, capacity) + 10.0
+    params = [f"--dataRate={args.dataRate}", f"--respSize={args.respSize}",
+              f"--nRequests={args.nRequests}", f"--arrivalRate={rate}",
+              f"--maxBacklog={args.maxBacklog}", f"--simTime={sim_time:.3f}",
+              f"--RngRun={args.rngRun}", "--quiet=true", f"--resultsFile={results}"] + extra
+    cmd = ["./ns3", "run", SIMS[sim] + " " + " ".join(params)]
+    print("Running:", " ".join(cmd), flush=True)
+    try:
+        proc = subprocess.run(cmd, cwd=args.ns3_dir, capture_output=True, text=True, timeout=args.timeout)
+    except subprocess.TimeoutExpired:
+        print(f"  timed out after {args.timeout}s", file=sys.stderr)
+        return None
+    with open(os.path.join(args.out, tag + ".txt"), "w") as f:
+        f.write(proc.stdout + "\n" + proc.stderr)
+    if proc.returncode != 0 or not os.path.exists(results):
+        print(f"  failed (exit {proc.returncode}), see {tag}.txt", file=sys.stderr)
+        return None
+    with open(results) as f:
+        return json.load(f)["metrics"]
+
+
+def row_for(sim, rate, capacity, metrics):
+    row = {"sim": sim, "load": rate / capacity, "offered_rps": rate}
+    if metrics is None:
+        return row
+    ms = lambda key: metrics[key] * 1e3 if metrics.get(key) is not None else ""
+    row.update({
+        "offered_rps": metrics.get("offered_rps", rate),
+        "achieved_rps": metrics.get("achieved_rps", ""),
+        "throughput_mbps": metrics.get("throughput_mbps", ""),
+        "p50_ms": ms("latency_sojourn_p50_s"),
+        "p99_ms": ms("latency_sojourn_p99_s"),
+        "completed": metrics.get("completed_responses", ""),
+        "requested": metrics.get("requested_responses", ""),
+        "dropped": metrics.get("dropped_requests", ""),
+        "peak_backlog": metrics.get("peak_backlog", ""),
+    })
+    return row
+
+
+def plot(rows, capacity, path):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib not available, skipping the plot", file=sys.stderr)
+        return
+
+    fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(12, 4.5))
+    for sim in dict.fromkeys(r["sim"] for r in rows):
+        pts = [r for r in rows if r["sim"] == sim and r.get("achieved_rps", "") != ""]
+        x = [r["offered_rps"] for r in pts]
+        ax1.plot(x, [r["achieved_rps"] for r in pts], marker="o", label=sim)
+        p99 = [(r["offered_rps"], r["p99_ms"]) for r in pts if r["p99_ms"] != ""]
+        ax2.plot([p[0] for p in p99], [p[1] for p in p99], marker="o", label=sim)
+    for ax in (ax1, ax2):
+        ax.axvline(capacity, color="grey", linestyle="--", linewidth=1, label="link capacity")
+        ax.set_xlabel("Offered load (req/s)")
+        ax.grid(True, alpha=0.3)
+        ax.legend()
+    ax1.set_ylabel("Achieved throughput (req/s)")
+    ax1.set_title("Throughput vs offered load")
+    ax2.set_ylabel("p99 sojourn latency (ms)")
+    ax2.set_yscale("log")
+    ax2.set_title("p99 latency vs offered load")
+    fig.tight_layout()
+    fig.savefig(path, dpi=150)
+    print("Plot written to", path)
+
+
+def main():
+    argv = sys.argv[1:]
+    extra = []
+    if "--" in argv:
+        extra = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+    ap = argparse.ArgumentParser(description="Open-loop load sweep over the HTTP/1.1, HTTP/2 and HTTP/3 sims")
+    ap.add_argument("--sims", default="http1.1,http2,http3", help="comma-separated: " + ",".join(SIMS))
+    ap.add_argument("--loads", default="0.1,0.2,0.3,0.4,0.5,0.6,0.7,0.8,0.85,0.9,0.95,1.0,1.05,1.1",
+                    help="offered load points as fractions of link capacity")
+    ap.add_argument("--rates", default="", help="absolute offered loads in req/s (overrides --loads)")
+    ap.add_argument("--capacity", type=float, default=0.0, help="link capacity in req/s (default: from dataRate/respSize)")
+    ap.add_argument("--dataRate", default="10Mbps")
+    ap.add_argument("--respSize", type=int, default=102400)
+    ap.add_argument("--nRequests", type=int, default=200, help="arrivals per run")
+    ap.add_argument("--maxBacklog", type=int, default=0, help="per-connection backlog bound (0 = unbounded)")
+    ap.add_argument("--rngRun", type=int, default=1)
+    ap.add_argument("--ns3-dir", default=os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..")))
+    ap.add_argument("--out", default="loadsweep-results")
+    ap.add_argument("--timeout", type=int, default=600, help="seconds per run")
+    ap.add_argument("--plot", action="store_true", help="also write loadsweep.png (needs matplotlib)")
+    args = ap.parse_args(argv)
+
+    sims = [s for s in args.sims.split(",") if s]
+    for s in sims:
+        if s not in SIMS:
+            ap.error(f"unknown sim '{s}'")
+    try:
+        capacity = args.capacity or parse_rate_bps(args.dataRate) / (8.0 * args.respSize)
+    except ValueError as e:
+        ap.error(str(e))
+    rates = floats(args.rates) if args.rates else [f * capacity for f in floats(args.loads)]
+    if not rates or min(rates) <= 0:
+        ap.error("offered loads must be positive (0 would be the closed-loop mode)")
+    os.makedirs(args.out, exist_ok=True)
+    print(f"Link capacity ~{capacity:.2f} req/s ({args.dataRate}, {args.respSize} B responses)")
+
+    rows = []
+    for sim in sims:
+        for rate in rates:
+            rows.append(row_for(sim, rate, capacity, run_point(args, sim, rate, capacity, extra)))
+
+    csv_path = os.path.join(args.out, "loadsweep.csv")
+    with open(csv_path, "w", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=COLUMNS)
+        w.writeheader()
+        for r in rows:
+            w.writerow(r)
+    print("Sweep written to", csv_path)
+    if args.plot:
+        plot(rows, capacity, os.path.join(args.out, "loadsweep.png"))
+
+
+if __name__ == "__main__":
+    main()